@@ -0,0 +1,237 @@
+#pragma once
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "allocator_types.h"
+#include "config.h"
+#include "error.h"
+#include "utility.h"
+
+#ifdef __linux__
+#include <sys/mman.h>
+#endif
+
+/// @brief Alignment of allocations made from a `TCODPATH_Arena`.
+#define TCODPATH_ARENA_ALIGNMENT 16
+
+/// @brief Storage of the global allocator, shared by every translation unit.
+/// Used internally.
+inline TCODPATH_Allocator** TCODPATH_global_allocator_(void) {
+  static TCODPATH_Allocator* allocator = NULL;
+  return &allocator;
+}
+/// @brief Set the allocator used by containers and maps which were not given their own allocator.
+/// @details Must not be changed while memory from the previous allocator is still held by the library.
+/// @param allocator The new global allocator, or `NULL` to use `malloc` and `free` directly without any counters.
+static inline void TCODPATH_set_allocator(TCODPATH_Allocator* allocator) { *TCODPATH_global_allocator_() = allocator; }
+/// @brief Return the global allocator, or `NULL` if `malloc` and `free` are used directly.
+static inline TCODPATH_Allocator* TCODPATH_get_allocator(void) { return *TCODPATH_global_allocator_(); }
+
+/// @brief Count `delta` bytes against `allocator`.
+/// Used internally.
+static inline void TCODPATH_allocator_count_(TCODPATH_Allocator* __restrict allocator, int64_t delta) {
+  allocator->live_bytes += delta;
+  allocator->peak_bytes = TCODPATH_MAX(allocator->peak_bytes, allocator->live_bytes);
+}
+/// @brief Return true if `allocator` may grow by `delta` bytes without going over its limit.
+/// Used internally.
+static inline bool TCODPATH_allocator_within_limit_(const TCODPATH_Allocator* __restrict allocator, int64_t delta) {
+  return !allocator->limit_bytes || allocator->live_bytes + delta <= allocator->limit_bytes;
+}
+/// @brief Allocate `size` bytes from `allocator`, or from the global allocator if `allocator` is `NULL`.
+/// Used internally.
+static inline void* TCODPATH_alloc_(TCODPATH_Allocator* allocator, size_t size) {
+  if (!allocator) allocator = TCODPATH_get_allocator();
+  if (!allocator) return malloc(size);
+  if (!TCODPATH_allocator_within_limit_(allocator, (int64_t)size)) return NULL;
+  void* ptr = allocator->alloc(allocator->userdata, size);
+  if (ptr) TCODPATH_allocator_count_(allocator, (int64_t)size);
+  return ptr;
+}
+/// @brief Allocate `count * size` zeroed bytes like `TCODPATH_alloc_`.
+/// Used internally.
+static inline void* TCODPATH_calloc_(TCODPATH_Allocator* allocator, size_t count, size_t size) {
+  if (!allocator && !TCODPATH_get_allocator()) return calloc(count, size);
+  if (size && count > SIZE_MAX / size) return NULL;  // `count * size` would overflow, as calloc checks
+  void* ptr = TCODPATH_alloc_(allocator, count * size);
+  if (ptr) memset(ptr, 0, count * size);
+  return ptr;
+}
+/// @brief Resize `ptr` from `old_size` to `new_size` bytes like `TCODPATH_alloc_`. `ptr` can be `NULL`.
+/// Used internally.
+static inline void* TCODPATH_realloc_(TCODPATH_Allocator* allocator, void* ptr, size_t old_size, size_t new_size) {
+  if (!allocator) allocator = TCODPATH_get_allocator();
+  if (!allocator) return realloc(ptr, new_size);
+  if (!ptr) return TCODPATH_alloc_(allocator, new_size);
+  const int64_t delta = (int64_t)new_size - (int64_t)old_size;
+  if (!TCODPATH_allocator_within_limit_(allocator, delta)) return NULL;
+  void* new_ptr = NULL;
+  if (allocator->realloc) {
+    new_ptr = allocator->realloc(allocator->userdata, ptr, old_size, new_size);
+  } else {
+    new_ptr = allocator->alloc(allocator->userdata, new_size);
+    if (!new_ptr) return NULL;
+    memcpy(new_ptr, ptr, TCODPATH_MIN(old_size, new_size));
+    if (allocator->free) allocator->free(allocator->userdata, ptr, old_size);
+  }
+  if (new_ptr) TCODPATH_allocator_count_(allocator, delta);
+  return new_ptr;
+}
+/// @brief Free `ptr` of `size` bytes like `TCODPATH_alloc_`. `ptr` can be `NULL`.
+/// Used internally.
+static inline void TCODPATH_free_(TCODPATH_Allocator* allocator, void* ptr, size_t size) {
+  if (!ptr) return;
+  if (!allocator) allocator = TCODPATH_get_allocator();
+  if (!allocator) {
+    free(ptr);
+    return;
+  }
+  if (allocator->free) allocator->free(allocator->userdata, ptr, size);
+  TCODPATH_allocator_count_(allocator, -(int64_t)size);
+}
+
+/// @brief Hooks of `TCODPATH_allocator_malloc`.
+/// Used internally.
+static inline void* TCODPATH_malloc_alloc_(void*, size_t size) { return malloc(size); }
+static inline void* TCODPATH_malloc_realloc_(void*, void* ptr, size_t, size_t new_size) {
+  return realloc(ptr, new_size);
+}
+static inline void TCODPATH_malloc_free_(void*, void* ptr, size_t) { free(ptr); }
+/// @brief Return an allocator which uses `malloc` and `free`, for counting or limiting the memory of the library.
+static inline TCODPATH_Allocator TCODPATH_allocator_malloc(void) {
+  TCODPATH_Allocator allocator = {};
+  allocator.alloc = TCODPATH_malloc_alloc_;
+  allocator.realloc = TCODPATH_malloc_realloc_;
+  allocator.free = TCODPATH_malloc_free_;
+  return allocator;
+}
+
+/// @brief Setup an arena over `capacity` bytes of existing memory, such as a block of huge pages.
+/// @param data Memory which must outlive the arena and must be freed separately.
+static inline void TCODPATH_arena_init_from(TCODPATH_Arena* __restrict arena, size_t capacity, void* data) {
+  *arena = TCODPATH_Arena{};
+  arena->data = (unsigned char*)data;
+  arena->capacity = data ? capacity : 0;
+}
+/// @brief Setup an arena which owns a new block of `capacity` bytes.
+/// @return 0 on success, negative value on error.
+static inline int TCODPATH_arena_init(TCODPATH_Arena* __restrict arena, size_t capacity) {
+  if (!arena) return TCODPATH_E_INVALID_ARGUMENT;
+  void* data = malloc(capacity);
+  if (!data) return TCODPATH_E_OUT_OF_MEMORY;
+  TCODPATH_arena_init_from(arena, capacity, data);
+  arena->owned_data = true;
+  return TCODPATH_E_OK;
+}
+/// @brief Free the block of an arena and reset it to the default zero state.
+static inline void TCODPATH_arena_uninit(TCODPATH_Arena* __restrict arena) {
+  if (!arena) return;
+  if (arena->owned_data) free(arena->data);
+  *arena = TCODPATH_Arena{};
+}
+/// @brief Release every allocation of `arena` at once.
+/// @details Anything still holding memory from the arena must be uninitialized first, or discarded.
+/// The counters of allocators made from this arena are not changed.
+static inline void TCODPATH_arena_reset(TCODPATH_Arena* __restrict arena) { arena->used = arena->last = 0; }
+/// @brief Hooks of `TCODPATH_arena_allocator`, `arena_` is the arena.
+/// Used internally.
+static inline void* TCODPATH_arena_alloc_(void* arena_, size_t size) {
+  TCODPATH_Arena* __restrict arena = (TCODPATH_Arena*)arena_;
+  const size_t offset = (arena->used + TCODPATH_ARENA_ALIGNMENT - 1) & ~(size_t)(TCODPATH_ARENA_ALIGNMENT - 1);
+  if (offset > arena->capacity || size > arena->capacity - offset) return NULL;  // Arena is full
+  arena->last = offset;
+  arena->used = offset + size;
+  return arena->data + offset;
+}
+static inline void* TCODPATH_arena_realloc_(void* arena_, void* ptr, size_t old_size, size_t new_size) {
+  TCODPATH_Arena* __restrict arena = (TCODPATH_Arena*)arena_;
+  if ((unsigned char*)ptr == arena->data + arena->last && new_size <= arena->capacity - arena->last) {
+    arena->used = arena->last + new_size;  // The most recent allocation grows or shrinks in place
+    return ptr;
+  }
+  void* new_ptr = TCODPATH_arena_alloc_(arena, new_size);
+  if (new_ptr) memcpy(new_ptr, ptr, TCODPATH_MIN(old_size, new_size));
+  return new_ptr;
+}
+static inline void TCODPATH_arena_free_(void* arena_, void* ptr, size_t) {
+  TCODPATH_Arena* __restrict arena = (TCODPATH_Arena*)arena_;
+  if ((unsigned char*)ptr == arena->data + arena->last) arena->used = arena->last;  // Give back the most recent one
+}
+/// @brief Return an allocator which takes memory from `arena`. Allocations fail once the arena is full.
+static inline TCODPATH_Allocator TCODPATH_arena_allocator(TCODPATH_Arena* __restrict arena) {
+  TCODPATH_Allocator allocator = {};
+  allocator.alloc = TCODPATH_arena_alloc_;
+  allocator.realloc = TCODPATH_arena_realloc_;
+  allocator.free = TCODPATH_arena_free_;
+  allocator.userdata = arena;
+  return allocator;
+}
+
+/// @brief Return true if an allocation of `size` bytes is mapped on huge pages by `TCODPATH_allocator_huge_pages`.
+/// Used internally.
+static inline bool TCODPATH_is_huge_allocation_(size_t size) {
+#ifdef __linux__
+  return size >= TCODPATH_HUGE_PAGE_SIZE;
+#else
+  (void)size;
+  return false;
+#endif
+}
+/// @brief Map `size` bytes on huge pages, or allocate them with `malloc` if they are smaller than a huge page.
+/// @details Explicit huge pages are used when the system has some reserved, otherwise the mapping is advised to use
+/// transparent huge pages. Other platforms always use `malloc`.
+/// Used internally.
+static inline void* TCODPATH_huge_page_alloc_(void*, size_t size) {
+  if (!TCODPATH_is_huge_allocation_(size)) return malloc(size);
+#ifdef __linux__
+  const size_t length = (size + TCODPATH_HUGE_PAGE_SIZE - 1) / TCODPATH_HUGE_PAGE_SIZE * TCODPATH_HUGE_PAGE_SIZE;
+  void* ptr = MAP_FAILED;
+#ifdef MAP_HUGETLB
+  ptr = mmap(NULL, length, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+#endif
+  if (ptr != MAP_FAILED) return ptr;
+  ptr = mmap(NULL, length, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+  if (ptr == MAP_FAILED) return NULL;
+#ifdef MADV_HUGEPAGE
+  madvise(ptr, length, MADV_HUGEPAGE);
+#endif
+  return ptr;
+#else
+  return NULL;
+#endif
+}
+/// @brief Unmap or free memory from `TCODPATH_huge_page_alloc_`.
+/// Used internally.
+static inline void TCODPATH_huge_page_free_(void*, void* ptr, size_t size) {
+  if (!TCODPATH_is_huge_allocation_(size)) {
+    free(ptr);
+    return;
+  }
+#ifdef __linux__
+  munmap(ptr, (size + TCODPATH_HUGE_PAGE_SIZE - 1) / TCODPATH_HUGE_PAGE_SIZE * TCODPATH_HUGE_PAGE_SIZE);
+#endif
+}
+/// @brief Move memory from `TCODPATH_huge_page_alloc_` to a new allocation.
+/// Used internally.
+static inline void* TCODPATH_huge_page_realloc_(void*, void* ptr, size_t old_size, size_t new_size) {
+  if (!TCODPATH_is_huge_allocation_(old_size) && !TCODPATH_is_huge_allocation_(new_size)) {
+    return realloc(ptr, new_size);
+  }
+  void* new_ptr = TCODPATH_huge_page_alloc_(NULL, new_size);
+  if (!new_ptr) return NULL;
+  memcpy(new_ptr, ptr, TCODPATH_MIN(old_size, new_size));
+  TCODPATH_huge_page_free_(NULL, ptr, old_size);
+  return new_ptr;
+}
+/// @brief Return an allocator which puts allocations of `TCODPATH_HUGE_PAGE_SIZE` or more on huge pages.
+/// @details Full-map searches over large maps make fewer TLB misses when the maps are on huge pages.
+/// Smaller allocations use `malloc`.
+static inline TCODPATH_Allocator TCODPATH_allocator_huge_pages(void) {
+  TCODPATH_Allocator allocator = {};
+  allocator.alloc = TCODPATH_huge_page_alloc_;
+  allocator.realloc = TCODPATH_huge_page_realloc_;
+  allocator.free = TCODPATH_huge_page_free_;
+  return allocator;
+}
@@ -0,0 +1,37 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/// @brief Return `size` bytes of uninitialized memory, or `NULL` on failure.
+typedef void* TCODPATH_AllocFunction(void* userdata, size_t size);
+/// @brief Resize memory from the same allocator, keeping its contents. Return `NULL` on failure.
+typedef void* TCODPATH_ReallocFunction(void* userdata, void* ptr, size_t old_size, size_t new_size);
+/// @brief Release memory from the same allocator. `size` is the size it was allocated or last resized with.
+typedef void TCODPATH_FreeFunction(void* userdata, void* ptr, size_t size);
+
+/// @brief Memory hooks used by the library in place of `malloc`, `realloc`, and `free`.
+/// @details Sizes are always given back to `realloc` and `free`, so allocators do not need to store them.
+/// The counters are updated by the library and are not atomic, an allocator must not be shared between threads
+/// unless its hooks and counters are only used by one of them at a time.
+typedef struct TCODPATH_Allocator {
+  TCODPATH_AllocFunction* alloc;  // Required
+  TCODPATH_ReallocFunction* realloc;  // Optional, when NULL memory is moved with `alloc`, `memcpy`, and `free`
+  TCODPATH_FreeFunction* free;  // Optional, can be NULL for allocators which release everything at once
+  void* userdata;  // Passed to each hook
+  int64_t live_bytes;  // Bytes currently allocated through this allocator
+  int64_t peak_bytes;  // Largest value `live_bytes` has reached
+  int64_t limit_bytes;  // If not zero then allocations which would take `live_bytes` above this fail
+} TCODPATH_Allocator;
+
+/// @brief Bump allocator over one block of memory, see `TCODPATH_arena_allocator`.
+/// @details Allocations are freed all at once with `TCODPATH_arena_reset`.
+/// Only the most recent allocation can be resized in place or given back early.
+typedef struct TCODPATH_Arena {
+  unsigned char* __restrict data;
+  size_t capacity;  // Size of `data` in bytes
+  size_t used;  // Bytes used from the start of `data`, including alignment padding
+  size_t last;  // Offset of the most recent allocation
+  bool owned_data;  // If true then `data` will be freed by `TCODPATH_arena_uninit`
+} TCODPATH_Arena;
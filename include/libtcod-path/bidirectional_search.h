@@ -0,0 +1,186 @@
+#pragma once
+
+#include "breadth_first_search.h"
+#include "error.h"
+#include "flow_tools.h"
+#include "map_tools.h"
+#include "partition.h"
+#include "queue.h"
+#include "uniform_cost_search.h"
+
+/// @brief Write the half of the path found by the backward search into `distance` and `flow`.
+/// @details Follows `reverse_flow` from `meeting` to the goal, pointing each node of `flow` back at the node before
+/// it. Afterwards `distance` and `flow` can be used as if a single search from the start had reached the goal.
+/// Used internally.
+static inline void TCODPATH_bidirectional_stitch_(
+    TCODPATH_Map* __restrict distance,
+    TCODPATH_Map* __restrict flow,
+    const TCODPATH_Map* __restrict reverse_distance,
+    const TCODPATH_Map* __restrict reverse_flow,
+    const TCODPATH_IndexType* __restrict meeting) {
+  const int dimensions = TCODPATH_map_get_dimensions(distance);
+  const TCODPATH_ValueType total_distance =
+      TCODPATH_map_get(distance, meeting) + TCODPATH_map_get(reverse_distance, meeting);
+  TCODPATH_IndexType previous[TCODPATH_MAX_DIMENSIONS];
+  TCODPATH_IndexType index[TCODPATH_MAX_DIMENSIONS];
+  for (int i = 0; i < dimensions; ++i) previous[i] = index[i] = meeting[i];
+  while (TCODPATH_flow_iter_next(reverse_flow, index) == 0) {
+    TCODPATH_map_set(distance, index, total_distance - TCODPATH_map_get(reverse_distance, index));
+    if (flow) TCODPATH_map_set_index(flow, index, previous);
+    for (int i = 0; i < dimensions; ++i) previous[i] = index[i];
+  }
+}
+
+/// @brief Bidirectional A* search between `start` and `goal`, meeting in the middle.
+/// @details A forward search from `start` and a backward search from `goal` are expanded in turn, always the one
+/// with the smaller frontier. The search stops once no path through the remaining frontiers can be shorter than the
+/// best meeting found, so the result is optimal when both heuristics are admissible. Without heuristics this is
+/// bidirectional Dijkstra, which explores about half the area of a one-sided search on open maps.
+///
+/// The backward search follows `TCODPATH_graph_foreach_reverse_edge`, so the costs of directed graphs are kept.
+/// When `undirected` is true every edge is assumed to cost the same both ways and forward edges are used instead.
+///
+/// On success `distance` and `flow` hold the same path as `TCODPATH_astar` would give: the goal is at its distance
+/// and the flow leads from the goal back to `start`. Other nodes only hold the partial results of the forward search.
+/// `distance` and `reverse_distance` should be cleared with `TCODPATH_map_clear_max` beforehand, and `reverse_flow`
+/// reset with `TCODPATH_flow_reset`.
+/// @param graph Graph to traverse.
+/// @param heuristic Optional heuristic towards `goal`, can be `NULL`.
+/// @param reverse_heuristic Optional heuristic towards `start`, can be `NULL`.
+/// @param undirected If true then edges are assumed to cost the same in both directions.
+/// @param distance Distance map of the forward search. `start` is set to zero.
+/// @param flow Optional flow map of the forward search, can be `NULL`.
+/// @param reverse_distance Distance map of the backward search. `goal` is set to zero.
+/// @param reverse_flow Flow map of the backward search, required to recover the path.
+/// @param start Start index.
+/// @param goal Goal index.
+/// @param partition Optional connectivity labels, see `TCODPATH_partition_is_reachable`.
+/// @return 0 if `goal` was reached, 1 if `goal` is unreachable, negative value on error.
+static inline int TCODPATH_bidirectional_astar(
+    TCODPATH_Graph* __restrict graph,
+    TCODPATH_Heuristic* __restrict heuristic,
+    TCODPATH_Heuristic* __restrict reverse_heuristic,
+    bool undirected,
+    TCODPATH_Map* __restrict distance,
+    TCODPATH_Map* __restrict flow,
+    TCODPATH_Map* __restrict reverse_distance,
+    TCODPATH_Map* __restrict reverse_flow,
+    const TCODPATH_IndexType* __restrict start,
+    const TCODPATH_IndexType* __restrict goal,
+    const TCODPATH_Map* __restrict partition) {
+  if (!reverse_distance || !reverse_flow || !start || !goal) return TCODPATH_E_INVALID_ARGUMENT;
+  if (!TCODPATH_partition_is_reachable(partition, start, goal)) return 1;
+  TCODPATH_UniformCostSearch forward;
+  TCODPATH_UniformCostSearch backward;
+  int err = TCODPATH_ucs_init(&forward, graph, heuristic, distance, flow);
+  if (err < 0) return err;
+  err = TCODPATH_ucs_init(&backward, graph, reverse_heuristic, reverse_distance, reverse_flow);
+  if (err < 0) {
+    TCODPATH_ucs_uninit(&forward);
+    return err;
+  }
+  forward.opposite = reverse_distance;
+  backward.opposite = distance;
+  backward.reverse = !undirected;
+  TCODPATH_map_set(distance, start, 0);
+  TCODPATH_map_set(reverse_distance, goal, 0);
+  err = TCODPATH_ucs_push(&forward, start);
+  if (err >= 0) err = TCODPATH_ucs_push(&backward, goal);
+  // Any shorter path passes through both frontiers, a sum of the two only bounds it when neither uses a heuristic
+  const bool add_bounds = !heuristic && !reverse_heuristic;
+  while (err >= 0) {
+    if (forward.frontier.size <= 0 || backward.frontier.size <= 0) break;  // One side has been exhausted
+    const TCODPATH_ValueType best = TCODPATH_MIN(forward.meeting_distance, backward.meeting_distance);
+    const TCODPATH_ValueType forward_bound = TCODPATH_minheap_peek_priority(&forward.frontier);
+    const TCODPATH_ValueType backward_bound = TCODPATH_minheap_peek_priority(&backward.frontier);
+    const TCODPATH_ValueType lower_bound =
+        add_bounds ? forward_bound + backward_bound : TCODPATH_MAX(forward_bound, backward_bound);
+    if (lower_bound >= best) break;  // No remaining path can be shorter than the best meeting
+    err = TCODPATH_ucs_step(forward.frontier.size <= backward.frontier.size ? &forward : &backward);
+  }
+  const bool reached = TCODPATH_MIN(forward.meeting_distance, backward.meeting_distance) != TCODPATH_VALUE_MAX;
+  if (err >= 0 && reached) {
+    const bool forward_met = forward.meeting_distance <= backward.meeting_distance;
+    TCODPATH_bidirectional_stitch_(
+        distance, flow, reverse_distance, reverse_flow, forward_met ? forward.meeting : backward.meeting);
+  }
+  TCODPATH_ucs_uninit(&backward);
+  TCODPATH_ucs_uninit(&forward);
+  if (err < 0) return err;
+  return reached ? 0 : 1;
+}
+/// @brief Bidirectional Dijkstra search between `start` and `goal`, see `TCODPATH_bidirectional_astar`.
+/// @return 0 if `goal` was reached, 1 if `goal` is unreachable, negative value on error.
+static inline int TCODPATH_bidirectional_dijkstra(
+    TCODPATH_Graph* __restrict graph,
+    bool undirected,
+    TCODPATH_Map* __restrict distance,
+    TCODPATH_Map* __restrict flow,
+    TCODPATH_Map* __restrict reverse_distance,
+    TCODPATH_Map* __restrict reverse_flow,
+    const TCODPATH_IndexType* __restrict start,
+    const TCODPATH_IndexType* __restrict goal,
+    const TCODPATH_Map* __restrict partition) {
+  return TCODPATH_bidirectional_astar(
+      graph, NULL, NULL, undirected, distance, flow, reverse_distance, reverse_flow, start, goal, partition);
+}
+/// @brief Return the distance at the front of the frontier of `bfs_data`, the lowest distance in the frontier.
+/// Used internally.
+static inline TCODPATH_ValueType TCODPATH_bidirectional_bfs_front_(const TCODPATH_BreadthFirstSearch* bfs_data) {
+  TCODPATH_IndexType index[TCODPATH_MAX_DIMENSIONS];
+  if (TCODPATH_queue_peek(&bfs_data->frontier, index) < 0) return TCODPATH_VALUE_MAX;
+  return TCODPATH_map_get(bfs_data->distance, index);
+}
+/// @brief Bidirectional breadth-first search between `start` and `goal`, meeting in the middle.
+/// @details The breadth-first version of `TCODPATH_bidirectional_dijkstra`, edge costs are ignored.
+/// The same rules apply to the maps and to `undirected`, which here only matters for edges which exist one way.
+/// @return 0 if `goal` was reached, 1 if `goal` is unreachable, negative value on error.
+static inline int TCODPATH_bidirectional_bfs(
+    TCODPATH_Graph* __restrict graph,
+    bool undirected,
+    TCODPATH_Map* __restrict distance,
+    TCODPATH_Map* __restrict flow,
+    TCODPATH_Map* __restrict reverse_distance,
+    TCODPATH_Map* __restrict reverse_flow,
+    const TCODPATH_IndexType* __restrict start,
+    const TCODPATH_IndexType* __restrict goal,
+    const TCODPATH_Map* __restrict partition) {
+  if (!graph || !distance || !reverse_distance || !reverse_flow || !start || !goal) {
+    return TCODPATH_E_INVALID_ARGUMENT;
+  }
+  if (!TCODPATH_partition_is_reachable(partition, start, goal)) return 1;
+  TCODPATH_BreadthFirstSearch forward;
+  TCODPATH_BreadthFirstSearch backward;
+  int err = TCODPATH_bfs_init(&forward, graph, distance, flow);
+  if (err < 0) return err;
+  err = TCODPATH_bfs_init(&backward, graph, reverse_distance, reverse_flow);
+  if (err < 0) {
+    TCODPATH_bfs_uninit(&forward);
+    return err;
+  }
+  forward.opposite = reverse_distance;
+  backward.opposite = distance;
+  backward.reverse = !undirected;
+  TCODPATH_map_set(distance, start, 0);
+  TCODPATH_map_set(reverse_distance, goal, 0);
+  err = TCODPATH_bfs_push(&forward, start);
+  if (err >= 0) err = TCODPATH_bfs_push(&backward, goal);
+  while (err >= 0) {
+    if (forward.frontier.size <= 0 || backward.frontier.size <= 0) break;  // One side has been exhausted
+    const TCODPATH_ValueType best = TCODPATH_MIN(forward.meeting_distance, backward.meeting_distance);
+    const TCODPATH_ValueType lower_bound =
+        TCODPATH_bidirectional_bfs_front_(&forward) + TCODPATH_bidirectional_bfs_front_(&backward);
+    if (lower_bound >= best) break;  // No remaining path can be shorter than the best meeting
+    err = TCODPATH_bfs_step(forward.frontier.size <= backward.frontier.size ? &forward : &backward);
+  }
+  const bool reached = TCODPATH_MIN(forward.meeting_distance, backward.meeting_distance) != TCODPATH_VALUE_MAX;
+  if (err >= 0 && reached) {
+    const bool forward_met = forward.meeting_distance <= backward.meeting_distance;
+    TCODPATH_bidirectional_stitch_(
+        distance, flow, reverse_distance, reverse_flow, forward_met ? forward.meeting : backward.meeting);
+  }
+  TCODPATH_bfs_uninit(&backward);
+  TCODPATH_bfs_uninit(&forward);
+  if (err < 0) return err;
+  return reached ? 0 : 1;
+}
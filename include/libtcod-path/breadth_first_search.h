@@ -2,52 +2,297 @@
 
 #include "breadth_first_search_types.h"
 #include "graph_tools.h"
+#include "indexes.h"
 #include "map_tools.h"
+#include "partition.h"
+#include "queue.h"
 #include "ring_buffer.h"
+#include "search_stats.h"
 
-static inline void TCODPATH_bfs_set_edge(
-    void* bfs_data_,
+/// @brief Maximum number of neighbors collected by `TCODPATH_bfs_step` before they are added to the frontier.
+#define TCODPATH_BFS_BATCH_SIZE 16
+
+/// @brief Return a frontier capacity for a breadth-first search over `distance`.
+/// @details A wavefront on an open grid spans a few cross-sections of the map, taken across its longest axis.
+/// Maps without a shape, such as unbounded chunked maps, start from the minimum capacity and grow as needed.
+/// Used internally.
+static inline ptrdiff_t TCODPATH_bfs_frontier_estimate_(const TCODPATH_Map* __restrict distance) {
+  const int dimensions = TCODPATH_map_get_dimensions(distance);
+  const TCODPATH_IndexType* shape = TCODPATH_map_get_shape(distance);
+  if (!shape) return TCODPATH_QUEUE_MIN_CAPACITY;
+  ptrdiff_t nodes = 1;
+  ptrdiff_t longest_axis = 1;
+  for (int i = 0; i < dimensions; ++i) {
+    nodes *= shape[i];
+    longest_axis = TCODPATH_MAX(longest_axis, (ptrdiff_t)shape[i]);
+  }
+  return TCODPATH_MIN(nodes, nodes / longest_axis * 4);
+}
+/// @brief Setup `bfs_data` for a new search. The frontier will be empty.
+/// @details The frontier is sized for `distance` by its first `TCODPATH_bfs_push`, so `frontier.allocator` can be set
+/// before then.
+/// @return 0 on success, negative value on error.
+static inline int TCODPATH_bfs_init(
+    TCODPATH_BreadthFirstSearch* __restrict bfs_data,
+    TCODPATH_Graph* __restrict graph,
+    TCODPATH_Map* __restrict distance,
+    TCODPATH_Map* __restrict flow) {
+  if (!bfs_data || !graph || !distance) return TCODPATH_E_INVALID_ARGUMENT;
+  *bfs_data = TCODPATH_BreadthFirstSearch{};
+  bfs_data->dimensions = TCODPATH_map_get_dimensions(distance);
+  bfs_data->graph = graph;
+  bfs_data->distance = distance;
+  bfs_data->flow = flow;
+  bfs_data->meeting_distance = TCODPATH_VALUE_MAX;
+  return TCODPATH_queue_init(&bfs_data->frontier, sizeof(TCODPATH_IndexType) * bfs_data->dimensions);
+}
+/// @brief Free the frontier of `bfs_data`.
+static inline void TCODPATH_bfs_uninit(TCODPATH_BreadthFirstSearch* __restrict bfs_data) {
+  if (!bfs_data) return;
+  TCODPATH_queue_uninit(&bfs_data->frontier);
+}
+/// @brief Add `n` contiguous indexes to the frontier of `bfs_data`.
+/// Used internally.
+static inline int TCODPATH_bfs_frontier_push_n_(
+    TCODPATH_BreadthFirstSearch* __restrict bfs_data, int n, const TCODPATH_IndexType* __restrict indexes) {
+#if TCODPATH_STATS_ENABLED
+  const ptrdiff_t old_capacity = bfs_data->frontier.capacity;
+#endif
+  int err = TCODPATH_E_OK;
+  if (!bfs_data->frontier.capacity) {
+    err = TCODPATH_queue_reserve(&bfs_data->frontier, TCODPATH_bfs_frontier_estimate_(bfs_data->distance));
+  }
+  if (err >= 0) err = TCODPATH_queue_push_n(&bfs_data->frontier, n, indexes);
+  if (err < 0) return err;
+  TCODPATH_STATS_ADD(bfs_data->stats, pushes, n);
+  TCODPATH_STATS_MAX(bfs_data->stats, peak_frontier, bfs_data->frontier.size);
+  TCODPATH_STATS_ADD(
+      bfs_data->stats,
+      bytes_allocated,
+      (bfs_data->frontier.capacity - old_capacity) * bfs_data->frontier.element_size);
+  return TCODPATH_E_OK;
+}
+/// @brief Record a path through `index` if the search from the other end has also reached it.
+/// Used internally.
+static inline void TCODPATH_bfs_meet_(
+    TCODPATH_BreadthFirstSearch* __restrict bfs_data,
+    const TCODPATH_IndexType* __restrict index,
+    TCODPATH_ValueType distance) {
+  if (!bfs_data->opposite || TCODPATH_map_is_max(bfs_data->opposite, index)) return;
+  const TCODPATH_ValueType total_distance = distance + TCODPATH_map_get(bfs_data->opposite, index);
+  if (total_distance >= bfs_data->meeting_distance) return;
+  bfs_data->meeting_distance = total_distance;
+  for (int i = 0; i < bfs_data->dimensions; ++i) bfs_data->meeting[i] = index[i];
+}
+/// @brief Add `index` to the frontier using its current distance.
+/// @return 0 on success, negative value on error.
+static inline int TCODPATH_bfs_push(
+    TCODPATH_BreadthFirstSearch* __restrict bfs_data, const TCODPATH_IndexType* __restrict index) {
+  TCODPATH_TRACE(
+      bfs_data->trace, TCODPATH_TRACE_PUSH, bfs_data->dimensions, index, TCODPATH_map_get(bfs_data->distance, index));
+  TCODPATH_bfs_meet_(bfs_data, index, TCODPATH_map_get(bfs_data->distance, index));
+  return TCODPATH_bfs_frontier_push_n_(bfs_data, 1, index);
+}
+/// @brief Give `leaf_index` the distance of `root_index` plus one if that is an improvement.
+/// Used internally.
+/// @return True if `leaf_index` was updated and should be added to the frontier.
+static inline bool TCODPATH_bfs_relax_(
+    TCODPATH_BreadthFirstSearch* __restrict bfs_data,
     const TCODPATH_IndexType* __restrict root_index,
-    const TCODPATH_IndexType* __restrict leaf_index,
-    TCODPATH_ValueType) {
-  TCODPATH_BreadthFirstSearch* __restrict bfs_data = (TCODPATH_BreadthFirstSearch*)bfs_data_;
+    const TCODPATH_IndexType* __restrict leaf_index) {
   const TCODPATH_ValueType distance_at_root = TCODPATH_map_get(bfs_data->distance, root_index);
   const TCODPATH_ValueType distance_at_leaf = TCODPATH_map_get(bfs_data->distance, leaf_index);
   const TCODPATH_ValueType total_distance = distance_at_root + 1;
-  if (distance_at_leaf <= total_distance) return;  // This edge is not better than a previous edge
+  if (distance_at_leaf <= total_distance) return false;  // This edge is not better than a previous edge
+  if (bfs_data->has_distance_limit && total_distance > bfs_data->distance_limit) return false;  // Out of range
+  if (bfs_data->touched && distance_at_leaf == TCODPATH_VALUE_MAX) {
+    TCODPATH_ring_buffer_append(bfs_data->touched, sizeof(*leaf_index) * bfs_data->dimensions, leaf_index);
+  }
   TCODPATH_map_set(bfs_data->distance, leaf_index, total_distance);
-  TCODPATH_ring_buffer_append(&bfs_data->frontier, sizeof(*leaf_index) * bfs_data->dimensions, leaf_index);
+  TCODPATH_TRACE(bfs_data->trace, TCODPATH_TRACE_PUSH, bfs_data->dimensions, leaf_index, total_distance);
   if (bfs_data->flow) TCODPATH_map_set_index(bfs_data->flow, leaf_index, root_index);
+  TCODPATH_bfs_meet_(bfs_data, leaf_index, total_distance);
+  return true;
+}
+/// @brief Edge callback which adds each improved leaf to the frontier on its own.
+static inline void TCODPATH_bfs_set_edge(
+    void* bfs_data_,
+    const TCODPATH_IndexType* __restrict root_index,
+    const TCODPATH_IndexType* __restrict leaf_index,
+    TCODPATH_ValueType) {
+  TCODPATH_BreadthFirstSearch* __restrict bfs_data = (TCODPATH_BreadthFirstSearch*)bfs_data_;
+  if (TCODPATH_bfs_relax_(bfs_data, root_index, leaf_index)) TCODPATH_bfs_frontier_push_n_(bfs_data, 1, leaf_index);
 }
 
+/// @brief Improved neighbors of the node being expanded, added to the frontier together.
+/// Used internally.
+struct TCODPATH_BfsBatch_ {
+  TCODPATH_BreadthFirstSearch* __restrict bfs_data;
+  int count;
+  int err;
+  TCODPATH_IndexType indexes[TCODPATH_BFS_BATCH_SIZE * TCODPATH_MAX_DIMENSIONS];
+};
+/// @brief Edge callback which collects improved leaves into a `TCODPATH_BfsBatch_`.
+/// Used internally.
+static inline void TCODPATH_bfs_batch_edge_(
+    void* batch_,
+    const TCODPATH_IndexType* __restrict root_index,
+    const TCODPATH_IndexType* __restrict leaf_index,
+    TCODPATH_ValueType) {
+  struct TCODPATH_BfsBatch_* batch = (struct TCODPATH_BfsBatch_*)batch_;
+  TCODPATH_BreadthFirstSearch* __restrict bfs_data = batch->bfs_data;
+  if (!TCODPATH_bfs_relax_(bfs_data, root_index, leaf_index)) return;
+  const int dimensions = bfs_data->dimensions;
+  for (int i = 0; i < dimensions; ++i) batch->indexes[batch->count * dimensions + i] = leaf_index[i];
+  if (++batch->count < TCODPATH_BFS_BATCH_SIZE) return;
+  const int err = TCODPATH_bfs_frontier_push_n_(bfs_data, batch->count, batch->indexes);
+  if (err < 0) batch->err = err;
+  batch->count = 0;
+}
+/// @brief Edge callback for reverse searches, the expanded node is `leaf_index` and the new node is `root_index`.
+/// Used internally.
+static inline void TCODPATH_bfs_batch_reverse_edge_(
+    void* batch_,
+    const TCODPATH_IndexType* __restrict root_index,
+    const TCODPATH_IndexType* __restrict leaf_index,
+    TCODPATH_ValueType edge_cost) {
+  TCODPATH_bfs_batch_edge_(batch_, leaf_index, root_index, edge_cost);
+}
+
+/// @brief Expand the oldest node of the frontier.
+/// @return `1` when complete, `0` when incomplete, negative value on error.
 static inline int TCODPATH_bfs_step(TCODPATH_BreadthFirstSearch* __restrict bfs_data) {
   if (!bfs_data) return TCODPATH_E_INVALID_ARGUMENT;
-  if (bfs_data->frontier.used_bytes <= 0) return 1;  // Iteration complete
+  if (bfs_data->frontier.size <= 0) return 1;  // Iteration complete
 
   TCODPATH_IndexType index[TCODPATH_MAX_DIMENSIONS];
-  TCODPATH_ring_buffer_pop(&bfs_data->frontier, sizeof(*index) * bfs_data->dimensions, index);
-  TCODPATH_graph_foreach_edge(bfs_data->graph, bfs_data->dimensions, index, TCODPATH_bfs_set_edge, bfs_data);
-  return 0;  // Iteration continues
+  TCODPATH_queue_pop(&bfs_data->frontier, index);
+  if (bfs_data->has_goal && TCODPATH_indexes_equal(bfs_data->dimensions, index, bfs_data->goal)) return 1;
+  TCODPATH_STATS_ADD(bfs_data->stats, expansions, 1);
+  TCODPATH_TRACE(
+      bfs_data->trace,
+      TCODPATH_TRACE_EXPAND,
+      bfs_data->dimensions,
+      index,
+      TCODPATH_map_get(bfs_data->distance, index));
+  struct TCODPATH_BfsBatch_ batch;
+  batch.bfs_data = bfs_data;
+  batch.count = 0;
+  batch.err = TCODPATH_E_OK;
+  if (bfs_data->reverse) {
+    TCODPATH_graph_foreach_reverse_edge(
+        bfs_data->graph, bfs_data->dimensions, index, TCODPATH_bfs_batch_reverse_edge_, &batch);
+  } else {
+    TCODPATH_graph_foreach_edge(bfs_data->graph, bfs_data->dimensions, index, TCODPATH_bfs_batch_edge_, &batch);
+  }
+  if (batch.count) {
+    const int err = TCODPATH_bfs_frontier_push_n_(bfs_data, batch.count, batch.indexes);
+    if (err < 0) return err;
+  }
+  return batch.err;  // Iteration continues unless the frontier could not grow
 }
 
+/// @brief Compute a breadth-first distance map over `graph`, using the non-max values of `distance` as sources.
+/// @param graph Graph to traverse. Edge costs are ignored.
+/// @param distance Distance map to update in-place.
+/// @param flow Optional flow map to write during the search. Can be `NULL` to only write `distance`, in which case
+/// the flow can be derived afterwards with `TCODPATH_flow_from_bfs_distance`.
 static inline void TCODPATH_bfs(
     TCODPATH_Graph* __restrict graph, TCODPATH_Map* __restrict distance, TCODPATH_Map* __restrict flow) {
-  TCODPATH_BreadthFirstSearch bfs_data = {};
-  const int dimensions = bfs_data.dimensions = TCODPATH_map_get_dimensions(distance);
-  bfs_data.graph = graph;
-  bfs_data.distance = distance;
-  bfs_data.flow = flow;
+  TCODPATH_BreadthFirstSearch bfs_data;
+  if (TCODPATH_bfs_init(&bfs_data, graph, distance, flow) < 0) return;
+  const int dimensions = bfs_data.dimensions;
 
   // Use non-max values of distance to initialize the frontier
   TCODPATH_IndexType index[TCODPATH_MAX_DIMENSIONS];
   for (TCODPATH_indexes_iter_begin(dimensions, index);
        TCODPATH_indexes_iter_step(dimensions, TCODPATH_map_get_shape(distance), index);) {
     if (TCODPATH_map_is_max(distance, index)) continue;
-    TCODPATH_ring_buffer_append(&bfs_data.frontier, sizeof(*index) * dimensions, index);
+    TCODPATH_bfs_push(&bfs_data, index);
   }
   while (true) {
     int err = TCODPATH_bfs_step(&bfs_data);
     if (err != 0) break;
   }
-  TCODPATH_ring_buffer_uninit(&bfs_data.frontier);
+  TCODPATH_bfs_uninit(&bfs_data);
+}
+/// @brief Breadth-first search from `start` until `goal` is reached.
+/// @details `distance` should be cleared with `TCODPATH_map_clear_max` beforehand.
+/// @param graph Graph to traverse. Edge costs are ignored.
+/// @param distance Distance map to write. `start` is set to zero.
+/// @param flow Optional flow map to write, can be `NULL`.
+/// @param start Start index.
+/// @param goal Goal index.
+/// @param partition Optional connectivity labels, see `TCODPATH_partition_is_reachable`.
+/// When given, goals in a different partition are rejected without searching.
+/// @return 0 if `goal` was reached, 1 if `goal` is unreachable, negative value on error.
+static inline int TCODPATH_bfs_to(
+    TCODPATH_Graph* __restrict graph,
+    TCODPATH_Map* __restrict distance,
+    TCODPATH_Map* __restrict flow,
+    const TCODPATH_IndexType* __restrict start,
+    const TCODPATH_IndexType* __restrict goal,
+    const TCODPATH_Map* __restrict partition) {
+  if (!graph || !distance || !start || !goal) return TCODPATH_E_INVALID_ARGUMENT;
+  if (!TCODPATH_partition_is_reachable(partition, start, goal)) return 1;
+  TCODPATH_BreadthFirstSearch bfs_data;
+  int err = TCODPATH_bfs_init(&bfs_data, graph, distance, flow);
+  if (err < 0) return err;
+  bfs_data.has_goal = true;
+  for (int i = 0; i < bfs_data.dimensions; ++i) bfs_data.goal[i] = goal[i];
+  TCODPATH_map_set(distance, start, 0);
+  err = TCODPATH_bfs_push(&bfs_data, start);
+  while (err >= 0) {
+    err = TCODPATH_bfs_step(&bfs_data);
+    if (err != 0) break;
+  }
+  TCODPATH_bfs_uninit(&bfs_data);
+  if (err < 0) return err;
+  return TCODPATH_map_is_max(distance, goal) ? 1 : 0;
+}
+/// @brief Breadth-first search from `sources` which stops at `limit` steps and only visits the nodes within range.
+/// @details This is the unweighted version of `TCODPATH_dijkstra_bounded`, the same rules apply to `distance`.
+/// @param graph Graph to traverse. Edge costs are ignored.
+/// @param distance Distance map to write. Each source is set to zero.
+/// @param flow Optional flow map to write, can be `NULL`.
+/// @param source_n Number of sources.
+/// @param sources Contiguous array of `source_n` indexes.
+/// @param limit Maximum number of steps to take.
+/// @param touched Optional output, every index given a distance is appended to this buffer.
+/// @return 0 on success, negative value on error.
+static inline int TCODPATH_bfs_bounded(
+    TCODPATH_Graph* __restrict graph,
+    TCODPATH_Map* __restrict distance,
+    TCODPATH_Map* __restrict flow,
+    int source_n,
+    const TCODPATH_IndexType* __restrict sources,
+    TCODPATH_ValueType limit,
+    TCODPATH_RingBuffer* __restrict touched) {
+  if (!graph || !distance || (source_n > 0 && !sources)) return TCODPATH_E_INVALID_ARGUMENT;
+  // The frontier is not sized from the map since a bounded search only visits the nodes within range
+  TCODPATH_BreadthFirstSearch bfs_data = {};
+  const int dimensions = bfs_data.dimensions = TCODPATH_map_get_dimensions(distance);
+  bfs_data.graph = graph;
+  bfs_data.distance = distance;
+  bfs_data.flow = flow;
+  bfs_data.has_distance_limit = true;
+  bfs_data.distance_limit = limit;
+  bfs_data.touched = touched;
+  int err = TCODPATH_queue_init(&bfs_data.frontier, sizeof(*sources) * dimensions);
+  for (int i = 0; i < source_n && err >= 0; ++i) {
+    const TCODPATH_IndexType* source = sources + i * dimensions;
+    if (!TCODPATH_map_in_bounds(distance, source)) continue;
+    if (touched && TCODPATH_map_is_max(distance, source)) {
+      err = TCODPATH_ring_buffer_append(touched, sizeof(*source) * dimensions, source);
+      if (err < 0) break;
+    }
+    TCODPATH_map_set(distance, source, 0);
+    err = TCODPATH_queue_push(&bfs_data.frontier, source);
+  }
+  while (err >= 0) {
+    err = TCODPATH_bfs_step(&bfs_data);
+    if (err != 0) break;
+  }
+  TCODPATH_bfs_uninit(&bfs_data);
+  return err < 0 ? err : TCODPATH_E_OK;
 }
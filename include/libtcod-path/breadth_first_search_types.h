@@ -2,13 +2,26 @@
 
 #include "graph_types.h"
 #include "map_types.h"
+#include "queue_types.h"
 #include "ring_buffer.h"
+#include "search_stats_types.h"
 
 /// @brief State for Breadth-cost search.
 typedef struct TCODPATH_BreadthFirstSearch {
   int dimensions;
-  TCODPATH_RingBuffer frontier;
+  TCODPATH_Queue frontier;  // Indexes of `dimensions` each, oldest first
   TCODPATH_Graph* __restrict graph;
   TCODPATH_Map* __restrict distance;
   TCODPATH_Map* __restrict flow;
+  bool has_goal;  // If true then the search is complete once `goal` is reached
+  TCODPATH_IndexType goal[TCODPATH_MAX_DIMENSIONS];
+  bool has_distance_limit;  // If true then nodes further than `distance_limit` are never reached
+  TCODPATH_ValueType distance_limit;
+  TCODPATH_RingBuffer* __restrict touched;  // Optional record of every node given its first distance
+  bool reverse;  // If true then edges are traversed backwards, `distance` is then the distance to the sources
+  const TCODPATH_Map* __restrict opposite;  // Optional distance map of a search from the other end
+  TCODPATH_ValueType meeting_distance;  // Shortest path found through a node reached by both this and `opposite`
+  TCODPATH_IndexType meeting[TCODPATH_MAX_DIMENSIONS];  // Node where `meeting_distance` was found
+  TCODPATH_SearchStats* __restrict stats;  // Optional counters updated by each step
+  const TCODPATH_SearchTrace* __restrict trace;  // Optional callback for every push and expansion
 } TCODPATH_BreadthFirstSearch;
@@ -0,0 +1,101 @@
+#pragma once
+
+#include "config.h"
+#include "error.h"
+#include "map_tools.h"
+#include "map_types.h"
+#include "utility.h"
+
+/// @brief Check that `costs` and `clearance` are 2D maps of the same shape.
+/// Used internally.
+static inline int TCODPATH_clearance_check_(
+    const TCODPATH_Map* __restrict costs, const TCODPATH_Map* __restrict clearance) {
+  if (TCODPATH_map_get_dimensions(clearance) != 2) return TCODPATH_E_INVALID_ARGUMENT;
+  const TCODPATH_IndexType* shape = TCODPATH_map_get_shape(clearance);
+  if (!shape) return TCODPATH_E_INVALID_ARGUMENT;
+  if (!costs) return TCODPATH_E_OK;
+  const TCODPATH_IndexType* costs_shape = TCODPATH_map_get_shape(costs);
+  if (TCODPATH_map_get_dimensions(costs) != 2 || !costs_shape) return TCODPATH_E_INVALID_ARGUMENT;
+  if (costs_shape[0] != shape[0] || costs_shape[1] != shape[1]) return TCODPATH_E_INVALID_ARGUMENT;
+  return TCODPATH_E_OK;
+}
+/// @brief First clearance pass: write the number of open nodes to the right of each node, including itself.
+/// @details Rows are independent, so disjoint row ranges can be processed by separate threads.
+/// @param costs 2D cost map, nodes with a cost of zero or less are walls.
+/// @param clearance 2D output map with the same shape as `costs`.
+/// @param max_clearance Upper limit of the clearance values, such as the size of the largest agent.
+/// @param row_begin First row to process.
+/// @param row_end One past the last row to process.
+/// @return 0 on success, negative value on error.
+static inline int TCODPATH_clearance_rows(
+    const TCODPATH_Map* __restrict costs,
+    TCODPATH_Map* __restrict clearance,
+    TCODPATH_ValueType max_clearance,
+    TCODPATH_IndexType row_begin,
+    TCODPATH_IndexType row_end) {
+  const int err = TCODPATH_clearance_check_(costs, clearance);
+  if (err < 0) return err;
+  const TCODPATH_IndexType* shape = TCODPATH_map_get_shape(clearance);
+  for (TCODPATH_IndexType y = TCODPATH_MAX(row_begin, 0); y < TCODPATH_MIN(row_end, shape[0]); ++y) {
+    TCODPATH_ValueType run = 0;
+    for (TCODPATH_IndexType x = shape[1] - 1; x >= 0; --x) {
+      const TCODPATH_IndexType ij[2] = {y, x};
+      run = TCODPATH_map_get(costs, ij) > 0 ? TCODPATH_MIN(run + 1, max_clearance) : 0;
+      TCODPATH_map_set(clearance, ij, run);
+    }
+  }
+  return TCODPATH_E_OK;
+}
+/// @brief Second clearance pass: turn the runs of one row into clearance values using the finished row below it.
+/// @details Rows must be combined from the bottom up. Nodes within a row are independent, so disjoint column ranges
+/// of the same row can be processed by separate threads.
+/// @param clearance Map processed by `TCODPATH_clearance_rows`, with every row below `row` already combined.
+/// @param row Row to combine.
+/// @param column_begin First column to process.
+/// @param column_end One past the last column to process.
+/// @return 0 on success, negative value on error.
+static inline int TCODPATH_clearance_combine(
+    TCODPATH_Map* __restrict clearance,
+    TCODPATH_IndexType row,
+    TCODPATH_IndexType column_begin,
+    TCODPATH_IndexType column_end) {
+  const int err = TCODPATH_clearance_check_(NULL, clearance);
+  if (err < 0) return err;
+  const TCODPATH_IndexType* shape = TCODPATH_map_get_shape(clearance);
+  if (row < 0 || row >= shape[0]) return TCODPATH_E_INVALID_ARGUMENT;
+  for (TCODPATH_IndexType x = TCODPATH_MAX(column_begin, 0); x < TCODPATH_MIN(column_end, shape[1]); ++x) {
+    const TCODPATH_IndexType ij[2] = {row, x};
+    const TCODPATH_IndexType below[2] = {row + 1, x};
+    const TCODPATH_IndexType below_right[2] = {row + 1, x + 1};
+    // A square of size k fits here if the row has room for it and squares of size k - 1 fit at both nodes below
+    const TCODPATH_ValueType below_clearance =
+        TCODPATH_MIN(TCODPATH_map_get(clearance, below), TCODPATH_map_get(clearance, below_right));
+    TCODPATH_map_set(clearance, ij, TCODPATH_MIN(TCODPATH_map_get(clearance, ij), below_clearance + 1));
+  }
+  return TCODPATH_E_OK;
+}
+/// @brief Write the clearance of every node of `costs`: the side length of the largest open square with that node as
+/// its top-left corner.
+/// @details This is a linear-time dynamic-programming pass. Walls have a clearance of zero.
+/// Use the result with the `clearance` and `agent_size` options of `TCODPATH_GraphBasic2D`, so that one cost map
+/// serves agents of every size. Distances for small agents are admissible heuristics for larger agents, so the same
+/// differential heuristic tables can also be shared.
+/// @param costs 2D cost map, nodes with a cost of zero or less are walls.
+/// @param clearance 2D output map with the same shape as `costs`.
+/// @param max_clearance Upper limit of the clearance values, such as the size of the largest agent.
+/// @return 0 on success, negative value on error.
+static inline int TCODPATH_clearance_generate(
+    const TCODPATH_Map* __restrict costs, TCODPATH_Map* __restrict clearance, TCODPATH_ValueType max_clearance) {
+  int err = TCODPATH_clearance_check_(costs, clearance);
+  if (err < 0) return err;
+  const TCODPATH_IndexType* shape = TCODPATH_map_get_shape(clearance);
+  TCODPATH_MapJournal* journal = TCODPATH_map_get_journal(clearance);
+  TCODPATH_map_set_journal(clearance, NULL);  // Record this as one change instead of one per node
+  err = TCODPATH_clearance_rows(costs, clearance, max_clearance, 0, shape[0]);
+  for (TCODPATH_IndexType y = shape[0] - 1; y >= 0 && err >= 0; --y) {
+    err = TCODPATH_clearance_combine(clearance, y, 0, shape[1]);
+  }
+  TCODPATH_map_set_journal(clearance, journal);
+  TCODPATH_map_journal_mark_all(clearance);
+  return err;
+}
@@ -20,3 +20,61 @@
 /// @brief Type for indexes.
 #define TCODPATH_IndexType int
 #endif
+
+#ifndef TCODPATH_MAP_JOURNAL_MAX_RECTS
+/// @brief Maximum number of dirty rectangles tracked by a map journal before they are merged together.
+#define TCODPATH_MAP_JOURNAL_MAX_RECTS 8
+#endif
+
+#ifndef TCODPATH_LinearIdType
+/// @brief Type for linear node ids, see `TCODPATH_LinearGraph`.
+#define TCODPATH_LinearIdType int32_t
+#define TCODPATH_LINEAR_ID_MAX INT32_MAX
+#endif
+
+#ifndef TCODPATH_MAP_TILE_SIZE
+/// @brief Side length of the tiles fetched from callback maps by `TCODPATH_MapTileCache`.
+#define TCODPATH_MAP_TILE_SIZE 32
+#endif
+
+#ifndef TCODPATH_MAP_TILE_CACHE_SLOTS
+/// @brief Number of tiles held at once by `TCODPATH_MapTileCache`.
+#define TCODPATH_MAP_TILE_CACHE_SLOTS 8
+#endif
+
+#ifndef TCODPATH_MAP_CHUNK_SIZE
+/// @brief Default chunk side length for `TCODPATH_MAP_CHUNKED` maps.
+#define TCODPATH_MAP_CHUNK_SIZE 16
+#endif
+
+#ifndef TCODPATH_MAP_BULK_BLOCK
+/// @brief Number of values processed at once by bulk map operations which go through a `TCODPATH_ValueType` buffer.
+#define TCODPATH_MAP_BULK_BLOCK 256
+#endif
+
+#ifndef TCODPATH_STATS_ENABLED
+/// @brief Set to 0 to compile out `TCODPATH_SearchStats` collection and `TCODPATH_SearchTrace` callbacks.
+/// The `stats` and `trace` pointers of searches are then ignored.
+#define TCODPATH_STATS_ENABLED 1
+#endif
+
+#ifndef TCODPATH_HUGE_PAGE_SIZE
+/// @brief Huge page size assumed by `TCODPATH_allocator_huge_pages`.
+/// Allocations of at least this size are mapped on huge pages and rounded up to a multiple of it.
+#define TCODPATH_HUGE_PAGE_SIZE ((size_t)2 << 20)
+#endif
+
+#ifndef TCODPATH_LargeIdType
+/// @brief Type for the node ids of `TCODPATH_TiledMap`, which can hold more nodes than `TCODPATH_IndexType` can count.
+#define TCODPATH_LargeIdType int64_t
+#endif
+
+#ifndef TCODPATH_TILED_TILE_SIZE
+/// @brief Default side length of the tiles of a `TCODPATH_TiledMap`, must be a power of two.
+#define TCODPATH_TILED_TILE_SIZE 256
+#endif
+
+#ifndef TCODPATH_TILED_WORKING_SET
+/// @brief Number of tiles a `TCODPATH_TiledSearch` keeps in memory at once.
+#define TCODPATH_TILED_WORKING_SET 16
+#endif
@@ -0,0 +1,305 @@
+#pragma once
+
+#include <stdlib.h>
+
+#include "allocator.h"
+#include "connectivity_types.h"
+#include "error.h"
+#include "graph_tools.h"
+#include "map_tools.h"
+#include "partition.h"
+#include "queue.h"
+
+/// @brief Maximum number of neighbors which can be split apart by closing a single node.
+#define TCODPATH_CONNECTIVITY_MAX_SPLIT 32
+
+/// @brief Allocate a new label which is its own root. Returns `0` on error.
+static inline TCODPATH_ValueType TCODPATH_connectivity_new_label_(TCODPATH_Connectivity* __restrict connectivity) {
+  if (connectivity->label_count == connectivity->label_capacity) {
+    if (connectivity->label_capacity >= TCODPATH_VALUE_MAX / 2) return 0;  // Labels exhausted
+    const TCODPATH_ValueType new_capacity = connectivity->label_capacity ? connectivity->label_capacity * 2 : 64;
+    TCODPATH_ValueType* new_parents = (TCODPATH_ValueType*)TCODPATH_realloc_(
+        connectivity->allocator,
+        connectivity->parents,
+        connectivity->label_capacity * sizeof(*new_parents),
+        new_capacity * sizeof(*new_parents));
+    if (!new_parents) return 0;
+    connectivity->parents = new_parents;
+    connectivity->label_capacity = new_capacity;
+  }
+  const TCODPATH_ValueType label = connectivity->label_count++;
+  connectivity->parents[label] = label;
+  return label;
+}
+/// @brief Return the canonical label for the alias `label`.
+/// @details Does not modify `connectivity`, the alias chains are shortened by updates instead.
+static inline TCODPATH_ValueType TCODPATH_connectivity_find(
+    const TCODPATH_Connectivity* __restrict connectivity, TCODPATH_ValueType label) {
+  if (label <= 0 || label >= connectivity->label_count) return 0;
+  while (connectivity->parents[label] != label) label = connectivity->parents[label];
+  return label;
+}
+/// @brief Return the canonical label for the alias `label`, halving the path to it.
+/// Used internally.
+static inline TCODPATH_ValueType TCODPATH_connectivity_find_compress_(
+    TCODPATH_Connectivity* __restrict connectivity, TCODPATH_ValueType label) {
+  if (label <= 0 || label >= connectivity->label_count) return 0;
+  while (connectivity->parents[label] != label) {
+    connectivity->parents[label] = connectivity->parents[connectivity->parents[label]];  // Path halving
+    label = connectivity->parents[label];
+  }
+  return label;
+}
+/// @brief Merge the components of two canonical labels. Returns the canonical label of the result.
+static inline TCODPATH_ValueType TCODPATH_connectivity_union_(
+    TCODPATH_Connectivity* __restrict connectivity, TCODPATH_ValueType a, TCODPATH_ValueType b) {
+  a = TCODPATH_connectivity_find_compress_(connectivity, a);
+  b = TCODPATH_connectivity_find_compress_(connectivity, b);
+  if (a == b) return a;
+  if (b < a) {
+    const TCODPATH_ValueType swap = a;
+    a = b;
+    b = swap;
+  }
+  connectivity->parents[b] = a;  // Older labels stay canonical
+  return a;
+}
+/// @brief Return the canonical component label at `ij`, or `0` if `ij` has no edges.
+static inline TCODPATH_ValueType TCODPATH_connectivity_label_at(
+    const TCODPATH_Connectivity* __restrict connectivity, const TCODPATH_IndexType* __restrict ij) {
+  return TCODPATH_connectivity_find(connectivity, TCODPATH_map_get(connectivity->labels, ij));
+}
+/// @brief Return true if `goal` is reachable from `start`.
+static inline bool TCODPATH_connectivity_is_reachable(
+    const TCODPATH_Connectivity* __restrict connectivity,
+    const TCODPATH_IndexType* __restrict start,
+    const TCODPATH_IndexType* __restrict goal) {
+  if (TCODPATH_indexes_equal(TCODPATH_map_get_dimensions(connectivity->labels), start, goal)) return true;
+  const TCODPATH_ValueType start_label = TCODPATH_connectivity_label_at(connectivity, start);
+  return start_label != 0 && start_label == TCODPATH_connectivity_label_at(connectivity, goal);
+}
+/// @brief Rewrite `labels` with canonical labels numbered from `1` and reset the union-find table.
+/// @details This is O(map) and only needs to be called occasionally to reclaim labels.
+/// @return 0 on success, negative value on error.
+static inline int TCODPATH_connectivity_compact(TCODPATH_Connectivity* __restrict connectivity) {
+  if (!connectivity || !connectivity->labels) return TCODPATH_E_INVALID_ARGUMENT;
+  const int total = TCODPATH_partition_from_graph(connectivity->graph, connectivity->labels);
+  connectivity->label_count = 0;
+  for (int i = 0; i <= total; ++i) {
+    if (TCODPATH_connectivity_new_label_(connectivity) != i) return TCODPATH_E_OUT_OF_MEMORY;
+  }
+  return TCODPATH_E_OK;
+}
+/// @brief Setup `connectivity` for `graph`, computing the initial labels on `labels`.
+/// @param connectivity Connectivity state to initialize.
+/// @param graph Graph to track. Connectivity must be symmetric and edges must only connect nodes which are adjacent on
+/// the last two axes, as they are for 2D graphs.
+/// @param labels Map which will hold the label aliases. Must have the same shape as the nodes of `graph`.
+/// @param allocator Allocator of the union-find table and of the frontiers of splits. `NULL` for the global one.
+/// @return 0 on success, negative value on error.
+static inline int TCODPATH_connectivity_init_with_allocator(
+    TCODPATH_Connectivity* __restrict connectivity,
+    TCODPATH_Graph* __restrict graph,
+    TCODPATH_Map* __restrict labels,
+    TCODPATH_Allocator* allocator) {
+  if (!connectivity || !graph || !labels) return TCODPATH_E_INVALID_ARGUMENT;
+  *connectivity = TCODPATH_Connectivity{};
+  connectivity->graph = graph;
+  connectivity->labels = labels;
+  connectivity->allocator = allocator;
+  return TCODPATH_connectivity_compact(connectivity);
+}
+/// @brief Setup `connectivity` using the global allocator, see `TCODPATH_connectivity_init_with_allocator`.
+/// @return 0 on success, negative value on error.
+static inline int TCODPATH_connectivity_init(
+    TCODPATH_Connectivity* __restrict connectivity, TCODPATH_Graph* __restrict graph, TCODPATH_Map* __restrict labels) {
+  return TCODPATH_connectivity_init_with_allocator(connectivity, graph, labels, NULL);
+}
+/// @brief Free the union-find table of `connectivity`.
+static inline void TCODPATH_connectivity_uninit(TCODPATH_Connectivity* __restrict connectivity) {
+  if (!connectivity) return;
+  TCODPATH_free_(
+      connectivity->allocator, connectivity->parents, connectivity->label_capacity * sizeof(*connectivity->parents));
+  *connectivity = TCODPATH_Connectivity{};
+}
+
+struct TCODPATH_ConnectivityNeighbors_ {
+  int count;
+  TCODPATH_IndexType index[TCODPATH_CONNECTIVITY_MAX_SPLIT][TCODPATH_MAX_DIMENSIONS];
+  int dimensions;
+};
+static inline void TCODPATH_connectivity_collect_(
+    void* userdata, const TCODPATH_IndexType*, const TCODPATH_IndexType* __restrict leaf_index, TCODPATH_ValueType) {
+  struct TCODPATH_ConnectivityNeighbors_* neighbors = (struct TCODPATH_ConnectivityNeighbors_*)userdata;
+  if (neighbors->count == TCODPATH_CONNECTIVITY_MAX_SPLIT) return;
+  for (int i = 0; i < neighbors->dimensions; ++i) neighbors->index[neighbors->count][i] = leaf_index[i];
+  ++neighbors->count;
+}
+/// @brief Return true if the node at `index` has any edges.
+static inline bool TCODPATH_connectivity_is_open_(
+    TCODPATH_Connectivity* __restrict connectivity, const TCODPATH_IndexType* __restrict index) {
+  bool is_open = false;
+  TCODPATH_graph_foreach_edge(
+      connectivity->graph,
+      TCODPATH_map_get_dimensions(connectivity->labels),
+      index,
+      TCODPATH_partition_set_bool_if_open,
+      (void*)&is_open);
+  return is_open;
+}
+
+struct TCODPATH_ConnectivityFlood_ {
+  TCODPATH_Connectivity* __restrict connectivity;
+  TCODPATH_Queue* frontier;
+  TCODPATH_ValueType old_label;  // Canonical label of the component being split
+  TCODPATH_ValueType label;  // Label written by this flood
+  TCODPATH_ValueType first_label;  // First label allocated for this split
+};
+static inline void TCODPATH_connectivity_flood_edge_(
+    void* userdata, const TCODPATH_IndexType*, const TCODPATH_IndexType* __restrict leaf_index, TCODPATH_ValueType) {
+  struct TCODPATH_ConnectivityFlood_* flood = (struct TCODPATH_ConnectivityFlood_*)userdata;
+  TCODPATH_Connectivity* connectivity = flood->connectivity;
+  const TCODPATH_ValueType leaf_label = TCODPATH_connectivity_label_at(connectivity, leaf_index);
+  if (leaf_label == flood->old_label) {  // Unvisited node
+    TCODPATH_map_set(connectivity->labels, leaf_index, flood->label);
+    TCODPATH_queue_push(flood->frontier, leaf_index);
+  } else if (leaf_label >= flood->first_label) {  // Met another flood, these sides are still connected
+    TCODPATH_connectivity_union_(connectivity, leaf_label, flood->label);
+  }
+}
+/// @brief Relabel the component `old_label` after the node at `index` was closed, detecting any splits.
+/// @details Floods from each remaining neighbor advance in lockstep. Floods which meet are merged. A flood which runs
+/// out of nodes before meeting the others has explored a separated component and keeps its new label. The search
+/// stops once only one group of floods is left, so the cost is bounded by the smaller sides of the split.
+static inline int TCODPATH_connectivity_split_(
+    TCODPATH_Connectivity* __restrict connectivity,
+    TCODPATH_ValueType old_label,
+    struct TCODPATH_ConnectivityNeighbors_* __restrict neighbors) {
+  const int dimensions = neighbors->dimensions;
+  const int n = neighbors->count;
+  if (n == 0) return TCODPATH_E_OK;
+  TCODPATH_Queue frontiers[TCODPATH_CONNECTIVITY_MAX_SPLIT] = {};
+  struct TCODPATH_ConnectivityFlood_ floods[TCODPATH_CONNECTIVITY_MAX_SPLIT] = {};
+  const TCODPATH_ValueType first_label = connectivity->label_count;
+  int err = TCODPATH_E_OK;
+  for (int i = 0; i < n && err == TCODPATH_E_OK; ++i) {
+    floods[i].connectivity = connectivity;
+    floods[i].frontier = &frontiers[i];
+    TCODPATH_queue_init(&frontiers[i], sizeof(TCODPATH_IndexType) * dimensions);
+    frontiers[i].allocator = connectivity->allocator;
+    floods[i].old_label = old_label;
+    floods[i].first_label = first_label;
+    floods[i].label = TCODPATH_connectivity_new_label_(connectivity);
+    if (!floods[i].label) err = TCODPATH_E_OUT_OF_MEMORY;
+  }
+  for (int i = 0; i < n && err == TCODPATH_E_OK; ++i) {
+    TCODPATH_connectivity_flood_edge_(&floods[i], NULL, neighbors->index[i], 0);
+  }
+  while (err == TCODPATH_E_OK) {
+    // Count the groups of floods, and the groups which are still searching
+    const TCODPATH_ValueType group_0 = TCODPATH_connectivity_find_compress_(connectivity, floods[0].label);
+    bool single_group = true;
+    int active_groups = 0;
+    TCODPATH_ValueType active_group = 0;
+    for (int i = 0; i < n; ++i) {
+      const TCODPATH_ValueType group = TCODPATH_connectivity_find_compress_(connectivity, floods[i].label);
+      if (group != group_0) single_group = false;
+      if (!frontiers[i].size) continue;
+      bool counted = false;
+      for (int j = 0; j < i; ++j) {
+        counted |= frontiers[j].size && TCODPATH_connectivity_find(connectivity, floods[j].label) == group;
+      }
+      if (counted) continue;
+      ++active_groups;
+      active_group = group;
+    }
+    if (single_group) {  // All sides met, nothing was split
+      TCODPATH_connectivity_union_(connectivity, group_0, old_label);
+      break;
+    }
+    if (active_groups <= 1) {  // Every other side was separated
+      if (active_groups) TCODPATH_connectivity_union_(connectivity, active_group, old_label);
+      break;
+    }
+    for (int i = 0; i < n; ++i) {
+      TCODPATH_IndexType index[TCODPATH_MAX_DIMENSIONS];
+      if (TCODPATH_queue_pop(&frontiers[i], index) < 0) continue;
+      TCODPATH_graph_foreach_edge(
+          connectivity->graph, dimensions, index, TCODPATH_connectivity_flood_edge_, (void*)&floods[i]);
+    }
+  }
+  for (int i = 0; i < n; ++i) TCODPATH_queue_uninit(&frontiers[i]);
+  return err;
+}
+/// @brief Update the labels after the costs at `index` were changed, opening or closing it.
+/// @details Opening a node merges the components of its neighbors in O(1). Closing a node may split its component,
+/// which is resolved locally without repartitioning the whole map.
+/// @param connectivity Connectivity state.
+/// @param index Node which was changed.
+/// @return 0 on success, negative value on error.
+static inline int TCODPATH_connectivity_update(
+    TCODPATH_Connectivity* __restrict connectivity, const TCODPATH_IndexType* __restrict index) {
+  if (!connectivity || !index) return TCODPATH_E_INVALID_ARGUMENT;
+  if (!TCODPATH_map_in_bounds(connectivity->labels, index)) return TCODPATH_E_INVALID_ARGUMENT;
+  const int dimensions = TCODPATH_map_get_dimensions(connectivity->labels);
+  const TCODPATH_ValueType old_label = TCODPATH_connectivity_label_at(connectivity, index);
+  struct TCODPATH_ConnectivityNeighbors_ neighbors = {};
+  neighbors.dimensions = dimensions;
+  if (TCODPATH_connectivity_is_open_(connectivity, index)) {
+    // Opening only ever merges components
+    TCODPATH_graph_foreach_edge(
+        connectivity->graph, dimensions, index, TCODPATH_connectivity_collect_, (void*)&neighbors);
+    TCODPATH_ValueType label = old_label;
+    for (int i = 0; i < neighbors.count; ++i) {
+      const TCODPATH_ValueType neighbor_label = TCODPATH_connectivity_label_at(connectivity, neighbors.index[i]);
+      if (neighbor_label == 0) continue;
+      label = label ? TCODPATH_connectivity_union_(connectivity, label, neighbor_label) : neighbor_label;
+    }
+    if (!label) label = TCODPATH_connectivity_new_label_(connectivity);
+    if (!label) return TCODPATH_E_OUT_OF_MEMORY;
+    TCODPATH_map_set(connectivity->labels, index, label);
+    for (int i = 0; i < neighbors.count; ++i) {  // Neighbors whose only edges lead here
+      if (TCODPATH_connectivity_label_at(connectivity, neighbors.index[i]) != 0) continue;
+      TCODPATH_map_set(connectivity->labels, neighbors.index[i], label);
+    }
+    return TCODPATH_E_OK;
+  }
+  if (old_label == 0) return TCODPATH_E_OK;  // Was already closed
+  TCODPATH_map_set(connectivity->labels, index, 0);
+  // Collect the neighbors which are still open, all of them are in `old_label`
+  TCODPATH_IndexType neighbor[TCODPATH_MAX_DIMENSIONS];
+  for (int i = 0; i < dimensions; ++i) neighbor[i] = index[i];
+  TCODPATH_IndexType offset[TCODPATH_MAX_DIMENSIONS];
+  TCODPATH_IndexType size[TCODPATH_MAX_DIMENSIONS];
+  for (int i = 0; i < dimensions; ++i) size[i] = i < dimensions - 2 ? 1 : 3;  // 3x3 area of the last two axes
+  for (TCODPATH_indexes_iter_begin(dimensions, offset); TCODPATH_indexes_iter_step(dimensions, size, offset);) {
+    for (int i = dimensions - 2; i < dimensions; ++i) neighbor[i] = index[i] + offset[i] - 1;
+    if (TCODPATH_indexes_equal(dimensions, neighbor, index)) continue;
+    if (TCODPATH_connectivity_label_at(connectivity, neighbor) != old_label) continue;
+    if (!TCODPATH_connectivity_is_open_(connectivity, neighbor)) {
+      TCODPATH_map_set(connectivity->labels, neighbor, 0);  // This neighbor lost its only edge
+      continue;
+    }
+    TCODPATH_connectivity_collect_(&neighbors, NULL, neighbor, 0);
+  }
+  return TCODPATH_connectivity_split_(connectivity, old_label, &neighbors);
+}
+
+static inline TCODPATH_ValueType TCODPATH_connectivity_map_get_(void* userdata, const TCODPATH_IndexType* ij) {
+  return TCODPATH_connectivity_label_at((const TCODPATH_Connectivity*)userdata, ij);
+}
+static inline void TCODPATH_connectivity_map_set_(void*, const TCODPATH_IndexType*, TCODPATH_ValueType) {}
+/// @brief Setup `out` as a read-only view of the canonical labels of `connectivity`.
+/// @details The view can be passed as the `partition` parameter of search drivers.
+static inline void TCODPATH_connectivity_as_map(
+    TCODPATH_Connectivity* __restrict connectivity, TCODPATH_Map* __restrict out) {
+  if (!connectivity || !out) return;
+  out->callback = TCODPATH_MapCallback{};
+  out->callback.type = TCODPATH_MAP_CALLBACK;
+  out->callback.dimensions = TCODPATH_map_get_dimensions(connectivity->labels);
+  const TCODPATH_IndexType* shape = TCODPATH_map_get_shape(connectivity->labels);
+  for (int i = 0; i < out->callback.dimensions; ++i) out->callback.shape[i] = shape[i];
+  out->callback.userdata = connectivity;
+  out->callback.get = TCODPATH_connectivity_map_get_;
+  out->callback.set = TCODPATH_connectivity_map_set_;
+}
@@ -0,0 +1,18 @@
+#pragma once
+
+#include "allocator_types.h"
+#include "config.h"
+#include "graph_types.h"
+#include "map_types.h"
+
+/// @brief Connected components of a graph which are maintained as nodes open and close.
+/// @details Labels on `labels` are aliases which are resolved through a union-find table of `parents`.
+/// Use `TCODPATH_connectivity_label_at` or `TCODPATH_connectivity_as_map` to read the canonical labels.
+typedef struct TCODPATH_Connectivity {
+  TCODPATH_Graph* __restrict graph;
+  TCODPATH_Map* __restrict labels;  // Label aliases of each node, `0` for nodes without edges
+  TCODPATH_ValueType* __restrict parents;  // Union-find parent of each label
+  TCODPATH_ValueType label_count;  // Number of allocated labels, including the unused label `0`
+  TCODPATH_ValueType label_capacity;  // Allocated length of `parents`
+  TCODPATH_Allocator* allocator;  // Allocator of `parents` and of the split frontiers, NULL for the global one
+} TCODPATH_Connectivity;
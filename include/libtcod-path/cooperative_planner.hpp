@@ -0,0 +1,391 @@
+#pragma once
+
+#include <libtcod-path/graph_tools.h>
+#include <libtcod-path/graph_types.h>
+#include <libtcod-path/map_tools.h>
+#include <libtcod-path/map_types.h>
+#include <libtcod-path/uniform_cost_search.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <stdexcept>
+#include <thread>
+#include <type_traits>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace tcod::path {
+/// @brief Compact hash table of reserved space-time cells, mapping each `(cell, time)` pair to the agent holding it.
+/// @details Cells are linear node ids. Keys are packed into 64 bits and stored with open addressing.
+class ReservationTable {
+ public:
+  static constexpr int no_agent = -1;
+  static constexpr int max_time = (1 << 20) - 1;
+
+  /// @brief Reserve `cell` at `time` for `agent`, replacing any previous reservation.
+  void reserve(std::int64_t cell, int time, int agent) {
+    if (time < 0 || time > max_time) throw std::out_of_range("reservation time is out of range");
+    if ((count_ + 1) * 2 > keys_.size()) grow_();
+    const auto key = pack_(cell, time);
+    const auto slot = find_(key);
+    if (keys_[slot] == empty_key_) {
+      keys_[slot] = key;
+      ++count_;
+    }
+    agents_[slot] = agent;
+  }
+  /// @brief Return the agent holding `cell` at `time`, or `no_agent`.
+  auto get_agent(std::int64_t cell, int time) const noexcept -> int {
+    if (keys_.empty() || time < 0 || time > max_time) return no_agent;
+    const auto slot = find_(pack_(cell, time));
+    return keys_[slot] == empty_key_ ? no_agent : agents_[slot];
+  }
+  /// @brief Return true if `cell` at `time` is free or already held by `agent`.
+  auto is_free(std::int64_t cell, int time, int agent) const noexcept -> bool {
+    const int holder = get_agent(cell, time);
+    return holder == no_agent || holder == agent;
+  }
+  /// @brief Return true if `agent` can move from `from` at `time` to `to` at `time + 1`.
+  /// @details The destination must be free and the move must not swap places with another agent.
+  auto can_move(std::int64_t from, std::int64_t to, int time, int agent) const noexcept -> bool {
+    if (!is_free(to, time + 1, agent)) return false;
+    if (from == to) return true;
+    const int oncoming = get_agent(to, time);
+    return oncoming == no_agent || oncoming == agent || get_agent(from, time + 1) != oncoming;
+  }
+  /// @brief Remove all reservations. The allocated table is kept.
+  void clear() noexcept {
+    std::fill(keys_.begin(), keys_.end(), empty_key_);
+    count_ = 0;
+  }
+  /// @brief Return the number of reservations.
+  auto size() const noexcept -> std::size_t { return count_; }
+
+ private:
+  static constexpr std::uint64_t empty_key_ = UINT64_MAX;
+
+  static auto pack_(std::int64_t cell, int time) noexcept -> std::uint64_t {
+    return (static_cast<std::uint64_t>(cell) << 20) | static_cast<std::uint64_t>(time);
+  }
+  auto find_(std::uint64_t key) const noexcept -> std::size_t {
+    const std::size_t mask = keys_.size() - 1;
+    for (std::size_t slot = static_cast<std::size_t>((key * 0x9E3779B97F4A7C15ULL) >> 32) & mask;;
+         slot = (slot + 1) & mask) {
+      if (keys_[slot] == key || keys_[slot] == empty_key_) return slot;
+    }
+  }
+  void grow_() {
+    auto old_keys = std::move(keys_);
+    auto old_agents = std::move(agents_);
+    keys_.assign(std::max<std::size_t>(64, old_keys.size() * 2), empty_key_);
+    agents_.assign(keys_.size(), no_agent);
+    for (std::size_t i = 0; i < old_keys.size(); ++i) {
+      if (old_keys[i] == empty_key_) continue;
+      const auto slot = find_(old_keys[i]);
+      keys_[slot] = old_keys[i];
+      agents_[slot] = old_agents[i];
+    }
+  }
+
+  std::vector<std::uint64_t> keys_{};
+  std::vector<int> agents_{};
+  std::size_t count_{};
+};
+
+/// @brief The start and goal of one agent given to `CooperativePlanner`.
+struct PlannerAgent {
+  std::vector<TCODPATH_IndexType> start{};
+  std::vector<TCODPATH_IndexType> goal{};
+};
+
+/// @brief Options for `CooperativePlanner`.
+struct PlannerOptions {
+  int window{16};  // Number of time steps planned at once, agents should re-plan before reaching the end
+  TCODPATH_ValueType wait_cost{1};  // Cost of waiting in place for one time step
+  int max_expansions{1 << 14};  // Search budget per agent, agents which run out wait in place
+  int batch_size{64};  // Number of agents planned in parallel before their reservations are committed
+  int threads{0};  // Number of worker threads, `0` uses the hardware concurrency
+};
+
+/// @brief A collision-free path over one planning window.
+struct SpaceTimePath {
+  std::vector<TCODPATH_IndexType> steps{};  // Flattened indexes of the `window + 1` time steps from the start time
+  TCODPATH_ValueType cost{};  // Cost of the steps, including waiting
+  bool reached_goal{};  // True if the agent is at its goal at the end of the window
+  bool planned{};  // False if no path was found within the budget, the agent then waits in place and may collide
+};
+
+/// @brief Cooperative multi-agent planner using windowed space-time A* against a shared reservation table (WHCA*).
+/// @details Agents are planned in priority order. Each batch of agents is searched in parallel against the
+/// reservations of all earlier batches, then committed in priority order. An agent whose path conflicts with an
+/// earlier agent of its own batch is searched again before being committed, so the committed reservations never
+/// conflict. When no search hits its budget, each agent's cost is the same as with sequential prioritized planning,
+/// although ties between equal cost paths may be broken differently.
+/// The heuristic is an exact reverse distance field per goal, which is cached between calls.
+/// The cost map of the graph must be bounded. Unless `PlannerOptions::threads` is 1 the graph must also be safe to read
+/// from multiple threads, see `TCODPATH_graph_is_thread_safe`.
+class CooperativePlanner {
+ public:
+  CooperativePlanner(TCODPATH_Graph& graph, const PlannerOptions& options = {}) : graph_{graph}, options_{options} {
+    const TCODPATH_Map* costs = nullptr;
+    if (graph.type == TCODPATH_GRAPH_BASIC2D) costs = graph.basic2d.map;
+    if (graph.type == TCODPATH_GRAPH_STATIC) costs = graph.static_edges.map;
+    const TCODPATH_IndexType* shape = TCODPATH_map_get_shape(costs);
+    if (!shape) throw std::invalid_argument("graph must have a bounded cost map");
+    if (options.threads != 1 && !TCODPATH_graph_is_thread_safe(&graph)) {
+      throw std::invalid_argument("graph must be safe to read from multiple threads");
+    }
+    if (options.window <= 0 || options.window > ReservationTable::max_time) {
+      throw std::invalid_argument("window is out of range");
+    }
+    shape_.assign(shape, shape + TCODPATH_map_get_dimensions(costs));
+    strides_.resize(shape_.size());
+    for (int i = static_cast<int>(shape_.size()) - 1; i >= 0; --i) {
+      strides_[i] = node_count_;
+      node_count_ *= shape_[i];
+    }
+  }
+
+  /// @brief Plan one window for `agents` in priority order, the first agent has the highest priority.
+  /// @details The reservation table is cleared first, so each call is one re-planning round. Agents follow the first
+  /// few steps of their paths and then call this again with their new positions and a later `start_time`.
+  /// @return One path per agent.
+  auto plan(const std::vector<PlannerAgent>& agents, int start_time = 0) -> std::vector<SpaceTimePath> {
+    if (start_time < 0 || start_time > ReservationTable::max_time - options_.window) {
+      throw std::out_of_range("start_time is out of range");
+    }
+    reservations_.clear();
+    replanned_count_ = 0;
+    const int agent_count = static_cast<int>(agents.size());
+    auto starts = std::vector<std::int64_t>(agent_count);
+    auto goals = std::vector<std::int64_t>(agent_count);
+    for (int i = 0; i < agent_count; ++i) {
+      starts[i] = cell_from_index_(agents[i].start);
+      goals[i] = cell_from_index_(agents[i].goal);
+    }
+    prepare_heuristics_(goals);
+
+    const int thread_count =
+        options_.threads > 0 ? options_.threads : std::max(1, static_cast<int>(std::thread::hardware_concurrency()));
+    scratch_.resize(thread_count);
+    auto paths = std::vector<std::vector<std::int64_t>>(agent_count);
+    auto results = std::vector<SpaceTimePath>(agent_count);
+    const int batch_size = std::max(1, options_.batch_size);
+    for (int batch_begin = 0; batch_begin < agent_count; batch_begin += batch_size) {
+      const int batch_end = std::min(agent_count, batch_begin + batch_size);
+      parallel_for_(batch_end - batch_begin, thread_count, [&](int i, int worker) {
+        const int agent = batch_begin + i;
+        results[agent] = search_(scratch_[worker], agent, starts[agent], goals[agent], start_time, paths[agent]);
+      });
+      for (int agent = batch_begin; agent < batch_end; ++agent) {
+        if (results[agent].planned && !is_valid_(paths[agent], agent, start_time)) {
+          ++replanned_count_;  // Conflicts with an earlier agent of this batch
+          results[agent] = search_(scratch_[0], agent, starts[agent], goals[agent], start_time, paths[agent]);
+        }
+        for (int t = 0; t <= options_.window; ++t) {
+          if (reservations_.is_free(paths[agent][t], start_time + t, agent)) {
+            reservations_.reserve(paths[agent][t], start_time + t, agent);
+          }
+        }
+      }
+    }
+    for (int agent = 0; agent < agent_count; ++agent) {
+      auto& steps = results[agent].steps;
+      steps.resize(paths[agent].size() * shape_.size());
+      for (std::size_t t = 0; t < paths[agent].size(); ++t) {
+        index_from_cell_(paths[agent][t], &steps[t * shape_.size()]);
+      }
+    }
+    return results;
+  }
+  /// @brief Return the reservations made by the last call to `plan`.
+  auto get_reservations() const noexcept -> const ReservationTable& { return reservations_; }
+  /// @brief Return how many agents of the last call to `plan` were searched again after a conflict within a batch.
+  auto get_replanned_count() const noexcept -> std::size_t { return replanned_count_; }
+  /// @brief Drop the cached heuristic fields. Must be called after the costs of the graph change.
+  void clear_heuristics() { heuristics_.clear(); }
+
+ private:
+  using Field = std::vector<TCODPATH_ValueType>;
+  struct OpenEntry {
+    TCODPATH_ValueType f;
+    TCODPATH_ValueType g;
+    int node;
+  };
+  struct Node {
+    std::int64_t cell;
+    int time;  // Time relative to the start of the window
+    TCODPATH_ValueType g;
+    int parent;
+  };
+  /// Per-thread search buffers, reused between agents.
+  struct Scratch {
+    std::vector<Node> nodes{};
+    std::vector<OpenEntry> open{};
+    std::unordered_map<std::uint64_t, TCODPATH_ValueType> best{};  // Best `g` per space-time node
+    std::vector<std::pair<std::int64_t, TCODPATH_ValueType>> edges{};
+    const CooperativePlanner* planner{};
+  };
+
+  auto cell_from_index_(const std::vector<TCODPATH_IndexType>& index) const -> std::int64_t {
+    if (index.size() != shape_.size()) throw std::invalid_argument("agent index does not match the map dimensions");
+    std::int64_t cell = 0;
+    for (std::size_t i = 0; i < shape_.size(); ++i) {
+      if (index[i] < 0 || index[i] >= shape_[i]) throw std::out_of_range("agent index is out of bounds");
+      cell += index[i] * strides_[i];
+    }
+    return cell;
+  }
+  void index_from_cell_(std::int64_t cell, TCODPATH_IndexType* index_out) const noexcept {
+    for (std::size_t i = 0; i < shape_.size(); ++i) {
+      index_out[i] = static_cast<TCODPATH_IndexType>(cell / strides_[i]);
+      cell %= strides_[i];
+    }
+  }
+  static void collect_edge_(
+      void* userdata, const TCODPATH_IndexType*, const TCODPATH_IndexType* leaf_index, TCODPATH_ValueType edge_cost) {
+    auto& scratch = *static_cast<Scratch*>(userdata);
+    std::int64_t cell = 0;
+    for (std::size_t i = 0; i < scratch.planner->shape_.size(); ++i) {
+      if (leaf_index[i] < 0 || leaf_index[i] >= scratch.planner->shape_[i]) return;
+      cell += leaf_index[i] * scratch.planner->strides_[i];
+    }
+    scratch.edges.emplace_back(cell, edge_cost);
+  }
+  /// Compute the missing reverse distance fields of `goals` in parallel.
+  void prepare_heuristics_(const std::vector<std::int64_t>& goals) {
+    auto missing = std::vector<std::int64_t>{};
+    for (const auto goal : goals) {
+      if (heuristics_.count(goal)) continue;
+      heuristics_.emplace(goal, nullptr);
+      missing.push_back(goal);
+    }
+    auto fields = std::vector<std::shared_ptr<const Field>>(missing.size());
+    const int thread_count =
+        options_.threads > 0 ? options_.threads : std::max(1, static_cast<int>(std::thread::hardware_concurrency()));
+    parallel_for_(static_cast<int>(missing.size()), thread_count, [&](int i, int) {
+      auto field = std::make_shared<Field>(node_count_, TCODPATH_VALUE_MAX);
+      auto map = TCODPATH_Map{};
+      TCODPATH_map_init_contigious_from(
+          &map,
+          static_cast<int>(shape_.size()),
+          const_cast<TCODPATH_IndexType*>(shape_.data()),
+          static_cast<int>(sizeof(TCODPATH_ValueType)) * (std::is_signed_v<TCODPATH_ValueType> ? -1 : 1),
+          field->data());
+      (*field)[missing[i]] = 0;
+      TCODPATH_dijkstra_reverse(&graph_, &map, nullptr);
+      fields[i] = std::move(field);
+    });
+    for (std::size_t i = 0; i < missing.size(); ++i) heuristics_[missing[i]] = std::move(fields[i]);
+  }
+  /// Call `function(i, worker)` for each `i` in `[0, count)` using up to `thread_count` threads.
+  template <typename Function>
+  static void parallel_for_(int count, int thread_count, const Function& function) {
+    thread_count = std::min(thread_count, count);
+    if (thread_count <= 1) {
+      for (int i = 0; i < count; ++i) function(i, 0);
+      return;
+    }
+    auto next = std::atomic<int>{0};
+    auto work = [&](int worker) {
+      for (int i = next++; i < count; i = next++) function(i, worker);
+    };
+    auto threads = std::vector<std::thread>{};
+    for (int worker = 1; worker < thread_count; ++worker) threads.emplace_back(work, worker);
+    work(0);
+    for (auto& thread : threads) thread.join();
+  }
+  /// Return true if `path` does not conflict with the current reservations.
+  auto is_valid_(const std::vector<std::int64_t>& path, int agent, int start_time) const noexcept -> bool {
+    for (int t = 1; t <= options_.window; ++t) {
+      if (!reservations_.can_move(path[t - 1], path[t], start_time + t - 1, agent)) return false;
+    }
+    return true;
+  }
+  /// Return true if `goal` stays free from `time` until the end of the window.
+  auto can_stay_(std::int64_t goal, int time, int agent, int start_time) const noexcept -> bool {
+    for (int t = time; t <= options_.window; ++t) {
+      if (!reservations_.is_free(goal, start_time + t, agent)) return false;
+    }
+    return true;
+  }
+  /// Space-time A* for one agent. Writes the cell of each time step to `path_out`.
+  auto search_(
+      Scratch& scratch,
+      int agent,
+      std::int64_t start,
+      std::int64_t goal,
+      int start_time,
+      std::vector<std::int64_t>& path_out) const -> SpaceTimePath {
+    const Field& heuristic = *heuristics_.at(goal);
+    const int window = options_.window;
+    path_out.assign(window + 1, start);
+    auto result = SpaceTimePath{};
+    if (heuristic[start] == TCODPATH_VALUE_MAX) return result;  // Goal is unreachable
+    const auto is_worse = [](const OpenEntry& a, const OpenEntry& b) { return a.f > b.f || (a.f == b.f && a.g < b.g); };
+    scratch.planner = this;
+    scratch.nodes.clear();
+    scratch.open.clear();
+    scratch.best.clear();
+    const auto push = [&](std::int64_t cell, int time, TCODPATH_ValueType g, int parent) {
+      const auto key = (static_cast<std::uint64_t>(cell) << 20) | static_cast<std::uint64_t>(time);
+      const auto [it, inserted] = scratch.best.try_emplace(key, g);
+      if (!inserted) {
+        if (it->second <= g) return;
+        it->second = g;
+      }
+      scratch.nodes.push_back(Node{cell, time, g, parent});
+      scratch.open.push_back(OpenEntry{g + heuristic[cell], g, static_cast<int>(scratch.nodes.size()) - 1});
+      std::push_heap(scratch.open.begin(), scratch.open.end(), is_worse);
+    };
+    push(start, 0, 0, -1);
+    TCODPATH_IndexType index[TCODPATH_MAX_DIMENSIONS];
+    for (int expansions = 0; !scratch.open.empty() && expansions < options_.max_expansions;) {
+      std::pop_heap(scratch.open.begin(), scratch.open.end(), is_worse);
+      const int node_id = scratch.open.back().node;
+      scratch.open.pop_back();
+      const Node node = scratch.nodes[node_id];
+      if (scratch.best.at((static_cast<std::uint64_t>(node.cell) << 20) | node.time) < node.g) continue;  // Stale
+      ++expansions;
+      const bool at_goal = node.cell == goal && can_stay_(goal, node.time, agent, start_time);
+      if (at_goal || node.time == window) {
+        for (int id = node_id; id >= 0; id = scratch.nodes[id].parent) {
+          path_out[scratch.nodes[id].time] = scratch.nodes[id].cell;
+        }
+        std::fill(path_out.begin() + node.time + 1, path_out.end(), node.cell);
+        result.cost = node.g;
+        result.reached_goal = node.cell == goal;
+        result.planned = true;
+        return result;
+      }
+      const int time = start_time + node.time;
+      if (reservations_.is_free(node.cell, time + 1, agent)) {
+        push(node.cell, node.time + 1, node.g + options_.wait_cost, node_id);  // Wait in place
+      }
+      scratch.edges.clear();
+      index_from_cell_(node.cell, index);
+      TCODPATH_graph_foreach_edge(&graph_, static_cast<int>(shape_.size()), index, collect_edge_, &scratch);
+      for (const auto& [cell, edge_cost] : scratch.edges) {
+        if (heuristic[cell] == TCODPATH_VALUE_MAX) continue;
+        if (!reservations_.can_move(node.cell, cell, time, agent)) continue;
+        push(cell, node.time + 1, node.g + edge_cost, node_id);
+      }
+    }
+    return result;  // Out of budget or boxed in
+  }
+
+  TCODPATH_Graph& graph_;
+  PlannerOptions options_{};
+  std::vector<TCODPATH_IndexType> shape_{};
+  std::vector<std::int64_t> strides_{};
+  std::int64_t node_count_{1};
+  ReservationTable reservations_{};
+  std::unordered_map<std::int64_t, std::shared_ptr<const Field>> heuristics_{};  // Reverse distance field per goal
+  std::vector<Scratch> scratch_{};
+  std::size_t replanned_count_{};
+};
+}  // namespace tcod::path
@@ -1,7 +1,12 @@
 #pragma once
 #include <assert.h>
 
+#include "allocator.h"
 #include "config.h"
+#include "graph_tools.h"
+#include "map_tools.h"
+#include "queue.h"
+#include "search_stats.h"
 #include "uniform_cost_search.h"
 
 /// @brief Narrow the map `differentials` into a single index on `out`.
@@ -20,6 +25,11 @@ static inline void TCODPATH_differential_map_slice(
       memcpy(as_strides.strides.shape, differentials->contigious.shape, sizeof(as_strides.strides.shape));
       as_strides.strides.int_type = differentials->contigious.int_type;
       as_strides.strides.data = differentials->contigious.data;
+      ptrdiff_t stride = TCODPATH_ABS(differentials->contigious.int_type);
+      for (int i = as_strides.strides.dimensions - 1; i >= 0; --i) {
+        as_strides.strides.strides[i] = stride;
+        stride *= differentials->contigious.shape[i];
+      }
       return TCODPATH_differential_map_slice(&as_strides, differential_index, out);
     }
     case TCODPATH_MAP_STRIDES:
@@ -33,16 +43,19 @@ static inline void TCODPATH_differential_map_slice(
       return;
   }
 }
-/// @brief Generate differentials for `differential_index` using the provided pivot indexes.
-static inline void TCODPATH_differential_generate_one(
+/// @brief Generate differentials for `differential_index` using the provided pivot indexes, updating `stats`.
+/// @param stats Optional counters to update, the time spent is added to the differential phase. Can be `NULL`.
+static inline void TCODPATH_differential_generate_one_with_stats(
     TCODPATH_Graph* __restrict graph,
     TCODPATH_Map* __restrict differentials,
     int differential_index,
     int pivot_n,
-    TCODPATH_IndexType* __restrict pivot_ij) {
+    TCODPATH_IndexType* __restrict pivot_ij,
+    TCODPATH_SearchStats* __restrict stats) {
   assert(graph);
   assert(differentials);
   assert(pivot_ij);
+  const int64_t begin_ns = TCODPATH_stats_phase_begin_(stats);
   TCODPATH_Map differential_slice;
   TCODPATH_differential_map_slice(differentials, differential_index, &differential_slice);
   TCODPATH_map_clear_max(&differential_slice);
@@ -50,28 +63,53 @@ static inline void TCODPATH_differential_generate_one(
     TCODPATH_map_set(&differential_slice, pivot_ij, 0);
     pivot_ij += TCODPATH_map_get_dimensions(&differential_slice);
   }
-  TCODPATH_dijkstra(graph, &differential_slice, NULL);
+  TCODPATH_dijkstra_from_sources_(graph, &differential_slice, NULL, false, stats);
+  TCODPATH_stats_phase_end_(stats, TCODPATH_STATS_PHASE_DIFFERENTIAL, begin_ns);
 }
-/// @brief Generate differentials for `differential_index` automatically.
-static inline void TCODPATH_differential_generate_one_auto(
+/// @brief Generate differentials for `differential_index` using the provided pivot indexes.
+static inline void TCODPATH_differential_generate_one(
+    TCODPATH_Graph* __restrict graph,
+    TCODPATH_Map* __restrict differentials,
+    int differential_index,
+    int pivot_n,
+    TCODPATH_IndexType* __restrict pivot_ij) {
+  TCODPATH_differential_generate_one_with_stats(graph, differentials, differential_index, pivot_n, pivot_ij, NULL);
+}
+/// @brief Generate differentials for `differential_index` automatically, updating `stats`.
+/// @details Pivot selection allocates from the allocator of `differentials`.
+/// @param stats Optional counters to update, the time spent is added to the differential phase. Can be `NULL`.
+static inline void TCODPATH_differential_generate_one_auto_with_stats(
     TCODPATH_Graph* __restrict graph,
     int partition_count,
     TCODPATH_Map* __restrict partition,
     TCODPATH_Map* __restrict differentials,
     int differential_index,
     int start_index,
-    int end_index) {
+    int end_index,
+    TCODPATH_SearchStats* __restrict stats) {
   assert(graph);
   assert(partition);
   assert(differentials);
+  const int64_t begin_ns = TCODPATH_stats_phase_begin_(stats);
   TCODPATH_Map differential_slice;
   TCODPATH_differential_map_slice(differentials, differential_index, &differential_slice);
   TCODPATH_map_clear_max(&differential_slice);
   TCODPATH_IndexType index[TCODPATH_MAX_DIMENSIONS];
   const int dimensions = TCODPATH_map_get_dimensions(&differential_slice);
   const bool no_differentials_exist = start_index == end_index;
-  TCODPATH_IndexType* pivots_ij = (TCODPATH_IndexType*)calloc(dimensions * partition_count, sizeof(*pivots_ij));
-  TCODPATH_ValueType* best_values = (TCODPATH_ValueType*)malloc(partition_count * sizeof(*best_values));
+  const size_t pivots_bytes = sizeof(TCODPATH_IndexType) * dimensions * partition_count;
+  const size_t best_values_bytes = sizeof(TCODPATH_ValueType) * partition_count;
+  TCODPATH_Allocator* allocator = TCODPATH_map_get_allocator(differentials);  // Scratch space follows the output
+  TCODPATH_IndexType* pivots_ij = (TCODPATH_IndexType*)TCODPATH_calloc_(allocator, 1, pivots_bytes);
+  TCODPATH_ValueType* best_values = (TCODPATH_ValueType*)TCODPATH_alloc_(allocator, best_values_bytes);
+  if (!pivots_ij || !best_values) {
+    TCODPATH_free_(allocator, best_values, best_values_bytes);
+    TCODPATH_free_(allocator, pivots_ij, pivots_bytes);
+    TCODPATH_stats_phase_end_(stats, TCODPATH_STATS_PHASE_DIFFERENTIAL, begin_ns);
+    return;  // Out of memory, the differential is left cleared
+  }
+  TCODPATH_STATS_ADD(
+      stats, bytes_allocated, (int64_t)partition_count * (dimensions * sizeof(*pivots_ij) + sizeof(*best_values)));
   for (int i = 0; i < partition_count; ++i) best_values[i] = TCODPATH_VALUE_MAX;
   for (TCODPATH_indexes_iter_begin(dimensions, index);
        TCODPATH_indexes_iter_step(dimensions, TCODPATH_map_get_shape(&differential_slice), index);) {
@@ -93,21 +131,209 @@ static inline void TCODPATH_differential_generate_one_auto(
       for (int i = 0; i < dimensions; ++i) pivots_ij[this_partition * dimensions + i] = index[i];
     }
   }
-  free(best_values);
-  TCODPATH_differential_generate_one(graph, differentials, differential_index, partition_count, pivots_ij);
-  free(pivots_ij);
+  TCODPATH_free_(allocator, best_values, best_values_bytes);
+  TCODPATH_stats_phase_end_(stats, TCODPATH_STATS_PHASE_DIFFERENTIAL, begin_ns);  // Pivot selection
+  TCODPATH_differential_generate_one_with_stats(
+      graph, differentials, differential_index, partition_count, pivots_ij, stats);
+  TCODPATH_free_(allocator, pivots_ij, pivots_bytes);
+}
+/// @brief Generate differentials for `differential_index` automatically.
+static inline void TCODPATH_differential_generate_one_auto(
+    TCODPATH_Graph* __restrict graph,
+    int partition_count,
+    TCODPATH_Map* __restrict partition,
+    TCODPATH_Map* __restrict differentials,
+    int differential_index,
+    int start_index,
+    int end_index) {
+  TCODPATH_differential_generate_one_auto_with_stats(
+      graph, partition_count, partition, differentials, differential_index, start_index, end_index, NULL);
 }
 
-static inline void TCODPATH_differential_generate_all_auto(
+/// @brief Generate every differential of `differentials`, each one using pivots far from the previous ones.
+/// @param stats Optional counters to update, the time spent is added to the differential phase. Can be `NULL`.
+static inline void TCODPATH_differential_generate_all_auto_with_stats(
     TCODPATH_Graph* __restrict graph,
     int partition_count,
     TCODPATH_Map* __restrict partition,
-    TCODPATH_Map* __restrict differentials) {
+    TCODPATH_Map* __restrict differentials,
+    TCODPATH_SearchStats* __restrict stats) {
   assert(graph);
   assert(partition);
   assert(differentials);
   const int differentials_count = TCODPATH_map_get_shape(differentials)[TCODPATH_map_get_dimensions(differentials) - 1];
   for (int end_index = 0; end_index < differentials_count; ++end_index) {
-    TCODPATH_differential_generate_one_auto(graph, partition_count, partition, differentials, end_index, 0, end_index);
+    TCODPATH_differential_generate_one_auto_with_stats(
+        graph, partition_count, partition, differentials, end_index, 0, end_index, stats);
+  }
+}
+/// @brief Generate every differential of `differentials`, see `TCODPATH_differential_generate_all_auto_with_stats`.
+static inline void TCODPATH_differential_generate_all_auto(
+    TCODPATH_Graph* __restrict graph,
+    int partition_count,
+    TCODPATH_Map* __restrict partition,
+    TCODPATH_Map* __restrict differentials) {
+  TCODPATH_differential_generate_all_auto_with_stats(graph, partition_count, partition, differentials, NULL);
+}
+
+struct TCODPATH_DifferentialRepair_ {
+  TCODPATH_Graph* __restrict graph;
+  TCODPATH_Map* __restrict slice;
+  int dimensions;
+  TCODPATH_Queue pending;  // Invalidated nodes whose successors have not been checked yet
+  TCODPATH_Queue invalidated;  // Every invalidated node
+  TCODPATH_ValueType leaf_distance;
+  TCODPATH_ValueType best_distance;
+  bool found;
+};
+
+static inline void TCODPATH_differential_support_edge_(
+    void* userdata,
+    const TCODPATH_IndexType* __restrict root_index,
+    const TCODPATH_IndexType*,
+    TCODPATH_ValueType cost) {
+  struct TCODPATH_DifferentialRepair_* __restrict repair = (struct TCODPATH_DifferentialRepair_*)userdata;
+  if (TCODPATH_map_is_max(repair->slice, root_index)) return;
+  const TCODPATH_ValueType distance = TCODPATH_map_get(repair->slice, root_index) + cost;
+  if (repair->found && distance >= repair->best_distance) return;
+  repair->found = true;
+  repair->best_distance = distance;
+}
+/// @brief Return the best distance at `index` from its neighbors, or false if no neighbor has a distance.
+static inline bool TCODPATH_differential_best_from_neighbors_(
+    struct TCODPATH_DifferentialRepair_* __restrict repair,
+    const TCODPATH_IndexType* __restrict index,
+    TCODPATH_ValueType* __restrict out) {
+  repair->found = false;
+  TCODPATH_graph_foreach_reverse_edge(
+      repair->graph, repair->dimensions, index, TCODPATH_differential_support_edge_, repair);
+  *out = repair->best_distance;
+  return repair->found;
+}
+/// @brief Invalidate `index` if its distance is no longer supported by any predecessor.
+static inline void TCODPATH_differential_invalidate_(
+    struct TCODPATH_DifferentialRepair_* __restrict repair, const TCODPATH_IndexType* __restrict index) {
+  if (TCODPATH_map_is_max(repair->slice, index)) return;  // Unreached or already invalidated
+  const TCODPATH_ValueType distance = TCODPATH_map_get(repair->slice, index);
+  if (distance == 0) return;  // Pivots are never invalidated
+  TCODPATH_ValueType best_distance;
+  if (TCODPATH_differential_best_from_neighbors_(repair, index, &best_distance) && best_distance == distance) return;
+  TCODPATH_map_set_max(repair->slice, index);
+  TCODPATH_queue_push(&repair->pending, index);
+  TCODPATH_queue_push(&repair->invalidated, index);
+}
+static inline void TCODPATH_differential_invalidate_edge_(
+    void* userdata, const TCODPATH_IndexType*, const TCODPATH_IndexType* __restrict leaf_index, TCODPATH_ValueType) {
+  TCODPATH_differential_invalidate_((struct TCODPATH_DifferentialRepair_*)userdata, leaf_index);
+}
+/// @brief Setup iteration over a dirty rectangle of `journal` grown by one node and clamped to `shape`.
+/// @return False if the rectangle is empty.
+static inline bool TCODPATH_differential_dirty_bounds_(
+    const TCODPATH_MapJournal* __restrict journal,
+    int rect,
+    int dimensions,
+    const TCODPATH_IndexType* __restrict shape,
+    TCODPATH_IndexType* __restrict begin,
+    TCODPATH_IndexType* __restrict size) {
+  for (int i = 0; i < dimensions; ++i) {
+    begin[i] = TCODPATH_MAX(journal->dirty_begin[rect][i] - 1, 0);
+    size[i] = TCODPATH_MIN(journal->dirty_end[rect][i] + 1, shape[i]) - begin[i];
+    if (size[i] <= 0) return false;
+  }
+  return true;
+}
+/// @brief Refresh one slice of `differentials` after the costs of `graph` were changed.
+/// @details Only slices with a shortest-path tree reaching the dirty region of `journal` are refreshed. Of those, only
+/// nodes which lost their shortest path are cleared and searched again, then any cheaper paths through the dirty
+/// region are propagated outwards. Existing pivots are kept. Graph edges must only connect adjacent nodes.
+/// @param graph The graph after its costs were changed.
+/// @param differentials Differentials generated from `graph` before the change.
+/// @param differential_index Index of the slice to refresh.
+/// @param journal Journal of the cost map of `graph`.
+/// @return 1 if the slice was refreshed, 0 if the slice was not affected, negative value on error.
+static inline int TCODPATH_differential_refresh_one(
+    TCODPATH_Graph* __restrict graph,
+    TCODPATH_Map* __restrict differentials,
+    int differential_index,
+    const TCODPATH_MapJournal* __restrict journal) {
+  if (!graph || !differentials || !journal) return TCODPATH_E_INVALID_ARGUMENT;
+  TCODPATH_Map differential_slice;
+  TCODPATH_differential_map_slice(differentials, differential_index, &differential_slice);
+  const int dimensions = TCODPATH_map_get_dimensions(&differential_slice);
+  const TCODPATH_IndexType* shape = TCODPATH_map_get_shape(&differential_slice);
+  TCODPATH_IndexType begin[TCODPATH_MAX_DIMENSIONS];
+  TCODPATH_IndexType size[TCODPATH_MAX_DIMENSIONS];
+  TCODPATH_IndexType offset[TCODPATH_MAX_DIMENSIONS];
+  TCODPATH_IndexType index[TCODPATH_MAX_DIMENSIONS];
+
+  bool affected = false;  // True if the shortest-path tree of this slice touches the dirty region
+  for (int rect = 0; rect < journal->dirty_count && !affected; ++rect) {
+    if (!TCODPATH_differential_dirty_bounds_(journal, rect, dimensions, shape, begin, size)) continue;
+    for (TCODPATH_indexes_iter_begin(dimensions, offset); TCODPATH_indexes_iter_step(dimensions, size, offset);) {
+      for (int i = 0; i < dimensions; ++i) index[i] = begin[i] + offset[i];
+      if (TCODPATH_map_is_max(&differential_slice, index)) continue;
+      affected = true;
+      break;
+    }
+  }
+  if (!affected) return 0;
+
+  struct TCODPATH_DifferentialRepair_ repair = {};
+  repair.graph = graph;
+  repair.slice = &differential_slice;
+  repair.dimensions = dimensions;
+  TCODPATH_queue_init(&repair.pending, sizeof(*index) * dimensions);
+  TCODPATH_queue_init(&repair.invalidated, sizeof(*index) * dimensions);
+  // Invalidate nodes whose shortest path crossed the dirty region
+  for (int rect = 0; rect < journal->dirty_count; ++rect) {
+    if (!TCODPATH_differential_dirty_bounds_(journal, rect, dimensions, shape, begin, size)) continue;
+    for (TCODPATH_indexes_iter_begin(dimensions, offset); TCODPATH_indexes_iter_step(dimensions, size, offset);) {
+      for (int i = 0; i < dimensions; ++i) index[i] = begin[i] + offset[i];
+      TCODPATH_differential_invalidate_(&repair, index);
+    }
+  }
+  while (TCODPATH_queue_pop(&repair.pending, index) == 0) {
+    TCODPATH_graph_foreach_edge(graph, dimensions, index, TCODPATH_differential_invalidate_edge_, &repair);
+  }
+  // Search again from the border of the invalidated nodes and from the dirty region
+  TCODPATH_UniformCostSearch ucs_data;
+  int err = TCODPATH_ucs_init(&ucs_data, graph, NULL, &differential_slice, NULL);
+  while (err >= 0 && TCODPATH_queue_pop(&repair.invalidated, index) == 0) {
+    TCODPATH_ValueType best_distance;
+    if (!TCODPATH_differential_best_from_neighbors_(&repair, index, &best_distance)) continue;
+    TCODPATH_map_set(&differential_slice, index, best_distance);
+    err = TCODPATH_ucs_push(&ucs_data, index);
+  }
+  for (int rect = 0; err >= 0 && rect < journal->dirty_count; ++rect) {
+    if (!TCODPATH_differential_dirty_bounds_(journal, rect, dimensions, shape, begin, size)) continue;
+    for (TCODPATH_indexes_iter_begin(dimensions, offset); TCODPATH_indexes_iter_step(dimensions, size, offset);) {
+      for (int i = 0; i < dimensions; ++i) index[i] = begin[i] + offset[i];
+      if (TCODPATH_map_is_max(&differential_slice, index)) continue;
+      err = TCODPATH_ucs_push(&ucs_data, index);
+      if (err < 0) break;
+    }
+  }
+  while (err >= 0) {
+    err = TCODPATH_ucs_step(&ucs_data);
+    if (err != 0) break;
+  }
+  TCODPATH_ucs_uninit(&ucs_data);
+  TCODPATH_queue_uninit(&repair.pending);
+  TCODPATH_queue_uninit(&repair.invalidated);
+  return err < 0 ? err : 1;
+}
+/// @brief Refresh all slices of `differentials` which were affected by changes recorded in `journal`.
+/// @details Afterwards the caller should call `TCODPATH_map_journal_clear_dirty` on `journal`.
+/// @return The number of refreshed slices, or a negative value on error.
+static inline int TCODPATH_differential_refresh_all(
+    TCODPATH_Graph* __restrict graph, TCODPATH_Map* __restrict differentials, const TCODPATH_MapJournal* journal) {
+  if (!graph || !differentials || !journal) return TCODPATH_E_INVALID_ARGUMENT;
+  const int differentials_count = TCODPATH_map_get_shape(differentials)[TCODPATH_map_get_dimensions(differentials) - 1];
+  int refreshed = 0;
+  for (int i = 0; i < differentials_count; ++i) {
+    const int result = TCODPATH_differential_refresh_one(graph, differentials, i, journal);
+    if (result < 0) return result;
+    refreshed += result;
   }
+  return refreshed;
 }
@@ -0,0 +1,285 @@
+#pragma once
+
+#include <libtcod-path/flow_tools.h>
+#include <libtcod-path/graph_tools.h>
+#include <libtcod-path/graph_types.h>
+#include <libtcod-path/map_tools.h>
+#include <libtcod-path/map_types.h>
+#include <libtcod-path/uniform_cost_search.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <future>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace tcod::path {
+/// @brief Identifies a distance field by its goals, the graph it was computed on, and the cost map version.
+struct DistanceFieldKey {
+  std::vector<TCODPATH_IndexType> goals{};  // Flattened array of goal indexes
+  int graph_type{};
+  const void* graph_map{};  // Cost map of the graph
+  std::vector<std::intptr_t> graph_parameters{};  // Type specific parameters of the graph, including map versions
+  std::uint64_t version{};  // Version of the cost map, must change whenever costs change
+  bool with_flow{};  // True if the field also holds a flow map
+
+  /// @brief Return a key for `goals` on `graph`.
+  /// @details The version is read from the journal of the cost map, so edits made through `TCODPATH_map_set` give a
+  /// new key. Cost maps without a journal are always version 0.
+  static auto from_graph(const TCODPATH_Graph& graph, std::vector<TCODPATH_IndexType> goals, bool with_flow = false)
+      -> DistanceFieldKey {
+    auto key = DistanceFieldKey{std::move(goals), graph.type, nullptr, {}, 0, with_flow};
+    switch (graph.type) {
+      case TCODPATH_GRAPH_BASIC2D:
+        key.graph_map = graph.basic2d.map;
+        key.version = TCODPATH_map_get_version(graph.basic2d.map);
+        key.graph_parameters = {
+            graph.basic2d.cardinal,
+            graph.basic2d.diagonal,
+            reinterpret_cast<std::intptr_t>(graph.basic2d.clearance),
+            static_cast<std::intptr_t>(TCODPATH_map_get_version(graph.basic2d.clearance)),
+            graph.basic2d.agent_size,
+            graph.basic2d.no_corner_cutting};
+        break;
+      case TCODPATH_GRAPH_STATIC:
+        key.graph_map = graph.static_edges.map;
+        key.version = TCODPATH_map_get_version(graph.static_edges.map);
+        key.graph_parameters = {
+            graph.static_edges.dimensions,
+            graph.static_edges.edge_count,
+            reinterpret_cast<std::intptr_t>(graph.static_edges.edges)};
+        break;
+      default:
+        break;
+    }
+    return key;
+  }
+
+  bool operator==(const DistanceFieldKey& other) const noexcept {
+    return goals == other.goals && graph_type == other.graph_type && graph_map == other.graph_map &&
+           graph_parameters == other.graph_parameters && version == other.version && with_flow == other.with_flow;
+  }
+};
+
+struct DistanceFieldKeyHash {
+  auto operator()(const DistanceFieldKey& key) const noexcept -> std::size_t {
+    auto seed = std::hash<std::uint64_t>{}(key.version);
+    auto combine = [&seed](std::size_t value) { seed ^= value + 0x9e3779b97f4a7c15ULL + (seed << 6) + (seed >> 2); };
+    for (const auto& it : key.goals) combine(std::hash<TCODPATH_IndexType>{}(it));
+    combine(std::hash<int>{}(key.graph_type));
+    combine(std::hash<const void*>{}(key.graph_map));
+    for (const auto& it : key.graph_parameters) combine(std::hash<std::intptr_t>{}(it));
+    combine(key.with_flow);
+    return seed;
+  }
+};
+
+/// @brief A computed distance map with an optional flow map.
+class DistanceField {
+ public:
+  /// @brief Allocate a field of `shape`. Distances are cleared to the maximum value.
+  DistanceField(std::vector<TCODPATH_IndexType> shape, bool with_flow) : shape_{std::move(shape)} {
+    std::size_t elements = 1;
+    for (const auto& it : shape_) elements *= it;
+    distance_data_.resize(elements, TCODPATH_VALUE_MAX);
+    TCODPATH_map_init_contigious_from(
+        &distance_,
+        static_cast<int>(shape_.size()),
+        shape_.data(),
+        static_cast<int>(sizeof(TCODPATH_ValueType)) * (std::is_signed_v<TCODPATH_ValueType> ? -1 : 1),
+        distance_data_.data());
+    if (!with_flow) return;
+    flow_shape_ = shape_;
+    flow_shape_.push_back(static_cast<TCODPATH_IndexType>(shape_.size()));
+    flow_data_.resize(elements * shape_.size());
+    TCODPATH_map_init_contigious_from(
+        &flow_,
+        static_cast<int>(flow_shape_.size()),
+        flow_shape_.data(),
+        static_cast<int>(sizeof(TCODPATH_IndexType)) * (std::is_signed_v<TCODPATH_IndexType> ? -1 : 1),
+        flow_data_.data());
+  }
+  DistanceField(const DistanceField&) = delete;
+  DistanceField& operator=(const DistanceField&) = delete;
+
+  auto get_shape() const noexcept -> const std::vector<TCODPATH_IndexType>& { return shape_; }
+  /// @brief Return the distance map.
+  TCODPATH_Map* distance() noexcept { return &distance_; }
+  const TCODPATH_Map* distance() const noexcept { return &distance_; }
+  /// @brief Return the flow map, or nullptr if this field has no flow.
+  TCODPATH_Map* flow() noexcept { return flow_data_.empty() ? nullptr : &flow_; }
+  const TCODPATH_Map* flow() const noexcept { return flow_data_.empty() ? nullptr : &flow_; }
+  /// @brief Return the approximate memory used by this field in bytes.
+  auto size_bytes() const noexcept -> std::size_t {
+    return sizeof(*this) + distance_data_.size() * sizeof(TCODPATH_ValueType) +
+           flow_data_.size() * sizeof(TCODPATH_IndexType);
+  }
+
+ private:
+  std::vector<TCODPATH_IndexType> shape_{};
+  std::vector<TCODPATH_IndexType> flow_shape_{};
+  std::vector<TCODPATH_ValueType> distance_data_{};
+  std::vector<TCODPATH_IndexType> flow_data_{};
+  TCODPATH_Map distance_{};
+  TCODPATH_Map flow_{};
+};
+
+/// @brief Compute the Dijkstra distance field for `key` on `graph`.
+/// @details The search only writes distances, the flow is derived afterwards when `key.with_flow` is set.
+inline auto compute_distance_field(TCODPATH_Graph& graph, const DistanceFieldKey& key)
+    -> std::shared_ptr<DistanceField> {
+  const TCODPATH_Map* costs = reinterpret_cast<const TCODPATH_Map*>(key.graph_map);
+  const int dimensions = TCODPATH_map_get_dimensions(costs);
+  const TCODPATH_IndexType* shape = TCODPATH_map_get_shape(costs);
+  if (dimensions <= 0 || !shape) throw std::invalid_argument("graph has no cost map");
+  if (key.goals.size() % dimensions != 0) throw std::invalid_argument("goals do not match the graph dimensions");
+  auto field =
+      std::make_shared<DistanceField>(std::vector<TCODPATH_IndexType>(shape, shape + dimensions), key.with_flow);
+  for (std::size_t i = 0; i < key.goals.size(); i += dimensions) TCODPATH_map_set(field->distance(), &key.goals[i], 0);
+  TCODPATH_dijkstra(&graph, field->distance(), nullptr);
+  if (field->flow()) TCODPATH_flow_from_distance(&graph, field->distance(), field->flow());
+  return field;
+}
+
+/// @brief Thread-safe LRU cache of distance fields with a memory budget.
+/// @details Lookups are O(1). Cached fields are immutable and shared, so any number of threads can read them at once.
+/// Concurrent misses on the same key are single-flight: one caller computes the field while the others wait for it.
+class DistanceFieldCache {
+ public:
+  using FieldPtr = std::shared_ptr<const DistanceField>;
+  using ComputeFunction = std::function<std::shared_ptr<DistanceField>(const DistanceFieldKey&)>;
+
+  /// @brief Create a cache which holds at most `memory_budget` bytes of fields.
+  explicit DistanceFieldCache(std::size_t memory_budget) : memory_budget_{memory_budget} {}
+
+  /// @brief Return the field for `key`, or nullptr if it is not cached.
+  auto get(const DistanceFieldKey& key) -> FieldPtr {
+    auto lock = std::lock_guard{mutex_};
+    auto found = entries_.find(key);
+    if (found == entries_.end()) return nullptr;
+    lru_.splice(lru_.begin(), lru_, found->second);
+    ++hits_;
+    return found->second->field;
+  }
+  /// @brief Return the field for `key`, calling `compute` on a miss.
+  /// @details Exceptions thrown by `compute` are passed to every caller waiting on `key` and nothing is cached.
+  auto get_or_compute(const DistanceFieldKey& key, const ComputeFunction& compute) -> FieldPtr {
+    auto promise = std::promise<FieldPtr>{};
+    {
+      auto lock = std::unique_lock{mutex_};
+      auto found = entries_.find(key);
+      if (found != entries_.end()) {
+        lru_.splice(lru_.begin(), lru_, found->second);
+        ++hits_;
+        return found->second->field;
+      }
+      auto in_flight = in_flight_.find(key);
+      if (in_flight != in_flight_.end()) {
+        auto pending = in_flight->second;
+        ++hits_;
+        lock.unlock();
+        return pending.get();  // Another thread is already computing this key
+      }
+      ++misses_;
+      in_flight_.emplace(key, promise.get_future().share());
+    }
+    auto field = FieldPtr{};
+    try {
+      field = compute(key);
+    } catch (...) {
+      auto lock = std::lock_guard{mutex_};
+      in_flight_.erase(key);
+      promise.set_exception(std::current_exception());
+      throw;
+    }
+    {
+      auto lock = std::lock_guard{mutex_};
+      in_flight_.erase(key);
+      if (field) insert_(key, field);
+    }
+    promise.set_value(field);
+    return field;
+  }
+  /// @brief Return the distance field for `key` on `graph`, computing it with Dijkstra on a miss.
+  /// @details Misses on different keys are computed at once, so `graph` must be safe to read from multiple threads,
+  /// see `TCODPATH_graph_is_thread_safe`. Pass a compute function which serializes the searches for other graphs.
+  auto get_or_compute(TCODPATH_Graph& graph, const DistanceFieldKey& key) -> FieldPtr {
+    if (!TCODPATH_graph_is_thread_safe(&graph)) {
+      throw std::invalid_argument("graph must be safe to read from multiple threads");
+    }
+    return get_or_compute(key, [&graph](const DistanceFieldKey& key) { return compute_distance_field(graph, key); });
+  }
+  /// @brief Remove all cached fields. Fields still referenced elsewhere remain valid.
+  void clear() {
+    auto lock = std::lock_guard{mutex_};
+    entries_.clear();
+    lru_.clear();
+    memory_used_ = 0;
+  }
+  /// @brief Change the memory budget, evicting fields if needed.
+  void set_memory_budget(std::size_t memory_budget) {
+    auto lock = std::lock_guard{mutex_};
+    memory_budget_ = memory_budget;
+    evict_();
+  }
+  auto get_memory_budget() const -> std::size_t {
+    auto lock = std::lock_guard{mutex_};
+    return memory_budget_;
+  }
+  auto get_memory_used() const -> std::size_t {
+    auto lock = std::lock_guard{mutex_};
+    return memory_used_;
+  }
+  auto size() const -> std::size_t {
+    auto lock = std::lock_guard{mutex_};
+    return lru_.size();
+  }
+  auto get_hits() const -> std::size_t {
+    auto lock = std::lock_guard{mutex_};
+    return hits_;
+  }
+  auto get_misses() const -> std::size_t {
+    auto lock = std::lock_guard{mutex_};
+    return misses_;
+  }
+
+ private:
+  struct Entry {
+    DistanceFieldKey key;
+    FieldPtr field;
+    std::size_t size_bytes;
+  };
+  using LruList = std::list<Entry>;
+
+  void insert_(const DistanceFieldKey& key, FieldPtr field) {
+    const auto size_bytes = field->size_bytes();
+    if (size_bytes > memory_budget_) return;  // Would evict everything else, do not cache
+    lru_.push_front(Entry{key, std::move(field), size_bytes});
+    entries_.emplace(key, lru_.begin());
+    memory_used_ += size_bytes;
+    evict_();
+  }
+  void evict_() {
+    while (memory_used_ > memory_budget_ && !lru_.empty()) {
+      memory_used_ -= lru_.back().size_bytes;
+      entries_.erase(lru_.back().key);
+      lru_.pop_back();
+    }
+  }
+
+  mutable std::mutex mutex_{};
+  std::size_t memory_budget_{};
+  std::size_t memory_used_{};
+  std::size_t hits_{};
+  std::size_t misses_{};
+  LruList lru_{};  // Most recently used first
+  std::unordered_map<DistanceFieldKey, LruList::iterator, DistanceFieldKeyHash> entries_{};
+  std::unordered_map<DistanceFieldKey, std::shared_future<FieldPtr>, DistanceFieldKeyHash> in_flight_{};
+};
+}  // namespace tcod::path
@@ -1,4 +1,6 @@
 #pragma once
+#include "graph_tools.h"
+#include "graph_types.h"
 #include "map_tools.h"
 
 /// @brief Reset a flow map. All index values will refer to their own index.
@@ -8,10 +10,14 @@ static inline void TCODPATH_flow_reset(TCODPATH_Map* __restrict flow_map) {
   const int dimensions = TCODPATH_map_get_dimensions(flow_map);
   const TCODPATH_IndexType* __restrict shape = TCODPATH_map_get_shape(flow_map);
   if (dimensions <= 0 || !shape) return;
+  TCODPATH_MapJournal* journal = TCODPATH_map_get_journal(flow_map);
+  TCODPATH_map_set_journal(flow_map, NULL);  // Record this as one change instead of one per node
   TCODPATH_IndexType index[TCODPATH_MAX_DIMENSIONS];
   for (TCODPATH_indexes_iter_begin(dimensions - 1, index); TCODPATH_indexes_iter_step(dimensions - 1, shape, index);) {
     TCODPATH_map_set_index(flow_map, index, index);
   }
+  TCODPATH_map_set_journal(flow_map, journal);
+  TCODPATH_map_journal_mark_all(flow_map);
 }
 /// @brief Replace `ij` with the next index in this flow map. Return 1 when end is reached.
 /// @param flow_map Pointer to a flow map.
@@ -28,3 +34,165 @@ static inline int TCODPATH_flow_iter_next(const TCODPATH_Map* __restrict flow_ma
   }
   return 1;  // End has been reached
 }
+
+struct TCODPATH_FlowDescent_ {
+  const TCODPATH_Map* __restrict distance;
+  int dimensions;
+  TCODPATH_ValueType leaf_distance;  // Distance of the node being derived
+  TCODPATH_ValueType best_distance;  // Distance of the best predecessor so far
+  bool unit_costs;  // If true then every edge costs 1, as with breadth-first distances
+  bool found;
+  TCODPATH_IndexType best_index[TCODPATH_MAX_DIMENSIONS];
+};
+
+static inline void TCODPATH_flow_descent_edge_(
+    void* userdata,
+    const TCODPATH_IndexType* __restrict root_index,
+    const TCODPATH_IndexType* __restrict,
+    TCODPATH_ValueType edge_cost) {
+  struct TCODPATH_FlowDescent_* __restrict data = (struct TCODPATH_FlowDescent_*)userdata;
+  if (TCODPATH_map_is_max(data->distance, root_index)) return;  // Root was never reached
+  const TCODPATH_ValueType root_distance = TCODPATH_map_get(data->distance, root_index);
+  const TCODPATH_ValueType step = data->unit_costs ? 1 : edge_cost;
+  if (root_distance + step != data->leaf_distance) return;  // Edge is not on a shortest path
+  if (data->found && root_distance >= data->best_distance) return;  // Prefer the steepest edge
+  data->found = true;
+  data->best_distance = root_distance;
+  for (int i = 0; i < data->dimensions; ++i) data->best_index[i] = root_index[i];
+}
+/// @brief Derive the flow of a single node, see `TCODPATH_flow_from_distance_at`.
+/// Used internally.
+/// @param unit_costs If true then `distance` counts steps instead of edge costs.
+static inline int TCODPATH_flow_descend_at_(
+    TCODPATH_Graph* __restrict graph,
+    const TCODPATH_Map* __restrict distance,
+    const TCODPATH_IndexType* ij,
+    TCODPATH_IndexType* out,
+    bool unit_costs) {
+  if (!graph || !distance || !ij || !out) return -1;
+  const int dimensions = TCODPATH_map_get_dimensions(distance);
+  struct TCODPATH_FlowDescent_ data = {};
+  data.distance = distance;
+  data.dimensions = dimensions;
+  data.unit_costs = unit_costs;
+  if (!TCODPATH_map_is_max(distance, ij)) {
+    data.leaf_distance = TCODPATH_map_get(distance, ij);
+    TCODPATH_graph_foreach_reverse_edge(graph, dimensions, ij, TCODPATH_flow_descent_edge_, &data);
+  }
+  if (!data.found) {
+    for (int i = 0; i < dimensions; ++i) out[i] = ij[i];
+    return 1;
+  }
+  for (int i = 0; i < dimensions; ++i) out[i] = data.best_index[i];
+  return 0;
+}
+/// @brief Derive the flow of a single node from a finished distance map.
+/// @details Picks the predecessor of `ij` with the steepest descent along an edge of `graph` which exactly accounts
+/// for the distance at `ij`. This matches the flow a search over `graph` would have written.
+/// Distances from a breadth-first search ignore edge costs, use `TCODPATH_flow_from_bfs_distance_at` for those.
+/// @param graph Graph which was used to generate `distance`.
+/// @param distance Distance map from a completed search.
+/// @param ij Node index. Array size must match the `distance` dimensions.
+/// @param out Output index of the predecessor, or a copy of `ij` if `ij` has no predecessor. Can alias `ij`.
+/// @return 0 if a predecessor was found. 1 if `ij` is a source or was unreached.
+static inline int TCODPATH_flow_from_distance_at(
+    TCODPATH_Graph* __restrict graph,
+    const TCODPATH_Map* __restrict distance,
+    const TCODPATH_IndexType* ij,
+    TCODPATH_IndexType* out) {
+  return TCODPATH_flow_descend_at_(graph, distance, ij, out, false);
+}
+/// @brief Derive the flow of a single node from a finished breadth-first distance map, where every edge costs 1.
+/// @details The same as `TCODPATH_flow_from_distance_at` otherwise.
+static inline int TCODPATH_flow_from_bfs_distance_at(
+    TCODPATH_Graph* __restrict graph,
+    const TCODPATH_Map* __restrict distance,
+    const TCODPATH_IndexType* ij,
+    TCODPATH_IndexType* out) {
+  return TCODPATH_flow_descend_at_(graph, distance, ij, out, true);
+}
+/// @brief Derive `flow_map` from `distance` for indexes in `[begin, end)` of the first axis.
+/// Used internally.
+/// @param unit_costs If true then `distance` counts steps instead of edge costs.
+static inline void TCODPATH_flow_descend_range_(
+    TCODPATH_Graph* __restrict graph,
+    const TCODPATH_Map* __restrict distance,
+    TCODPATH_Map* __restrict flow_map,
+    TCODPATH_IndexType begin,
+    TCODPATH_IndexType end,
+    bool unit_costs) {
+  if (!graph || !distance || !flow_map) return;
+  const int dimensions = TCODPATH_map_get_dimensions(distance);
+  const TCODPATH_IndexType* __restrict distance_shape = TCODPATH_map_get_shape(distance);
+  if (dimensions <= 0 || !distance_shape) return;
+  TCODPATH_IndexType shape[TCODPATH_MAX_DIMENSIONS];
+  for (int i = 0; i < dimensions; ++i) shape[i] = distance_shape[i];
+  begin = TCODPATH_MAX(begin, 0);
+  end = TCODPATH_MIN(end, shape[0]);
+  if (begin >= end) return;
+  shape[0] = end - begin;
+  TCODPATH_IndexType offset[TCODPATH_MAX_DIMENSIONS];
+  TCODPATH_IndexType index[TCODPATH_MAX_DIMENSIONS];
+  TCODPATH_IndexType next[TCODPATH_MAX_DIMENSIONS];
+  for (TCODPATH_indexes_iter_begin(dimensions, offset); TCODPATH_indexes_iter_step(dimensions, shape, offset);) {
+    for (int i = 0; i < dimensions; ++i) index[i] = offset[i];
+    index[0] += begin;
+    TCODPATH_flow_descend_at_(graph, distance, index, next, unit_costs);
+    TCODPATH_map_set_index(flow_map, index, next);
+  }
+}
+/// @brief Derive `flow_map` from `distance` for indexes in `[begin, end)` of the first axis.
+/// @details Every node is derived independently, so disjoint ranges can be run in parallel.
+/// Unreached nodes and sources will refer to their own index.
+/// @param graph Graph which was used to generate `distance`.
+/// @param distance Distance map from a completed search.
+/// @param flow_map Output flow map.
+/// @param begin First index of the first axis to derive.
+/// @param end One past the last index of the first axis to derive.
+static inline void TCODPATH_flow_from_distance_range(
+    TCODPATH_Graph* __restrict graph,
+    const TCODPATH_Map* __restrict distance,
+    TCODPATH_Map* __restrict flow_map,
+    TCODPATH_IndexType begin,
+    TCODPATH_IndexType end) {
+  TCODPATH_flow_descend_range_(graph, distance, flow_map, begin, end, false);
+}
+/// @brief Derive `flow_map` from `distance` after a search was run without a flow map.
+/// @details This is equivalent to passing `flow_map` to the search, but the search itself will only write distances.
+/// @param graph Graph which was used to generate `distance`.
+/// @param distance Distance map from a completed search.
+/// @param flow_map Output flow map.
+static inline void TCODPATH_flow_from_distance(
+    TCODPATH_Graph* __restrict graph, const TCODPATH_Map* __restrict distance, TCODPATH_Map* __restrict flow_map) {
+  const TCODPATH_IndexType* __restrict shape = TCODPATH_map_get_shape(distance);
+  if (!shape) return;
+  TCODPATH_flow_from_distance_range(graph, distance, flow_map, 0, shape[0]);
+}
+/// @brief Derive `flow_map` from a breadth-first `distance` for indexes in `[begin, end)` of the first axis.
+/// @details The same as `TCODPATH_flow_from_distance_range`, but every edge costs 1.
+static inline void TCODPATH_flow_from_bfs_distance_range(
+    TCODPATH_Graph* __restrict graph,
+    const TCODPATH_Map* __restrict distance,
+    TCODPATH_Map* __restrict flow_map,
+    TCODPATH_IndexType begin,
+    TCODPATH_IndexType end) {
+  TCODPATH_flow_descend_range_(graph, distance, flow_map, begin, end, true);
+}
+/// @brief Derive `flow_map` from `distance` after a breadth-first search was run without a flow map.
+/// @details The same as `TCODPATH_flow_from_distance`, but every edge costs 1.
+static inline void TCODPATH_flow_from_bfs_distance(
+    TCODPATH_Graph* __restrict graph, const TCODPATH_Map* __restrict distance, TCODPATH_Map* __restrict flow_map) {
+  const TCODPATH_IndexType* __restrict shape = TCODPATH_map_get_shape(distance);
+  if (!shape) return;
+  TCODPATH_flow_from_bfs_distance_range(graph, distance, flow_map, 0, shape[0]);
+}
+/// @brief Replace `ij` with the next index towards a source of `distance`. Return 1 when end is reached.
+/// @details Derives the path on demand, without a flow map.
+/// @param graph Graph which was used to generate `distance`.
+/// @param distance Distance map from a completed search.
+/// @param ij Current position on the distance map.
+/// @return 0 if `ij` was changed. 1 if end was reached.
+static inline int TCODPATH_distance_iter_next(
+    TCODPATH_Graph* __restrict graph, const TCODPATH_Map* __restrict distance, TCODPATH_IndexType* __restrict ij) {
+  return TCODPATH_flow_from_distance_at(graph, distance, ij, ij);
+}
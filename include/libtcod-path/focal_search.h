@@ -0,0 +1,217 @@
+#pragma once
+
+#include <stddef.h>
+
+#include "focal_search_types.h"
+#include "graph_tools.h"
+#include "heapq_tools.h"
+#include "heuristic_tools.h"
+#include "indexes.h"
+#include "map_tools.h"
+#include "partition.h"
+#include "search_stats.h"
+
+/// @brief Return `heuristic` of `index` at `distance`, counting the call in the search stats.
+/// Used internally.
+static inline TCODPATH_ValueType TCODPATH_focal_heuristic_at_(
+    const TCODPATH_FocalSearch* __restrict focal_data,
+    TCODPATH_Heuristic* __restrict heuristic,
+    const TCODPATH_IndexType* __restrict index,
+    TCODPATH_ValueType distance) {
+  if (heuristic) TCODPATH_STATS_ADD(focal_data->stats, heuristic_calls, 1);
+  return TCODPATH_heuristic_at(heuristic, focal_data->dimensions, index, distance);
+}
+/// @brief Push `node` to `heap` and record any growth of `heap` in the search stats.
+/// Used internally.
+static inline int TCODPATH_focal_heap_push_(
+    TCODPATH_FocalSearch* __restrict focal_data,
+    struct TCODPATH_Heap* __restrict heap,
+    int priority,
+    const TCODPATH_FocalNode* __restrict node) {
+#if TCODPATH_STATS_ENABLED
+  const int old_capacity = heap->capacity;
+#else
+  (void)focal_data;
+#endif
+  const int err = TCODPATH_minheap_push(heap, priority, node);
+  TCODPATH_STATS_ADD(focal_data->stats, bytes_allocated, (int64_t)(heap->capacity - old_capacity) * heap->node_size);
+  return err;
+}
+/// @brief Return the highest `f` allowed in the focal list of `focal_data`.
+static inline int TCODPATH_focal_threshold_(const TCODPATH_FocalSearch* __restrict focal_data) {
+  return (int)((int64_t)focal_data->lower_bound * focal_data->suboptimality / 100);
+}
+/// @brief Return true if `node` is outdated, either expanded already or found again at a shorter distance.
+static inline bool TCODPATH_focal_is_stale_(
+    const TCODPATH_FocalSearch* __restrict focal_data, const TCODPATH_FocalNode* __restrict node) {
+  if (TCODPATH_map_get(focal_data->closed, node->index)) return true;
+  const TCODPATH_ValueType distance = TCODPATH_map_get(focal_data->distance, node->index);
+  return node->f != TCODPATH_focal_heuristic_at_(focal_data, focal_data->heuristic, node->index, distance);
+}
+/// @brief Push `node` into the focal list, ordered by the focal heuristic.
+static inline int TCODPATH_focal_push_focal_(
+    TCODPATH_FocalSearch* __restrict focal_data, const TCODPATH_FocalNode* __restrict node) {
+  TCODPATH_Heuristic* order = focal_data->focal_heuristic ? focal_data->focal_heuristic : focal_data->heuristic;
+  const int priority = TCODPATH_focal_heuristic_at_(focal_data, order, node->index, 0);
+  return TCODPATH_focal_heap_push_(focal_data, &focal_data->focal, priority, node);
+}
+/// @brief Add the node at `index` to the open list using its current distance.
+/// @return 0 on success, negative value on error.
+static inline int TCODPATH_focal_push(
+    TCODPATH_FocalSearch* __restrict focal_data, const TCODPATH_IndexType* __restrict index) {
+  TCODPATH_FocalNode node;
+  for (int i = 0; i < focal_data->dimensions; ++i) node.index[i] = index[i];
+  node.f = TCODPATH_focal_heuristic_at_(
+      focal_data, focal_data->heuristic, index, TCODPATH_map_get(focal_data->distance, index));
+  const int err = TCODPATH_focal_heap_push_(focal_data, &focal_data->open, node.f, &node);
+  if (err < 0) return err;
+  TCODPATH_STATS_ADD(focal_data->stats, pushes, 1);
+  TCODPATH_STATS_MAX(focal_data->stats, peak_frontier, focal_data->open.size);
+  if (node.f <= TCODPATH_focal_threshold_(focal_data)) return TCODPATH_focal_push_focal_(focal_data, &node);
+  return TCODPATH_focal_heap_push_(focal_data, &focal_data->waiting, node.f, &node);
+}
+
+static inline void TCODPATH_focal_set_edge(
+    void* focal_data_,
+    const TCODPATH_IndexType* __restrict root_index,
+    const TCODPATH_IndexType* __restrict leaf_index,
+    TCODPATH_ValueType edge_cost) {
+  TCODPATH_FocalSearch* __restrict focal_data = (TCODPATH_FocalSearch*)focal_data_;
+  const TCODPATH_ValueType distance_at_root = TCODPATH_map_get(focal_data->distance, root_index);
+  const TCODPATH_ValueType distance_at_leaf = TCODPATH_map_get(focal_data->distance, leaf_index);
+  const TCODPATH_ValueType total_distance = distance_at_root + edge_cost;
+  if (distance_at_leaf <= total_distance) return;  // This edge is not better than a previous edge
+  TCODPATH_map_set(focal_data->distance, leaf_index, total_distance);
+  if (focal_data->flow) TCODPATH_map_set_index(focal_data->flow, leaf_index, root_index);
+  TCODPATH_map_set(focal_data->closed, leaf_index, 0);  // Reopen, required to keep `lower_bound` valid
+  TCODPATH_focal_push(focal_data, leaf_index);
+}
+
+/// @brief Setup `focal_data` for a new search. The open list will be empty.
+/// @return 0 on success, negative value on error.
+static inline int TCODPATH_focal_init(
+    TCODPATH_FocalSearch* __restrict focal_data,
+    TCODPATH_Graph* __restrict graph,
+    TCODPATH_Heuristic* __restrict heuristic,
+    TCODPATH_Heuristic* __restrict focal_heuristic,
+    int suboptimality,
+    TCODPATH_Map* __restrict distance,
+    TCODPATH_Map* __restrict flow,
+    TCODPATH_Map* __restrict closed) {
+  if (!focal_data || !graph || !distance || !closed || suboptimality < 100) return TCODPATH_E_INVALID_ARGUMENT;
+  *focal_data = TCODPATH_FocalSearch{};
+  focal_data->dimensions = TCODPATH_map_get_dimensions(distance);
+  focal_data->graph = graph;
+  focal_data->heuristic = heuristic;
+  focal_data->focal_heuristic = focal_heuristic;
+  focal_data->distance = distance;
+  focal_data->flow = flow;
+  focal_data->closed = closed;
+  focal_data->suboptimality = suboptimality;
+  const size_t node_size = offsetof(TCODPATH_FocalNode, index) + focal_data->dimensions * sizeof(TCODPATH_IndexType);
+  int err = TCODPATH_heap_init(&focal_data->open, node_size);
+  if (err >= 0) err = TCODPATH_heap_init(&focal_data->waiting, node_size);
+  if (err >= 0) err = TCODPATH_heap_init(&focal_data->focal, node_size);
+  return err;
+}
+/// @brief Free the lists of `focal_data`.
+static inline void TCODPATH_focal_uninit(TCODPATH_FocalSearch* __restrict focal_data) {
+  if (!focal_data) return;
+  TCODPATH_heap_uninit(&focal_data->open);
+  TCODPATH_heap_uninit(&focal_data->waiting);
+  TCODPATH_heap_uninit(&focal_data->focal);
+}
+
+/// @brief Preform a single iteration of focal search. Return the status.
+/// @return `1` when complete, `0` when incomplete, negative value on error.
+static inline int TCODPATH_focal_step(TCODPATH_FocalSearch* __restrict focal_data) {
+  if (!focal_data) return TCODPATH_E_INVALID_ARGUMENT;
+  TCODPATH_FocalNode node;
+  // Find the lowest `f`, which is a lower bound on the cost to any goal
+  while (TCODPATH_minheap_peek(&focal_data->open, &node) != INT_MAX && TCODPATH_focal_is_stale_(focal_data, &node)) {
+    TCODPATH_minheap_pop(&focal_data->open, NULL);
+    TCODPATH_STATS_ADD(focal_data->stats, stale_pops, 1);  // Each push has one entry in `open`
+  }
+  if (focal_data->open.size <= 0) return 1;  // Iteration complete
+  focal_data->lower_bound = node.f;
+  // Move nodes within the new bound into the focal list
+  const int threshold = TCODPATH_focal_threshold_(focal_data);
+  while (TCODPATH_minheap_peek_priority(&focal_data->waiting) <= threshold) {
+    TCODPATH_minheap_pop(&focal_data->waiting, &node);
+    if (TCODPATH_focal_is_stale_(focal_data, &node)) continue;
+    const int err = TCODPATH_focal_push_focal_(focal_data, &node);
+    if (err < 0) return err;
+  }
+  // Expand the best node within the bound
+  while (true) {
+    if (focal_data->focal.size <= 0) return 0;  // Only stale nodes were left, try again
+    TCODPATH_minheap_pop(&focal_data->focal, &node);
+    if (TCODPATH_focal_is_stale_(focal_data, &node)) continue;
+    if (node.f <= threshold) break;
+    // The bound went down since this node was added, wait for it to go back up
+    const int err = TCODPATH_focal_heap_push_(focal_data, &focal_data->waiting, node.f, &node);
+    if (err < 0) return err;
+  }
+  if (focal_data->has_goal && TCODPATH_indexes_equal(focal_data->dimensions, node.index, focal_data->goal)) return 1;
+  TCODPATH_map_set(focal_data->closed, node.index, 1);
+  TCODPATH_STATS_ADD(focal_data->stats, expansions, 1);
+  TCODPATH_graph_foreach_edge(
+      focal_data->graph, focal_data->dimensions, node.index, TCODPATH_focal_set_edge, focal_data);
+  return 0;  // Iteration continues
+}
+
+/// @brief Focal search (A*ε) from `start` to `goal` with a guaranteed suboptimality bound.
+/// @details Every node with `f` within `suboptimality` percent of the lowest `f` may be expanded. Among those, the
+/// node with the lowest `focal_heuristic` is chosen, which is usually the one closest to the goal. The path found
+/// costs at most `suboptimality / 100` times the optimal cost when `heuristic` is admissible.
+/// `distance` should be cleared with `TCODPATH_map_clear_max` beforehand.
+/// @param graph Graph to traverse.
+/// @param heuristic Admissible heuristic for `goal`.
+/// @param focal_heuristic Optional heuristic used to order the focal list, it does not need to be admissible.
+/// Defaults to `heuristic`.
+/// @param suboptimality Suboptimality bound in percent, at least 100.
+/// @param distance Distance map to write. `start` is set to zero.
+/// @param flow Optional flow map to write, can be `NULL`.
+/// @param closed Map of expanded nodes, must be all zero beforehand.
+/// @param start Start index.
+/// @param goal Goal index.
+/// @param partition Optional connectivity labels, see `TCODPATH_partition_is_reachable`.
+/// @param bound_out Optional output for the achieved suboptimality bound in percent, `100` means optimal.
+/// @return 0 if `goal` was reached, 1 if `goal` is unreachable, negative value on error.
+static inline int TCODPATH_focal_search(
+    TCODPATH_Graph* __restrict graph,
+    TCODPATH_Heuristic* __restrict heuristic,
+    TCODPATH_Heuristic* __restrict focal_heuristic,
+    int suboptimality,
+    TCODPATH_Map* __restrict distance,
+    TCODPATH_Map* __restrict flow,
+    TCODPATH_Map* __restrict closed,
+    const TCODPATH_IndexType* __restrict start,
+    const TCODPATH_IndexType* __restrict goal,
+    const TCODPATH_Map* __restrict partition,
+    int* __restrict bound_out) {
+  if (!start || !goal) return TCODPATH_E_INVALID_ARGUMENT;
+  if (!TCODPATH_partition_is_reachable(partition, start, goal)) return 1;
+  TCODPATH_FocalSearch focal_data;
+  int err = TCODPATH_focal_init(
+      &focal_data, graph, heuristic, focal_heuristic, suboptimality, distance, flow, closed);
+  if (err >= 0) {
+    focal_data.has_goal = true;
+    for (int i = 0; i < focal_data.dimensions; ++i) focal_data.goal[i] = goal[i];
+    TCODPATH_map_set(distance, start, 0);
+    err = TCODPATH_focal_push(&focal_data, start);
+  }
+  while (err >= 0) {
+    err = TCODPATH_focal_step(&focal_data);
+    if (err != 0) break;
+  }
+  if (err >= 0 && bound_out && !TCODPATH_map_is_max(distance, goal)) {
+    const TCODPATH_ValueType cost = TCODPATH_map_get(distance, goal);
+    const TCODPATH_ValueType lower_bound = focal_data.lower_bound;
+    *bound_out = lower_bound > 0 ? (int)(((int64_t)cost * 100 + lower_bound - 1) / lower_bound) : 100;
+    *bound_out = TCODPATH_MIN(*bound_out, suboptimality);
+  }
+  TCODPATH_focal_uninit(&focal_data);
+  if (err < 0) return err;
+  return TCODPATH_map_is_max(distance, goal) ? 1 : 0;
+}
@@ -0,0 +1,32 @@
+#pragma once
+
+#include "graph_types.h"
+#include "heapq_types.h"
+#include "heuristic_types.h"
+#include "map_types.h"
+#include "search_stats_types.h"
+
+/// @brief A frontier entry of focal search, `f` is used to detect stale entries.
+typedef struct TCODPATH_FocalNode {
+  int f;
+  TCODPATH_IndexType index[TCODPATH_MAX_DIMENSIONS];
+} TCODPATH_FocalNode;
+
+/// @brief State for focal search (A*ε).
+typedef struct TCODPATH_FocalSearch {
+  int dimensions;
+  struct TCODPATH_Heap open;  // Every open node ordered by `f`, used to track the lowest `f`
+  struct TCODPATH_Heap waiting;  // Open nodes not yet in `focal`, ordered by `f`
+  struct TCODPATH_Heap focal;  // Open nodes within the bound, ordered by the focal heuristic
+  TCODPATH_Graph* __restrict graph;
+  TCODPATH_Heuristic* __restrict heuristic;  // Admissible heuristic
+  TCODPATH_Heuristic* __restrict focal_heuristic;  // Any estimate of the remaining effort, for ordering `focal`
+  TCODPATH_Map* __restrict distance;
+  TCODPATH_Map* __restrict flow;
+  TCODPATH_Map* __restrict closed;  // Map of expanded nodes, must be all zero before the search
+  int suboptimality;  // Bound in percent, nodes with `f <= lowest_f * suboptimality / 100` are in focal
+  TCODPATH_ValueType lower_bound;  // Lowest `f` of any open node as of the last iteration
+  bool has_goal;  // If true then the search is complete once `goal` is reached
+  TCODPATH_IndexType goal[TCODPATH_MAX_DIMENSIONS];
+  TCODPATH_SearchStats* __restrict stats;  // Optional counters updated by each step
+} TCODPATH_FocalSearch;
@@ -0,0 +1,237 @@
+#pragma once
+
+#include "allocator.h"
+#include "error.h"
+#include "fringe_search_types.h"
+#include "graph_tools.h"
+#include "heuristic_tools.h"
+#include "indexes.h"
+#include "map_tools.h"
+#include "partition.h"
+#include "search_stats.h"
+
+/// @brief Return the linear id of `index`.
+/// Used internally.
+static inline TCODPATH_LinearIdType TCODPATH_fringe_id_(
+    const TCODPATH_FringeSearch* __restrict fringe, const TCODPATH_IndexType* __restrict index) {
+  ptrdiff_t id = 0;
+  for (int i = 0; i < fringe->dimensions; ++i) id += index[i] * fringe->strides[i];
+  return (TCODPATH_LinearIdType)id;
+}
+/// @brief Convert the linear `id` back into `index_out`.
+/// Used internally.
+static inline void TCODPATH_fringe_index_(
+    const TCODPATH_FringeSearch* __restrict fringe,
+    TCODPATH_LinearIdType id,
+    TCODPATH_IndexType* __restrict index_out) {
+  ptrdiff_t remainder = id;
+  for (int i = 0; i < fringe->dimensions; ++i) {
+    index_out[i] = (TCODPATH_IndexType)(remainder / fringe->strides[i]);
+    remainder %= fringe->strides[i];
+  }
+}
+/// @brief Return the id of the head of the fringe list.
+/// Used internally.
+static inline TCODPATH_LinearIdType TCODPATH_fringe_head_(const TCODPATH_FringeSearch* __restrict fringe) {
+  return (TCODPATH_LinearIdType)fringe->node_count;
+}
+/// @brief Insert the listed-out node `id` after `after` in the fringe.
+/// Used internally.
+static inline void TCODPATH_fringe_link_(
+    TCODPATH_FringeSearch* __restrict fringe, TCODPATH_LinearIdType after, TCODPATH_LinearIdType id) {
+  TCODPATH_FringeNode* __restrict nodes = fringe->nodes;
+  const TCODPATH_LinearIdType before = nodes[after].next - 1;
+  nodes[id].prev = after + 1;
+  nodes[id].next = before + 1;
+  nodes[after].next = id + 1;
+  nodes[before].prev = id + 1;
+}
+/// @brief Remove the listed node `id` from the fringe.
+/// Used internally.
+static inline void TCODPATH_fringe_unlink_(TCODPATH_FringeSearch* __restrict fringe, TCODPATH_LinearIdType id) {
+  TCODPATH_FringeNode* __restrict nodes = fringe->nodes;
+  nodes[nodes[id].prev - 1].next = nodes[id].next;
+  nodes[nodes[id].next - 1].prev = nodes[id].prev;
+  nodes[id].prev = -1;
+}
+/// @brief Fill the cache of a node reached for the first time, taking its distance from the distance map.
+/// Used internally.
+static inline void TCODPATH_fringe_reach_(
+    TCODPATH_FringeSearch* __restrict fringe, TCODPATH_LinearIdType id, const TCODPATH_IndexType* __restrict index) {
+  TCODPATH_FringeNode* __restrict node = &fringe->nodes[id];
+  node->prev = -1;
+  node->g = TCODPATH_map_get(fringe->distance, index);
+  if (fringe->heuristic) TCODPATH_STATS_ADD(fringe->stats, heuristic_calls, 1);
+  node->h = TCODPATH_heuristic_at(fringe->heuristic, fringe->dimensions, index, 0);
+}
+static inline void TCODPATH_fringe_set_edge(
+    void* fringe_,
+    const TCODPATH_IndexType* __restrict root_index,
+    const TCODPATH_IndexType* __restrict leaf_index,
+    TCODPATH_ValueType edge_cost) {
+  TCODPATH_FringeSearch* __restrict fringe = (TCODPATH_FringeSearch*)fringe_;
+  const TCODPATH_LinearIdType leaf = TCODPATH_fringe_id_(fringe, leaf_index);
+  TCODPATH_FringeNode* __restrict node = &fringe->nodes[leaf];
+  if (node->prev == 0) TCODPATH_fringe_reach_(fringe, leaf, leaf_index);
+  const TCODPATH_ValueType total_distance = fringe->nodes[fringe->current].g + edge_cost;
+  if (node->g <= total_distance) return;  // This edge is not better than a previous edge
+  if (node->prev > 0) TCODPATH_fringe_unlink_(fringe, leaf);
+  node->g = total_distance;
+  TCODPATH_map_set(fringe->distance, leaf_index, total_distance);
+  if (fringe->flow) TCODPATH_map_set_index(fringe->flow, leaf_index, root_index);
+  TCODPATH_fringe_link_(fringe, fringe->current, leaf);  // Visited next, within the same pass
+  TCODPATH_STATS_ADD(fringe->stats, pushes, 1);
+}
+
+/// @brief Allocate the node cache of `fringe` on its first push.
+/// Used internally.
+static inline int TCODPATH_fringe_alloc_(TCODPATH_FringeSearch* __restrict fringe) {
+  fringe->nodes =
+      (TCODPATH_FringeNode*)TCODPATH_calloc_(fringe->allocator, fringe->node_count + 1, sizeof(*fringe->nodes));
+  if (!fringe->nodes) return TCODPATH_E_OUT_OF_MEMORY;
+  TCODPATH_STATS_ADD(fringe->stats, bytes_allocated, (int64_t)sizeof(*fringe->nodes) * (fringe->node_count + 1));
+  const TCODPATH_LinearIdType head = TCODPATH_fringe_head_(fringe);
+  fringe->nodes[head].prev = fringe->nodes[head].next = head + 1;
+  return TCODPATH_E_OK;
+}
+
+/// @brief Free the node cache of `fringe`.
+static inline void TCODPATH_fringe_uninit(TCODPATH_FringeSearch* __restrict fringe) {
+  if (!fringe || !fringe->nodes) return;
+  TCODPATH_free_(fringe->allocator, fringe->nodes, sizeof(*fringe->nodes) * (fringe->node_count + 1));
+  fringe->nodes = NULL;
+}
+/// @brief Setup `fringe` for a new search. The fringe will be empty.
+/// @details The node cache is allocated zeroed by the first push and only the nodes which are reached are touched.
+/// @param fringe Output, must be freed with `TCODPATH_fringe_uninit`.
+/// @param graph Graph to traverse.
+/// @param heuristic Optional heuristic, can be `NULL` for a Dijkstra search.
+/// It is evaluated once per node at a distance of zero, so it must return `distance` plus an estimate.
+/// @param distance Distance map to write, its shape decides the linear ids.
+/// @param flow Optional flow map to write, can be `NULL`.
+/// @return 0 on success, negative value on error.
+static inline int TCODPATH_fringe_init(
+    TCODPATH_FringeSearch* __restrict fringe,
+    TCODPATH_Graph* __restrict graph,
+    TCODPATH_Heuristic* __restrict heuristic,
+    TCODPATH_Map* __restrict distance,
+    TCODPATH_Map* __restrict flow) {
+  if (!fringe || !graph || !distance) return TCODPATH_E_INVALID_ARGUMENT;
+  *fringe = TCODPATH_FringeSearch{};
+  fringe->dimensions = TCODPATH_map_get_dimensions(distance);
+  const TCODPATH_IndexType* shape = TCODPATH_map_get_shape(distance);
+  if (fringe->dimensions <= 0 || !shape) return TCODPATH_E_INVALID_ARGUMENT;
+  fringe->graph = graph;
+  fringe->heuristic = heuristic;
+  fringe->distance = distance;
+  fringe->flow = flow;
+  ptrdiff_t stride = 1;
+  for (int i = fringe->dimensions - 1; i >= 0; --i) {
+    fringe->shape[i] = shape[i];
+    fringe->strides[i] = stride;
+    stride *= shape[i];
+  }
+  fringe->node_count = stride;
+  if (fringe->node_count >= TCODPATH_LINEAR_ID_MAX) return TCODPATH_E_INVALID_ARGUMENT;  // Too many nodes for the ids
+  fringe->threshold = TCODPATH_VALUE_MIN;
+  fringe->next_threshold = TCODPATH_VALUE_MAX;
+  fringe->cursor = TCODPATH_fringe_head_(fringe);
+  return TCODPATH_E_OK;
+}
+/// @brief Add `index` to the end of the fringe using its current distance.
+/// @return 0 on success, negative value on error.
+static inline int TCODPATH_fringe_push(TCODPATH_FringeSearch* __restrict fringe, const TCODPATH_IndexType* index) {
+  if (!fringe || !index) return TCODPATH_E_INVALID_ARGUMENT;
+  if (!fringe->nodes) {
+    const int err = TCODPATH_fringe_alloc_(fringe);
+    if (err < 0) return err;
+  }
+  const TCODPATH_LinearIdType id = TCODPATH_fringe_id_(fringe, index);
+  TCODPATH_FringeNode* __restrict node = &fringe->nodes[id];
+  if (node->prev == 0) TCODPATH_fringe_reach_(fringe, id, index);
+  node->g = TCODPATH_map_get(fringe->distance, index);
+  if (node->prev > 0) return TCODPATH_E_OK;  // Already in the fringe
+  const TCODPATH_LinearIdType head = TCODPATH_fringe_head_(fringe);
+  TCODPATH_fringe_link_(fringe, fringe->nodes[head].prev - 1, id);
+  fringe->next_threshold = TCODPATH_MIN(fringe->next_threshold, node->g + node->h);
+  TCODPATH_STATS_ADD(fringe->stats, pushes, 1);
+  return TCODPATH_E_OK;
+}
+/// @brief Set the goal of `fringe`. The search will be complete once `goal` is reached.
+static inline void TCODPATH_fringe_set_goal(
+    TCODPATH_FringeSearch* __restrict fringe, const TCODPATH_IndexType* __restrict goal) {
+  fringe->has_goal = goal != NULL;
+  if (!goal) return;
+  for (int i = 0; i < fringe->dimensions; ++i) fringe->goal[i] = goal[i];
+}
+/// @brief Run fringe search until one node is expanded. Return the status.
+/// @details Nodes above the threshold are passed over without counting as a step.
+/// @return `1` when complete, `0` when incomplete, negative value on error.
+static inline int TCODPATH_fringe_step(TCODPATH_FringeSearch* __restrict fringe) {
+  if (!fringe) return TCODPATH_E_INVALID_ARGUMENT;
+  if (!fringe->nodes) return 1;  // Nothing was pushed
+  TCODPATH_FringeNode* __restrict nodes = fringe->nodes;
+  const TCODPATH_LinearIdType head = TCODPATH_fringe_head_(fringe);
+  while (true) {
+    if (nodes[head].next - 1 == head) return 1;  // Iteration complete
+    if (fringe->cursor == head) {
+      // Start the next pass from the lowest `f` left over by the last one
+      fringe->threshold = fringe->next_threshold;
+      fringe->next_threshold = TCODPATH_VALUE_MAX;
+      fringe->cursor = nodes[head].next - 1;
+    }
+    const TCODPATH_LinearIdType id = fringe->cursor;
+    const TCODPATH_ValueType f = nodes[id].g + nodes[id].h;
+    if (f > fringe->threshold) {
+      fringe->next_threshold = TCODPATH_MIN(fringe->next_threshold, f);
+      fringe->cursor = nodes[id].next - 1;
+      continue;
+    }
+    TCODPATH_IndexType index[TCODPATH_MAX_DIMENSIONS];
+    TCODPATH_fringe_index_(fringe, id, index);
+    if (fringe->has_goal && TCODPATH_indexes_equal(fringe->dimensions, index, fringe->goal)) return 1;
+    TCODPATH_STATS_ADD(fringe->stats, expansions, 1);
+    fringe->current = id;
+    TCODPATH_graph_foreach_edge(fringe->graph, fringe->dimensions, index, TCODPATH_fringe_set_edge, fringe);
+    fringe->cursor = nodes[id].next - 1;  // The first child, if any were added
+    TCODPATH_fringe_unlink_(fringe, id);
+    return 0;  // Iteration continues
+  }
+}
+/// @brief Fringe search from `start` until `goal` is reached, using `heuristic` to guide the search.
+/// @details Finds the same path costs as `TCODPATH_astar` without a priority queue. It tends to be faster on grids
+/// where many nodes share the same `f`, since a pass over the fringe is cheaper than keeping a heap sorted.
+/// `distance` should be cleared with `TCODPATH_map_clear_max` beforehand.
+/// @param graph Graph to traverse.
+/// @param heuristic Optional heuristic, can be `NULL` for a Dijkstra search.
+/// It must return `distance` plus an estimate which does not depend on `distance`, as the built-in ones do.
+/// @param distance Distance map to write. `start` is set to zero.
+/// @param flow Optional flow map to write, can be `NULL`.
+/// @param start Start index.
+/// @param goal Goal index.
+/// @param partition Optional connectivity labels, see `TCODPATH_partition_is_reachable`.
+/// @return 0 if `goal` was reached, 1 if `goal` is unreachable, negative value on error.
+static inline int TCODPATH_fringe_search(
+    TCODPATH_Graph* __restrict graph,
+    TCODPATH_Heuristic* __restrict heuristic,
+    TCODPATH_Map* __restrict distance,
+    TCODPATH_Map* __restrict flow,
+    const TCODPATH_IndexType* __restrict start,
+    const TCODPATH_IndexType* __restrict goal,
+    const TCODPATH_Map* __restrict partition) {
+  if (!start || !goal) return TCODPATH_E_INVALID_ARGUMENT;
+  if (!TCODPATH_partition_is_reachable(partition, start, goal)) return 1;
+  TCODPATH_FringeSearch fringe;
+  int err = TCODPATH_fringe_init(&fringe, graph, heuristic, distance, flow);
+  if (err < 0) return err;
+  TCODPATH_fringe_set_goal(&fringe, goal);
+  TCODPATH_map_set(distance, start, 0);
+  err = TCODPATH_fringe_push(&fringe, start);
+  while (err >= 0) {
+    err = TCODPATH_fringe_step(&fringe);
+    if (err != 0) break;
+  }
+  TCODPATH_fringe_uninit(&fringe);
+  if (err < 0) return err;
+  return TCODPATH_map_is_max(distance, goal) ? 1 : 0;
+}
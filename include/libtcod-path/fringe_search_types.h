@@ -0,0 +1,42 @@
+#pragma once
+
+#include <stddef.h>
+
+#include "allocator_types.h"
+#include "config.h"
+#include "graph_types.h"
+#include "heuristic_types.h"
+#include "map_types.h"
+#include "search_stats_types.h"
+
+/// @brief Cached state of one node of fringe search. A zeroed node has never been reached.
+typedef struct TCODPATH_FringeNode {
+  TCODPATH_LinearIdType prev;  // Previous node in the fringe plus one, 0 if never reached, -1 if not in the fringe
+  TCODPATH_LinearIdType next;  // Next node in the fringe plus one
+  TCODPATH_ValueType g;  // Distance of this node, the same as the distance map
+  TCODPATH_ValueType h;  // Heuristic of this node, computed once when it is first reached
+} TCODPATH_FringeNode;
+
+/// @brief State for fringe search, a heap-free alternative to A*.
+/// @details The fringe is a linked list over linear node ids. Each pass walks the whole list, expanding the nodes
+/// with `f` within the threshold and raising the threshold to the lowest `f` left over for the next pass.
+/// Children are inserted right after the node which reached them, so they are visited within the same pass.
+typedef struct TCODPATH_FringeSearch {
+  int dimensions;
+  TCODPATH_Graph* __restrict graph;
+  TCODPATH_Heuristic* __restrict heuristic;  // Must be of the form `distance + h(index)`, as the built-in ones are
+  TCODPATH_Map* __restrict distance;
+  TCODPATH_Map* __restrict flow;
+  TCODPATH_IndexType shape[TCODPATH_MAX_DIMENSIONS];  // Shape of `distance`
+  ptrdiff_t strides[TCODPATH_MAX_DIMENSIONS];  // Row-major strides of the linear ids
+  ptrdiff_t node_count;
+  TCODPATH_FringeNode* __restrict nodes;  // `node_count + 1` nodes, the last one is the head of the fringe
+  TCODPATH_ValueType threshold;  // Highest `f` expanded by the current pass
+  TCODPATH_ValueType next_threshold;  // Lowest `f` above `threshold` seen so far, the threshold of the next pass
+  TCODPATH_LinearIdType cursor;  // Next node visited by the current pass, the head once the pass is over
+  TCODPATH_LinearIdType current;  // Node being expanded
+  bool has_goal;  // If true then the search is complete once `goal` is reached
+  TCODPATH_IndexType goal[TCODPATH_MAX_DIMENSIONS];
+  TCODPATH_SearchStats* __restrict stats;  // Optional counters updated by each step
+  TCODPATH_Allocator* allocator;  // Allocator of `nodes`, NULL for the global one. Set while `nodes` is NULL.
+} TCODPATH_FringeSearch;
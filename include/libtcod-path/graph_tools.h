@@ -1,8 +1,126 @@
 #pragma once
 
+#include "error.h"
 #include "graph_types.h"
 #include "map_tools.h"
 
+/// @brief Fill `edges_out` with an N-dimensional neighborhood stencil for `TCODPATH_GraphStatic`.
+/// @details Every offset in `{-1, 0, 1}^dimensions` which moves along at least 1 and at most `max_axes` axes is
+/// included. In 3D a `max_axes` of 1, 2, or 3 gives the 6, 18, or 26 neighborhoods.
+/// @param dimensions Number of axes of the stencil.
+/// @param max_axes Maximum number of axes changed by a single edge.
+/// @param axis_costs Cost multipliers indexed by the number of changed axes minus one, an array of `max_axes`.
+/// Edges with a multiplier of zero are skipped.
+/// @param edges_out Output array, can be `NULL` to only count the edges.
+/// Must have room for `3^dimensions - 1` edges of `dimensions + 1` ints.
+/// @return The number of edges, or a negative value on error.
+static inline int TCODPATH_graph_stencil_fill(
+    int dimensions, int max_axes, const TCODPATH_ValueType* __restrict axis_costs, int* __restrict edges_out) {
+  if (dimensions <= 0 || dimensions > TCODPATH_MAX_DIMENSIONS || max_axes <= 0 || !axis_costs) {
+    return TCODPATH_E_INVALID_ARGUMENT;
+  }
+  int edge_count = 0;
+  int offset[TCODPATH_MAX_DIMENSIONS];
+  for (int i = 0; i < dimensions; ++i) offset[i] = -1;
+  while (true) {
+    int axes = 0;
+    for (int i = 0; i < dimensions; ++i) axes += offset[i] != 0;
+    if (axes > 0 && axes <= max_axes && axis_costs[axes - 1] > 0) {
+      if (edges_out) {
+        int* edge = edges_out + edge_count * (dimensions + 1);
+        for (int i = 0; i < dimensions; ++i) edge[i] = offset[i];
+        edge[dimensions] = axis_costs[axes - 1];
+      }
+      ++edge_count;
+    }
+    int axis = dimensions - 1;  // Increment the offset like an odometer
+    for (; axis >= 0 && offset[axis] == 1; --axis) offset[axis] = -1;
+    if (axis < 0) break;
+    ++offset[axis];
+  }
+  return edge_count;
+}
+/// @brief Precompute the byte offset of every edge of a static `graph`, so that traversal reads costs directly.
+/// @details Nodes at least the stencil radius away from every border then have their edges read without any bounds
+/// checks. Static graphs without offsets are traversed at the speed of `TCODPATH_map_get`.
+/// @param graph A `TCODPATH_GRAPH_STATIC` graph with a contiguous or strided cost map.
+/// @param offsets_out Array of `edge_count` offsets. Must outlive the use of `graph`.
+/// @return 0 on success, negative value on error.
+static inline int TCODPATH_graph_static_init_offsets(TCODPATH_Graph* __restrict graph, ptrdiff_t* offsets_out) {
+  if (!graph || graph->type != TCODPATH_GRAPH_STATIC || !offsets_out) return TCODPATH_E_INVALID_ARGUMENT;
+  struct TCODPATH_GraphStatic* static_edges = &graph->static_edges;
+  const int map_dimensions = TCODPATH_map_get_dimensions(static_edges->map);
+  const int first_axis = map_dimensions - static_edges->dimensions;
+  if (first_axis < 0) return TCODPATH_E_INVALID_ARGUMENT;
+  ptrdiff_t strides[TCODPATH_MAX_DIMENSIONS];
+  const int err = TCODPATH_map_get_byte_strides(static_edges->map, strides);
+  if (err < 0) return err;
+  int radius = 0;
+  for (int edge = 0; edge < static_edges->edge_count; ++edge) {
+    const int* offset = static_edges->edges + edge * (static_edges->dimensions + 1);
+    offsets_out[edge] = 0;
+    for (int i = 0; i < static_edges->dimensions; ++i) {
+      offsets_out[edge] += strides[first_axis + i] * offset[i];
+      radius = TCODPATH_MAX(radius, TCODPATH_ABS(offset[i]));
+    }
+  }
+  static_edges->offsets = offsets_out;
+  static_edges->radius = radius;
+  return TCODPATH_E_OK;
+}
+/// @brief Return true if every edge of `static_edges` from or into `index` stays within its map.
+/// Used internally.
+static inline bool TCODPATH_graph_static_is_interior_(
+    const struct TCODPATH_GraphStatic* __restrict static_edges,
+    int first_axis,
+    const TCODPATH_IndexType* __restrict index) {
+  const TCODPATH_IndexType* shape = TCODPATH_map_get_shape(static_edges->map);
+  if (!shape) return false;
+  for (int i = first_axis; i < first_axis + static_edges->dimensions; ++i) {
+    if (index[i] < static_edges->radius || index[i] >= shape[i] - static_edges->radius) return false;
+  }
+  return true;
+}
+/// @brief Return true if the maps of `graph` can be read from multiple threads at once.
+/// @details Searches only read from the graph, so separate searches on a thread-safe graph can run in parallel.
+/// @param graph Pointer to a graph. Can be NULL.
+static inline bool TCODPATH_graph_is_thread_safe(const TCODPATH_Graph* __restrict graph) {
+  if (!graph) return true;
+  switch (graph->type) {
+    case TCODPATH_GRAPH_BASIC2D:
+      return TCODPATH_map_is_thread_safe(graph->basic2d.map) && TCODPATH_map_is_thread_safe(graph->basic2d.clearance);
+    case TCODPATH_GRAPH_STATIC:
+      return TCODPATH_map_is_thread_safe(graph->static_edges.map);
+    default:
+      return true;
+  }
+}
+
+/// @brief Return true if the agent of a basic 2D `graph` fits at `index`.
+/// Used internally.
+static inline bool TCODPATH_graph_basic2d_fits_(
+    const struct TCODPATH_GraphBasic2D* __restrict basic2d, const TCODPATH_IndexType* __restrict index) {
+  if (basic2d->agent_size <= 1 || !basic2d->clearance) return true;
+  return TCODPATH_map_get(basic2d->clearance, index) >= basic2d->agent_size;
+}
+/// @brief Return true if the diagonal move between `index` and its `y, x` neighbor does not cut a corner.
+/// The two nodes beside a diagonal move are the same in both directions, so this works for reverse edges too.
+/// Used internally.
+static inline bool TCODPATH_graph_basic2d_corner_ok_(
+    const struct TCODPATH_GraphBasic2D* __restrict basic2d,
+    int n,
+    const TCODPATH_IndexType* __restrict index,
+    TCODPATH_IndexType y,
+    TCODPATH_IndexType x) {
+  if (!basic2d->no_corner_cutting || x == 0 || y == 0) return true;
+  TCODPATH_IndexType side[TCODPATH_MAX_DIMENSIONS];
+  for (int i = 0; i < n; ++i) side[i] = index[i];
+  side[n - 2] += y;
+  if (TCODPATH_map_get(basic2d->map, side) <= 0) return false;
+  side[n - 2] = index[n - 2];
+  side[n - 1] += x;
+  return TCODPATH_map_get(basic2d->map, side) > 0;
+}
 /// @brief Call `callback` for each edge on `graph` from the node at `index`.
 /// @param graph The graph to traverse. Must not be `NULL`.
 /// @param n Length of `index`.
@@ -18,6 +136,7 @@ static inline void TCODPATH_graph_foreach_edge(
   switch (graph->type) {
     case TCODPATH_GRAPH_BASIC2D: {
       if (TCODPATH_map_get(graph->basic2d.map, index) <= 0) return;  // Can not move from here (this test might be slow)
+      if (!TCODPATH_graph_basic2d_fits_(&graph->basic2d, index)) return;
       TCODPATH_IndexType leaf_index[TCODPATH_MAX_DIMENSIONS];
       for (int i = 0; i < n; ++i) leaf_index[i] = index[i];  // Copy whole index, required for 3D+ graphs
       for (TCODPATH_ValueType y = -1; y <= 1; ++y) {  // Iterate over 3x3 grid surrounding index
@@ -29,12 +148,148 @@ static inline void TCODPATH_graph_foreach_edge(
           if (base_cost <= 0) continue;
           const TCODPATH_ValueType edge_cost = base_cost * TCODPATH_map_get(graph->basic2d.map, leaf_index);
           if (edge_cost <= 0) continue;
+          if (!TCODPATH_graph_basic2d_fits_(&graph->basic2d, leaf_index)) continue;
+          if (!TCODPATH_graph_basic2d_corner_ok_(&graph->basic2d, n, index, y, x)) continue;
           callback(userdata, index, leaf_index, edge_cost);
         }
       }
     } break;
-    case TCODPATH_GRAPH_STATIC:
+    case TCODPATH_GRAPH_STATIC: {
+      const struct TCODPATH_GraphStatic* static_edges = &graph->static_edges;
+      const int first_axis = n - static_edges->dimensions;
+      if (first_axis < 0) return;
+      const unsigned char* root_at = NULL;
+      if (static_edges->offsets) {
+        root_at = (const unsigned char*)TCODPATH_map_at(static_edges->map, index);
+        if (!root_at) return;
+        if (TCODPATH_map_value_at_(static_edges->map->strides.int_type, root_at) <= 0) return;
+      } else if (TCODPATH_map_get(static_edges->map, index) <= 0) {
+        return;  // Can not move from here
+      }
+      const TCODPATH_IndexType* shape = TCODPATH_map_get_shape(static_edges->map);
+      TCODPATH_IndexType leaf_index[TCODPATH_MAX_DIMENSIONS];
+      for (int i = 0; i < n; ++i) leaf_index[i] = index[i];
+      const int* edge = static_edges->edges;
+      if (root_at && TCODPATH_graph_static_is_interior_(static_edges, first_axis, index)) {  // No bounds checks
+        const int8_t int_type = static_edges->map->strides.int_type;
+        for (int k = 0; k < static_edges->edge_count; ++k, edge += static_edges->dimensions + 1) {
+          const TCODPATH_ValueType base_cost = edge[static_edges->dimensions];
+          if (base_cost <= 0) continue;
+          const TCODPATH_ValueType edge_cost =
+              base_cost * TCODPATH_map_value_at_(int_type, root_at + static_edges->offsets[k]);
+          if (edge_cost <= 0) continue;
+          for (int i = 0; i < static_edges->dimensions; ++i) {
+            leaf_index[first_axis + i] = index[first_axis + i] + edge[i];
+          }
+          callback(userdata, index, leaf_index, edge_cost);
+        }
+        return;
+      }
+      for (int k = 0; k < static_edges->edge_count; ++k, edge += static_edges->dimensions + 1) {
+        const TCODPATH_ValueType base_cost = edge[static_edges->dimensions];
+        if (base_cost <= 0) continue;
+        bool in_bounds = true;
+        for (int i = 0; i < static_edges->dimensions; ++i) {
+          const TCODPATH_IndexType leaf = leaf_index[first_axis + i] = index[first_axis + i] + edge[i];
+          if (shape && (leaf < 0 || leaf >= shape[first_axis + i])) in_bounds = false;
+        }
+        if (!in_bounds) continue;
+        const TCODPATH_ValueType leaf_cost =
+            root_at ? TCODPATH_map_value_at_(static_edges->map->strides.int_type, root_at + static_edges->offsets[k])
+                    : TCODPATH_map_get(static_edges->map, leaf_index);
+        const TCODPATH_ValueType edge_cost = base_cost * leaf_cost;
+        if (edge_cost <= 0) continue;
+        callback(userdata, index, leaf_index, edge_cost);
+      }
+    } break;
+    default:
       break;
+  }
+}
+/// @brief Call `callback` for each edge on `graph` which leads into the node at `index`.
+/// The callback is given the same `root_index`, `leaf_index`, and `edge_cost` as `TCODPATH_graph_foreach_edge` would
+/// give when traversing from `root_index`, but `leaf_index` is always `index`.
+/// @param graph The graph to traverse. Must not be `NULL`.
+/// @param n Length of `index`.
+/// @param index Node to traverse into. Must not be `NULL`.
+/// @param callback Function to call for each edge.
+/// @param userdata Custom pointer passed to `callback`.
+static inline void TCODPATH_graph_foreach_reverse_edge(
+    TCODPATH_Graph* __restrict graph,
+    int n,
+    const TCODPATH_IndexType* __restrict index,
+    TCODPATH_GraphCallback callback,
+    void* userdata) {
+  switch (graph->type) {
+    case TCODPATH_GRAPH_BASIC2D: {
+      const TCODPATH_ValueType leaf_cost = TCODPATH_map_get(graph->basic2d.map, index);
+      if (leaf_cost <= 0) return;  // Can not move into here
+      if (!TCODPATH_graph_basic2d_fits_(&graph->basic2d, index)) return;
+      TCODPATH_IndexType root_index[TCODPATH_MAX_DIMENSIONS];
+      for (int i = 0; i < n; ++i) root_index[i] = index[i];
+      for (TCODPATH_ValueType y = -1; y <= 1; ++y) {
+        for (TCODPATH_ValueType x = -1; x <= 1; ++x) {
+          if (x == 0 && y == 0) continue;
+          root_index[n - 2] = index[n - 2] + y;
+          root_index[n - 1] = index[n - 1] + x;
+          const TCODPATH_ValueType base_cost = (x != 0 && y != 0) ? graph->basic2d.diagonal : graph->basic2d.cardinal;
+          if (base_cost <= 0) continue;
+          const TCODPATH_ValueType edge_cost = base_cost * leaf_cost;
+          if (edge_cost <= 0) continue;
+          if (TCODPATH_map_get(graph->basic2d.map, root_index) <= 0) continue;  // Can not move from root
+          if (!TCODPATH_graph_basic2d_fits_(&graph->basic2d, root_index)) continue;
+          if (!TCODPATH_graph_basic2d_corner_ok_(&graph->basic2d, n, index, y, x)) continue;
+          callback(userdata, root_index, index, edge_cost);
+        }
+      }
+    } break;
+    case TCODPATH_GRAPH_STATIC: {
+      const struct TCODPATH_GraphStatic* static_edges = &graph->static_edges;
+      const int first_axis = n - static_edges->dimensions;
+      if (first_axis < 0) return;
+      const unsigned char* leaf_at = NULL;
+      TCODPATH_ValueType leaf_cost;
+      if (static_edges->offsets) {
+        leaf_at = (const unsigned char*)TCODPATH_map_at(static_edges->map, index);
+        if (!leaf_at) return;
+        leaf_cost = TCODPATH_map_value_at_(static_edges->map->strides.int_type, leaf_at);
+      } else {
+        leaf_cost = TCODPATH_map_get(static_edges->map, index);
+      }
+      if (leaf_cost <= 0) return;  // Can not move into here
+      const TCODPATH_IndexType* shape = TCODPATH_map_get_shape(static_edges->map);
+      TCODPATH_IndexType root_index[TCODPATH_MAX_DIMENSIONS];
+      for (int i = 0; i < n; ++i) root_index[i] = index[i];
+      const int* edge = static_edges->edges;
+      if (leaf_at && TCODPATH_graph_static_is_interior_(static_edges, first_axis, index)) {  // No bounds checks
+        const int8_t int_type = static_edges->map->strides.int_type;
+        for (int k = 0; k < static_edges->edge_count; ++k, edge += static_edges->dimensions + 1) {
+          const TCODPATH_ValueType edge_cost = edge[static_edges->dimensions] * leaf_cost;
+          if (edge_cost <= 0) continue;
+          if (TCODPATH_map_value_at_(int_type, leaf_at - static_edges->offsets[k]) <= 0) continue;  // Root is a wall
+          for (int i = 0; i < static_edges->dimensions; ++i) {
+            root_index[first_axis + i] = index[first_axis + i] - edge[i];
+          }
+          callback(userdata, root_index, index, edge_cost);
+        }
+        return;
+      }
+      for (int k = 0; k < static_edges->edge_count; ++k, edge += static_edges->dimensions + 1) {
+        const TCODPATH_ValueType edge_cost = edge[static_edges->dimensions] * leaf_cost;
+        if (edge_cost <= 0) continue;
+        bool in_bounds = true;
+        for (int i = 0; i < static_edges->dimensions; ++i) {
+          const TCODPATH_IndexType root = root_index[first_axis + i] = index[first_axis + i] - edge[i];
+          if (shape && (root < 0 || root >= shape[first_axis + i])) in_bounds = false;
+        }
+        if (!in_bounds) continue;
+        const TCODPATH_ValueType root_cost =
+            leaf_at ? TCODPATH_map_value_at_(static_edges->map->strides.int_type, leaf_at - static_edges->offsets[k])
+                    : TCODPATH_map_get(static_edges->map, root_index);
+        if (root_cost <= 0) continue;  // Can not move from root
+        callback(userdata, root_index, index, edge_cost);
+      }
+    } break;
     default:
       break;
   }
@@ -23,9 +23,14 @@ struct TCODPATH_GraphBasic2D {
   TCODPATH_Map* __restrict map;  // Pointer to map costs
   TCODPATH_ValueType cardinal;  // Multiplier for cardinal costs, or 0 to disable cardinal movement
   TCODPATH_ValueType diagonal;  // Multiplier for diagonal costs, or 0 to disable diagonal movement
+  const TCODPATH_Map* __restrict clearance;  // Optional map from `TCODPATH_clearance_generate`, see `agent_size`
+  TCODPATH_ValueType agent_size;  // Side of the square agent anchored at its top-left, 1 or less ignores clearance
+  bool no_corner_cutting;  // If true then diagonal moves need both cardinal nodes beside them to be passable
 };
 
 /// @brief A custom edge array for a map with weighted costs.
+/// @details Each edge is an offset over the last `dimensions` axes of `map` followed by a cost multiplier, so this
+/// works as an N-dimensional neighborhood stencil. See `TCODPATH_graph_stencil_fill` for the common stencils.
 struct TCODPATH_GraphStatic {
   int type;  // Must be TCODPATH_GRAPH_STATIC
   TCODPATH_Map* __restrict map;  // Pointer to map costs
@@ -33,6 +38,10 @@ struct TCODPATH_GraphStatic {
   int edge_count;
   /// An array of graph edges, must be a contiguous array of ``edges[edge_count * (dimensions + 1)]``
   int* __restrict edges;
+  /// Optional byte offset of each edge in `map`, set by `TCODPATH_graph_static_init_offsets`.
+  /// Without them every edge is read through `TCODPATH_map_get` with its bounds checked.
+  ptrdiff_t* __restrict offsets;
+  int radius;  // Largest offset of any edge on any axis, set with `offsets`
 };
 
 /// @brief Generic graph tagged union.
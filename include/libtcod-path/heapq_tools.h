@@ -1,8 +1,11 @@
+#pragma once
 
 #include <assert.h>
+#include <limits.h>
 #include <stdlib.h>
 #include <string.h>
 
+#include "allocator.h"
 #include "error.h"
 #include "heapq_types.h"
 
@@ -17,7 +20,7 @@
     @param heap A pointer to a TCODPATH_Heap struct, the struct itself is not freed.
  */
 static inline void TCODPATH_heap_uninit(struct TCODPATH_Heap* heap) {
-  if (heap->heap) free(heap->heap);
+  TCODPATH_free_(heap->allocator, heap->heap, heap->capacity * heap->node_size);
   heap->heap = NULL;
   heap->size = 0;
   heap->capacity = 0;
@@ -44,6 +47,7 @@ static inline int TCODPATH_heap_init(struct TCODPATH_Heap* heap, size_t data_siz
   heap->data_size = data_size;
   heap->data_offset = sizeof(int);
   heap->priority_type = -4;  // Signed int type.
+  heap->allocator = NULL;
   return 0;
 }
 /***************************************************************************
@@ -124,6 +128,29 @@ static void TCODPATH_minheap_heapify_up_(struct TCODPATH_Heap* minheap, int inde
 static inline void TCODPATH_minheap_heapify(struct TCODPATH_Heap* minheap) {
   for (int i = minheap->size / 2; i >= 0; --i) TCODPATH_minheap_heapify_down_(minheap, i);
 }
+/***************************************************************************
+    @brief Return the priority of the smallest element without removing it.
+
+    @param minheap A TCODPATH_Heap pointer.
+    @return The smallest priority, or INT_MAX if the heap is empty.
+ */
+static inline int TCODPATH_minheap_peek_priority(const struct TCODPATH_Heap* minheap) {
+  assert(minheap->priority_type == -4);
+  if (minheap->size == 0) return INT_MAX;
+  return *(const int*)minheap->heap;
+}
+/***************************************************************************
+    @brief Copy the data of the smallest element without removing it.
+
+    @param minheap A TCODPATH_Heap pointer.
+    @param out A pointer to store the data of the smallest element.
+    @return The smallest priority, or INT_MAX if the heap is empty.
+ */
+static inline int TCODPATH_minheap_peek(const struct TCODPATH_Heap* __restrict minheap, void* __restrict out) {
+  if (minheap->size == 0) return INT_MAX;
+  memcpy(out, minheap->heap + minheap->data_offset, minheap->data_size);
+  return TCODPATH_minheap_peek_priority(minheap);
+}
 /***************************************************************************
     @brief Remove the smallest element from the heap and keep it sorted.
 
@@ -149,7 +176,8 @@ static inline int TCODPATH_minheap_push(
     struct TCODPATH_Heap* __restrict minheap, int priority, const void* __restrict data) {
   if (minheap->size == minheap->capacity) {
     const int new_capacity = (minheap->capacity ? minheap->capacity * 2 : TCODPATH_HEAP_DEFAULT_CAPACITY);
-    void* new_heap = realloc(minheap->heap, minheap->node_size * new_capacity);
+    void* new_heap = TCODPATH_realloc_(
+        minheap->allocator, minheap->heap, minheap->node_size * minheap->capacity, minheap->node_size * new_capacity);
     if (!new_heap) {
       TCODPATH_set_errorv("Out of memory while reallocating heap.");
       return TCODPATH_E_OUT_OF_MEMORY;
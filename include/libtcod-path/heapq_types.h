@@ -7,6 +7,8 @@
 #include <stddef.h>
 #include <stdint.h>
 
+#include "allocator_types.h"
+
 struct TCODPATH_Heap {
   unsigned char* __restrict heap;
   int size;  // The current number of elements in heap.
@@ -15,5 +17,6 @@ struct TCODPATH_Heap {
   ptrdiff_t data_size;  // The size of a nodes user data section in bytes.
   ptrdiff_t data_offset;  // The offset of the user data section.
   int priority_type;  // Bytesize and sign of priority type, should be -4 for int32
+  TCODPATH_Allocator* allocator;  // Allocator of `heap`, NULL for the global one. Set while `heap` is NULL.
 };
 #endif  // TCODPATH_HEAPQ_TYPES_H
@@ -37,3 +37,11 @@ static inline bool TCODPATH_indexes_iter_step(
   }
   return false;  // end has been reached
 }
+/// @brief Return true if the indexes `a` and `b` of length `n` are equal.
+static inline bool TCODPATH_indexes_equal(
+    int n, const TCODPATH_IndexType* __restrict a, const TCODPATH_IndexType* __restrict b) {
+  for (int i = 0; i < n; ++i) {
+    if (a[i] != b[i]) return false;
+  }
+  return true;
+}
@@ -0,0 +1,156 @@
+#pragma once
+
+#include <stdlib.h>
+
+#include "allocator.h"
+#include "error.h"
+#include "graph_tools.h"
+#include "graph_types.h"
+#include "indexes.h"
+#include "linear_graph_types.h"
+#include "map_tools.h"
+
+/// @brief Free the arrays of `linear`.
+static inline void TCODPATH_linear_graph_uninit(TCODPATH_LinearGraph* __restrict linear) {
+  if (!linear) return;
+  TCODPATH_free_(linear->allocator, linear->costs, sizeof(*linear->costs) * linear->node_count);
+  TCODPATH_free_(linear->allocator, linear->edge_offsets, sizeof(*linear->edge_offsets) * linear->edge_capacity);
+  TCODPATH_free_(linear->allocator, linear->edge_costs, sizeof(*linear->edge_costs) * linear->edge_capacity);
+  *linear = TCODPATH_LinearGraph{};
+}
+/// @brief Return the linear id of the node at `index`. `index` must be in bounds.
+static inline TCODPATH_LinearIdType TCODPATH_linear_graph_id(
+    const TCODPATH_LinearGraph* __restrict linear, const TCODPATH_IndexType* __restrict index) {
+  ptrdiff_t id = 0;
+  for (int i = 0; i < linear->dimensions; ++i) id += (index[i] + linear->padding[i]) * linear->strides[i];
+  return (TCODPATH_LinearIdType)id;
+}
+/// @brief Convert the linear `id` back into the node index `index_out`.
+static inline void TCODPATH_linear_graph_index(
+    const TCODPATH_LinearGraph* __restrict linear, TCODPATH_LinearIdType id, TCODPATH_IndexType* __restrict index_out) {
+  ptrdiff_t remainder = id;
+  for (int i = 0; i < linear->dimensions; ++i) {
+    index_out[i] = (TCODPATH_IndexType)(remainder / linear->strides[i] - linear->padding[i]);
+    remainder %= linear->strides[i];
+  }
+}
+/// @brief Add an edge with `offset` over the last `offset_dimensions` axes to `linear`.
+/// Used internally.
+/// @return 0 on success, negative value if the edge is not supported.
+static inline int TCODPATH_linear_graph_add_edge_(
+    TCODPATH_LinearGraph* __restrict linear, int offset_dimensions, const int* offset, TCODPATH_ValueType cost) {
+  if (cost <= 0) return TCODPATH_E_OK;
+  const int first_axis = linear->dimensions - offset_dimensions;
+  ptrdiff_t id_offset = 0;
+  for (int i = 0; i < offset_dimensions; ++i) {
+    if (offset[i] < -1 || offset[i] > 1) return TCODPATH_E_INVALID_ARGUMENT;  // The border is only one node wide
+    if (offset[i] != 0) linear->padding[first_axis + i] = 1;
+    id_offset += offset[i] * linear->strides[first_axis + i];
+  }
+  linear->edge_offsets[linear->edge_count] = id_offset;
+  linear->edge_costs[linear->edge_count] = cost;
+  ++linear->edge_count;
+  return TCODPATH_E_OK;
+}
+/// @brief Flatten `graph` into `linear`, copying its costs into a padded array.
+/// @details The copy is a snapshot, `linear` must be initialized again when the costs of `graph` change.
+/// Supports `TCODPATH_GRAPH_BASIC2D` and `TCODPATH_GRAPH_STATIC` graphs whose edges move at most one node per axis.
+/// Basic 2D graphs with `no_corner_cutting` set are rejected.
+/// @param linear Output, must be freed with `TCODPATH_linear_graph_uninit`.
+/// @param graph Graph to flatten. Its cost map must have a shape.
+/// @param allocator Allocator of the arrays, also used by searches over `linear`. `NULL` for the global one.
+/// @return 0 on success, negative value on error.
+static inline int TCODPATH_linear_graph_init_with_allocator(
+    TCODPATH_LinearGraph* __restrict linear, const TCODPATH_Graph* __restrict graph, TCODPATH_Allocator* allocator) {
+  if (!linear || !graph) return TCODPATH_E_INVALID_ARGUMENT;
+  *linear = TCODPATH_LinearGraph{};
+  linear->allocator = allocator;
+  const TCODPATH_Map* costs = NULL;
+  int max_edges = 0;
+  switch (graph->type) {
+    case TCODPATH_GRAPH_BASIC2D:
+      costs = graph->basic2d.map;
+      max_edges = 8;
+      break;
+    case TCODPATH_GRAPH_STATIC:
+      costs = graph->static_edges.map;
+      max_edges = graph->static_edges.edge_count;
+      break;
+    default:
+      return TCODPATH_E_INVALID_ARGUMENT;
+  }
+  const int dimensions = TCODPATH_map_get_dimensions(costs);
+  const TCODPATH_IndexType* shape = TCODPATH_map_get_shape(costs);
+  if (dimensions <= 0 || !shape) return TCODPATH_E_INVALID_ARGUMENT;
+  if (graph->type == TCODPATH_GRAPH_BASIC2D && dimensions < 2) return TCODPATH_E_INVALID_ARGUMENT;
+  // Every node shares the same edges, so per-node corner rules can not be represented
+  if (graph->type == TCODPATH_GRAPH_BASIC2D && graph->basic2d.no_corner_cutting) return TCODPATH_E_INVALID_ARGUMENT;
+  if (graph->type == TCODPATH_GRAPH_STATIC && graph->static_edges.dimensions > dimensions) {
+    return TCODPATH_E_INVALID_ARGUMENT;
+  }
+  linear->dimensions = dimensions;
+  for (int i = 0; i < dimensions; ++i) linear->shape[i] = shape[i];
+  linear->edge_capacity = TCODPATH_MAX(max_edges, 1);
+  linear->edge_offsets =
+      (ptrdiff_t*)TCODPATH_alloc_(allocator, sizeof(*linear->edge_offsets) * linear->edge_capacity);
+  linear->edge_costs =
+      (TCODPATH_ValueType*)TCODPATH_alloc_(allocator, sizeof(*linear->edge_costs) * linear->edge_capacity);
+  if (!linear->edge_offsets || !linear->edge_costs) {
+    TCODPATH_linear_graph_uninit(linear);
+    return TCODPATH_E_OUT_OF_MEMORY;
+  }
+  // Padding depends on which axes are used, so edges are added twice: once to find the padding and again for offsets
+  for (int pass = 0; pass < 2; ++pass) {
+    ptrdiff_t stride = 1;
+    for (int i = dimensions - 1; i >= 0; --i) {
+      linear->strides[i] = stride;
+      stride *= shape[i] + linear->padding[i] * 2;
+    }
+    linear->node_count = stride;
+    linear->edge_count = 0;
+    if (graph->type == TCODPATH_GRAPH_BASIC2D) {
+      for (int y = -1; y <= 1; ++y) {
+        for (int x = -1; x <= 1; ++x) {
+          if (x == 0 && y == 0) continue;
+          const int offset[2] = {y, x};
+          const TCODPATH_ValueType cost = (x != 0 && y != 0) ? graph->basic2d.diagonal : graph->basic2d.cardinal;
+          TCODPATH_linear_graph_add_edge_(linear, 2, offset, cost);
+        }
+      }
+    } else {
+      const struct TCODPATH_GraphStatic* static_edges = &graph->static_edges;
+      for (int k = 0; k < static_edges->edge_count; ++k) {
+        const int* edge = static_edges->edges + k * (static_edges->dimensions + 1);
+        const int err =
+            TCODPATH_linear_graph_add_edge_(linear, static_edges->dimensions, edge, edge[static_edges->dimensions]);
+        if (err < 0) {
+          TCODPATH_linear_graph_uninit(linear);
+          return err;
+        }
+      }
+    }
+  }
+  if (linear->node_count > TCODPATH_LINEAR_ID_MAX) {
+    TCODPATH_linear_graph_uninit(linear);
+    return TCODPATH_E_INVALID_ARGUMENT;  // Too many nodes for the id type
+  }
+  linear->costs = (TCODPATH_ValueType*)TCODPATH_calloc_(allocator, linear->node_count, sizeof(*linear->costs));
+  if (!linear->costs) {
+    TCODPATH_linear_graph_uninit(linear);
+    return TCODPATH_E_OUT_OF_MEMORY;
+  }
+  TCODPATH_IndexType index[TCODPATH_MAX_DIMENSIONS];
+  for (TCODPATH_indexes_iter_begin(dimensions, index); TCODPATH_indexes_iter_step(dimensions, shape, index);) {
+    linear->costs[TCODPATH_linear_graph_id(linear, index)] = TCODPATH_map_get(costs, index);
+    if (graph->type == TCODPATH_GRAPH_BASIC2D && !TCODPATH_graph_basic2d_fits_(&graph->basic2d, index)) {
+      linear->costs[TCODPATH_linear_graph_id(linear, index)] = 0;  // Too small for the agent, same as a wall
+    }
+  }
+  return TCODPATH_E_OK;
+}
+/// @brief Flatten `graph` into `linear` using the global allocator, see `TCODPATH_linear_graph_init_with_allocator`.
+/// @return 0 on success, negative value on error.
+static inline int TCODPATH_linear_graph_init(
+    TCODPATH_LinearGraph* __restrict linear, const TCODPATH_Graph* __restrict graph) {
+  return TCODPATH_linear_graph_init_with_allocator(linear, graph, NULL);
+}
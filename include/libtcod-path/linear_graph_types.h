@@ -0,0 +1,23 @@
+#pragma once
+
+#include <stddef.h>
+
+#include "allocator_types.h"
+#include "config.h"
+
+/// @brief A graph flattened into linear node ids over a cost array with a sentinel border.
+/// @details Every axis the graph moves along is padded by one impassable node on each side, so the neighbors of a
+/// node are always `id + edge_offsets[k]` without any bounds checks.
+typedef struct TCODPATH_LinearGraph {
+  int dimensions;
+  TCODPATH_IndexType shape[TCODPATH_MAX_DIMENSIONS];  // Shape of the original map
+  TCODPATH_IndexType padding[TCODPATH_MAX_DIMENSIONS];  // Border size of each axis, 0 or 1
+  ptrdiff_t strides[TCODPATH_MAX_DIMENSIONS];  // Padded strides of each axis in nodes
+  ptrdiff_t node_count;  // Total number of padded nodes
+  TCODPATH_ValueType* __restrict costs;  // Padded cost array, the border is zero
+  int edge_count;
+  int edge_capacity;  // Allocated length of `edge_offsets` and `edge_costs`
+  ptrdiff_t* __restrict edge_offsets;  // Id offset of each edge
+  TCODPATH_ValueType* __restrict edge_costs;  // Cost multiplier of each edge
+  TCODPATH_Allocator* allocator;  // Allocator of the arrays and of searches over them, NULL for the global one
+} TCODPATH_LinearGraph;
@@ -0,0 +1,214 @@
+#pragma once
+
+#include <stdlib.h>
+
+#include "allocator.h"
+#include "error.h"
+#include "heapq_tools.h"
+#include "indexes.h"
+#include "linear_graph.h"
+#include "map_tools.h"
+#include "queue.h"
+
+/// @brief Working arrays of a search over a linear graph.
+/// Used internally.
+struct TCODPATH_LinearSearch_ {
+  TCODPATH_ValueType* __restrict distance;
+  TCODPATH_LinearIdType* __restrict parent;  // Only allocated when a flow map is requested
+  ptrdiff_t node_count;  // Length of the arrays
+  TCODPATH_Allocator* allocator;  // Allocator of the arrays, from the linear graph
+};
+
+/// @brief Free the arrays of `search`.
+/// Used internally.
+static inline void TCODPATH_linear_search_uninit_(struct TCODPATH_LinearSearch_* __restrict search) {
+  TCODPATH_free_(search->allocator, search->distance, sizeof(*search->distance) * search->node_count);
+  TCODPATH_free_(search->allocator, search->parent, sizeof(*search->parent) * search->node_count);
+}
+/// @brief Allocate `search` and import the non-max values of `distance` as sources.
+/// Used internally.
+/// @return 0 on success, negative value on error.
+static inline int TCODPATH_linear_search_init_(
+    struct TCODPATH_LinearSearch_* __restrict search,
+    const TCODPATH_LinearGraph* __restrict linear,
+    const TCODPATH_Map* __restrict distance,
+    bool with_parent) {
+  *search = TCODPATH_LinearSearch_{};
+  if (TCODPATH_map_get_dimensions(distance) != linear->dimensions) return TCODPATH_E_INVALID_ARGUMENT;
+  search->node_count = linear->node_count;
+  search->allocator = linear->allocator;
+  search->distance =
+      (TCODPATH_ValueType*)TCODPATH_alloc_(search->allocator, sizeof(*search->distance) * linear->node_count);
+  if (with_parent) {
+    search->parent =
+        (TCODPATH_LinearIdType*)TCODPATH_alloc_(search->allocator, sizeof(*search->parent) * linear->node_count);
+  }
+  if (!search->distance || (with_parent && !search->parent)) {
+    TCODPATH_linear_search_uninit_(search);
+    return TCODPATH_E_OUT_OF_MEMORY;
+  }
+  for (ptrdiff_t id = 0; id < linear->node_count; ++id) search->distance[id] = TCODPATH_VALUE_MAX;
+  if (with_parent) {
+    for (ptrdiff_t id = 0; id < linear->node_count; ++id) search->parent[id] = (TCODPATH_LinearIdType)id;
+  }
+  TCODPATH_IndexType index[TCODPATH_MAX_DIMENSIONS];
+  for (TCODPATH_indexes_iter_begin(linear->dimensions, index);
+       TCODPATH_indexes_iter_step(linear->dimensions, linear->shape, index);) {
+    if (TCODPATH_map_is_max(distance, index)) continue;
+    search->distance[TCODPATH_linear_graph_id(linear, index)] = TCODPATH_map_get(distance, index);
+  }
+  return TCODPATH_E_OK;
+}
+/// @brief Write the results of `search` back to the `distance` and `flow` maps.
+/// Used internally.
+static inline void TCODPATH_linear_search_export_(
+    const struct TCODPATH_LinearSearch_* __restrict search,
+    const TCODPATH_LinearGraph* __restrict linear,
+    TCODPATH_Map* __restrict distance,
+    TCODPATH_Map* __restrict flow) {
+  TCODPATH_IndexType index[TCODPATH_MAX_DIMENSIONS];
+  TCODPATH_IndexType parent_index[TCODPATH_MAX_DIMENSIONS];
+  for (TCODPATH_indexes_iter_begin(linear->dimensions, index);
+       TCODPATH_indexes_iter_step(linear->dimensions, linear->shape, index);) {
+    const TCODPATH_LinearIdType id = TCODPATH_linear_graph_id(linear, index);
+    if (search->distance[id] == TCODPATH_VALUE_MAX) continue;  // Never reached
+    TCODPATH_map_set(distance, index, search->distance[id]);
+    if (!flow || !search->parent || search->parent[id] == id) continue;
+    TCODPATH_linear_graph_index(linear, search->parent[id], parent_index);
+    TCODPATH_map_set_index(flow, index, parent_index);
+  }
+}
+
+/// @brief Dijkstra over a linear graph, using the non-max values of `distance` as sources.
+/// @details Gives the same results as `TCODPATH_dijkstra` on the graph `linear` was made from, but the frontier
+/// holds 4-byte node ids and expanding a node is a loop over the edge table with no bounds checks.
+/// Multi-indexes are only used when reading the sources and writing the results.
+/// @param linear Graph from `TCODPATH_linear_graph_init`.
+/// @param distance Distance map to update in-place.
+/// @param flow Optional flow map to write, can be `NULL`.
+/// @return 0 on success, negative value on error.
+static inline int TCODPATH_linear_dijkstra(
+    const TCODPATH_LinearGraph* __restrict linear, TCODPATH_Map* __restrict distance, TCODPATH_Map* __restrict flow) {
+  if (!linear || !distance) return TCODPATH_E_INVALID_ARGUMENT;
+  struct TCODPATH_LinearSearch_ search;
+  int err = TCODPATH_linear_search_init_(&search, linear, distance, flow != NULL);
+  if (err < 0) return err;
+  struct TCODPATH_Heap frontier;
+  err = TCODPATH_heap_init(&frontier, sizeof(TCODPATH_LinearIdType));
+  frontier.allocator = linear->allocator;
+  for (TCODPATH_LinearIdType id = 0; id < linear->node_count && err >= 0; ++id) {
+    if (search.distance[id] != TCODPATH_VALUE_MAX) err = TCODPATH_minheap_push(&frontier, search.distance[id], &id);
+  }
+  const TCODPATH_ValueType* __restrict costs = linear->costs;
+  while (frontier.size > 0 && err >= 0) {
+    const int priority = TCODPATH_minheap_peek_priority(&frontier);
+    TCODPATH_LinearIdType root;
+    TCODPATH_minheap_pop(&frontier, &root);
+    const TCODPATH_ValueType distance_at_root = search.distance[root];
+    if (priority > distance_at_root) continue;  // Stale entry
+    if (costs[root] <= 0) continue;  // Can not move from here
+    for (int k = 0; k < linear->edge_count; ++k) {
+      const TCODPATH_LinearIdType leaf = (TCODPATH_LinearIdType)(root + linear->edge_offsets[k]);
+      const TCODPATH_ValueType leaf_cost = costs[leaf];
+      if (leaf_cost <= 0) continue;  // Includes the border
+      const TCODPATH_ValueType total_distance = distance_at_root + linear->edge_costs[k] * leaf_cost;
+      if (search.distance[leaf] <= total_distance) continue;
+      search.distance[leaf] = total_distance;
+      if (search.parent) search.parent[leaf] = root;
+      err = TCODPATH_minheap_push(&frontier, total_distance, &leaf);
+      if (err < 0) break;
+    }
+  }
+  TCODPATH_heap_uninit(&frontier);
+  if (err >= 0) TCODPATH_linear_search_export_(&search, linear, distance, flow);
+  TCODPATH_linear_search_uninit_(&search);
+  return err < 0 ? err : TCODPATH_E_OK;
+}
+/// @brief Breadth-first search over a linear graph, using the non-max values of `distance` as sources.
+/// @details Gives the same distances as `TCODPATH_bfs` on the graph `linear` was made from. Edge costs are ignored.
+/// @param linear Graph from `TCODPATH_linear_graph_init`.
+/// @param distance Distance map to update in-place.
+/// @param flow Optional flow map to write, can be `NULL`.
+/// @return 0 on success, negative value on error.
+static inline int TCODPATH_linear_bfs(
+    const TCODPATH_LinearGraph* __restrict linear, TCODPATH_Map* __restrict distance, TCODPATH_Map* __restrict flow) {
+  if (!linear || !distance) return TCODPATH_E_INVALID_ARGUMENT;
+  struct TCODPATH_LinearSearch_ search;
+  int err = TCODPATH_linear_search_init_(&search, linear, distance, flow != NULL);
+  if (err < 0) return err;
+  TCODPATH_Queue frontier;
+  TCODPATH_queue_init(&frontier, sizeof(TCODPATH_LinearIdType));
+  frontier.allocator = linear->allocator;
+  for (TCODPATH_LinearIdType id = 0; id < linear->node_count && err >= 0; ++id) {
+    if (search.distance[id] != TCODPATH_VALUE_MAX) err = TCODPATH_queue_push(&frontier, &id);
+  }
+  const TCODPATH_ValueType* __restrict costs = linear->costs;
+  TCODPATH_LinearIdType root;
+  while (err >= 0 && TCODPATH_queue_pop(&frontier, &root) == 0) {
+    if (costs[root] <= 0) continue;  // Can not move from here
+    const TCODPATH_ValueType total_distance = search.distance[root] + 1;
+    for (int k = 0; k < linear->edge_count; ++k) {
+      const TCODPATH_LinearIdType leaf = (TCODPATH_LinearIdType)(root + linear->edge_offsets[k]);
+      if (costs[leaf] <= 0) continue;  // Includes the border
+      if (search.distance[leaf] <= total_distance) continue;
+      search.distance[leaf] = total_distance;
+      if (search.parent) search.parent[leaf] = root;
+      err = TCODPATH_queue_push(&frontier, &leaf);
+      if (err < 0) break;
+    }
+  }
+  TCODPATH_queue_uninit(&frontier);
+  if (err >= 0) TCODPATH_linear_search_export_(&search, linear, distance, flow);
+  TCODPATH_linear_search_uninit_(&search);
+  return err < 0 ? err : TCODPATH_E_OK;
+}
+/// @brief Label the connected components of a linear graph on `out`, like `TCODPATH_partition_from_graph`.
+/// @param linear Graph from `TCODPATH_linear_graph_init`.
+/// @param out Output labels. Nodes without edges are labeled `0`.
+/// @return The number of components, which are labeled from `1` onwards, or a negative value on error.
+static inline int TCODPATH_linear_partition(
+    const TCODPATH_LinearGraph* __restrict linear, TCODPATH_Map* __restrict out) {
+  if (!linear || !out || TCODPATH_map_get_dimensions(out) != linear->dimensions) return TCODPATH_E_INVALID_ARGUMENT;
+  TCODPATH_LinearIdType* __restrict labels =
+      (TCODPATH_LinearIdType*)TCODPATH_calloc_(linear->allocator, linear->node_count, sizeof(TCODPATH_LinearIdType));
+  if (!labels) return TCODPATH_E_OUT_OF_MEMORY;
+  const TCODPATH_ValueType* __restrict costs = linear->costs;
+  TCODPATH_Queue frontier;
+  TCODPATH_queue_init(&frontier, sizeof(TCODPATH_LinearIdType));
+  frontier.allocator = linear->allocator;
+  TCODPATH_LinearIdType total_partitions = 0;
+  int err = 0;
+  for (TCODPATH_LinearIdType id = 0; id < linear->node_count && err >= 0; ++id) {
+    if (labels[id] != 0 || costs[id] <= 0) continue;  // Already labeled, or no edges from here
+    bool is_open = false;
+    for (int k = 0; k < linear->edge_count && !is_open; ++k) is_open = costs[id + linear->edge_offsets[k]] > 0;
+    if (!is_open) continue;
+    labels[id] = ++total_partitions;
+    err = TCODPATH_queue_push(&frontier, &id);
+    TCODPATH_LinearIdType root;
+    while (err >= 0 && TCODPATH_queue_pop(&frontier, &root) == 0) {
+      if (costs[root] <= 0) continue;  // Reached, but can not move from here
+      for (int k = 0; k < linear->edge_count; ++k) {
+        const TCODPATH_LinearIdType leaf = (TCODPATH_LinearIdType)(root + linear->edge_offsets[k]);
+        if (labels[leaf] != 0 || costs[leaf] <= 0) continue;
+        labels[leaf] = total_partitions;
+        err = TCODPATH_queue_push(&frontier, &leaf);
+        if (err < 0) break;
+      }
+    }
+  }
+  TCODPATH_queue_uninit(&frontier);
+  if (err >= 0) {
+    TCODPATH_MapJournal* journal = TCODPATH_map_get_journal(out);
+    TCODPATH_map_set_journal(out, NULL);  // Record this as one change instead of one per node
+    TCODPATH_IndexType index[TCODPATH_MAX_DIMENSIONS];
+    for (TCODPATH_indexes_iter_begin(linear->dimensions, index);
+         TCODPATH_indexes_iter_step(linear->dimensions, linear->shape, index);) {
+      TCODPATH_map_set(out, index, labels[TCODPATH_linear_graph_id(linear, index)]);
+    }
+    TCODPATH_map_set_journal(out, journal);
+    TCODPATH_map_journal_mark_all(out);
+  }
+  TCODPATH_free_(linear->allocator, labels, sizeof(*labels) * linear->node_count);
+  return err < 0 ? err : (int)total_partitions;
+}
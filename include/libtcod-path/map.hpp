@@ -4,6 +4,12 @@
 #include <libtcod-path/graph_types.h>
 #include <libtcod-path/map_types.h>
 
+#include <algorithm>
+#include <array>
+#include <stdexcept>
+#include <type_traits>
+#include <vector>
+
 namespace tcod::path {
 template <typename ValueType = TCODPATH_ValueType, typename IndexType = TCODPATH_IndexType>
 class Map2D {
@@ -14,8 +20,8 @@ class Map2D {
   Map2D() = default;
   Map2D(std::array<index_type, 2> shape, value_type default_value = 0)
       : shape_{std::move(shape)}, data_(shape_.at(0) * shape_.at(1), default_value) {}
-  template <typename IndexType>
-  Map2D(const std::array<IndexType, 2>& shape, value_type default_value = 0)
+  template <typename OtherIndexType>
+  Map2D(const std::array<OtherIndexType, 2>& shape, value_type default_value = 0)
       : Map2D{{static_cast<index_type>(shape.at(0)), static_cast<index_type>(shape.at(1))}, default_value} {}
 
   auto get_shape() const noexcept -> const std::array<index_type, 2>& { return shape_; }
@@ -29,11 +35,11 @@ class Map2D {
 
   value_type& operator[](const std::array<int, 2>& ij) noexcept {
     range_check(ij);
-    return data_.at(ij.at(0) * shape_.at(0) + ij.at(1));
+    return data_.at(ij.at(0) * shape_.at(1) + ij.at(1));
   }
   const value_type& operator[](const std::array<int, 2>& ij) const noexcept {
     range_check(ij);
-    return data_.at(ij.at(0) * shape_.at(0) + ij.at(1));
+    return data_.at(ij.at(0) * shape_.at(1) + ij.at(1));
   }
 
   TCODPATH_Map* c_data() noexcept { return &map_c_; }
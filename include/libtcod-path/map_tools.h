@@ -1,14 +1,31 @@
 #pragma once
 
 #include <stdlib.h>
+#include <string.h>
 
+#include "allocator.h"
 #include "assert.h"
 #include "config.h"
+#include "error.h"
 #include "indexes.h"
 #include "limits.h"
 #include "map_types.h"
+#include "ring_buffer.h"
 #include "utility.h"
 
+/// @brief Return the size in bytes of the data array of a contigious map.
+/// Used internally.
+static inline size_t TCODPATH_map_contigious_bytes_(const struct TCODPATH_MapContigious* __restrict contigious) {
+  size_t elements = 1;
+  for (int i = 0; i < contigious->dimensions; ++i) elements *= contigious->shape[i];
+  return elements * TCODPATH_ABS(contigious->int_type);
+}
+/// @brief Free the values of one chunk of a chunked map. `data` can be NULL.
+/// Used internally.
+static inline void TCODPATH_map_chunk_free_(
+    const struct TCODPATH_MapChunked* __restrict chunked, TCODPATH_ValueType* __restrict data) {
+  TCODPATH_free_(chunked->allocator, data, sizeof(*data) * chunked->chunk_size);
+}
 /// @brief Uninitialize maps, freeing owned pointers.
 /// @param map Pointer to generic map, can be NULL
 static inline void TCODPATH_map_uninit(TCODPATH_Map* map) {
@@ -16,10 +33,21 @@ static inline void TCODPATH_map_uninit(TCODPATH_Map* map) {
   switch (map->type) {
     case TCODPATH_MAP_CONTIGIOUS:
       if (map->contigious.owned_data && map->contigious.data) {
-        free(map->contigious.data);
+        TCODPATH_free_(
+            map->contigious.allocator, map->contigious.data, TCODPATH_map_contigious_bytes_(&map->contigious));
         map->contigious.data = NULL;
       }
       break;
+    case TCODPATH_MAP_CHUNKED:
+      if (map->chunked.chunks) {
+        for (ptrdiff_t i = 0; i < map->chunked.chunk_capacity; ++i) {
+          TCODPATH_map_chunk_free_(&map->chunked, map->chunked.chunks[i].data);
+        }
+        TCODPATH_free_(
+            map->chunked.allocator, map->chunked.chunks, sizeof(*map->chunked.chunks) * map->chunked.chunk_capacity);
+        map->chunked.chunks = NULL;
+      }
+      break;
     default:
       break;
   }
@@ -30,7 +58,7 @@ static inline void TCODPATH_map_uninit(TCODPATH_Map* map) {
 static inline void TCODPATH_map_delete(TCODPATH_Map* map) {
   if (!map) return;
   TCODPATH_map_uninit(map);
-  free(map);
+  TCODPATH_free_(NULL, map, sizeof(*map));
 }
 /// @brief Initialize a map from contigious data.
 /// @param map Pointer to a map to setup
@@ -46,18 +74,33 @@ static inline void TCODPATH_map_init_contigious_from(
   map->contigious.int_type = int_type;
   map->contigious.data = (unsigned char*)data;
 }
-static inline void TCODPATH_map_init_contigious(
-    TCODPATH_Map* __restrict map, int dimensions, TCODPATH_IndexType* __restrict shape, int8_t int_type) {
+/// @brief Initialize a contigious map which owns new zeroed data from `allocator`.
+/// @param map Pointer to a map to setup. Must be freed with `TCODPATH_map_uninit`.
+/// @param dimensions Number of dimensions of `shape`
+/// @param shape Shape of the map in row-major order
+/// @param int_type Integer type to use: `-4 = int32_t`, `1 = uint8_t`
+/// @param allocator Allocator of the data, such as one from `TCODPATH_allocator_huge_pages`. `NULL` for the global one.
+static inline void TCODPATH_map_init_contigious_with_allocator(
+    TCODPATH_Map* __restrict map,
+    int dimensions,
+    TCODPATH_IndexType* __restrict shape,
+    int8_t int_type,
+    TCODPATH_Allocator* allocator) {
   if (!shape) return;
   size_t elements = 1;
   for (int i = 0; i < dimensions; ++i) elements *= shape[i];
   if (!int_type) int_type = -4;
-  void* data = (unsigned char*)calloc(elements, TCODPATH_ABS(int_type));
+  void* data = TCODPATH_calloc_(allocator, elements, TCODPATH_ABS(int_type));
   if (!data) return;
   TCODPATH_map_init_contigious_from(map, dimensions, shape, int_type, data);
   map->contigious.owned_data = 1;
+  map->contigious.allocator = allocator;
   return;
 }
+static inline void TCODPATH_map_init_contigious(
+    TCODPATH_Map* __restrict map, int dimensions, TCODPATH_IndexType* __restrict shape, int8_t int_type) {
+  TCODPATH_map_init_contigious_with_allocator(map, dimensions, shape, int_type, NULL);
+}
 /// @brief Return a new contigious map.
 /// @param dimensions Number of dimensions of `shape`
 /// @param shape Shape of the map in row-major order
@@ -65,7 +108,7 @@ static inline void TCODPATH_map_init_contigious(
 /// @return The new map, or NULL on error
 static inline TCODPATH_Map* TCODPATH_map_new(int dimensions, TCODPATH_IndexType* __restrict shape, int8_t int_type) {
   if (!shape) return NULL;
-  TCODPATH_Map* map = (TCODPATH_Map*)calloc(1, sizeof(*map));
+  TCODPATH_Map* map = (TCODPATH_Map*)TCODPATH_calloc_(NULL, 1, sizeof(*map));
   if (!map) return NULL;
   TCODPATH_map_init_contigious(map, dimensions, shape, int_type);
   if (!map->contigious.data) {
@@ -74,6 +117,77 @@ static inline TCODPATH_Map* TCODPATH_map_new(int dimensions, TCODPATH_IndexType*
   }
   return map;
 }
+/// @brief Initialize a sparse map which stores its data in chunks allocated on first write.
+/// @details Memory use is proportional to the chunks written to instead of the size of the map.
+/// Reads from unallocated chunks return `default_value`, and writing `default_value` does not allocate a chunk.
+/// Reads update a cached chunk pointer, so a chunked map must not be read from multiple threads at once.
+/// @param map Pointer to a map to setup. Must be freed with `TCODPATH_map_uninit`.
+/// @param dimensions Number of dimensions of the map.
+/// @param shape Shape of the map, or `NULL` for an unbounded map which also accepts negative indexes.
+/// Unbounded maps can only be used by searches which start from given indexes, such as `TCODPATH_astar` or
+/// `TCODPATH_dijkstra_bounded`, since there is no shape to scan.
+/// @param chunk_shape Shape of each chunk, or `NULL` to use `TCODPATH_MAP_CHUNK_SIZE` on each axis, clipped to `shape`.
+/// Unbounded flow maps should give the length of the index as the last axis of the chunk shape.
+/// @param default_value Value of nodes which have not been written to.
+/// @param allocator Allocator of the chunks and their table. `NULL` for the global one.
+/// @return 0 on success, negative value on error.
+static inline int TCODPATH_map_init_chunked_with_allocator(
+    TCODPATH_Map* __restrict map,
+    int dimensions,
+    const TCODPATH_IndexType* __restrict shape,
+    const TCODPATH_IndexType* __restrict chunk_shape,
+    TCODPATH_ValueType default_value,
+    TCODPATH_Allocator* allocator) {
+  if (!map || dimensions <= 0 || dimensions > TCODPATH_MAX_DIMENSIONS) return TCODPATH_E_INVALID_ARGUMENT;
+  struct TCODPATH_MapChunked chunked = {};
+  chunked.type = TCODPATH_MAP_CHUNKED;
+  chunked.dimensions = dimensions;
+  chunked.unbounded = !shape;
+  chunked.chunk_size = 1;
+  for (int i = 0; i < dimensions; ++i) {
+    if (shape && shape[i] <= 0) return TCODPATH_E_INVALID_ARGUMENT;
+    chunked.shape[i] = shape ? shape[i] : 0;
+    chunked.chunk_shape[i] = chunk_shape ? chunk_shape[i] : TCODPATH_MAP_CHUNK_SIZE;
+    if (!chunk_shape && shape) chunked.chunk_shape[i] = TCODPATH_MIN(chunked.chunk_shape[i], shape[i]);
+    if (chunked.chunk_shape[i] <= 0) return TCODPATH_E_INVALID_ARGUMENT;
+    chunked.chunk_size *= chunked.chunk_shape[i];
+  }
+  chunked.default_value = default_value;
+  chunked.allocator = allocator;
+  chunked.chunk_capacity = 16;
+  chunked.chunks =
+      (struct TCODPATH_MapChunk*)TCODPATH_calloc_(allocator, chunked.chunk_capacity, sizeof(*chunked.chunks));
+  if (!chunked.chunks) return TCODPATH_E_OUT_OF_MEMORY;
+  map->chunked = chunked;
+  return TCODPATH_E_OK;
+}
+/// @brief Initialize a sparse map using the global allocator, see `TCODPATH_map_init_chunked_with_allocator`.
+/// @return 0 on success, negative value on error.
+static inline int TCODPATH_map_init_chunked(
+    TCODPATH_Map* __restrict map,
+    int dimensions,
+    const TCODPATH_IndexType* __restrict shape,
+    const TCODPATH_IndexType* __restrict chunk_shape,
+    TCODPATH_ValueType default_value) {
+  return TCODPATH_map_init_chunked_with_allocator(map, dimensions, shape, chunk_shape, default_value, NULL);
+}
+/// @brief Return the number of chunks allocated by a chunked `map`, or `0` for other map types.
+static inline ptrdiff_t TCODPATH_map_get_chunk_count(const TCODPATH_Map* __restrict map) {
+  if (!map || map->type != TCODPATH_MAP_CHUNKED) return 0;
+  return map->chunked.chunk_count;
+}
+/// @brief Return the allocator `map` was made with, or `NULL` for the global one and maps which do not allocate.
+static inline TCODPATH_Allocator* TCODPATH_map_get_allocator(const TCODPATH_Map* __restrict map) {
+  if (!map) return NULL;
+  switch (map->type) {
+    case TCODPATH_MAP_CONTIGIOUS:
+      return map->contigious.allocator;
+    case TCODPATH_MAP_CHUNKED:
+      return map->chunked.allocator;
+    default:
+      return NULL;
+  }
+}
 /// @brief Return the dimensions of `map`. Returns `0` if invalid.
 static inline int TCODPATH_map_get_dimensions(const TCODPATH_Map* __restrict map) {
   if (!map) return 0;
@@ -84,6 +198,8 @@ static inline int TCODPATH_map_get_dimensions(const TCODPATH_Map* __restrict map
       return map->contigious.dimensions;
     case TCODPATH_MAP_STRIDES:
       return map->strides.dimensions;
+    case TCODPATH_MAP_CHUNKED:
+      return map->chunked.dimensions;
     default:
       return 0;
   }
@@ -98,6 +214,8 @@ static inline const TCODPATH_IndexType* TCODPATH_map_get_shape(const TCODPATH_Ma
       return map->contigious.shape;
     case TCODPATH_MAP_STRIDES:
       return map->strides.shape;
+    case TCODPATH_MAP_CHUNKED:
+      return map->chunked.unbounded ? NULL : map->chunked.shape;
     default:
       return NULL;
   }
@@ -115,6 +233,130 @@ static inline bool TCODPATH_map_in_bounds(const TCODPATH_Map* __restrict map, co
   }
   return true;  // In-bounds
 }
+/// @brief Return the change journal of `map`, or `NULL` if it has none.
+static inline TCODPATH_MapJournal* TCODPATH_map_get_journal(const TCODPATH_Map* __restrict map) {
+  if (!map) return NULL;
+  switch (map->type) {
+    case TCODPATH_MAP_CALLBACK:
+      return map->callback.journal;
+    case TCODPATH_MAP_CONTIGIOUS:
+      return map->contigious.journal;
+    case TCODPATH_MAP_STRIDES:
+      return map->strides.journal;
+    case TCODPATH_MAP_CHUNKED:
+      return map->chunked.journal;
+    default:
+      return NULL;
+  }
+}
+/// @brief Attach `journal` to `map`. All later writes to `map` will be recorded in `journal`.
+/// @param map Pointer to a `map`. Can be NULL.
+/// @param journal Journal to attach, or `NULL` to detach the current journal.
+static inline void TCODPATH_map_set_journal(TCODPATH_Map* __restrict map, TCODPATH_MapJournal* journal) {
+  if (!map) return;
+  switch (map->type) {
+    case TCODPATH_MAP_CALLBACK:
+      map->callback.journal = journal;
+      return;
+    case TCODPATH_MAP_CONTIGIOUS:
+      map->contigious.journal = journal;
+      return;
+    case TCODPATH_MAP_STRIDES:
+      map->strides.journal = journal;
+      return;
+    case TCODPATH_MAP_CHUNKED:
+      map->chunked.journal = journal;
+      return;
+    default:
+      return;
+  }
+}
+/// @brief Return the version of `map`, or `0` if it has no journal.
+static inline uint64_t TCODPATH_map_get_version(const TCODPATH_Map* __restrict map) {
+  const TCODPATH_MapJournal* journal = TCODPATH_map_get_journal(map);
+  return journal ? journal->version : 0;
+}
+/// @brief Record a change to the region `[begin, end)` in `journal`.
+/// @details A region which fits within an existing dirty rectangle grown by one node on each side extends that
+/// rectangle, so changes to neighboring nodes build up a single rectangle. Other regions get a new rectangle. Once all
+/// rectangles are in use the new region is merged into whichever rectangle grows the least.
+/// @param journal Journal to update. Can be NULL.
+/// @param dimensions Length of `begin` and `end`.
+/// @param begin Inclusive lower bounds of the changed region.
+/// @param end Exclusive upper bounds of the changed region.
+static inline void TCODPATH_map_journal_mark(
+    TCODPATH_MapJournal* __restrict journal,
+    int dimensions,
+    const TCODPATH_IndexType* __restrict begin,
+    const TCODPATH_IndexType* __restrict end) {
+  if (!journal || !begin || !end) return;
+  ++journal->version;
+  for (int r = 0; r < journal->dirty_count; ++r) {  // Extend a rectangle which is at most one node away
+    bool adjacent = true;
+    for (int i = 0; i < dimensions; ++i) {
+      adjacent &= begin[i] >= journal->dirty_begin[r][i] - 1 && end[i] <= journal->dirty_end[r][i] + 1;
+    }
+    if (!adjacent) continue;
+    for (int i = 0; i < dimensions; ++i) {
+      journal->dirty_begin[r][i] = TCODPATH_MIN(journal->dirty_begin[r][i], begin[i]);
+      journal->dirty_end[r][i] = TCODPATH_MAX(journal->dirty_end[r][i], end[i]);
+    }
+    return;
+  }
+  int r = journal->dirty_count;
+  if (r < TCODPATH_MAP_JOURNAL_MAX_RECTS) {  // Add a new rectangle
+    ++journal->dirty_count;
+    for (int i = 0; i < dimensions; ++i) {
+      journal->dirty_begin[r][i] = begin[i];
+      journal->dirty_end[r][i] = end[i];
+    }
+    return;
+  }
+  int64_t best_growth = INT64_MAX;  // Merge into the rectangle which grows the least
+  for (int candidate = 0; candidate < journal->dirty_count; ++candidate) {
+    int64_t volume = 1;
+    int64_t merged_volume = 1;
+    for (int i = 0; i < dimensions; ++i) {
+      volume *= journal->dirty_end[candidate][i] - journal->dirty_begin[candidate][i];
+      merged_volume *= TCODPATH_MAX(journal->dirty_end[candidate][i], end[i]) -
+                       TCODPATH_MIN(journal->dirty_begin[candidate][i], begin[i]);
+    }
+    if (merged_volume - volume >= best_growth) continue;
+    best_growth = merged_volume - volume;
+    r = candidate;
+  }
+  for (int i = 0; i < dimensions; ++i) {
+    journal->dirty_begin[r][i] = TCODPATH_MIN(journal->dirty_begin[r][i], begin[i]);
+    journal->dirty_end[r][i] = TCODPATH_MAX(journal->dirty_end[r][i], end[i]);
+  }
+}
+/// @brief Record a change to the single node `ij` in `journal`.
+static inline void TCODPATH_map_journal_mark_index(
+    TCODPATH_MapJournal* __restrict journal, int dimensions, const TCODPATH_IndexType* __restrict ij) {
+  if (!journal || !ij) return;
+  TCODPATH_IndexType end[TCODPATH_MAX_DIMENSIONS];
+  for (int i = 0; i < dimensions; ++i) end[i] = ij[i] + 1;
+  TCODPATH_map_journal_mark(journal, dimensions, ij, end);
+}
+/// @brief Record a change to every node of `map` in its journal, if it has one.
+static inline void TCODPATH_map_journal_mark_all(TCODPATH_Map* __restrict map) {
+  TCODPATH_MapJournal* journal = TCODPATH_map_get_journal(map);
+  if (!journal) return;
+  const int dimensions = TCODPATH_map_get_dimensions(map);
+  const TCODPATH_IndexType* shape = TCODPATH_map_get_shape(map);
+  if (!shape) {
+    ++journal->version;  // Unbounded maps have no rectangle to mark, only the version changes
+    return;
+  }
+  TCODPATH_IndexType begin[TCODPATH_MAX_DIMENSIONS] = {0};
+  TCODPATH_map_journal_mark(journal, dimensions, begin, shape);
+}
+/// @brief Forget all dirty rectangles of `journal`. The version is kept.
+/// Call this once everything depending on the journaled map has been refreshed.
+static inline void TCODPATH_map_journal_clear_dirty(TCODPATH_MapJournal* __restrict journal) {
+  if (!journal) return;
+  journal->dirty_count = 0;
+}
 /// @brief Return the data at `ij` in `map`
 /// @param map Pointer to a `map` with array data. Can be `NULL` or an incompatible map type.
 /// @param ij Node index. Array size must match the `map` dimensions. Can be `NULL`.
@@ -141,7 +383,196 @@ static inline void* TCODPATH_map_at(TCODPATH_Map* __restrict map, const TCODPATH
       return NULL;
   }
 }
+/// @brief Drop all tiles held by `cache`. Must be called when callback data changes without going through the map.
+static inline void TCODPATH_map_tile_cache_invalidate(TCODPATH_MapTileCache* __restrict cache) {
+  if (!cache) return;
+  for (int i = 0; i < TCODPATH_MAP_TILE_CACHE_SLOTS; ++i) cache->valid[i] = false;
+}
+/// @brief Attach `cache` to a callback `map` which has a `get_block` callback.
+/// @details Reads are then served from tiles fetched with `get_block`, so searches make one callback per tile instead
+/// of one per node. Writes through the map update the cached tiles.
+/// @param map Pointer to a callback `map`. Other map types are ignored.
+/// @param cache Cache to attach, or `NULL` to detach the current cache.
+static inline void TCODPATH_map_set_tile_cache(TCODPATH_Map* __restrict map, TCODPATH_MapTileCache* cache) {
+  if (!map || map->type != TCODPATH_MAP_CALLBACK) return;
+  TCODPATH_map_tile_cache_invalidate(cache);
+  map->callback.tile_cache = cache;
+}
+/// @brief Return true if `map` can be read from multiple threads at once.
+/// @details Chunked maps and callback maps with a tile cache update shared state on reads. The callbacks of other
+/// callback maps are assumed to be safe to call from multiple threads.
+/// @param map Pointer to a `map`. Can be NULL.
+static inline bool TCODPATH_map_is_thread_safe(const TCODPATH_Map* __restrict map) {
+  if (!map) return true;
+  switch (map->type) {
+    case TCODPATH_MAP_CALLBACK:
+      return !map->callback.tile_cache || !map->callback.get_block;
+    case TCODPATH_MAP_CHUNKED:
+      return false;
+    default:
+      return true;
+  }
+}
+/// @brief Return a pointer to the cached value at `ij`, or `NULL` if `ij` can not be cached.
+/// Used internally.
+/// @param fetch If true then a missing tile is fetched, otherwise `NULL` is returned for missing tiles.
+static inline TCODPATH_ValueType* TCODPATH_map_tile_cache_at_(
+    const struct TCODPATH_MapCallback* __restrict callback, const TCODPATH_IndexType* __restrict ij, bool fetch) {
+  TCODPATH_MapTileCache* cache = callback->tile_cache;
+  if (!cache || !callback->get_block) return NULL;
+  const int dimensions = callback->dimensions;
+  const int first_tiled_axis = dimensions >= 2 ? dimensions - 2 : 0;
+  TCODPATH_IndexType origin[TCODPATH_MAX_DIMENSIONS];
+  TCODPATH_IndexType shape[TCODPATH_MAX_DIMENSIONS];
+  size_t hash = 0;
+  for (int i = 0; i < dimensions; ++i) {
+    if (ij[i] < 0 || ij[i] >= callback->shape[i]) return NULL;  // Out-of-bounds reads go to the callback
+    if (i < first_tiled_axis) {
+      origin[i] = ij[i];
+      shape[i] = 1;
+      hash = hash * 31 + (size_t)ij[i];
+    } else {
+      origin[i] = ij[i] - ij[i] % TCODPATH_MAP_TILE_SIZE;
+      shape[i] = TCODPATH_MIN(TCODPATH_MAP_TILE_SIZE, callback->shape[i] - origin[i]);
+      hash = hash * 31 + (size_t)(ij[i] / TCODPATH_MAP_TILE_SIZE);
+    }
+  }
+  const int slot = (int)(hash % TCODPATH_MAP_TILE_CACHE_SLOTS);
+  if (!cache->valid[slot] || !TCODPATH_indexes_equal(dimensions, origin, cache->origin[slot])) {
+    if (!fetch) return NULL;
+    callback->get_block(callback->userdata, origin, shape, cache->values[slot]);
+    for (int i = 0; i < dimensions; ++i) {
+      cache->origin[slot][i] = origin[i];
+      cache->shape[slot][i] = shape[i];
+    }
+    cache->valid[slot] = true;
+    ++cache->fetches;
+  }
+  ptrdiff_t offset = 0;
+  for (int i = first_tiled_axis; i < dimensions; ++i) offset = offset * shape[i] + (ij[i] - origin[i]);
+  return &cache->values[slot][offset];
+}
+/// @brief Return the hash table slot of the chunk at `key`, which is empty if the chunk is not allocated.
+/// Used internally.
+static inline struct TCODPATH_MapChunk* TCODPATH_map_chunked_find_(
+    const struct TCODPATH_MapChunked* __restrict chunked, const TCODPATH_IndexType* __restrict key) {
+  uint64_t hash = 0;
+  for (int i = 0; i < chunked->dimensions; ++i) hash = (hash ^ (uint64_t)(uint32_t)key[i]) * 0x9E3779B97F4A7C15ULL;
+  const ptrdiff_t mask = chunked->chunk_capacity - 1;
+  for (ptrdiff_t slot = (ptrdiff_t)(hash >> 32) & mask;; slot = (slot + 1) & mask) {
+    struct TCODPATH_MapChunk* chunk = &chunked->chunks[slot];
+    if (!chunk->data || TCODPATH_indexes_equal(chunked->dimensions, key, chunk->key)) return chunk;
+  }
+}
+/// @brief Double the hash table capacity of `chunked`.
+/// Used internally.
+static inline int TCODPATH_map_chunked_grow_(struct TCODPATH_MapChunked* __restrict chunked) {
+  struct TCODPATH_MapChunk* old_chunks = chunked->chunks;
+  const ptrdiff_t old_capacity = chunked->chunk_capacity;
+  struct TCODPATH_MapChunk* new_chunks =
+      (struct TCODPATH_MapChunk*)TCODPATH_calloc_(chunked->allocator, old_capacity * 2, sizeof(*new_chunks));
+  if (!new_chunks) return TCODPATH_E_OUT_OF_MEMORY;
+  chunked->chunks = new_chunks;
+  chunked->chunk_capacity = old_capacity * 2;
+  chunked->last_chunk = NULL;
+  for (ptrdiff_t i = 0; i < old_capacity; ++i) {
+    if (old_chunks[i].data) *TCODPATH_map_chunked_find_(chunked, old_chunks[i].key) = old_chunks[i];
+  }
+  TCODPATH_free_(chunked->allocator, old_chunks, sizeof(*old_chunks) * old_capacity);
+  return TCODPATH_E_OK;
+}
+/// @brief Return a pointer to the value at `ij` in `chunked`, or `NULL` if it is out-of-bounds or not allocated.
+/// Used internally.
+/// @param create If true then a missing chunk is allocated and filled with the default value.
+static inline TCODPATH_ValueType* TCODPATH_map_chunked_at_(
+    struct TCODPATH_MapChunked* __restrict chunked, const TCODPATH_IndexType* __restrict ij, bool create) {
+  TCODPATH_IndexType key[TCODPATH_MAX_DIMENSIONS];
+  ptrdiff_t offset = 0;
+  for (int i = 0; i < chunked->dimensions; ++i) {
+    if (!chunked->unbounded && (ij[i] < 0 || ij[i] >= chunked->shape[i])) return NULL;  // Out-of-bounds
+    const TCODPATH_IndexType size = chunked->chunk_shape[i];
+    key[i] = ij[i] >= 0 ? ij[i] / size : -((-ij[i] - 1) / size) - 1;  // Floor division for negative indexes
+    offset = offset * size + (ij[i] - key[i] * size);
+  }
+  const struct TCODPATH_MapChunk* last_chunk = chunked->last_chunk;
+  if (last_chunk && TCODPATH_indexes_equal(chunked->dimensions, key, last_chunk->key)) {
+    return last_chunk->data + offset;  // Searches usually stay within one chunk
+  }
+  struct TCODPATH_MapChunk* chunk = TCODPATH_map_chunked_find_(chunked, key);
+  if (!chunk->data) {
+    if (!create) return NULL;
+    if ((chunked->chunk_count + 1) * 2 > chunked->chunk_capacity) {  // Keep the load factor at or below 50%
+      if (TCODPATH_map_chunked_grow_(chunked) < 0) return NULL;
+      chunk = TCODPATH_map_chunked_find_(chunked, key);
+    }
+    TCODPATH_ValueType* data =
+        (TCODPATH_ValueType*)TCODPATH_alloc_(chunked->allocator, sizeof(*data) * chunked->chunk_size);
+    if (!data) return NULL;
+    for (ptrdiff_t i = 0; i < chunked->chunk_size; ++i) data[i] = chunked->default_value;
+    for (int i = 0; i < chunked->dimensions; ++i) chunk->key[i] = key[i];
+    chunk->data = data;
+    ++chunked->chunk_count;
+  }
+  chunked->last_chunk = chunk;
+  return chunk->data + offset;
+}
+/// @brief Set the value at `ij` in `chunked`, only allocating a chunk if `value` is not the default value.
+/// Used internally.
+static inline void TCODPATH_map_chunked_set_(
+    struct TCODPATH_MapChunked* __restrict chunked, const TCODPATH_IndexType* __restrict ij, TCODPATH_ValueType value) {
+  TCODPATH_ValueType* at = TCODPATH_map_chunked_at_(chunked, ij, value != chunked->default_value);
+  if (at) *at = value;
+}
+/// @brief Return the byte strides of a contiguous or strided `map`.
+/// @param map Pointer to a `map`. Can be NULL.
+/// @param strides_out Output array with a length matching the `map` dimensions.
+/// @return 0 on success, negative value if `map` has no byte layout, such as callback maps.
+static inline int TCODPATH_map_get_byte_strides(const TCODPATH_Map* __restrict map, ptrdiff_t* __restrict strides_out) {
+  if (!map || !strides_out) return TCODPATH_E_INVALID_ARGUMENT;
+  switch (map->type) {
+    case TCODPATH_MAP_CONTIGIOUS: {
+      ptrdiff_t stride = TCODPATH_ABS(map->contigious.int_type);
+      for (int i = map->contigious.dimensions - 1; i >= 0; --i) {
+        strides_out[i] = stride;
+        stride *= map->contigious.shape[i];
+      }
+      return TCODPATH_E_OK;
+    }
+    case TCODPATH_MAP_STRIDES:
+      for (int i = 0; i < map->strides.dimensions; ++i) strides_out[i] = map->strides.strides[i];
+      return TCODPATH_E_OK;
+    default:
+      return TCODPATH_E_INVALID_ARGUMENT;
+  }
+}
+/// @brief Return the value stored at `at` for the integer type `int_type`.
+/// Used internally.
+static inline TCODPATH_ValueType TCODPATH_map_value_at_(int8_t int_type, const void* __restrict at) {
+  switch (int_type) {
+    case 1:
+      return (TCODPATH_ValueType)(*(uint8_t*)at);
+    case 2:
+      return (TCODPATH_ValueType)(*(uint16_t*)at);
+    case 4:
+      return (TCODPATH_ValueType)(*(uint32_t*)at);
+    case 8:
+      return (TCODPATH_ValueType)(*(uint64_t*)at);
+    case -1:
+      return (TCODPATH_ValueType)(*(int8_t*)at);
+    case -2:
+      return (TCODPATH_ValueType)(*(int16_t*)at);
+    case -4:
+      return (TCODPATH_ValueType)(*(int32_t*)at);
+    case -8:
+      return (TCODPATH_ValueType)(*(int64_t*)at);
+    default:
+      assert(0);  // int_type undefined or invalid
+      return 0;
+  }
+}
 /// @brief Return the value at `ij` in `map`.
+/// @details Reads from a chunked map or a callback map with a tile cache update the map, see
+/// `TCODPATH_map_is_thread_safe`.
 /// @param map Pointer to a `map`. Can be NULL.
 /// @param ij Node index. Array size must match the `map` dimensions. Can be `NULL`.
 /// @return The requested value, or `0` on invalid parameters.
@@ -149,33 +580,22 @@ static inline TCODPATH_ValueType TCODPATH_map_get(
     const TCODPATH_Map* __restrict map, const TCODPATH_IndexType* __restrict ij) {
   if (!map || !ij) return 0;
   switch (map->type) {
-    case TCODPATH_MAP_CALLBACK:
+    case TCODPATH_MAP_CALLBACK: {
+      const TCODPATH_ValueType* cached = TCODPATH_map_tile_cache_at_(&map->callback, ij, true);
+      if (cached) return *cached;
       return map->callback.get(map->callback.userdata, ij);
+    }
     case TCODPATH_MAP_CONTIGIOUS:
     case TCODPATH_MAP_STRIDES: {
       const void* at = TCODPATH_map_at((TCODPATH_Map*)map, ij);
       if (at == NULL) return 0;  // Out-of-bounds
-      switch (map->strides.int_type) {
-        case 1:
-          return (TCODPATH_ValueType)(*(uint8_t*)at);
-        case 2:
-          return (TCODPATH_ValueType)(*(uint16_t*)at);
-        case 4:
-          return (TCODPATH_ValueType)(*(uint32_t*)at);
-        case 8:
-          return (TCODPATH_ValueType)(*(uint64_t*)at);
-        case -1:
-          return (TCODPATH_ValueType)(*(int8_t*)at);
-        case -2:
-          return (TCODPATH_ValueType)(*(int16_t*)at);
-        case -4:
-          return (TCODPATH_ValueType)(*(int32_t*)at);
-        case -8:
-          return (TCODPATH_ValueType)(*(int64_t*)at);
-        default:
-          assert(0);  // int_type undefined or invalid
-          return 0;
-      }
+      return TCODPATH_map_value_at_(map->strides.int_type, at);
+    }
+    case TCODPATH_MAP_CHUNKED: {
+      // Reads only update the cached chunk pointer
+      const TCODPATH_ValueType* at = TCODPATH_map_chunked_at_((struct TCODPATH_MapChunked*)&map->chunked, ij, false);
+      if (at) return *at;
+      return TCODPATH_map_in_bounds(map, ij) ? map->chunked.default_value : 0;
     }
     default:
       return 0;
@@ -190,7 +610,8 @@ static inline bool TCODPATH_map_is_max(const TCODPATH_Map* __restrict map, const
 
   switch (map->type) {
     case TCODPATH_MAP_CALLBACK:
-      return map->callback.get(map->callback.userdata, ij) == TCODPATH_VALUE_MAX;
+    case TCODPATH_MAP_CHUNKED:
+      return TCODPATH_map_get(map, ij) == TCODPATH_VALUE_MAX;
     case TCODPATH_MAP_CONTIGIOUS:
     case TCODPATH_MAP_STRIDES: {
       const void* at = TCODPATH_map_at((TCODPATH_Map*)map, ij);
@@ -229,9 +650,18 @@ static inline bool TCODPATH_map_is_max(const TCODPATH_Map* __restrict map, const
 static inline void TCODPATH_map_set(
     TCODPATH_Map* __restrict map, const TCODPATH_IndexType* __restrict ij, TCODPATH_ValueType value) {
   if (!map || !ij) return;
+  TCODPATH_MapJournal* journal = TCODPATH_map_get_journal(map);
+  if (journal && TCODPATH_map_in_bounds(map, ij)) {
+    TCODPATH_map_journal_mark_index(journal, TCODPATH_map_get_dimensions(map), ij);
+  }
   switch (map->type) {
-    case TCODPATH_MAP_CALLBACK:
+    case TCODPATH_MAP_CALLBACK: {
+      TCODPATH_ValueType* cached = TCODPATH_map_tile_cache_at_(&map->callback, ij, false);
+      if (cached) *cached = value;
       return map->callback.set(map->callback.userdata, ij, value);
+    }
+    case TCODPATH_MAP_CHUNKED:
+      return TCODPATH_map_chunked_set_(&map->chunked, ij, value);
     case TCODPATH_MAP_CONTIGIOUS:
     case TCODPATH_MAP_STRIDES: {
       void* at = TCODPATH_map_at(map, ij);
@@ -275,9 +705,18 @@ static inline void TCODPATH_map_set(
 /// @param ij Node index. Array size must match the `map` dimensions. Can be `NULL`.
 static inline void TCODPATH_map_set_max(TCODPATH_Map* __restrict map, const TCODPATH_IndexType* __restrict ij) {
   if (!map || !ij) return;
+  TCODPATH_MapJournal* journal = TCODPATH_map_get_journal(map);
+  if (journal && TCODPATH_map_in_bounds(map, ij)) {
+    TCODPATH_map_journal_mark_index(journal, TCODPATH_map_get_dimensions(map), ij);
+  }
   switch (map->type) {
-    case TCODPATH_MAP_CALLBACK:
+    case TCODPATH_MAP_CALLBACK: {
+      TCODPATH_ValueType* cached = TCODPATH_map_tile_cache_at_(&map->callback, ij, false);
+      if (cached) *cached = TCODPATH_VALUE_MAX;
       return map->callback.set(map->callback.userdata, ij, TCODPATH_VALUE_MAX);
+    }
+    case TCODPATH_MAP_CHUNKED:
+      return TCODPATH_map_chunked_set_(&map->chunked, ij, TCODPATH_VALUE_MAX);
     case TCODPATH_MAP_CONTIGIOUS:
     case TCODPATH_MAP_STRIDES: {
       void* at = TCODPATH_map_at(map, ij);
@@ -316,6 +755,68 @@ static inline void TCODPATH_map_set_max(TCODPATH_Map* __restrict map, const TCOD
       return;
   }
 }
+/// @brief Copy a block of `map` into `out`.
+/// @details Callback maps with a `get_block` callback are read with a single call, other maps are read per node.
+/// @param map Pointer to a `map`.
+/// @param origin First index of the block, must be in bounds.
+/// @param shape Shape of the block, must be in bounds.
+/// @param out Output array in row-major order, with room for every node of `shape`.
+/// @return 0 on success, negative value on error.
+static inline int TCODPATH_map_get_block(
+    const TCODPATH_Map* __restrict map,
+    const TCODPATH_IndexType* __restrict origin,
+    const TCODPATH_IndexType* __restrict shape,
+    TCODPATH_ValueType* __restrict out) {
+  if (!map || !origin || !shape || !out) return TCODPATH_E_INVALID_ARGUMENT;
+  const int dimensions = TCODPATH_map_get_dimensions(map);
+  if (map->type == TCODPATH_MAP_CALLBACK && map->callback.get_block) {
+    map->callback.get_block(map->callback.userdata, origin, shape, out);
+    return TCODPATH_E_OK;
+  }
+  TCODPATH_IndexType offset[TCODPATH_MAX_DIMENSIONS];
+  TCODPATH_IndexType index[TCODPATH_MAX_DIMENSIONS];
+  for (TCODPATH_indexes_iter_begin(dimensions, offset); TCODPATH_indexes_iter_step(dimensions, shape, offset);) {
+    for (int i = 0; i < dimensions; ++i) index[i] = origin[i] + offset[i];
+    *out++ = TCODPATH_map_get(map, index);
+  }
+  return TCODPATH_E_OK;
+}
+/// @brief Copy `values` into a block of `map`.
+/// @details Callback maps with a `set_block` callback are written with a single call, other maps are written per node.
+/// The block is recorded as a single change by the map journal.
+/// @param map Pointer to a `map`.
+/// @param origin First index of the block, must be in bounds.
+/// @param shape Shape of the block, must be in bounds.
+/// @param values Input array in row-major order, with a value for every node of `shape`.
+/// @return 0 on success, negative value on error.
+static inline int TCODPATH_map_set_block(
+    TCODPATH_Map* __restrict map,
+    const TCODPATH_IndexType* __restrict origin,
+    const TCODPATH_IndexType* __restrict shape,
+    const TCODPATH_ValueType* __restrict values) {
+  if (!map || !origin || !shape || !values) return TCODPATH_E_INVALID_ARGUMENT;
+  const int dimensions = TCODPATH_map_get_dimensions(map);
+  TCODPATH_MapJournal* journal = TCODPATH_map_get_journal(map);
+  if (journal) {
+    TCODPATH_IndexType end[TCODPATH_MAX_DIMENSIONS];
+    for (int i = 0; i < dimensions; ++i) end[i] = origin[i] + shape[i];
+    TCODPATH_map_journal_mark(journal, dimensions, origin, end);
+  }
+  if (map->type == TCODPATH_MAP_CALLBACK && map->callback.set_block) {
+    map->callback.set_block(map->callback.userdata, origin, shape, values);
+    TCODPATH_map_tile_cache_invalidate(map->callback.tile_cache);
+    return TCODPATH_E_OK;
+  }
+  TCODPATH_map_set_journal(map, NULL);  // Already recorded
+  TCODPATH_IndexType offset[TCODPATH_MAX_DIMENSIONS];
+  TCODPATH_IndexType index[TCODPATH_MAX_DIMENSIONS];
+  for (TCODPATH_indexes_iter_begin(dimensions, offset); TCODPATH_indexes_iter_step(dimensions, shape, offset);) {
+    for (int i = 0; i < dimensions; ++i) index[i] = origin[i] + offset[i];
+    TCODPATH_map_set(map, index, *values++);
+  }
+  TCODPATH_map_set_journal(map, journal);
+  return TCODPATH_E_OK;
+}
 /// @brief Return the index at `ij` in `map`.
 /// @param map Pointer to a `map`. Can be NULL.
 /// @param ij Index of index. Array size must match the `map` dimensions - 1 (because the last axis is the index).
@@ -346,13 +847,410 @@ static inline void TCODPATH_map_set_index(
     TCODPATH_map_set(map, index, value[i]);
   }
 }
+/// @brief A view of one or two maps of the same shape as rows of equally spaced values.
+/// @details Axes which are contiguous in every map are merged into the row, so a contiguous map is a single row.
+/// Used internally.
+struct TCODPATH_MapRows_ {
+  int outer_dimensions;  // Number of axes which are not part of the row
+  TCODPATH_IndexType outer_shape[TCODPATH_MAX_DIMENSIONS];
+  ptrdiff_t outer_strides[2][TCODPATH_MAX_DIMENSIONS];  // Byte strides of the outer axes for each map
+  ptrdiff_t row_count;
+  ptrdiff_t row_length;
+  ptrdiff_t row_stride[2];  // Byte stride between the values of a row for each map
+  unsigned char* data[2];
+  int8_t int_type[2];
+};
+/// @brief Setup `rows` for `count` maps. Returns false if any map has no array data or the shapes differ.
+/// Used internally.
+static inline bool TCODPATH_map_rows_init_(
+    struct TCODPATH_MapRows_* __restrict rows, int count, const TCODPATH_Map* const* __restrict maps) {
+  const int dimensions = TCODPATH_map_get_dimensions(maps[0]);
+  const TCODPATH_IndexType* shape = TCODPATH_map_get_shape(maps[0]);
+  if (dimensions <= 0 || !shape) return false;
+  ptrdiff_t strides[2][TCODPATH_MAX_DIMENSIONS];
+  for (int k = 0; k < count; ++k) {
+    if (maps[k]->type != TCODPATH_MAP_CONTIGIOUS && maps[k]->type != TCODPATH_MAP_STRIDES) return false;
+    if (TCODPATH_map_get_dimensions(maps[k]) != dimensions) return false;
+    if (!TCODPATH_indexes_equal(dimensions, shape, TCODPATH_map_get_shape(maps[k]))) return false;
+    TCODPATH_map_get_byte_strides(maps[k], strides[k]);
+    rows->data[k] = maps[k]->strides.data;
+    rows->int_type[k] = maps[k]->strides.int_type;
+    rows->row_stride[k] = strides[k][dimensions - 1];
+  }
+  rows->row_length = shape[dimensions - 1];
+  int axis = dimensions - 2;
+  for (; axis >= 0; --axis) {  // Merge outer axes into the row while every map stays evenly spaced
+    bool mergeable = true;
+    for (int k = 0; k < count; ++k) mergeable &= strides[k][axis] == rows->row_stride[k] * rows->row_length;
+    if (!mergeable) break;
+    rows->row_length *= shape[axis];
+  }
+  rows->outer_dimensions = axis + 1;
+  rows->row_count = 1;
+  for (int i = 0; i < rows->outer_dimensions; ++i) {
+    rows->outer_shape[i] = shape[i];
+    rows->row_count *= shape[i];
+    for (int k = 0; k < count; ++k) rows->outer_strides[k][i] = strides[k][i];
+  }
+  return true;
+}
+/// @brief Return the first value of row `row` of map `k`.
+/// Used internally.
+static inline unsigned char* TCODPATH_map_rows_at_(
+    const struct TCODPATH_MapRows_* __restrict rows, int k, ptrdiff_t row) {
+  unsigned char* at = rows->data[k];
+  for (int i = rows->outer_dimensions - 1; i >= 0; --i) {
+    at += rows->outer_strides[k][i] * (row % rows->outer_shape[i]);
+    row /= rows->outer_shape[i];
+  }
+  return at;
+}
+// Typed row kernels. Unit-stride rows use plain indexed loops over restrict pointers so that they are vectorized.
+#define TCODPATH_MAP_ROW_KERNELS_(SUFFIX, TYPE)                                                                        \
+  static inline void TCODPATH_map_row_fill_##SUFFIX##_(                                                                \
+      unsigned char* data, ptrdiff_t stride, ptrdiff_t n, TYPE value) {                                                \
+    if (stride == (ptrdiff_t)sizeof(TYPE)) {                                                                           \
+      TYPE* __restrict row = (TYPE*)data;                                                                              \
+      for (ptrdiff_t i = 0; i < n; ++i) row[i] = value;                                                                \
+      return;                                                                                                          \
+    }                                                                                                                  \
+    for (ptrdiff_t i = 0; i < n; ++i) *(TYPE*)(data + i * stride) = value;                                             \
+  }                                                                                                                    \
+  static inline void TCODPATH_map_row_load_##SUFFIX##_(                                                                \
+      const unsigned char* data, ptrdiff_t stride, ptrdiff_t n, TCODPATH_ValueType* __restrict out) {                  \
+    if (stride == (ptrdiff_t)sizeof(TYPE)) {                                                                           \
+      const TYPE* __restrict row = (const TYPE*)data;                                                                  \
+      for (ptrdiff_t i = 0; i < n; ++i) out[i] = (TCODPATH_ValueType)row[i];                                           \
+      return;                                                                                                          \
+    }                                                                                                                  \
+    for (ptrdiff_t i = 0; i < n; ++i) out[i] = (TCODPATH_ValueType)(*(const TYPE*)(data + i * stride));                \
+  }                                                                                                                    \
+  static inline void TCODPATH_map_row_store_##SUFFIX##_(                                                               \
+      unsigned char* data, ptrdiff_t stride, ptrdiff_t n, const TCODPATH_ValueType* __restrict in) {                   \
+    if (stride == (ptrdiff_t)sizeof(TYPE)) {                                                                           \
+      TYPE* __restrict row = (TYPE*)data;                                                                              \
+      for (ptrdiff_t i = 0; i < n; ++i) row[i] = (TYPE)in[i];                                                          \
+      return;                                                                                                          \
+    }                                                                                                                  \
+    for (ptrdiff_t i = 0; i < n; ++i) *(TYPE*)(data + i * stride) = (TYPE)in[i];                                       \
+  }
+TCODPATH_MAP_ROW_KERNELS_(u8, uint8_t)
+TCODPATH_MAP_ROW_KERNELS_(u16, uint16_t)
+TCODPATH_MAP_ROW_KERNELS_(u32, uint32_t)
+TCODPATH_MAP_ROW_KERNELS_(u64, uint64_t)
+TCODPATH_MAP_ROW_KERNELS_(i8, int8_t)
+TCODPATH_MAP_ROW_KERNELS_(i16, int16_t)
+TCODPATH_MAP_ROW_KERNELS_(i32, int32_t)
+TCODPATH_MAP_ROW_KERNELS_(i64, int64_t)
+#undef TCODPATH_MAP_ROW_KERNELS_
+/// @brief Fill `n` values of type `int_type` with `value`, or with the maximum of `int_type` if `use_max` is true.
+/// Used internally.
+static inline void TCODPATH_map_row_fill_(
+    int8_t int_type, unsigned char* data, ptrdiff_t stride, ptrdiff_t n, TCODPATH_ValueType value, bool use_max) {
+  switch (int_type) {
+    case 1:
+      return TCODPATH_map_row_fill_u8_(data, stride, n, use_max ? UINT8_MAX : (uint8_t)value);
+    case 2:
+      return TCODPATH_map_row_fill_u16_(data, stride, n, use_max ? UINT16_MAX : (uint16_t)value);
+    case 4:
+      return TCODPATH_map_row_fill_u32_(data, stride, n, use_max ? UINT32_MAX : (uint32_t)value);
+    case 8:
+      return TCODPATH_map_row_fill_u64_(data, stride, n, use_max ? UINT64_MAX : (uint64_t)value);
+    case -1:
+      return TCODPATH_map_row_fill_i8_(data, stride, n, use_max ? INT8_MAX : (int8_t)value);
+    case -2:
+      return TCODPATH_map_row_fill_i16_(data, stride, n, use_max ? INT16_MAX : (int16_t)value);
+    case -4:
+      return TCODPATH_map_row_fill_i32_(data, stride, n, use_max ? INT32_MAX : (int32_t)value);
+    case -8:
+      return TCODPATH_map_row_fill_i64_(data, stride, n, use_max ? INT64_MAX : (int64_t)value);
+    default:
+      assert(0);  // int_type undefined or invalid
+      return;
+  }
+}
+/// @brief Read `n` values of type `int_type` into `out`.
+/// Used internally.
+static inline void TCODPATH_map_row_load_(
+    int8_t int_type, const unsigned char* data, ptrdiff_t stride, ptrdiff_t n, TCODPATH_ValueType* __restrict out) {
+  switch (int_type) {
+    case 1:
+      return TCODPATH_map_row_load_u8_(data, stride, n, out);
+    case 2:
+      return TCODPATH_map_row_load_u16_(data, stride, n, out);
+    case 4:
+      return TCODPATH_map_row_load_u32_(data, stride, n, out);
+    case 8:
+      return TCODPATH_map_row_load_u64_(data, stride, n, out);
+    case -1:
+      return TCODPATH_map_row_load_i8_(data, stride, n, out);
+    case -2:
+      return TCODPATH_map_row_load_i16_(data, stride, n, out);
+    case -4:
+      return TCODPATH_map_row_load_i32_(data, stride, n, out);
+    case -8:
+      return TCODPATH_map_row_load_i64_(data, stride, n, out);
+    default:
+      assert(0);  // int_type undefined or invalid
+      return;
+  }
+}
+/// @brief Write `n` values from `in` as type `int_type`.
+/// Used internally.
+static inline void TCODPATH_map_row_store_(
+    int8_t int_type, unsigned char* data, ptrdiff_t stride, ptrdiff_t n, const TCODPATH_ValueType* __restrict in) {
+  switch (int_type) {
+    case 1:
+      return TCODPATH_map_row_store_u8_(data, stride, n, in);
+    case 2:
+      return TCODPATH_map_row_store_u16_(data, stride, n, in);
+    case 4:
+      return TCODPATH_map_row_store_u32_(data, stride, n, in);
+    case 8:
+      return TCODPATH_map_row_store_u64_(data, stride, n, in);
+    case -1:
+      return TCODPATH_map_row_store_i8_(data, stride, n, in);
+    case -2:
+      return TCODPATH_map_row_store_i16_(data, stride, n, in);
+    case -4:
+      return TCODPATH_map_row_store_i32_(data, stride, n, in);
+    case -8:
+      return TCODPATH_map_row_store_i64_(data, stride, n, in);
+    default:
+      assert(0);  // int_type undefined or invalid
+      return;
+  }
+}
+
+/// @brief Fill `map` with `value`, or with the maximum value of its int type if `use_max` is true.
+/// Used internally.
+static inline int TCODPATH_map_fill_(TCODPATH_Map* __restrict map, TCODPATH_ValueType value, bool use_max) {
+  if (!map) return TCODPATH_E_INVALID_ARGUMENT;
+  if (map->type == TCODPATH_MAP_CHUNKED) {  // Drop every chunk and change the default value instead
+    for (ptrdiff_t i = 0; i < map->chunked.chunk_capacity; ++i) {
+      TCODPATH_map_chunk_free_(&map->chunked, map->chunked.chunks[i].data);
+      map->chunked.chunks[i].data = NULL;
+    }
+    map->chunked.chunk_count = 0;
+    map->chunked.last_chunk = NULL;
+    map->chunked.default_value = use_max ? TCODPATH_VALUE_MAX : value;
+    TCODPATH_map_journal_mark_all(map);
+    return TCODPATH_E_OK;
+  }
+  struct TCODPATH_MapRows_ rows;
+  const TCODPATH_Map* maps[1] = {map};
+  if (TCODPATH_map_rows_init_(&rows, 1, maps)) {
+    for (ptrdiff_t row = 0; row < rows.row_count; ++row) {
+      TCODPATH_map_row_fill_(
+          rows.int_type[0], TCODPATH_map_rows_at_(&rows, 0, row), rows.row_stride[0], rows.row_length, value, use_max);
+    }
+    TCODPATH_map_journal_mark_all(map);
+    return TCODPATH_E_OK;
+  }
+  const int dimensions = TCODPATH_map_get_dimensions(map);
+  const TCODPATH_IndexType* shape = TCODPATH_map_get_shape(map);
+  if (!shape) return TCODPATH_E_INVALID_ARGUMENT;
+  TCODPATH_MapJournal* journal = TCODPATH_map_get_journal(map);
+  TCODPATH_map_set_journal(map, NULL);  // Record this as one change instead of one per node
+  TCODPATH_IndexType index[TCODPATH_MAX_DIMENSIONS];
+  for (TCODPATH_indexes_iter_begin(dimensions, index); TCODPATH_indexes_iter_step(dimensions, shape, index);) {
+    if (use_max) {
+      TCODPATH_map_set_max(map, index);
+    } else {
+      TCODPATH_map_set(map, index, value);
+    }
+  }
+  TCODPATH_map_set_journal(map, journal);
+  TCODPATH_map_journal_mark_all(map);
+  return TCODPATH_E_OK;
+}
+/// @brief Set every value of `map` to `value`.
+/// @details Contiguous and strided maps are written one row at a time without per-node dispatch.
+/// Chunked maps free their chunks and use `value` as their new default value.
+/// @param map Pointer to a `map`.
+/// @return 0 on success, negative value on error.
+static inline int TCODPATH_map_fill(TCODPATH_Map* __restrict map, TCODPATH_ValueType value) {
+  return TCODPATH_map_fill_(map, value, false);
+}
+/// @brief Set every value of `map` to the maximum value of its int type, the same as `TCODPATH_map_set_max`.
+/// @param map Pointer to a `map`.
+/// @return 0 on success, negative value on error.
+static inline int TCODPATH_map_fill_max(TCODPATH_Map* __restrict map) { return TCODPATH_map_fill_(map, 0, true); }
 /// @brief Set all values on `map` to the maximum finite value
+/// @details Chunked maps free all of their chunks and use the maximum value as their new default value.
 /// @param map Pointer to a `map`. Can be NULL.
 static inline void TCODPATH_map_clear_max(TCODPATH_Map* __restrict map) {
   if (!map) return;
+  TCODPATH_map_fill_max(map);
+}
+/// @brief Copy every value of `source` into `dest`, converting between their int types.
+/// @details Values are converted the same way as `TCODPATH_map_set`. Maps with the same int type and layout are
+/// copied with `memcpy`.
+/// @param source Map to read. Can be any map type.
+/// @param dest Map to write, with the same shape as `source`.
+/// @return 0 on success, negative value on error.
+static inline int TCODPATH_map_copy(const TCODPATH_Map* __restrict source, TCODPATH_Map* __restrict dest) {
+  if (!source || !dest) return TCODPATH_E_INVALID_ARGUMENT;
+  const int dimensions = TCODPATH_map_get_dimensions(source);
+  const TCODPATH_IndexType* shape = TCODPATH_map_get_shape(source);
+  if (!shape || TCODPATH_map_get_dimensions(dest) != dimensions) return TCODPATH_E_INVALID_ARGUMENT;
+  const TCODPATH_IndexType* dest_shape = TCODPATH_map_get_shape(dest);
+  if (!dest_shape || !TCODPATH_indexes_equal(dimensions, shape, dest_shape)) return TCODPATH_E_INVALID_ARGUMENT;
+  struct TCODPATH_MapRows_ rows;
+  const TCODPATH_Map* maps[2] = {source, dest};
+  if (TCODPATH_map_rows_init_(&rows, 2, maps)) {
+    const bool same_layout = rows.int_type[0] == rows.int_type[1] && rows.row_stride[0] == rows.row_stride[1] &&
+                             rows.row_stride[0] == TCODPATH_ABS(rows.int_type[0]);
+    TCODPATH_ValueType buffer[TCODPATH_MAP_BULK_BLOCK];
+    for (ptrdiff_t row = 0; row < rows.row_count; ++row) {
+      const unsigned char* source_at = TCODPATH_map_rows_at_(&rows, 0, row);
+      unsigned char* dest_at = TCODPATH_map_rows_at_(&rows, 1, row);
+      if (same_layout) {
+        memcpy(dest_at, source_at, rows.row_length * rows.row_stride[0]);
+        continue;
+      }
+      for (ptrdiff_t i = 0; i < rows.row_length; i += TCODPATH_MAP_BULK_BLOCK) {
+        const ptrdiff_t n = TCODPATH_MIN(TCODPATH_MAP_BULK_BLOCK, rows.row_length - i);
+        TCODPATH_map_row_load_(rows.int_type[0], source_at + i * rows.row_stride[0], rows.row_stride[0], n, buffer);
+        TCODPATH_map_row_store_(rows.int_type[1], dest_at + i * rows.row_stride[1], rows.row_stride[1], n, buffer);
+      }
+    }
+    TCODPATH_map_journal_mark_all(dest);
+    return TCODPATH_E_OK;
+  }
+  TCODPATH_MapJournal* journal = TCODPATH_map_get_journal(dest);
+  TCODPATH_map_set_journal(dest, NULL);  // Record this as one change instead of one per node
   TCODPATH_IndexType index[TCODPATH_MAX_DIMENSIONS];
-  for (TCODPATH_indexes_iter_begin(TCODPATH_map_get_dimensions(map), index);
-       TCODPATH_indexes_iter_step(TCODPATH_map_get_dimensions(map), TCODPATH_map_get_shape(map), index);) {
+  for (TCODPATH_indexes_iter_begin(dimensions, index); TCODPATH_indexes_iter_step(dimensions, shape, index);) {
+    TCODPATH_map_set(dest, index, TCODPATH_map_get(source, index));
+  }
+  TCODPATH_map_set_journal(dest, journal);
+  TCODPATH_map_journal_mark_all(dest);
+  return TCODPATH_E_OK;
+}
+/// @brief Update the reduction outputs with `n` values.
+/// Used internally.
+static inline void TCODPATH_map_reduce_values_(
+    const TCODPATH_ValueType* __restrict values,
+    ptrdiff_t n,
+    TCODPATH_ValueType* __restrict min_value,
+    TCODPATH_ValueType* __restrict max_value,
+    int64_t* __restrict sum) {
+  TCODPATH_ValueType block_min = *min_value;
+  TCODPATH_ValueType block_max = *max_value;
+  int64_t block_sum = 0;
+  for (ptrdiff_t i = 0; i < n; ++i) {
+    block_min = TCODPATH_MIN(block_min, values[i]);
+    block_max = TCODPATH_MAX(block_max, values[i]);
+    block_sum += values[i];
+  }
+  *min_value = block_min;
+  *max_value = block_max;
+  *sum += block_sum;
+}
+/// @brief Return the minimum, maximum, and sum of every value of `map` in a single pass.
+/// @details Values are read the same way as `TCODPATH_map_get`.
+/// @param map Pointer to a `map` with a shape.
+/// @param min_out Optional output for the minimum value, `TCODPATH_VALUE_MAX` for an empty map.
+/// @param max_out Optional output for the maximum value, `TCODPATH_VALUE_MIN` for an empty map.
+/// @param sum_out Optional output for the sum of all values.
+/// @return 0 on success, negative value on error.
+static inline int TCODPATH_map_reduce(
+    const TCODPATH_Map* __restrict map,
+    TCODPATH_ValueType* __restrict min_out,
+    TCODPATH_ValueType* __restrict max_out,
+    int64_t* __restrict sum_out) {
+  if (!map) return TCODPATH_E_INVALID_ARGUMENT;
+  const int dimensions = TCODPATH_map_get_dimensions(map);
+  const TCODPATH_IndexType* shape = TCODPATH_map_get_shape(map);
+  if (!shape) return TCODPATH_E_INVALID_ARGUMENT;
+  TCODPATH_ValueType min_value = TCODPATH_VALUE_MAX;
+  TCODPATH_ValueType max_value = TCODPATH_VALUE_MIN;
+  int64_t sum = 0;
+  TCODPATH_ValueType buffer[TCODPATH_MAP_BULK_BLOCK];
+  struct TCODPATH_MapRows_ rows;
+  const TCODPATH_Map* maps[1] = {map};
+  if (TCODPATH_map_rows_init_(&rows, 1, maps)) {
+    for (ptrdiff_t row = 0; row < rows.row_count; ++row) {
+      const unsigned char* at = TCODPATH_map_rows_at_(&rows, 0, row);
+      for (ptrdiff_t i = 0; i < rows.row_length; i += TCODPATH_MAP_BULK_BLOCK) {
+        const ptrdiff_t n = TCODPATH_MIN(TCODPATH_MAP_BULK_BLOCK, rows.row_length - i);
+        TCODPATH_map_row_load_(rows.int_type[0], at + i * rows.row_stride[0], rows.row_stride[0], n, buffer);
+        TCODPATH_map_reduce_values_(buffer, n, &min_value, &max_value, &sum);
+      }
+    }
+  } else {
+    TCODPATH_IndexType index[TCODPATH_MAX_DIMENSIONS];
+    ptrdiff_t n = 0;
+    for (TCODPATH_indexes_iter_begin(dimensions, index); TCODPATH_indexes_iter_step(dimensions, shape, index);) {
+      buffer[n++] = TCODPATH_map_get(map, index);
+      if (n < TCODPATH_MAP_BULK_BLOCK) continue;
+      TCODPATH_map_reduce_values_(buffer, n, &min_value, &max_value, &sum);
+      n = 0;
+    }
+    TCODPATH_map_reduce_values_(buffer, n, &min_value, &max_value, &sum);
+  }
+  if (min_out) *min_out = min_value;
+  if (max_out) *max_out = max_value;
+  if (sum_out) *sum_out = sum;
+  return TCODPATH_E_OK;
+}
+/// @brief Write `1` to `mask` where `source` is within `[low, high]` and `0` everywhere else.
+/// @details For example a `low` of `0` and a `high` of `limit` masks every node of a distance map within `limit`.
+/// @param source Map to read.
+/// @param mask Map to write, with the same shape as `source`. Can use a different int type.
+/// @param low Lowest value to include.
+/// @param high Highest value to include.
+/// @return 0 on success, negative value on error.
+static inline int TCODPATH_map_threshold(
+    const TCODPATH_Map* __restrict source,
+    TCODPATH_Map* __restrict mask,
+    TCODPATH_ValueType low,
+    TCODPATH_ValueType high) {
+  if (!source || !mask) return TCODPATH_E_INVALID_ARGUMENT;
+  const int dimensions = TCODPATH_map_get_dimensions(source);
+  const TCODPATH_IndexType* shape = TCODPATH_map_get_shape(source);
+  if (!shape || TCODPATH_map_get_dimensions(mask) != dimensions) return TCODPATH_E_INVALID_ARGUMENT;
+  const TCODPATH_IndexType* mask_shape = TCODPATH_map_get_shape(mask);
+  if (!mask_shape || !TCODPATH_indexes_equal(dimensions, shape, mask_shape)) return TCODPATH_E_INVALID_ARGUMENT;
+  struct TCODPATH_MapRows_ rows;
+  const TCODPATH_Map* maps[2] = {source, mask};
+  if (TCODPATH_map_rows_init_(&rows, 2, maps)) {
+    TCODPATH_ValueType buffer[TCODPATH_MAP_BULK_BLOCK];
+    for (ptrdiff_t row = 0; row < rows.row_count; ++row) {
+      const unsigned char* source_at = TCODPATH_map_rows_at_(&rows, 0, row);
+      unsigned char* mask_at = TCODPATH_map_rows_at_(&rows, 1, row);
+      for (ptrdiff_t i = 0; i < rows.row_length; i += TCODPATH_MAP_BULK_BLOCK) {
+        const ptrdiff_t n = TCODPATH_MIN(TCODPATH_MAP_BULK_BLOCK, rows.row_length - i);
+        TCODPATH_map_row_load_(rows.int_type[0], source_at + i * rows.row_stride[0], rows.row_stride[0], n, buffer);
+        for (ptrdiff_t j = 0; j < n; ++j) buffer[j] = low <= buffer[j] && buffer[j] <= high;
+        TCODPATH_map_row_store_(rows.int_type[1], mask_at + i * rows.row_stride[1], rows.row_stride[1], n, buffer);
+      }
+    }
+    TCODPATH_map_journal_mark_all(mask);
+    return TCODPATH_E_OK;
+  }
+  TCODPATH_MapJournal* journal = TCODPATH_map_get_journal(mask);
+  TCODPATH_map_set_journal(mask, NULL);  // Record this as one change instead of one per node
+  TCODPATH_IndexType index[TCODPATH_MAX_DIMENSIONS];
+  for (TCODPATH_indexes_iter_begin(dimensions, index); TCODPATH_indexes_iter_step(dimensions, shape, index);) {
+    const TCODPATH_ValueType value = TCODPATH_map_get(source, index);
+    TCODPATH_map_set(mask, index, low <= value && value <= high);
+  }
+  TCODPATH_map_set_journal(mask, journal);
+  TCODPATH_map_journal_mark_all(mask);
+  return TCODPATH_E_OK;
+}
+/// @brief Set only the nodes recorded in `touched` to their maximum value, emptying `touched`.
+/// @details This undoes a search which recorded its touched nodes in O(touched) instead of O(map).
+/// @param map Pointer to a `map`. Can be NULL.
+/// @param touched Contiguous indexes matching the dimensions of `map`. Can be NULL.
+static inline void TCODPATH_map_reset_touched(TCODPATH_Map* __restrict map, TCODPATH_RingBuffer* __restrict touched) {
+  if (!map || !touched) return;
+  const ptrdiff_t index_size = sizeof(TCODPATH_IndexType) * TCODPATH_map_get_dimensions(map);
+  TCODPATH_IndexType index[TCODPATH_MAX_DIMENSIONS];
+  while (touched->used_bytes >= index_size && index_size > 0) {
+    TCODPATH_ring_buffer_pop(touched, index_size, index);
     TCODPATH_map_set_max(map, index);
-  };
+  }
 }
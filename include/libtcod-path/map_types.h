@@ -1,8 +1,10 @@
 #pragma once
 
 #include <stdbool.h>
+#include <stddef.h>
 #include <stdint.h>
 
+#include "allocator_types.h"
 #include "config.h"
 
 /// @brief Enum tags for map unions.
@@ -11,8 +13,42 @@ typedef enum TCODPATH_MapTypes {
   TCODPATH_MAP_CALLBACK = 1,
   TCODPATH_MAP_CONTIGIOUS = 2,
   TCODPATH_MAP_STRIDES = 3,
+  TCODPATH_MAP_CHUNKED = 4,
 } TCODPATH_MapTypes;
 
+/// @brief Optional record of when and where a map was changed.
+/// @details Attach to a map with `TCODPATH_map_set_journal`. Can be used right away from a zeroed state.
+typedef struct TCODPATH_MapJournal {
+  uint64_t version;  // Incremented on every recorded change, never reset
+  int dirty_count;  // Number of active dirty rectangles
+  TCODPATH_IndexType dirty_begin[TCODPATH_MAP_JOURNAL_MAX_RECTS][TCODPATH_MAX_DIMENSIONS];  // Inclusive lower bounds
+  TCODPATH_IndexType dirty_end[TCODPATH_MAP_JOURNAL_MAX_RECTS][TCODPATH_MAX_DIMENSIONS];  // Exclusive upper bounds
+} TCODPATH_MapJournal;
+
+/// @brief Optional cache of tiles fetched in bulk from a callback map.
+/// @details Tiles cover `TCODPATH_MAP_TILE_SIZE` nodes along the last two axes and one node along any other axes.
+/// Attach to a map with `TCODPATH_map_set_tile_cache`. Can be used right away from a zeroed state.
+/// Reads fill the cache, so a map with a tile cache must not be read from multiple threads at once.
+typedef struct TCODPATH_MapTileCache {
+  bool valid[TCODPATH_MAP_TILE_CACHE_SLOTS];
+  TCODPATH_IndexType origin[TCODPATH_MAP_TILE_CACHE_SLOTS][TCODPATH_MAX_DIMENSIONS];  // First index of each tile
+  TCODPATH_IndexType shape[TCODPATH_MAP_TILE_CACHE_SLOTS][TCODPATH_MAX_DIMENSIONS];  // Tile shapes, clipped to the map
+  TCODPATH_ValueType values[TCODPATH_MAP_TILE_CACHE_SLOTS][TCODPATH_MAP_TILE_SIZE * TCODPATH_MAP_TILE_SIZE];
+  uint64_t fetches;  // Number of tiles fetched so far
+} TCODPATH_MapTileCache;
+
+/// @brief Read or write a block of nodes at once, the block is a row-major array of `shape` starting at `origin`.
+typedef void TCODPATH_MapBlockGet(
+    void* userdata,
+    const TCODPATH_IndexType* __restrict origin,
+    const TCODPATH_IndexType* __restrict shape,
+    TCODPATH_ValueType* __restrict out);
+typedef void TCODPATH_MapBlockSet(
+    void* userdata,
+    const TCODPATH_IndexType* __restrict origin,
+    const TCODPATH_IndexType* __restrict shape,
+    const TCODPATH_ValueType* __restrict values);
+
 /// @brief Map data based on a callback.
 struct TCODPATH_MapCallback {
   TCODPATH_MapTypes type;  // Must be TCODPATH_MAP_CALLBACK
@@ -21,6 +57,10 @@ struct TCODPATH_MapCallback {
   void* userdata;
   TCODPATH_ValueType (*get)(void* userdata, const TCODPATH_IndexType* __restrict ij);  // Get callback
   void (*set)(void* userdata, const TCODPATH_IndexType* __restrict ij, TCODPATH_ValueType v);  // Set callback
+  TCODPATH_MapJournal* journal;  // Optional change journal, can be NULL
+  TCODPATH_MapBlockGet* get_block;  // Optional bulk get callback, can be NULL
+  TCODPATH_MapBlockSet* set_block;  // Optional bulk set callback, can be NULL
+  TCODPATH_MapTileCache* tile_cache;  // Optional cache of tiles from `get_block`, can be NULL
 };
 /// @brief Contigious map data.
 struct TCODPATH_MapContigious {
@@ -30,6 +70,8 @@ struct TCODPATH_MapContigious {
   int8_t int_type;  // data array integer byte-size plus sign: -4=int32_t, 1=uint8_t, etc
   unsigned char* __restrict data;  // Pointer to contigious integer array
   bool owned_data;  // If true then data pointer will be freed when this object is deleted
+  TCODPATH_MapJournal* journal;  // Optional change journal, can be NULL
+  TCODPATH_Allocator* allocator;  // Allocator of owned data, NULL for the global allocator
 };
 /// @brief Non-contigious map data.
 struct TCODPATH_MapStrides {
@@ -39,6 +81,30 @@ struct TCODPATH_MapStrides {
   int8_t int_type;  // data array integer byte-size plus sign: -4=int32_t, 1=uint8_t, etc
   unsigned char* __restrict data;  // Pointer to strided integer array
   ptrdiff_t strides[TCODPATH_MAX_DIMENSIONS];  // Strides for each axis in bytes
+  TCODPATH_MapJournal* journal;  // Optional change journal, can be NULL
+};
+
+/// @brief A chunk of `TCODPATH_MapChunked` stored in its hash table.
+struct TCODPATH_MapChunk {
+  TCODPATH_IndexType key[TCODPATH_MAX_DIMENSIONS];  // Chunk coordinates, the index divided by the chunk shape
+  TCODPATH_ValueType* data;  // Chunk values in row-major order, or NULL for an empty slot
+};
+/// @brief Sparse map data stored in fixed-size chunks, which are only allocated when written to.
+/// @details Must be setup with `TCODPATH_map_init_chunked` and freed with `TCODPATH_map_uninit`.
+struct TCODPATH_MapChunked {
+  TCODPATH_MapTypes type;  // Must be TCODPATH_MAP_CHUNKED
+  int dimensions;
+  TCODPATH_IndexType shape[TCODPATH_MAX_DIMENSIONS];
+  bool unbounded;  // If true then `shape` is ignored and every index is in bounds
+  TCODPATH_IndexType chunk_shape[TCODPATH_MAX_DIMENSIONS];
+  ptrdiff_t chunk_size;  // Number of values in each chunk
+  TCODPATH_ValueType default_value;  // Value of every node in an unallocated chunk
+  struct TCODPATH_MapChunk* __restrict chunks;  // Open-addressing hash table of chunks
+  ptrdiff_t chunk_capacity;  // Size of the `chunks` table, always a power of 2
+  ptrdiff_t chunk_count;  // Number of allocated chunks
+  const struct TCODPATH_MapChunk* last_chunk;  // The most recently used chunk, checked before the hash table
+  TCODPATH_MapJournal* journal;  // Optional change journal, can be NULL
+  TCODPATH_Allocator* allocator;  // Allocator of the chunks and their table, NULL for the global allocator
 };
 
 /// @brief Union type for tile maps.
@@ -47,4 +113,5 @@ typedef union TCODPATH_Map {
   struct TCODPATH_MapCallback callback;
   struct TCODPATH_MapContigious contigious;
   struct TCODPATH_MapStrides strides;
+  struct TCODPATH_MapChunked chunked;
 } TCODPATH_Map;
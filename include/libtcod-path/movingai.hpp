@@ -0,0 +1,317 @@
+#pragma once
+
+#include <libtcod-path/map.hpp>
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <istream>
+#include <limits>
+#include <ostream>
+#include <queue>
+#include <random>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace tcod::path {
+/// @brief A grid map in the Moving AI benchmark format.
+/// @details See specification: https://movingai.com/benchmarks/formats.html
+struct MovingAIMap {
+  int width{};
+  int height{};
+  std::vector<std::string> tiles{};  // Tile characters indexed by `tiles[y][x]`
+
+  /// @brief Return true if `tile` is passable terrain.
+  /// @details Swamp is treated as regular terrain. Water is impassable since it can not be entered from terrain.
+  static constexpr auto is_passable(char tile) noexcept -> bool { return tile == '.' || tile == 'G' || tile == 'S'; }
+  auto is_passable(int x, int y) const noexcept -> bool {
+    return 0 <= x && x < width && 0 <= y && y < height && is_passable(tiles[y][x]);
+  }
+  /// @brief Return a cost map with 1 for passable tiles and 0 for everything else.
+  auto to_costs() const -> Map2D<> {
+    auto costs = Map2D<>{std::array{height, width}};
+    for (int y = 0; y < height; ++y) {
+      for (int x = 0; x < width; ++x) costs[{y, x}] = is_passable(tiles[y][x]);
+    }
+    return costs;
+  }
+};
+
+/// @brief A single query from a Moving AI scenario file.
+struct MovingAIScenario {
+  int bucket{};  // Queries are grouped by length, usually `optimal_length / 4`
+  std::string map{};  // Map file name as written in the scenario file
+  int map_width{};
+  int map_height{};
+  int start_x{};
+  int start_y{};
+  int goal_x{};
+  int goal_y{};
+  double optimal_length{};  // Octile length with a cost of 1 for cardinal and sqrt(2) for diagonal moves
+};
+
+/// @brief Parse a Moving AI `.map` file from `in`. Throws `std::runtime_error` on malformed input.
+inline auto load_movingai_map(std::istream& in) -> MovingAIMap {
+  auto map = MovingAIMap{};
+  auto keyword = std::string{};
+  auto type = std::string{};
+  if (!(in >> keyword >> type) || keyword != "type") throw std::runtime_error("map is missing its type header");
+  while (in >> keyword && keyword != "map") {
+    if (keyword == "height") {
+      in >> map.height;
+    } else if (keyword == "width") {
+      in >> map.width;
+    } else {
+      throw std::runtime_error("unknown map header: " + keyword);
+    }
+  }
+  if (keyword != "map" || map.width <= 0 || map.height <= 0) throw std::runtime_error("map has an invalid header");
+  in >> std::ws;
+  map.tiles.resize(map.height);
+  for (auto& row : map.tiles) {
+    if (!std::getline(in, row)) throw std::runtime_error("map has too few rows");
+    if (!row.empty() && row.back() == '\r') row.pop_back();
+    if (static_cast<int>(row.size()) < map.width) throw std::runtime_error("map has a row which is too short");
+    row.resize(map.width);
+  }
+  return map;
+}
+/// @brief Load a Moving AI `.map` file from `path`.
+inline auto load_movingai_map(const std::string& path) -> MovingAIMap {
+  auto file = std::ifstream{path};
+  if (!file) throw std::runtime_error("could not open map: " + path);
+  return load_movingai_map(file);
+}
+/// @brief Write `map` to `out` in the Moving AI `.map` format.
+inline void save_movingai_map(std::ostream& out, const MovingAIMap& map) {
+  out << "type octile\nheight " << map.height << "\nwidth " << map.width << "\nmap\n";
+  for (const auto& row : map.tiles) out << row << '\n';
+}
+
+/// @brief Parse a Moving AI `.scen` file from `in`. Throws `std::runtime_error` on malformed input.
+inline auto load_movingai_scenarios(std::istream& in) -> std::vector<MovingAIScenario> {
+  auto scenarios = std::vector<MovingAIScenario>{};
+  auto line = std::string{};
+  for (bool first = true; std::getline(in, line); first = false) {
+    if (first && line.rfind("version", 0) == 0) continue;  // Version 0 files have no header
+    if (line.find_first_not_of(" \t\r") == std::string::npos) continue;
+    auto parts = std::istringstream{line};
+    auto& it = scenarios.emplace_back();
+    parts >> it.bucket >> it.map >> it.map_width >> it.map_height >> it.start_x >> it.start_y >> it.goal_x >>
+        it.goal_y >> it.optimal_length;
+    if (!parts) throw std::runtime_error("malformed scenario: " + line);
+  }
+  return scenarios;
+}
+/// @brief Load a Moving AI `.scen` file from `path`.
+inline auto load_movingai_scenarios(const std::string& path) -> std::vector<MovingAIScenario> {
+  auto file = std::ifstream{path};
+  if (!file) throw std::runtime_error("could not open scenarios: " + path);
+  return load_movingai_scenarios(file);
+}
+/// @brief Write `scenarios` to `out` in the version 1 `.scen` format.
+inline void save_movingai_scenarios(std::ostream& out, const std::vector<MovingAIScenario>& scenarios) {
+  out << "version 1\n";
+  const auto flags = out.flags();
+  out << std::fixed << std::setprecision(8);
+  for (const auto& it : scenarios) {
+    out << it.bucket << '\t' << it.map << '\t' << it.map_width << '\t' << it.map_height << '\t' << it.start_x << '\t'
+        << it.start_y << '\t' << it.goal_x << '\t' << it.goal_y << '\t' << it.optimal_length << '\n';
+  }
+  out.flags(flags);
+}
+
+/// @brief Return the exact octile distance from `(start_x, start_y)` to every tile of `map`, following the Moving AI
+/// rules: diagonal moves cost sqrt(2) and may not cut corners.
+/// @details This is a plain double precision Dijkstra kept separate from the library, so it can be used as an
+/// independent reference. Unreachable tiles are infinite. The result is indexed by `y * width + x`.
+inline auto movingai_octile_distances(const MovingAIMap& map, int start_x, int start_y) -> std::vector<double> {
+  constexpr double INF = std::numeric_limits<double>::infinity();
+  auto distance = std::vector<double>(static_cast<size_t>(map.width) * map.height, INF);
+  if (!map.is_passable(start_x, start_y)) return distance;
+  using Node = std::pair<double, int>;
+  auto frontier = std::priority_queue<Node, std::vector<Node>, std::greater<Node>>{};
+  distance[start_y * map.width + start_x] = 0;
+  frontier.emplace(0.0, start_y * map.width + start_x);
+  while (!frontier.empty()) {
+    const auto [here, id] = frontier.top();
+    frontier.pop();
+    if (here > distance[id]) continue;
+    const int x = id % map.width;
+    const int y = id / map.width;
+    for (int dy = -1; dy <= 1; ++dy) {
+      for (int dx = -1; dx <= 1; ++dx) {
+        if (dx == 0 && dy == 0) continue;
+        if (!map.is_passable(x + dx, y + dy)) continue;
+        if (dx != 0 && dy != 0 && (!map.is_passable(x + dx, y) || !map.is_passable(x, y + dy))) continue;
+        const double next = here + (dx != 0 && dy != 0 ? std::sqrt(2.0) : 1.0);
+        const int next_id = (y + dy) * map.width + (x + dx);
+        if (next >= distance[next_id]) continue;
+        distance[next_id] = next;
+        frontier.emplace(next, next_id);
+      }
+    }
+  }
+  return distance;
+}
+
+/// @brief Kinds of synthetic benchmark maps.
+enum class SyntheticMapType {
+  open,  // Open terrain with scattered rectangular obstacles
+  rooms,  // A grid of square rooms connected by doors
+  maze,  // A perfect maze with corridors of a fixed width
+};
+
+/// @brief Options for `generate_synthetic_map`.
+struct SyntheticMapOptions {
+  SyntheticMapType type{SyntheticMapType::open};
+  int width{256};
+  int height{256};
+  /// Obstacle size for open maps, room size for room maps, or corridor width for mazes
+  int feature_size{8};
+  std::uint32_t seed{};
+};
+
+/// @brief Generate a map similar to the synthetic sets of the Moving AI benchmarks, so benchmarks can run offline.
+/// @details The output only depends on `options`, the same seed gives the same map on every platform.
+inline auto generate_synthetic_map(const SyntheticMapOptions& options) -> MovingAIMap {
+  if (options.width <= 0 || options.height <= 0 || options.feature_size <= 0) {
+    throw std::invalid_argument("synthetic map sizes must be positive");
+  }
+  auto rng = std::mt19937{options.seed};
+  auto random_below = [&rng](int n) { return n > 0 ? static_cast<int>(rng() % static_cast<std::uint32_t>(n)) : 0; };
+  auto map = MovingAIMap{options.width, options.height, {}};
+  auto fill = [&map](int x0, int y0, int x1, int y1, char tile) {
+    for (int y = std::max(y0, 0); y < std::min(y1, map.height); ++y) {
+      for (int x = std::max(x0, 0); x < std::min(x1, map.width); ++x) map.tiles[y][x] = tile;
+    }
+  };
+  const int size = options.feature_size;
+  switch (options.type) {
+    case SyntheticMapType::open: {
+      map.tiles.assign(map.height, std::string(map.width, '.'));
+      const int obstacles = map.width * map.height / (size * size * 2);  // Around 10% coverage after overlaps
+      for (int i = 0; i < obstacles; ++i) {
+        const int w = 1 + random_below(size);
+        const int h = 1 + random_below(size);
+        const int x = random_below(map.width);
+        const int y = random_below(map.height);
+        fill(x, y, x + w, y + h, '@');
+      }
+    } break;
+    case SyntheticMapType::rooms: {
+      map.tiles.assign(map.height, std::string(map.width, '.'));
+      const int pitch = size + 1;  // Each room plus the wall on its top and left
+      for (int y = 0; y < map.height; y += pitch) fill(0, y, map.width, y + 1, '@');
+      for (int x = 0; x < map.width; x += pitch) fill(x, 0, x + 1, map.height, '@');
+      for (int room_y = 0; room_y * pitch < map.height; ++room_y) {
+        for (int room_x = 0; room_x * pitch < map.width; ++room_x) {
+          const int x = room_x * pitch;
+          const int y = room_y * pitch;
+          // Open a door in the top and left walls, or sometimes remove the wall entirely
+          if (room_y > 0) {
+            const int door = x + 1 + random_below(size);
+            if (random_below(8) == 0) {
+              fill(x + 1, y, x + pitch, y + 1, '.');
+            } else {
+              fill(door, y, door + 1, y + 1, '.');
+            }
+          }
+          if (room_x > 0) {
+            const int door = y + 1 + random_below(size);
+            if (random_below(8) == 0) {
+              fill(x, y + 1, x + 1, y + pitch, '.');
+            } else {
+              fill(x, door, x + 1, door + 1, '.');
+            }
+          }
+        }
+      }
+    } break;
+    case SyntheticMapType::maze: {
+      map.tiles.assign(map.height, std::string(map.width, '@'));
+      const int pitch = size * 2;  // Each cell is a corridor square followed by a wall of the same width
+      const int cells_x = std::max(1, (map.width + size) / pitch);
+      const int cells_y = std::max(1, (map.height + size) / pitch);
+      auto visited = std::vector<bool>(static_cast<size_t>(cells_x) * cells_y);
+      auto stack = std::vector<int>{0};  // Recursive backtracker over cell ids
+      visited[0] = true;
+      fill(0, 0, size, size, '.');
+      while (!stack.empty()) {
+        const int cell = stack.back();
+        const int cx = cell % cells_x;
+        const int cy = cell / cells_x;
+        int neighbors[4];
+        int neighbor_count = 0;
+        if (cx > 0 && !visited[cell - 1]) neighbors[neighbor_count++] = cell - 1;
+        if (cx < cells_x - 1 && !visited[cell + 1]) neighbors[neighbor_count++] = cell + 1;
+        if (cy > 0 && !visited[cell - cells_x]) neighbors[neighbor_count++] = cell - cells_x;
+        if (cy < cells_y - 1 && !visited[cell + cells_x]) neighbors[neighbor_count++] = cell + cells_x;
+        if (neighbor_count == 0) {
+          stack.pop_back();
+          continue;
+        }
+        const int next = neighbors[random_below(neighbor_count)];
+        const int nx = next % cells_x;
+        const int ny = next / cells_x;
+        visited[next] = true;
+        fill(std::min(cx, nx) * pitch, std::min(cy, ny) * pitch, std::max(cx, nx) * pitch + size,
+             std::max(cy, ny) * pitch + size, '.');
+        stack.push_back(next);
+      }
+    } break;
+  }
+  return map;
+}
+
+/// @brief Generate `count` random queries on `map` with exact optimal lengths, sorted by bucket.
+/// @details Buckets follow the Moving AI convention of `optimal_length / 4`. Start and goal are always connected.
+/// @param map Map to generate queries for.
+/// @param map_name Name written to the `map` field of each scenario.
+/// @param count Number of queries.
+/// @param seed Random seed.
+/// @param goals_per_start Number of goals sharing a start, each start costs one full Dijkstra pass over `map`.
+inline auto generate_movingai_scenarios(
+    const MovingAIMap& map, const std::string& map_name, int count, std::uint32_t seed, int goals_per_start = 16)
+    -> std::vector<MovingAIScenario> {
+  auto passable = std::vector<int>{};
+  for (int y = 0; y < map.height; ++y) {
+    for (int x = 0; x < map.width; ++x) {
+      if (map.is_passable(x, y)) passable.push_back(y * map.width + x);
+    }
+  }
+  auto scenarios = std::vector<MovingAIScenario>{};
+  if (passable.size() < 2) return scenarios;
+  auto rng = std::mt19937{seed};
+  auto random_tile = [&]() { return passable[rng() % passable.size()]; };
+  for (int attempts = 0; static_cast<int>(scenarios.size()) < count && attempts < count * 4; ++attempts) {
+    const int start = random_tile();
+    const auto distance = movingai_octile_distances(map, start % map.width, start / map.width);
+    for (int i = 0; i < goals_per_start && static_cast<int>(scenarios.size()) < count; ++i) {
+      const int goal = random_tile();
+      if (goal == start || !std::isfinite(distance[goal])) continue;
+      scenarios.push_back(MovingAIScenario{
+          static_cast<int>(distance[goal] / 4),
+          map_name,
+          map.width,
+          map.height,
+          start % map.width,
+          start / map.width,
+          goal % map.width,
+          goal / map.width,
+          distance[goal]});
+    }
+  }
+  std::stable_sort(scenarios.begin(), scenarios.end(), [](const auto& lhs, const auto& rhs) {
+    return lhs.bucket < rhs.bucket;
+  });
+  return scenarios;
+}
+}  // namespace tcod::path
@@ -5,9 +5,11 @@
 
 #include "graph_tools.h"
 #include "graph_types.h"
+#include "indexes.h"
 #include "map_tools.h"
 #include "map_types.h"
-#include "ring_buffer.h"
+#include "queue.h"
+#include "search_stats.h"
 
 static inline void TCODPATH_partition_set_bool_if_open(
     void* userdata, const TCODPATH_IndexType*, const TCODPATH_IndexType*, TCODPATH_ValueType) {
@@ -15,10 +17,11 @@ static inline void TCODPATH_partition_set_bool_if_open(
 }
 
 struct TCODPATH_FloodFill_ {
-  TCODPATH_RingBuffer frontier;
+  TCODPATH_Queue frontier;
   TCODPATH_Graph* graph;
   TCODPATH_Map* __restrict map;
   TCODPATH_ValueType value;
+  TCODPATH_SearchStats* __restrict stats;
 };
 
 static inline void TCODPATH_partition_flood_fill(
@@ -26,22 +29,52 @@ static inline void TCODPATH_partition_flood_fill(
   struct TCODPATH_FloodFill_* data = (struct TCODPATH_FloodFill_*)userdata;
   if (TCODPATH_map_get(data->map, leaf_index) != 0) return;
   TCODPATH_map_set(data->map, leaf_index, data->value);
-  TCODPATH_ring_buffer_append(
-      &data->frontier, sizeof(*leaf_index) * TCODPATH_map_get_dimensions(data->map), leaf_index);
+#if TCODPATH_STATS_ENABLED
+  const ptrdiff_t old_capacity = data->frontier.capacity;
+#endif
+  TCODPATH_queue_push(&data->frontier, leaf_index);
+  TCODPATH_STATS_ADD(data->stats, pushes, 1);
+  TCODPATH_STATS_MAX(data->stats, peak_frontier, data->frontier.size);
+  TCODPATH_STATS_ADD(
+      data->stats, bytes_allocated, (data->frontier.capacity - old_capacity) * data->frontier.element_size);
 }
 
-static inline int TCODPATH_partition_from_graph(TCODPATH_Graph* __restrict graph, TCODPATH_Map* __restrict out) {
+/// @brief Return true if `goal` might be reachable from `start` according to the labels of `partition`.
+/// @details This is an O(1) test which assumes that connectivity is symmetric, as it is for 2D graphs.
+/// @param partition Labels from `TCODPATH_partition_from_graph` or any map with equivalent labels.
+/// @param start Start index, must match the dimensions of `partition`.
+/// @param goal Goal index, must match the dimensions of `partition`.
+/// @return False if `goal` is known to be unreachable.
+static inline bool TCODPATH_partition_is_reachable(
+    const TCODPATH_Map* __restrict partition,
+    const TCODPATH_IndexType* __restrict start,
+    const TCODPATH_IndexType* __restrict goal) {
+  if (!partition) return true;  // Unknown connectivity
+  if (TCODPATH_indexes_equal(TCODPATH_map_get_dimensions(partition), start, goal)) return true;
+  const TCODPATH_ValueType start_label = TCODPATH_map_get(partition, start);
+  if (start_label == 0) return false;  // Start has no edges
+  return start_label == TCODPATH_map_get(partition, goal);
+}
+/// @brief Label the connected components of `graph` on `out`, updating `stats`. See `TCODPATH_partition_from_graph`.
+/// @param graph Graph to label.
+/// @param out Output map of labels.
+/// @param stats Optional counters to update, the time spent is added to the partition phase. Can be `NULL`.
+/// @return The number of components, which are labeled from `1` onwards.
+static inline int TCODPATH_partition_from_graph_with_stats(
+    TCODPATH_Graph* __restrict graph, TCODPATH_Map* __restrict out, TCODPATH_SearchStats* __restrict stats) {
+  const int64_t begin_ns = TCODPATH_stats_phase_begin_(stats);
   const int dimensions = TCODPATH_map_get_dimensions(out);
   const TCODPATH_IndexType* shape = TCODPATH_map_get_shape(out);
   TCODPATH_IndexType index[TCODPATH_MAX_DIMENSIONS];
+  TCODPATH_MapJournal* journal = TCODPATH_map_get_journal(out);
+  TCODPATH_map_set_journal(out, NULL);  // Record this as one change instead of one per node
 
-  // Clear map
-  for (TCODPATH_indexes_iter_begin(dimensions, index); TCODPATH_indexes_iter_step(dimensions, shape, index);) {
-    TCODPATH_map_set(out, index, 0);
-  }
+  TCODPATH_map_fill(out, 0);
   // Partition map
   TCODPATH_ValueType total_partitions = 0;
   struct TCODPATH_FloodFill_ flood_fill_data = {};
+  flood_fill_data.stats = stats;
+  TCODPATH_queue_init(&flood_fill_data.frontier, sizeof(*index) * dimensions);
   for (TCODPATH_indexes_iter_begin(dimensions, index); TCODPATH_indexes_iter_step(dimensions, shape, index);) {
     if (TCODPATH_map_get(out, index) != 0) continue;  // Partition already known for this index
     bool is_open = false;
@@ -52,14 +85,25 @@ static inline int TCODPATH_partition_from_graph(TCODPATH_Graph* __restrict graph
     flood_fill_data.map = out;
     flood_fill_data.value = total_partitions;
     TCODPATH_partition_flood_fill(&flood_fill_data, NULL, index, 0);
-    while (flood_fill_data.frontier.used_bytes) {  // Until ring buffer is empty
+    while (flood_fill_data.frontier.size) {  // Until the queue is empty
       TCODPATH_IndexType next_index[TCODPATH_MAX_DIMENSIONS];
-      TCODPATH_ring_buffer_pop(&flood_fill_data.frontier, sizeof(*index) * dimensions, next_index);
+      TCODPATH_queue_pop(&flood_fill_data.frontier, next_index);
       TCODPATH_map_set(out, next_index, total_partitions);
+      TCODPATH_STATS_ADD(stats, expansions, 1);
       TCODPATH_graph_foreach_edge(
           graph, dimensions, next_index, TCODPATH_partition_flood_fill, (void*)&flood_fill_data);
     }
   }
-  TCODPATH_ring_buffer_uninit(&flood_fill_data.frontier);
+  TCODPATH_queue_uninit(&flood_fill_data.frontier);
+  TCODPATH_map_set_journal(out, journal);
+  TCODPATH_map_journal_mark_all(out);
+  TCODPATH_stats_phase_end_(stats, TCODPATH_STATS_PHASE_PARTITION, begin_ns);
   return total_partitions;
 }
+/// @brief Label the connected components of `graph` on `out`. Nodes without edges are labeled `0`.
+/// @param graph Graph to label.
+/// @param out Output map of labels.
+/// @return The number of components, which are labeled from `1` onwards.
+static inline int TCODPATH_partition_from_graph(TCODPATH_Graph* __restrict graph, TCODPATH_Map* __restrict out) {
+  return TCODPATH_partition_from_graph_with_stats(graph, out, NULL);
+}
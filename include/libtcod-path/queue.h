@@ -0,0 +1,118 @@
+#pragma once
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "allocator.h"
+#include "error.h"
+#include "queue_types.h"
+#include "utility.h"
+
+/// @brief Smallest capacity allocated by a queue.
+#define TCODPATH_QUEUE_MIN_CAPACITY 64
+
+/// @brief Setup an empty queue for elements of `element_size` bytes.
+/// @return 0 on success, negative value on error.
+static inline int TCODPATH_queue_init(TCODPATH_Queue* __restrict queue, ptrdiff_t element_size) {
+  if (!queue || element_size <= 0) return TCODPATH_E_INVALID_ARGUMENT;
+  *queue = TCODPATH_Queue{};
+  queue->element_size = element_size;
+  return TCODPATH_E_OK;
+}
+/// @brief Free the elements of a queue and reset it to the default zero state.
+static inline void TCODPATH_queue_uninit(TCODPATH_Queue* __restrict queue) {
+  if (!queue) return;
+  TCODPATH_free_(queue->allocator, queue->data, queue->capacity * queue->element_size);
+  *queue = TCODPATH_Queue{};
+}
+/// @brief Remove all elements from a queue, keeping its capacity.
+static inline void TCODPATH_queue_clear(TCODPATH_Queue* __restrict queue) { queue->head = queue->size = 0; }
+/// @brief Copy `n` elements starting at `position` out of the queue with at most two copies.
+/// Used internally.
+static inline void TCODPATH_queue_read_(
+    const TCODPATH_Queue* __restrict queue, ptrdiff_t position, ptrdiff_t n, unsigned char* __restrict out) {
+  const ptrdiff_t begin = position & (queue->capacity - 1);
+  const ptrdiff_t first = TCODPATH_MIN(n, queue->capacity - begin);
+  memcpy(out, queue->data + begin * queue->element_size, first * queue->element_size);
+  if (n > first) memcpy(out + first * queue->element_size, queue->data, (n - first) * queue->element_size);
+}
+/// @brief Copy `n` elements into the queue starting at `position` with at most two copies.
+/// Used internally.
+static inline void TCODPATH_queue_write_(
+    TCODPATH_Queue* __restrict queue, ptrdiff_t position, ptrdiff_t n, const unsigned char* __restrict elements) {
+  const ptrdiff_t begin = position & (queue->capacity - 1);
+  const ptrdiff_t first = TCODPATH_MIN(n, queue->capacity - begin);
+  memcpy(queue->data + begin * queue->element_size, elements, first * queue->element_size);
+  if (n > first) memcpy(queue->data, elements + first * queue->element_size, (n - first) * queue->element_size);
+}
+/// @brief Ensure that `queue` can hold at least `count` elements without reallocating.
+/// @details The capacity is rounded up to a power of two. Use this to size a frontier before a search.
+/// @return 0 on success, negative value on error.
+static inline int TCODPATH_queue_reserve(TCODPATH_Queue* __restrict queue, ptrdiff_t count) {
+  if (count <= queue->capacity) return TCODPATH_E_OK;
+  if (queue->element_size <= 0) return TCODPATH_E_INVALID_ARGUMENT;  // Not initialized
+  ptrdiff_t new_capacity = TCODPATH_MAX(queue->capacity, TCODPATH_QUEUE_MIN_CAPACITY);
+  while (new_capacity < count) new_capacity *= 2;
+  unsigned char* new_data = (unsigned char*)TCODPATH_alloc_(queue->allocator, new_capacity * queue->element_size);
+  if (!new_data) return TCODPATH_E_OUT_OF_MEMORY;
+  if (queue->size) TCODPATH_queue_read_(queue, queue->head, queue->size, new_data);
+  TCODPATH_free_(queue->allocator, queue->data, queue->capacity * queue->element_size);
+  queue->data = new_data;
+  queue->capacity = new_capacity;
+  queue->head = 0;
+  return TCODPATH_E_OK;
+}
+/// @brief Append one element to the back of the queue.
+/// @param element Array of `element_size` bytes.
+/// @return 0 on success, negative value on error.
+static inline int TCODPATH_queue_push(TCODPATH_Queue* __restrict queue, const void* __restrict element) {
+  if (queue->size == queue->capacity) {
+    const int err = TCODPATH_queue_reserve(queue, queue->capacity + 1);
+    if (err < 0) return err;
+  }
+  const ptrdiff_t tail = (queue->head + queue->size) & (queue->capacity - 1);
+  memcpy(queue->data + tail * queue->element_size, element, queue->element_size);
+  ++queue->size;
+  return TCODPATH_E_OK;
+}
+/// @brief Append `n` contiguous elements to the back of the queue in one copy, or two when the queue wraps.
+/// @param elements Array of `n * element_size` bytes.
+/// @return 0 on success, negative value on error.
+static inline int TCODPATH_queue_push_n(
+    TCODPATH_Queue* __restrict queue, ptrdiff_t n, const void* __restrict elements) {
+  if (n <= 0) return TCODPATH_E_OK;
+  const int err = TCODPATH_queue_reserve(queue, queue->size + n);
+  if (err < 0) return err;
+  TCODPATH_queue_write_(queue, queue->head + queue->size, n, (const unsigned char*)elements);
+  queue->size += n;
+  return TCODPATH_E_OK;
+}
+/// @brief Remove one element from the front of the queue.
+/// @param out Output of `element_size` bytes. Can be `NULL` to discard the element.
+/// @return 0 on success, negative value if the queue was empty.
+static inline int TCODPATH_queue_pop(TCODPATH_Queue* __restrict queue, void* __restrict out) {
+  if (queue->size == 0) return TCODPATH_E_ERROR;  // Underflow
+  if (out) memcpy(out, queue->data + queue->head * queue->element_size, queue->element_size);
+  queue->head = (queue->head + 1) & (queue->capacity - 1);
+  --queue->size;
+  return TCODPATH_E_OK;
+}
+/// @brief Copy the element at the front of the queue without removing it.
+/// @param out Output of `element_size` bytes.
+/// @return 0 on success, negative value if the queue was empty.
+static inline int TCODPATH_queue_peek(const TCODPATH_Queue* __restrict queue, void* __restrict out) {
+  if (queue->size == 0) return TCODPATH_E_ERROR;  // Underflow
+  memcpy(out, queue->data + queue->head * queue->element_size, queue->element_size);
+  return TCODPATH_E_OK;
+}
+/// @brief Remove up to `n` elements from the front of the queue.
+/// @param out Output of `n * element_size` bytes. Can be `NULL` to discard the elements.
+/// @return The number of elements removed.
+static inline ptrdiff_t TCODPATH_queue_pop_n(TCODPATH_Queue* __restrict queue, ptrdiff_t n, void* __restrict out) {
+  n = TCODPATH_MIN(n, queue->size);
+  if (n <= 0) return 0;
+  if (out) TCODPATH_queue_read_(queue, queue->head, n, (unsigned char*)out);
+  queue->head = (queue->head + n) & (queue->capacity - 1);
+  queue->size -= n;
+  return n;
+}
@@ -0,0 +1,17 @@
+#pragma once
+
+#include <stddef.h>
+
+#include "allocator_types.h"
+
+/// @brief First-in first-out queue of elements with a fixed size, such as the indexes of a breadth-first frontier.
+/// @details Capacity is always zero or a power of two so positions wrap with a mask.
+/// Must be setup with `TCODPATH_queue_init` and freed with `TCODPATH_queue_uninit`.
+typedef struct TCODPATH_Queue {
+  unsigned char* __restrict data;
+  ptrdiff_t element_size;  ///< Size of each element in bytes
+  ptrdiff_t capacity;  ///< Number of elements which fit in `data`
+  ptrdiff_t head;  ///< Position of the first element
+  ptrdiff_t size;  ///< Number of elements currently queued
+  TCODPATH_Allocator* allocator;  ///< Allocator of `data`, NULL for the global one. Set while `data` is NULL.
+} TCODPATH_Queue;
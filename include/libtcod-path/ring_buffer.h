@@ -1,15 +1,20 @@
 #pragma once
 
 #include <stdlib.h>
+#include <string.h>
 
+#include "allocator.h"
 #include "error.h"
 #include "ring_buffer_types.h"
+#include "utility.h"
 
-/// @brief Free arrays from a ring buffer and reset it to the default zero state.
+/// @brief Free arrays from a ring buffer and reset it to the default zero state, keeping its allocator.
 static inline void TCODPATH_ring_buffer_uninit(TCODPATH_RingBuffer* __restrict buffer) {
   if (!buffer) return;
-  if (buffer->data) free(buffer->data);
-  buffer = {0};
+  TCODPATH_Allocator* allocator = buffer->allocator;
+  TCODPATH_free_(allocator, buffer->data, buffer->capacity);
+  *buffer = TCODPATH_RingBuffer{};
+  buffer->allocator = allocator;
 }
 /// @brief Pop data from the left of a ring buffer.
 /// @param buffer Must not be `NULL`.
@@ -18,14 +23,17 @@ static inline void TCODPATH_ring_buffer_uninit(TCODPATH_RingBuffer* __restrict b
 /// @return 0 on success, negative value on buffer underflow.
 static inline int TCODPATH_ring_buffer_pop(
     TCODPATH_RingBuffer* __restrict buffer, ptrdiff_t n_bytes, const void* __restrict data_out) {
+  if (n_bytes > buffer->used_bytes) return -1;  // Data Underflow
+  if (n_bytes <= 0) return 0;
   unsigned char* data = (unsigned char*)data_out;
-  while (n_bytes) {
-    if (buffer->used_bytes == 0) return -1;  // Data Underflow
-    if (data) *data++ = buffer->data[buffer->begin];
-    if (++buffer->begin == buffer->capacity) buffer->begin = 0;
-    --buffer->used_bytes;
-    --n_bytes;
+  const ptrdiff_t first = TCODPATH_MIN(n_bytes, buffer->capacity - buffer->begin);
+  if (data) {
+    memcpy(data, buffer->data + buffer->begin, first);
+    memcpy(data + first, buffer->data, n_bytes - first);
   }
+  buffer->begin = first < n_bytes ? n_bytes - first : buffer->begin + n_bytes;
+  if (buffer->begin == buffer->capacity) buffer->begin = 0;
+  buffer->used_bytes -= n_bytes;
   return 0;
 }
 /// @brief Increate buffer capacity to at least `size_bytes`.
@@ -38,7 +46,8 @@ static inline int TCODPATH_ring_buffer_grow(TCODPATH_RingBuffer* __restrict buff
   TCODPATH_RingBuffer new_buffer = {};
   new_buffer.capacity = size_bytes;
   new_buffer.used_bytes = new_buffer.end = buffer->used_bytes;
-  new_buffer.data = (unsigned char*)malloc(size_bytes);
+  new_buffer.allocator = buffer->allocator;
+  new_buffer.data = (unsigned char*)TCODPATH_alloc_(buffer->allocator, size_bytes);
   if (!new_buffer.data) return TCODPATH_E_OUT_OF_MEMORY;
   TCODPATH_ring_buffer_pop(buffer, buffer->used_bytes, new_buffer.data);
   TCODPATH_ring_buffer_uninit(buffer);
@@ -52,16 +61,19 @@ static inline int TCODPATH_ring_buffer_grow(TCODPATH_RingBuffer* __restrict buff
 /// @return 0 on success, negative on error.
 static inline int TCODPATH_ring_buffer_append(
     TCODPATH_RingBuffer* __restrict buffer, ptrdiff_t n_bytes, const void* __restrict data_in) {
-  const unsigned char* data = (const unsigned char*)data_in;
-  while (n_bytes) {
-    if (buffer->used_bytes == buffer->capacity) {
-      const int err = TCODPATH_ring_buffer_grow(buffer, buffer->capacity * 2);
-      if (err) return err;
-    }
-    buffer->data[buffer->end] = *data++;
-    if (++buffer->end == buffer->capacity) buffer->end = 0;
-    ++buffer->used_bytes;
-    --n_bytes;
+  if (n_bytes <= 0) return 0;
+  if (buffer->used_bytes + n_bytes > buffer->capacity) {
+    ptrdiff_t new_capacity = TCODPATH_MAX(buffer->capacity * 2, 256);
+    while (new_capacity < buffer->used_bytes + n_bytes) new_capacity *= 2;
+    const int err = TCODPATH_ring_buffer_grow(buffer, new_capacity);
+    if (err) return err;
   }
+  const unsigned char* data = (const unsigned char*)data_in;
+  const ptrdiff_t first = TCODPATH_MIN(n_bytes, buffer->capacity - buffer->end);
+  memcpy(buffer->data + buffer->end, data, first);
+  memcpy(buffer->data, data + first, n_bytes - first);
+  buffer->end = first < n_bytes ? n_bytes - first : buffer->end + n_bytes;
+  if (buffer->end == buffer->capacity) buffer->end = 0;
+  buffer->used_bytes += n_bytes;
   return 0;
 }
@@ -2,6 +2,8 @@
 
 #include <stddef.h>
 
+#include "allocator_types.h"
+
 /// @brief Ring Buffer data structure.
 /// Can be used right away from a zeroed state, but must be uninit afterwards.
 typedef struct TCODPATH_RingBuffer {
@@ -10,4 +12,5 @@ typedef struct TCODPATH_RingBuffer {
   ptrdiff_t begin;  ///< Byte index of the buffer head
   ptrdiff_t end;  ///< Byte index of the buffer tail
   unsigned char* __restrict data;
+  TCODPATH_Allocator* allocator;  ///< Allocator of `data`, NULL for the global one. Set while `data` is NULL.
 } TCODPATH_RingBuffer;
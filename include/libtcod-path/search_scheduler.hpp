@@ -0,0 +1,180 @@
+#pragma once
+
+#include <libtcod-path/heuristic_types.h>
+#include <libtcod-path/indexes.h>
+#include <libtcod-path/map_tools.h>
+#include <libtcod-path/uniform_cost_search.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <memory>
+#include <optional>
+#include <stdexcept>
+#include <vector>
+
+namespace tcod::path {
+/// @brief Status of a resumable search.
+enum class SearchStatus {
+  pending,  // The search can continue
+  complete,  // The search has finished, the goal may or may not have been reached
+  cancelled,  // The search was cancelled before finishing
+  failed,  // The search ran into an error
+};
+
+/// @brief Options for a resumable search.
+struct SearchOptions {
+  TCODPATH_Heuristic* heuristic{};  // Optional heuristic
+  int heuristic_weight{100};  // Heuristic weight in percent, higher values trade path quality for speed
+  bool anytime{};  // Keep improving the best path after the goal is first reached, until the search is optimal
+};
+
+/// @brief A point-to-point UCS/A* search which runs in budgeted slices and can be resumed later.
+/// @details The maps passed in must outlive the search. `distance` should be cleared beforehand.
+class ResumableSearch {
+ public:
+  using Clock = std::chrono::steady_clock;
+
+  ResumableSearch(
+      TCODPATH_Graph& graph,
+      TCODPATH_Map& distance,
+      TCODPATH_Map* flow,
+      const std::vector<TCODPATH_IndexType>& start,
+      const std::vector<TCODPATH_IndexType>& goal,
+      const SearchOptions& options = {}) {
+    const int dimensions = TCODPATH_map_get_dimensions(&distance);
+    if (static_cast<int>(start.size()) != dimensions || static_cast<int>(goal.size()) != dimensions) {
+      throw std::invalid_argument("start and goal must match the dimensions of the distance map");
+    }
+    if (TCODPATH_ucs_init(&ucs_, &graph, options.heuristic, &distance, flow) < 0) {
+      throw std::runtime_error("failed to initialize search");
+    }
+    ucs_.heuristic_weight = options.heuristic_weight;
+    ucs_.anytime = options.anytime;
+    TCODPATH_ucs_set_goal(&ucs_, goal.data());
+    TCODPATH_map_set(&distance, start.data(), 0);
+    if (TCODPATH_ucs_push(&ucs_, start.data()) < 0) status_ = SearchStatus::failed;
+  }
+  ResumableSearch(const ResumableSearch&) = delete;
+  ResumableSearch& operator=(const ResumableSearch&) = delete;
+  ~ResumableSearch() { TCODPATH_ucs_uninit(&ucs_); }
+
+  /// @brief Run at most `max_expansions` iterations. Returns the status afterwards.
+  auto run_for(int max_expansions) -> SearchStatus {
+    if (status_ != SearchStatus::pending) return status_;
+    int steps = 0;
+    const int result = TCODPATH_ucs_run(&ucs_, max_expansions, &steps);
+    expansions_ += steps;
+    if (result < 0) status_ = SearchStatus::failed;
+    if (result > 0) finish_();
+    return status_;
+  }
+  /// @brief Run until complete or until `deadline`, checking the clock every `check_interval` expansions.
+  auto run_until(Clock::time_point deadline, int check_interval = 64) -> SearchStatus {
+    while (status_ == SearchStatus::pending && Clock::now() < deadline) run_for(check_interval);
+    return status_;
+  }
+  /// @brief Stop this search. It can not be resumed afterwards.
+  void cancel() noexcept {
+    if (status_ != SearchStatus::pending) return;
+    status_ = SearchStatus::cancelled;
+    TCODPATH_heap_clear(&ucs_.frontier);
+  }
+
+  auto get_status() const noexcept -> SearchStatus { return status_; }
+  /// @brief Return the total number of expansions so far.
+  auto get_expansions() const noexcept -> std::size_t { return expansions_; }
+  /// @brief Return true if a path to the goal is known. In anytime mode this path may still improve.
+  auto has_path() const noexcept -> bool { return get_path_cost() != TCODPATH_VALUE_MAX; }
+  /// @brief Return the cost of the best known path, or `TCODPATH_VALUE_MAX` if no path is known.
+  auto get_path_cost() const noexcept -> TCODPATH_ValueType {
+    if (ucs_.anytime) return ucs_.incumbent;
+    if (status_ != SearchStatus::complete) return TCODPATH_VALUE_MAX;
+    return TCODPATH_map_get(ucs_.distance, ucs_.goal);
+  }
+
+ private:
+  void finish_() noexcept {
+    status_ = SearchStatus::complete;
+    TCODPATH_heap_clear(&ucs_.frontier);
+  }
+
+  TCODPATH_UniformCostSearch ucs_{};
+  SearchStatus status_{SearchStatus::pending};
+  std::size_t expansions_{};
+};
+
+/// @brief Shares a per-frame expansion budget between many pending searches.
+/// @details Searches with a higher priority are run first. Searches of equal priority split the remaining budget
+/// evenly, and budget left over by searches which finish early goes to the others.
+class SearchScheduler {
+ public:
+  using Clock = ResumableSearch::Clock;
+  using SearchPtr = std::shared_ptr<ResumableSearch>;
+
+  /// @brief Add `search` to this scheduler. Higher `priority` values run first.
+  void submit(SearchPtr search, int priority = 0) {
+    if (!search) return;
+    entries_.push_back(Entry{std::move(search), priority});
+    std::stable_sort(entries_.begin(), entries_.end(), [](const Entry& lhs, const Entry& rhs) {
+      return lhs.priority > rhs.priority;
+    });
+  }
+  /// @brief Cancel `search` and remove it from this scheduler.
+  void cancel(const SearchPtr& search) {
+    if (!search) return;
+    search->cancel();
+    remove_finished_();
+  }
+  /// @brief Run pending searches for at most `max_expansions` total expansions, or until `deadline`.
+  /// @return The number of expansions used.
+  auto run_frame(int max_expansions, std::optional<Clock::time_point> deadline = std::nullopt) -> int {
+    int remaining = max_expansions;
+    for (std::size_t tier_begin = 0; tier_begin < entries_.size() && remaining > 0;) {
+      std::size_t tier_end = tier_begin;
+      while (tier_end < entries_.size() && entries_[tier_end].priority == entries_[tier_begin].priority) ++tier_end;
+      while (remaining > 0) {
+        int pending = 0;
+        for (std::size_t i = tier_begin; i < tier_end; ++i) {
+          pending += entries_[i].search->get_status() == SearchStatus::pending;
+        }
+        if (pending == 0) break;
+        const int share = std::max(1, remaining / pending);
+        for (std::size_t i = tier_begin; i < tier_end && remaining > 0; ++i) {
+          auto& search = *entries_[i].search;
+          if (search.get_status() != SearchStatus::pending) continue;
+          if (deadline && Clock::now() >= *deadline) {
+            remove_finished_();
+            return max_expansions - remaining;
+          }
+          const auto before = search.get_expansions();
+          search.run_for(std::min(share, remaining));
+          remaining -= static_cast<int>(search.get_expansions() - before);
+          if (search.get_status() == SearchStatus::pending && search.get_expansions() == before) break;
+        }
+      }
+      tier_begin = tier_end;
+    }
+    remove_finished_();
+    return max_expansions - remaining;
+  }
+  /// @brief Return the number of searches which have not finished.
+  auto get_pending_count() const noexcept -> std::size_t { return entries_.size(); }
+
+ private:
+  struct Entry {
+    SearchPtr search;
+    int priority;
+  };
+  void remove_finished_() {
+    entries_.erase(
+        std::remove_if(
+            entries_.begin(),
+            entries_.end(),
+            [](const Entry& entry) { return entry.search->get_status() != SearchStatus::pending; }),
+        entries_.end());
+  }
+
+  std::vector<Entry> entries_{};  // Sorted by priority, then by submission order
+};
+}  // namespace tcod::path
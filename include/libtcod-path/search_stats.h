@@ -0,0 +1,70 @@
+#pragma once
+
+#include <time.h>
+
+#include "config.h"
+#include "search_stats_types.h"
+#include "utility.h"
+
+#if TCODPATH_STATS_ENABLED
+/// @brief Add `n` to `field` of `stats` if `stats` is not `NULL`.
+#define TCODPATH_STATS_ADD(stats, field, n) \
+  do {                                      \
+    if (stats) (stats)->field += (n);       \
+  } while (0)
+/// @brief Raise `field` of `stats` to at least `n` if `stats` is not `NULL`.
+#define TCODPATH_STATS_MAX(stats, field, n)                         \
+  do {                                                              \
+    if (stats) (stats)->field = TCODPATH_MAX((stats)->field, (n)); \
+  } while (0)
+/// @brief Report `event` at `index` to `trace` if `trace` is not `NULL`.
+#define TCODPATH_TRACE(trace, event, dimensions, index, distance)                                  \
+  do {                                                                                           \
+    if (trace) (trace)->callback((trace)->userdata, (event), (dimensions), (index), (distance)); \
+  } while (0)
+#else
+#define TCODPATH_STATS_ADD(stats, field, n) ((void)0)
+#define TCODPATH_STATS_MAX(stats, field, n) ((void)0)
+#define TCODPATH_TRACE(trace, event, dimensions, index, distance) ((void)0)
+#endif
+
+/// @brief Return a monotonic time in nanoseconds, or zero when stats are disabled.
+/// @details Windows has no `clock_gettime`, the C11 `timespec_get` is used there instead.
+static inline int64_t TCODPATH_stats_now_ns(void) {
+#if !TCODPATH_STATS_ENABLED
+  return 0;
+#elif defined(_WIN32)
+  struct timespec now;
+  if (timespec_get(&now, TIME_UTC) != TIME_UTC) return 0;
+  return (int64_t)now.tv_sec * 1000000000 + now.tv_nsec;
+#else
+  struct timespec now;
+  if (clock_gettime(CLOCK_MONOTONIC, &now) != 0) return 0;
+  return (int64_t)now.tv_sec * 1000000000 + now.tv_nsec;
+#endif
+}
+/// @brief Return the start time of a phase, or zero when `stats` is `NULL` so that no clock is read.
+/// Used internally.
+static inline int64_t TCODPATH_stats_phase_begin_(const TCODPATH_SearchStats* stats) {
+#if TCODPATH_STATS_ENABLED
+  return stats ? TCODPATH_stats_now_ns() : 0;
+#else
+  (void)stats;
+  return 0;
+#endif
+}
+/// @brief Add the time since `begin_ns` to `phase` of `stats`.
+/// Used internally.
+static inline void TCODPATH_stats_phase_end_(TCODPATH_SearchStats* stats, TCODPATH_StatsPhase phase, int64_t begin_ns) {
+#if TCODPATH_STATS_ENABLED
+  if (stats) stats->phase_ns[phase] += TCODPATH_stats_now_ns() - begin_ns;
+#else
+  (void)stats;
+  (void)phase;
+  (void)begin_ns;
+#endif
+}
+/// @brief Reset all counters and timers of `stats` to zero.
+static inline void TCODPATH_stats_clear(TCODPATH_SearchStats* stats) {
+  if (stats) *stats = TCODPATH_SearchStats{};
+}
@@ -0,0 +1,46 @@
+#pragma once
+
+#include <stdint.h>
+
+#include "config.h"
+
+/// @brief Phases timed by `TCODPATH_SearchStats`.
+typedef enum TCODPATH_StatsPhase {
+  TCODPATH_STATS_PHASE_SEARCH = 0,  ///< Searches run to completion or to a step budget
+  TCODPATH_STATS_PHASE_PARTITION = 1,  ///< `TCODPATH_partition_from_graph`
+  TCODPATH_STATS_PHASE_DIFFERENTIAL = 2,  ///< Differential generation, this includes its own search phase
+  TCODPATH_STATS_PHASE_COUNT = 3,
+} TCODPATH_StatsPhase;
+
+/// @brief Counters describing the work done by searches. Zero this before use, counters are only ever added to.
+/// @details Searches update this through an optional `stats` pointer, which is ignored when
+/// `TCODPATH_STATS_ENABLED` is 0. The same struct can be shared by several searches to sum their work.
+typedef struct TCODPATH_SearchStats {
+  int64_t expansions;  ///< Nodes whose edges were visited
+  int64_t pushes;  ///< Nodes added to a frontier
+  int64_t stale_pops;  ///< Frontier entries discarded because the node was already expanded at a shorter distance
+  int64_t peak_frontier;  ///< Largest number of nodes held by a single frontier
+  int64_t heuristic_calls;  ///< Number of times a heuristic was evaluated
+  int64_t bytes_allocated;  ///< Bytes allocated for frontiers and scratch buffers
+  int64_t phase_ns[TCODPATH_STATS_PHASE_COUNT];  ///< Wall time in nanoseconds, indexed by `TCODPATH_StatsPhase`
+} TCODPATH_SearchStats;
+
+/// @brief Events reported to a `TCODPATH_SearchTrace`.
+typedef enum TCODPATH_TraceEvent {
+  TCODPATH_TRACE_PUSH = 0,  ///< A node was added to the frontier
+  TCODPATH_TRACE_EXPAND = 1,  ///< A node was taken from the frontier and its edges visited
+} TCODPATH_TraceEvent;
+
+/// @brief Called for each event of a search with the node `index` and its `distance` at that time.
+typedef void TCODPATH_TraceFunction(
+    void* userdata,
+    TCODPATH_TraceEvent event,
+    int dimensions,
+    const TCODPATH_IndexType* __restrict index,
+    TCODPATH_ValueType distance);
+
+/// @brief Callback which records every push and expansion of a search, for replaying or debugging it.
+typedef struct TCODPATH_SearchTrace {
+  TCODPATH_TraceFunction* callback;
+  void* userdata;
+} TCODPATH_SearchTrace;
@@ -0,0 +1,295 @@
+#pragma once
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "allocator.h"
+#include "error.h"
+#include "map_tools.h"
+#include "tiled_map_types.h"
+#include "utility.h"
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define TCODPATH_HAS_MMAP_ 1
+#endif
+
+/// @brief Largest tile side length, so that the index of a node within its tile fits in 32 bits.
+#define TCODPATH_TILED_MAX_TILE_SIZE 32768
+
+/// @brief Set the shape and layout of `map` without any data.
+/// Used internally.
+/// @return 0 on success, negative value on error.
+static inline int TCODPATH_tiled_map_layout_(
+    TCODPATH_TiledMap* __restrict map, int64_t height, int64_t width, int tile_size, ptrdiff_t element_size) {
+  *map = TCODPATH_TiledMap{};
+  if (tile_size == 0) tile_size = TCODPATH_TILED_TILE_SIZE;
+  if (height <= 0 || width <= 0 || element_size <= 0) return TCODPATH_E_INVALID_ARGUMENT;
+  if (tile_size <= 0 || (tile_size & (tile_size - 1)) != 0) return TCODPATH_E_INVALID_ARGUMENT;  // Power of two only
+  if (tile_size > TCODPATH_TILED_MAX_TILE_SIZE) return TCODPATH_E_INVALID_ARGUMENT;
+  while ((1 << map->tile_shift) < tile_size) ++map->tile_shift;
+  map->shape[0] = height;
+  map->shape[1] = width;
+  map->tiles_shape[0] = (height + tile_size - 1) >> map->tile_shift;
+  map->tiles_shape[1] = (width + tile_size - 1) >> map->tile_shift;
+  map->element_size = element_size;
+  const int64_t tile_bytes = (int64_t)tile_size * tile_size * element_size;
+  if (map->tiles_shape[0] > PTRDIFF_MAX / tile_bytes / map->tiles_shape[1]) {
+    *map = TCODPATH_TiledMap{};
+    return TCODPATH_E_INVALID_ARGUMENT;  // Too large to address
+  }
+  map->size_bytes = (size_t)(map->tiles_shape[0] * map->tiles_shape[1] * tile_bytes);
+  return TCODPATH_E_OK;
+}
+/// @brief Return the number of bytes a tiled map of this shape needs, or 0 if the arguments are invalid.
+/// @param tile_size Side length of each tile, a power of two up to `TCODPATH_TILED_MAX_TILE_SIZE`.
+/// 0 for `TCODPATH_TILED_TILE_SIZE`.
+static inline size_t TCODPATH_tiled_map_size_bytes(
+    int64_t height, int64_t width, int tile_size, ptrdiff_t element_size) {
+  TCODPATH_TiledMap layout;
+  if (TCODPATH_tiled_map_layout_(&layout, height, width, tile_size, element_size) < 0) return 0;
+  return layout.size_bytes;
+}
+/// @brief Setup a tiled map in memory with every node set to zero.
+/// @param map Output, must be freed with `TCODPATH_tiled_map_uninit`.
+/// @param tile_size Side length of each tile, a power of two up to `TCODPATH_TILED_MAX_TILE_SIZE`.
+/// 0 for `TCODPATH_TILED_TILE_SIZE`.
+/// @param element_size Size of each node in bytes.
+/// @param allocator Allocator of the data, or `NULL` for the global allocator.
+/// @return 0 on success, negative value on error.
+static inline int TCODPATH_tiled_map_init(
+    TCODPATH_TiledMap* __restrict map,
+    int64_t height,
+    int64_t width,
+    int tile_size,
+    ptrdiff_t element_size,
+    TCODPATH_Allocator* allocator) {
+  if (!map) return TCODPATH_E_INVALID_ARGUMENT;
+  const int err = TCODPATH_tiled_map_layout_(map, height, width, tile_size, element_size);
+  if (err < 0) return err;
+  map->allocator = allocator;
+  map->data = (unsigned char*)TCODPATH_calloc_(allocator, map->size_bytes, 1);
+  if (!map->data) {
+    *map = TCODPATH_TiledMap{};
+    return TCODPATH_E_OUT_OF_MEMORY;
+  }
+  return TCODPATH_E_OK;
+}
+/// @brief Setup a tiled map as a shared mapping of the file at `path`.
+/// @details Tiles are only read from the file when they are used, and written back by the system, so the map can be
+/// much larger than memory. Files written this way can be opened again with the same shape and tile size.
+/// Only available on platforms with `mmap`, elsewhere this always fails.
+/// @param map Output, must be freed with `TCODPATH_tiled_map_uninit`.
+/// @param tile_size Side length of each tile, a power of two up to `TCODPATH_TILED_MAX_TILE_SIZE`.
+/// 0 for `TCODPATH_TILED_TILE_SIZE`.
+/// @param element_size Size of each node in bytes.
+/// @param mode Open an existing file or create a new one. Existing files must be at least as large as the map.
+/// @return 0 on success, negative value on error.
+static inline int TCODPATH_tiled_map_open(
+    TCODPATH_TiledMap* __restrict map,
+    const char* path,
+    int64_t height,
+    int64_t width,
+    int tile_size,
+    ptrdiff_t element_size,
+    TCODPATH_TiledOpenMode mode) {
+  if (!map || !path) return TCODPATH_E_INVALID_ARGUMENT;
+  const int err = TCODPATH_tiled_map_layout_(map, height, width, tile_size, element_size);
+  if (err < 0) return err;
+#ifdef TCODPATH_HAS_MMAP_
+  const int flags = mode == TCODPATH_TILED_READ_ONLY ? O_RDONLY
+                    : mode == TCODPATH_TILED_CREATE  ? O_RDWR | O_CREAT | O_TRUNC
+                                                     : O_RDWR;
+  const int fd = open(path, flags, 0644);
+  if (fd < 0) {
+    *map = TCODPATH_TiledMap{};
+    return TCODPATH_E_ERROR;
+  }
+  bool sized = false;
+  if (mode == TCODPATH_TILED_CREATE) {
+    sized = ftruncate(fd, (off_t)map->size_bytes) == 0;  // Sparse on most file systems, reads as zeros
+  } else {
+    struct stat info;
+    sized = fstat(fd, &info) == 0 && (size_t)info.st_size >= map->size_bytes;
+  }
+  void* data = MAP_FAILED;
+  if (sized) {
+    const int protection = mode == TCODPATH_TILED_READ_ONLY ? PROT_READ : PROT_READ | PROT_WRITE;
+    data = mmap(NULL, map->size_bytes, protection, MAP_SHARED, fd, 0);
+  }
+  close(fd);  // The mapping keeps the file open
+  if (data == MAP_FAILED) {
+    *map = TCODPATH_TiledMap{};
+    return TCODPATH_E_ERROR;
+  }
+  map->data = (unsigned char*)data;
+  map->mapped = true;
+  return TCODPATH_E_OK;
+#else
+  (void)mode;
+  *map = TCODPATH_TiledMap{};
+  return TCODPATH_E_ERROR;  // No file mappings on this platform
+#endif
+}
+/// @brief Free or unmap the data of `map` and reset it to the default zero state.
+static inline void TCODPATH_tiled_map_uninit(TCODPATH_TiledMap* __restrict map) {
+  if (!map) return;
+  if (map->mapped) {
+#ifdef TCODPATH_HAS_MMAP_
+    munmap(map->data, map->size_bytes);
+#endif
+  } else {
+    TCODPATH_free_(map->allocator, map->data, map->size_bytes);
+  }
+  *map = TCODPATH_TiledMap{};
+}
+/// @brief Write the changes to a mapped map back to its file and wait for them to finish.
+/// @return 0 on success, negative value on error. Maps in memory always succeed.
+static inline int TCODPATH_tiled_map_sync(TCODPATH_TiledMap* __restrict map) {
+  if (!map || !map->mapped) return TCODPATH_E_OK;
+#ifdef TCODPATH_HAS_MMAP_
+  if (msync(map->data, map->size_bytes, MS_SYNC) != 0) return TCODPATH_E_ERROR;
+#endif
+  return TCODPATH_E_OK;
+}
+/// @brief Return the number of tiles in `map`.
+static inline int64_t TCODPATH_tiled_map_tile_count(const TCODPATH_TiledMap* __restrict map) {
+  return map->tiles_shape[0] * map->tiles_shape[1];
+}
+/// @brief Return the number of nodes in each tile of `map`, including padding.
+static inline int64_t TCODPATH_tiled_map_tile_nodes(const TCODPATH_TiledMap* __restrict map) {
+  return (int64_t)1 << (map->tile_shift * 2);
+}
+/// @brief Return true if `{y, x}` is in the bounds of `map`.
+static inline bool TCODPATH_tiled_map_in_bounds(const TCODPATH_TiledMap* __restrict map, int64_t y, int64_t x) {
+  return 0 <= y && y < map->shape[0] && 0 <= x && x < map->shape[1];
+}
+/// @brief Return the row-major node id of `{y, x}`. Ids are 64-bit, so maps can hold more than 2^31 nodes.
+static inline TCODPATH_LargeIdType TCODPATH_tiled_map_id(
+    const TCODPATH_TiledMap* __restrict map, int64_t y, int64_t x) {
+  return (TCODPATH_LargeIdType)(y * map->shape[1] + x);
+}
+/// @brief Return the tile holding `{y, x}`.
+static inline int64_t TCODPATH_tiled_map_tile_of(const TCODPATH_TiledMap* __restrict map, int64_t y, int64_t x) {
+  return (y >> map->tile_shift) * map->tiles_shape[1] + (x >> map->tile_shift);
+}
+/// @brief Return the first node of `tile` in `y_out` and `x_out`.
+static inline void TCODPATH_tiled_map_tile_origin(
+    const TCODPATH_TiledMap* __restrict map, int64_t tile, int64_t* __restrict y_out, int64_t* __restrict x_out) {
+  *y_out = (tile / map->tiles_shape[1]) << map->tile_shift;
+  *x_out = (tile % map->tiles_shape[1]) << map->tile_shift;
+}
+/// @brief Return a pointer to the nodes of `tile`, in row-major order within the tile.
+static inline unsigned char* TCODPATH_tiled_map_tile_data(const TCODPATH_TiledMap* __restrict map, int64_t tile) {
+  return map->data + (size_t)tile * (size_t)(TCODPATH_tiled_map_tile_nodes(map) * map->element_size);
+}
+/// @brief Return a pointer to the node at `{y, x}`, which must be in bounds.
+static inline void* TCODPATH_tiled_map_at(const TCODPATH_TiledMap* __restrict map, int64_t y, int64_t x) {
+  const int64_t mask = ((int64_t)1 << map->tile_shift) - 1;
+  const int64_t local = ((y & mask) << map->tile_shift) | (x & mask);
+  return TCODPATH_tiled_map_tile_data(map, TCODPATH_tiled_map_tile_of(map, y, x)) + local * map->element_size;
+}
+/// @brief Return the value at `{y, x}` of a map of `TCODPATH_ValueType` nodes.
+static inline TCODPATH_ValueType TCODPATH_tiled_map_get(const TCODPATH_TiledMap* __restrict map, int64_t y, int64_t x) {
+  return *(const TCODPATH_ValueType*)TCODPATH_tiled_map_at(map, y, x);
+}
+/// @brief Set the value at `{y, x}` of a map of `TCODPATH_ValueType` nodes.
+static inline void TCODPATH_tiled_map_set(
+    TCODPATH_TiledMap* __restrict map, int64_t y, int64_t x, TCODPATH_ValueType value) {
+  *(TCODPATH_ValueType*)TCODPATH_tiled_map_at(map, y, x) = value;
+}
+/// @brief Give `advice` to the system about the pages of `tile`. Does nothing for maps in memory.
+/// Used internally.
+static inline void TCODPATH_tiled_map_advise_(const TCODPATH_TiledMap* __restrict map, int64_t tile, int advice) {
+#ifdef TCODPATH_HAS_MMAP_
+  if (!map->mapped) return;
+  const size_t page = (size_t)sysconf(_SC_PAGESIZE);
+  const size_t tile_bytes = (size_t)(TCODPATH_tiled_map_tile_nodes(map) * map->element_size);
+  const size_t begin = (size_t)tile * tile_bytes / page * page;  // Pages shared with other tiles are included
+  const size_t end = TCODPATH_MIN(map->size_bytes, (size_t)(tile + 1) * tile_bytes);
+  madvise(map->data + begin, end - begin, advice);
+#else
+  (void)map;
+  (void)tile;
+  (void)advice;
+#endif
+}
+/// @brief Ask the system to start reading `tile` of a mapped map, so that it is in memory before it is used.
+static inline void TCODPATH_tiled_map_load_tile(const TCODPATH_TiledMap* __restrict map, int64_t tile) {
+#ifdef TCODPATH_HAS_MMAP_
+  TCODPATH_tiled_map_advise_(map, tile, MADV_WILLNEED);
+#else
+  (void)map;
+  (void)tile;
+#endif
+}
+/// @brief Drop `tile` of a mapped map from memory. Changes are kept and will be read back from the file when needed.
+static inline void TCODPATH_tiled_map_release_tile(const TCODPATH_TiledMap* __restrict map, int64_t tile) {
+#ifdef TCODPATH_HAS_MMAP_
+  TCODPATH_tiled_map_advise_(map, tile, MADV_DONTNEED);  // Safe on shared file mappings, the page cache keeps it
+#else
+  (void)map;
+  (void)tile;
+#endif
+}
+/// @brief Set every node of a map of `TCODPATH_ValueType` nodes to `value`, one tile at a time.
+/// @return 0 on success, negative value on error.
+static inline int TCODPATH_tiled_map_fill(TCODPATH_TiledMap* __restrict map, TCODPATH_ValueType value) {
+  if (!map || map->element_size != sizeof(TCODPATH_ValueType)) return TCODPATH_E_INVALID_ARGUMENT;
+  const int64_t tile_count = TCODPATH_tiled_map_tile_count(map);
+  const int64_t tile_nodes = TCODPATH_tiled_map_tile_nodes(map);
+  for (int64_t tile = 0; tile < tile_count; ++tile) {
+    TCODPATH_ValueType* __restrict values = (TCODPATH_ValueType*)TCODPATH_tiled_map_tile_data(map, tile);
+    for (int64_t i = 0; i < tile_nodes; ++i) values[i] = value;
+    TCODPATH_tiled_map_release_tile(map, tile);
+  }
+  return TCODPATH_E_OK;
+}
+/// @brief Return true if `tiled` holds `TCODPATH_ValueType` nodes and has the same shape as the 2D map `map`.
+/// Used internally.
+static inline bool TCODPATH_tiled_map_matches_(
+    const TCODPATH_TiledMap* __restrict tiled, const TCODPATH_Map* __restrict map) {
+  if (tiled->element_size != sizeof(TCODPATH_ValueType) || TCODPATH_map_get_dimensions(map) != 2) return false;
+  const TCODPATH_IndexType* shape = TCODPATH_map_get_shape(map);
+  return shape && shape[0] == tiled->shape[0] && shape[1] == tiled->shape[1];
+}
+/// @brief Copy the values of the 2D map `source` into `map`, one tile at a time. Both must have the same shape.
+/// @return 0 on success, negative value on error.
+static inline int TCODPATH_tiled_map_copy_from(
+    TCODPATH_TiledMap* __restrict map, const TCODPATH_Map* __restrict source) {
+  if (!map || !source || !TCODPATH_tiled_map_matches_(map, source)) return TCODPATH_E_INVALID_ARGUMENT;
+  const int64_t tile_size = (int64_t)1 << map->tile_shift;
+  for (int64_t tile = 0; tile < TCODPATH_tiled_map_tile_count(map); ++tile) {
+    int64_t y0, x0;
+    TCODPATH_tiled_map_tile_origin(map, tile, &y0, &x0);
+    for (int64_t y = y0; y < TCODPATH_MIN(y0 + tile_size, map->shape[0]); ++y) {
+      for (int64_t x = x0; x < TCODPATH_MIN(x0 + tile_size, map->shape[1]); ++x) {
+        const TCODPATH_IndexType index[2] = {(TCODPATH_IndexType)y, (TCODPATH_IndexType)x};
+        TCODPATH_tiled_map_set(map, y, x, TCODPATH_map_get(source, index));
+      }
+    }
+    TCODPATH_tiled_map_release_tile(map, tile);
+  }
+  return TCODPATH_E_OK;
+}
+/// @brief Copy the values of `map` into the 2D map `dest`, one tile at a time. Both must have the same shape.
+/// @return 0 on success, negative value on error.
+static inline int TCODPATH_tiled_map_copy_to(const TCODPATH_TiledMap* __restrict map, TCODPATH_Map* __restrict dest) {
+  if (!map || !dest || !TCODPATH_tiled_map_matches_(map, dest)) return TCODPATH_E_INVALID_ARGUMENT;
+  const int64_t tile_size = (int64_t)1 << map->tile_shift;
+  for (int64_t tile = 0; tile < TCODPATH_tiled_map_tile_count(map); ++tile) {
+    int64_t y0, x0;
+    TCODPATH_tiled_map_tile_origin(map, tile, &y0, &x0);
+    for (int64_t y = y0; y < TCODPATH_MIN(y0 + tile_size, map->shape[0]); ++y) {
+      for (int64_t x = x0; x < TCODPATH_MIN(x0 + tile_size, map->shape[1]); ++x) {
+        const TCODPATH_IndexType index[2] = {(TCODPATH_IndexType)y, (TCODPATH_IndexType)x};
+        TCODPATH_map_set(dest, index, TCODPATH_tiled_map_get(map, y, x));
+      }
+    }
+    TCODPATH_tiled_map_release_tile(map, tile);
+  }
+  return TCODPATH_E_OK;
+}
@@ -0,0 +1,33 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "allocator_types.h"
+#include "config.h"
+
+/// @brief How `TCODPATH_tiled_map_open` opens its file.
+typedef enum TCODPATH_TiledOpenMode {
+  TCODPATH_TILED_READ_ONLY = 0,  ///< Open an existing file, the map must not be written to
+  TCODPATH_TILED_READ_WRITE = 1,  ///< Open an existing file, writes go back to the file
+  TCODPATH_TILED_CREATE = 2,  ///< Create or truncate the file, every node starts as zero
+} TCODPATH_TiledOpenMode;
+
+/// @brief A 2D map with 64-bit sizes stored as square tiles, each tile being one contiguous block of its nodes.
+/// @details Nodes are stored tile by tile in row-major order of the tiles, and in row-major order within a tile.
+/// Tiles on the right and bottom edges are padded to full size, so every tile has the same layout.
+/// The data is either owned memory or a shared mapping of a file, which lets maps be larger than memory as long as
+/// only a few tiles are used at a time, see `TCODPATH_tiled_map_load_tile` and `TCODPATH_TiledSearch`.
+/// Must be setup with `TCODPATH_tiled_map_init` or `TCODPATH_tiled_map_open` and freed with
+/// `TCODPATH_tiled_map_uninit`.
+typedef struct TCODPATH_TiledMap {
+  int64_t shape[2];  // Height and width in nodes
+  int64_t tiles_shape[2];  // Number of tiles along each axis
+  int tile_shift;  // Log2 of the tile side length
+  ptrdiff_t element_size;  // Size of each node in bytes
+  unsigned char* __restrict data;  // Tiles in row-major order
+  size_t size_bytes;  // Size of `data` in bytes
+  bool mapped;  // If true then `data` is a mapping of a file
+  TCODPATH_Allocator* allocator;  // Allocator of unmapped data, NULL for the global allocator
+} TCODPATH_TiledMap;
@@ -0,0 +1,341 @@
+#pragma once
+
+#include <stdlib.h>
+
+#include "allocator.h"
+#include "error.h"
+#include "heapq_tools.h"
+#include "search_stats.h"
+#include "tiled_map.h"
+#include "tiled_search_types.h"
+
+/// @brief Offsets `{dy, dx}` of the 8 directions, a direction map stores the index of the move plus one.
+static const int TCODPATH_TILED_DIRECTIONS[8][2] = {
+    {-1, -1}, {-1, 0}, {-1, 1}, {0, -1}, {0, 1}, {1, -1}, {1, 0}, {1, 1},
+};
+
+/// @brief A frontier entry of `TCODPATH_TiledSearch`.
+/// Used internally.
+struct TCODPATH_TiledEntry_ {
+  int32_t local;  // Node index within its tile
+  int8_t direction;  // Move which reached this node plus one, or 0 for a source
+  bool deferred;  // If true then the priority is a lower bound which does not include the cost of this node yet
+};
+
+/// @brief Return the cost multiplier of direction `k`.
+/// Used internally.
+static inline TCODPATH_ValueType TCODPATH_tiled_search_edge_cost_(
+    const TCODPATH_TiledSearch* __restrict search, int k) {
+  return (TCODPATH_TILED_DIRECTIONS[k][0] && TCODPATH_TILED_DIRECTIONS[k][1]) ? search->diagonal : search->cardinal;
+}
+/// @brief Free the frontiers of `search` and release its working set. The maps themselves are not freed.
+static inline void TCODPATH_tiled_search_uninit(TCODPATH_TiledSearch* __restrict search) {
+  if (!search) return;
+  for (int64_t tile = 0; search->frontiers && tile < search->tile_count; ++tile) {
+    TCODPATH_heap_uninit(&search->frontiers[tile]);
+  }
+  TCODPATH_free_(search->allocator, search->frontiers, sizeof(*search->frontiers) * search->tile_count);
+  TCODPATH_heap_uninit(&search->tile_queue);
+  for (int i = 0; search->costs && i < TCODPATH_TILED_WORKING_SET; ++i) {
+    if (search->resident[i] < 0) continue;
+    TCODPATH_tiled_map_release_tile(search->costs, search->resident[i]);
+    TCODPATH_tiled_map_release_tile(search->distance, search->resident[i]);
+    if (search->direction) TCODPATH_tiled_map_release_tile(search->direction, search->resident[i]);
+  }
+  *search = TCODPATH_TiledSearch{};
+}
+/// @brief Setup a search over `costs` which writes to `distance`, moving like a `TCODPATH_GraphBasic2D` graph.
+/// @details Nothing is reset, `distance` should be filled with `TCODPATH_VALUE_MAX` first except for any sources.
+/// @param search Output, must be freed with `TCODPATH_tiled_search_uninit`.
+/// @param costs Map of `TCODPATH_ValueType` costs. Moving into a node costs its value times the edge multiplier.
+/// @param distance Map of `TCODPATH_ValueType` distances with the same shape and tile size as `costs`.
+/// @param direction Optional map of 1-byte directions with the same shape and tile size, can be `NULL`.
+/// @param cardinal Multiplier for cardinal costs, or 0 to disable cardinal movement.
+/// @param diagonal Multiplier for diagonal costs, or 0 to disable diagonal movement.
+/// @param allocator Allocator of the frontiers, `NULL` for the global one. Tiles are managed by the maps themselves.
+/// @return 0 on success, negative value on error.
+static inline int TCODPATH_tiled_search_init_with_allocator(
+    TCODPATH_TiledSearch* __restrict search,
+    const TCODPATH_TiledMap* costs,
+    TCODPATH_TiledMap* distance,
+    TCODPATH_TiledMap* direction,
+    TCODPATH_ValueType cardinal,
+    TCODPATH_ValueType diagonal,
+    TCODPATH_Allocator* allocator) {
+  if (!search || !costs || !distance) return TCODPATH_E_INVALID_ARGUMENT;
+  *search = TCODPATH_TiledSearch{};
+  search->allocator = allocator;
+  if (costs->element_size != sizeof(TCODPATH_ValueType) || distance->element_size != sizeof(TCODPATH_ValueType)) {
+    return TCODPATH_E_INVALID_ARGUMENT;
+  }
+  const TCODPATH_TiledMap* maps[2] = {distance, direction};
+  for (int i = 0; i < 2; ++i) {
+    if (!maps[i]) continue;
+    if (maps[i]->shape[0] != costs->shape[0] || maps[i]->shape[1] != costs->shape[1]) {
+      return TCODPATH_E_INVALID_ARGUMENT;
+    }
+    if (maps[i]->tile_shift != costs->tile_shift) return TCODPATH_E_INVALID_ARGUMENT;
+  }
+  if (direction && direction->element_size != 1) return TCODPATH_E_INVALID_ARGUMENT;
+  search->costs = costs;
+  search->distance = distance;
+  search->direction = direction;
+  search->cardinal = cardinal;
+  search->diagonal = diagonal;
+  search->tile_count = TCODPATH_tiled_map_tile_count(costs);
+  search->current_tile = -1;
+  for (int i = 0; i < TCODPATH_TILED_WORKING_SET; ++i) search->resident[i] = -1;
+  TCODPATH_heap_init(&search->tile_queue, sizeof(int64_t));
+  search->tile_queue.allocator = allocator;
+  // Zeroed heaps have no node size, they are setup on their first push
+  search->frontiers =
+      (struct TCODPATH_Heap*)TCODPATH_calloc_(allocator, search->tile_count, sizeof(*search->frontiers));
+  if (!search->frontiers) {
+    TCODPATH_tiled_search_uninit(search);
+    return TCODPATH_E_OUT_OF_MEMORY;
+  }
+  return TCODPATH_E_OK;
+}
+/// @brief Setup a search using the global allocator, see `TCODPATH_tiled_search_init_with_allocator`.
+/// @return 0 on success, negative value on error.
+static inline int TCODPATH_tiled_search_init(
+    TCODPATH_TiledSearch* __restrict search,
+    const TCODPATH_TiledMap* costs,
+    TCODPATH_TiledMap* distance,
+    TCODPATH_TiledMap* direction,
+    TCODPATH_ValueType cardinal,
+    TCODPATH_ValueType diagonal) {
+  return TCODPATH_tiled_search_init_with_allocator(search, costs, distance, direction, cardinal, diagonal, NULL);
+}
+/// @brief Return the working set slot holding `tile`, or -1 if it is not in memory.
+/// Used internally.
+static inline int TCODPATH_tiled_search_find_resident_(const TCODPATH_TiledSearch* __restrict search, int64_t tile) {
+  for (int i = 0; i < TCODPATH_TILED_WORKING_SET; ++i) {
+    if (search->resident[i] == tile) return i;
+  }
+  return -1;
+}
+/// @brief Bring `tile` into the working set, releasing the least recently used tile if the set is full.
+/// Used internally.
+static inline void TCODPATH_tiled_search_make_resident_(TCODPATH_TiledSearch* __restrict search, int64_t tile) {
+  int slot = TCODPATH_tiled_search_find_resident_(search, tile);
+  if (slot < 0) {
+    slot = 0;
+    for (int i = 1; i < TCODPATH_TILED_WORKING_SET && search->resident[slot] >= 0; ++i) {
+      if (search->resident[i] < 0 || search->resident_used[i] < search->resident_used[slot]) slot = i;
+    }
+    const int64_t evicted = search->resident[slot];
+    if (evicted >= 0) {
+      TCODPATH_tiled_map_release_tile(search->costs, evicted);
+      TCODPATH_tiled_map_release_tile(search->distance, evicted);
+      if (search->direction) TCODPATH_tiled_map_release_tile(search->direction, evicted);
+    }
+    TCODPATH_tiled_map_load_tile(search->costs, tile);
+    TCODPATH_tiled_map_load_tile(search->distance, tile);
+    if (search->direction) TCODPATH_tiled_map_load_tile(search->direction, tile);
+    search->resident[slot] = tile;
+    ++search->tile_loads;
+  }
+  search->resident_used[slot] = ++search->clock;
+}
+/// @brief Push `entry` onto the frontier of `tile`, queuing the tile if this lowers its smallest distance.
+/// Used internally.
+/// @return 0 on success, negative value on error.
+static inline int TCODPATH_tiled_search_push_(
+    TCODPATH_TiledSearch* __restrict search,
+    int64_t tile,
+    TCODPATH_ValueType priority,
+    const struct TCODPATH_TiledEntry_* __restrict entry) {
+  struct TCODPATH_Heap* __restrict frontier = &search->frontiers[tile];
+  if (frontier->node_size == 0) {
+    TCODPATH_heap_init(frontier, sizeof(*entry));
+    frontier->allocator = search->allocator;
+  }
+  const bool is_new_minimum = frontier->size == 0 || priority < TCODPATH_minheap_peek_priority(frontier);
+  int err = TCODPATH_minheap_push(frontier, priority, entry);
+  if (err < 0) return err;
+  TCODPATH_STATS_ADD(search->stats, pushes, 1);
+  TCODPATH_STATS_MAX(search->stats, peak_frontier, frontier->size);
+  // The tile being processed is queued again once it stops
+  if (is_new_minimum && tile != search->current_tile) err = TCODPATH_minheap_push(&search->tile_queue, priority, &tile);
+  return err;
+}
+/// @brief Add a source node at `{y, x}` with a starting distance of `value`.
+/// @details Sources are expanded unless `distance` already holds a smaller value for them.
+/// @return 0 on success, negative value on error.
+static inline int TCODPATH_tiled_search_add_source(
+    TCODPATH_TiledSearch* __restrict search, int64_t y, int64_t x, TCODPATH_ValueType value) {
+  if (!search || !TCODPATH_tiled_map_in_bounds(search->costs, y, x)) return TCODPATH_E_INVALID_ARGUMENT;
+  const int64_t mask = ((int64_t)1 << search->costs->tile_shift) - 1;
+  const int32_t local = (int32_t)(((y & mask) << search->costs->tile_shift) | (x & mask));
+  const struct TCODPATH_TiledEntry_ entry = {local, 0, false};
+  return TCODPATH_tiled_search_push_(search, TCODPATH_tiled_map_tile_of(search->costs, y, x), value, &entry);
+}
+/// @brief Add every non-max value of `distance` as a source, reading it one tile at a time.
+/// @return 0 on success, negative value on error.
+static inline int TCODPATH_tiled_search_add_sources_from_distance(TCODPATH_TiledSearch* __restrict search) {
+  if (!search) return TCODPATH_E_INVALID_ARGUMENT;
+  const TCODPATH_TiledMap* distance = search->distance;
+  const int64_t tile_size = (int64_t)1 << distance->tile_shift;
+  for (int64_t tile = 0; tile < search->tile_count; ++tile) {
+    TCODPATH_tiled_search_make_resident_(search, tile);
+    const TCODPATH_ValueType* __restrict values =
+        (const TCODPATH_ValueType*)TCODPATH_tiled_map_tile_data(distance, tile);
+    int64_t y0, x0;
+    TCODPATH_tiled_map_tile_origin(distance, tile, &y0, &x0);
+    const int64_t height = TCODPATH_MIN(tile_size, distance->shape[0] - y0);
+    const int64_t width = TCODPATH_MIN(tile_size, distance->shape[1] - x0);
+    for (int64_t ly = 0; ly < height; ++ly) {
+      for (int64_t lx = 0; lx < width; ++lx) {
+        const int64_t local = (ly << distance->tile_shift) | lx;
+        if (values[local] == TCODPATH_VALUE_MAX) continue;
+        const struct TCODPATH_TiledEntry_ entry = {(int32_t)local, 0, false};
+        const int err = TCODPATH_tiled_search_push_(search, tile, values[local], &entry);
+        if (err < 0) return err;
+      }
+    }
+  }
+  return TCODPATH_E_OK;
+}
+/// @brief Expand nodes of `tile` until its frontier is empty or another tile has a smaller distance.
+/// Used internally.
+/// @return 0 on success, negative value on error.
+static inline int TCODPATH_tiled_search_process_tile_(TCODPATH_TiledSearch* __restrict search, int64_t tile) {
+  TCODPATH_tiled_search_make_resident_(search, tile);
+  search->current_tile = tile;
+  const TCODPATH_TiledMap* costs = search->costs;
+  const int shift = costs->tile_shift;
+  const int64_t mask = ((int64_t)1 << shift) - 1;
+  const TCODPATH_ValueType* __restrict tile_costs =
+      (const TCODPATH_ValueType*)TCODPATH_tiled_map_tile_data(costs, tile);
+  TCODPATH_ValueType* __restrict tile_distance =
+      (TCODPATH_ValueType*)TCODPATH_tiled_map_tile_data(search->distance, tile);
+  int8_t* __restrict tile_direction =
+      search->direction ? (int8_t*)TCODPATH_tiled_map_tile_data(search->direction, tile) : NULL;
+  int64_t y0, x0;
+  TCODPATH_tiled_map_tile_origin(costs, tile, &y0, &x0);
+  struct TCODPATH_Heap* __restrict frontier = &search->frontiers[tile];
+  int err = 0;
+  while (frontier->size > 0 && err >= 0) {
+    TCODPATH_ValueType priority = TCODPATH_minheap_peek_priority(frontier);
+    if (search->tile_queue.size > 0) {
+      const int64_t next = TCODPATH_minheap_peek_priority(&search->tile_queue);
+      if (priority > next && (int64_t)priority - next > search->slack) break;  // Another tile comes first
+    }
+    struct TCODPATH_TiledEntry_ entry;
+    TCODPATH_minheap_pop(frontier, &entry);
+    if (entry.deferred) {
+      // Queued from another tile without reading this one, the lower bound assumed a cost of 1
+      const TCODPATH_ValueType node_cost = tile_costs[entry.local];
+      if (node_cost <= 0) continue;
+      const TCODPATH_ValueType edge_cost = TCODPATH_tiled_search_edge_cost_(search, entry.direction - 1);
+      priority += edge_cost * (node_cost - 1);
+      if (priority >= tile_distance[entry.local]) {
+        TCODPATH_STATS_ADD(search->stats, stale_pops, 1);
+        continue;
+      }
+      if (node_cost > 1) {
+        entry.deferred = false;
+        err = TCODPATH_tiled_search_push_(search, tile, priority, &entry);
+        continue;
+      }
+    }
+    // Sources already hold their own distance
+    const TCODPATH_ValueType current = tile_distance[entry.local];
+    if (entry.direction ? priority >= current : priority > current) {
+      TCODPATH_STATS_ADD(search->stats, stale_pops, 1);
+      continue;
+    }
+    tile_distance[entry.local] = priority;
+    if (tile_direction) tile_direction[entry.local] = entry.direction;
+    TCODPATH_STATS_ADD(search->stats, expansions, 1);
+    if (tile_costs[entry.local] <= 0) continue;  // Can not move from here
+    const int64_t ly = entry.local >> shift;
+    const int64_t lx = entry.local & mask;
+    for (int k = 0; k < 8 && err >= 0; ++k) {
+      const TCODPATH_ValueType edge_cost = TCODPATH_tiled_search_edge_cost_(search, k);
+      if (edge_cost <= 0) continue;
+      const int64_t y = y0 + ly + TCODPATH_TILED_DIRECTIONS[k][0];
+      const int64_t x = x0 + lx + TCODPATH_TILED_DIRECTIONS[k][1];
+      if (!TCODPATH_tiled_map_in_bounds(costs, y, x)) continue;
+      const int64_t leaf_tile = TCODPATH_tiled_map_tile_of(costs, y, x);
+      struct TCODPATH_TiledEntry_ leaf = {(int32_t)(((y & mask) << shift) | (x & mask)), (int8_t)(k + 1), false};
+      if (leaf_tile != tile && TCODPATH_tiled_search_find_resident_(search, leaf_tile) < 0) {
+        leaf.deferred = true;  // Reading the leaf would load its tile, check it once that tile is processed
+        err = TCODPATH_tiled_search_push_(search, leaf_tile, priority + edge_cost, &leaf);
+        continue;
+      }
+      const TCODPATH_ValueType leaf_cost =
+          ((const TCODPATH_ValueType*)TCODPATH_tiled_map_tile_data(costs, leaf_tile))[leaf.local];
+      if (leaf_cost <= 0) continue;
+      const TCODPATH_ValueType total_distance = priority + edge_cost * leaf_cost;
+      if (((const TCODPATH_ValueType*)TCODPATH_tiled_map_tile_data(search->distance, leaf_tile))[leaf.local] <=
+          total_distance) {
+        continue;
+      }
+      err = TCODPATH_tiled_search_push_(search, leaf_tile, total_distance, &leaf);
+    }
+  }
+  search->current_tile = -1;
+  if (err < 0) return err;
+  if (frontier->size > 0) {
+    return TCODPATH_minheap_push(&search->tile_queue, TCODPATH_minheap_peek_priority(frontier), &tile);
+  }
+  TCODPATH_heap_uninit(frontier);  // Finished tiles give back their frontier
+  return TCODPATH_E_OK;
+}
+/// @brief Run the search until every reachable node has its final distance.
+/// @return 0 on success, negative value on error.
+static inline int TCODPATH_tiled_search_run(TCODPATH_TiledSearch* __restrict search) {
+  if (!search || !search->frontiers) return TCODPATH_E_INVALID_ARGUMENT;
+  const int64_t begin_ns = TCODPATH_stats_phase_begin_(search->stats);
+  int err = 0;
+  while (search->tile_queue.size > 0 && err >= 0) {
+    const TCODPATH_ValueType priority = TCODPATH_minheap_peek_priority(&search->tile_queue);
+    int64_t tile;
+    TCODPATH_minheap_pop(&search->tile_queue, &tile);
+    const struct TCODPATH_Heap* frontier = &search->frontiers[tile];
+    if (frontier->size == 0 || TCODPATH_minheap_peek_priority(frontier) != priority) continue;  // Stale entry
+    err = TCODPATH_tiled_search_process_tile_(search, tile);
+  }
+  TCODPATH_stats_phase_end_(search->stats, TCODPATH_STATS_PHASE_SEARCH, begin_ns);
+  return err < 0 ? err : TCODPATH_E_OK;
+}
+/// @brief Return the parent of node `id` from a direction map written by a tiled search.
+/// @return The id of the node `id` was reached from, or -1 for sources and unreached nodes.
+static inline TCODPATH_LargeIdType TCODPATH_tiled_search_parent(
+    const TCODPATH_TiledMap* __restrict direction, TCODPATH_LargeIdType id) {
+  const int64_t y = id / direction->shape[1];
+  const int64_t x = id % direction->shape[1];
+  const int8_t k = *(const int8_t*)TCODPATH_tiled_map_at(direction, y, x);
+  if (k <= 0) return -1;
+  return TCODPATH_tiled_map_id(
+      direction, y - TCODPATH_TILED_DIRECTIONS[k - 1][0], x - TCODPATH_TILED_DIRECTIONS[k - 1][1]);
+}
+/// @brief Dijkstra over tiled maps, using the non-max values of `distance` as sources.
+/// @details Gives the same distances as `TCODPATH_dijkstra` on a `TCODPATH_GraphBasic2D` graph of the same costs,
+/// but only `TCODPATH_TILED_WORKING_SET` tiles are in memory at once, so the maps can be mapped files much larger
+/// than memory. Frontier priorities are `int`, so `TCODPATH_ValueType` distances must fit in an `int`.
+/// @param costs Map of `TCODPATH_ValueType` costs.
+/// @param distance Map of `TCODPATH_ValueType` distances to update in-place.
+/// @param direction Optional map of 1-byte directions to write, can be `NULL`.
+/// @param cardinal Multiplier for cardinal costs, or 0 to disable cardinal movement.
+/// @param diagonal Multiplier for diagonal costs, or 0 to disable diagonal movement.
+/// @param stats Optional counters to update, can be `NULL`.
+/// @return 0 on success, negative value on error.
+static inline int TCODPATH_tiled_dijkstra(
+    const TCODPATH_TiledMap* costs,
+    TCODPATH_TiledMap* distance,
+    TCODPATH_TiledMap* direction,
+    TCODPATH_ValueType cardinal,
+    TCODPATH_ValueType diagonal,
+    TCODPATH_SearchStats* stats) {
+  TCODPATH_TiledSearch search;
+  int err = TCODPATH_tiled_search_init(&search, costs, distance, direction, cardinal, diagonal);
+  if (err < 0) return err;
+  search.stats = stats;
+  err = TCODPATH_tiled_search_add_sources_from_distance(&search);
+  if (err >= 0) err = TCODPATH_tiled_search_run(&search);
+  TCODPATH_tiled_search_uninit(&search);
+  return err;
+}
@@ -0,0 +1,36 @@
+#pragma once
+
+#include <stdint.h>
+
+#include "allocator_types.h"
+#include "config.h"
+#include "heapq_types.h"
+#include "search_stats_types.h"
+#include "tiled_map_types.h"
+
+/// @brief Dijkstra over a `TCODPATH_TiledMap` which only keeps a working set of tiles in memory.
+/// @details The frontier is split into one heap per tile, and tiles are processed in order of their smallest
+/// distance. Edges into a tile outside of the working set are queued on that tile without reading it, so tiles are
+/// only read when they are processed and each is read as one contiguous block.
+/// Must be setup with `TCODPATH_tiled_search_init` and freed with `TCODPATH_tiled_search_uninit`.
+typedef struct TCODPATH_TiledSearch {
+  const TCODPATH_TiledMap* costs;  // Costs of entering each node, 0 or less for walls
+  TCODPATH_TiledMap* distance;  // Output distances
+  TCODPATH_TiledMap* direction;  // Optional output of 1-byte directions, see `TCODPATH_tiled_search_parent`
+  TCODPATH_ValueType cardinal;  // Multiplier for cardinal costs, or 0 to disable cardinal movement
+  TCODPATH_ValueType diagonal;  // Multiplier for diagonal costs, or 0 to disable diagonal movement
+  /// How far past the smallest distance of the other tiles a tile keeps being processed before switching.
+  /// 0 expands nodes in the same order as Dijkstra. Larger values switch tiles less often but can expand a node
+  /// more than once, the final distances are the same either way.
+  TCODPATH_ValueType slack;
+  int64_t tile_count;
+  struct TCODPATH_Heap* __restrict frontiers;  // Frontier of each tile, only allocated while it has nodes
+  struct TCODPATH_Heap tile_queue;  // Tile ids by the smallest distance of their frontier, may hold stale entries
+  int64_t current_tile;  // Tile being processed, or -1
+  int64_t resident[TCODPATH_TILED_WORKING_SET];  // Tiles in memory, or -1 for an empty slot
+  uint64_t resident_used[TCODPATH_TILED_WORKING_SET];  // When each slot was last used, for eviction
+  uint64_t clock;  // Incremented on every tile use
+  int64_t tile_loads;  // Number of times a tile was brought into the working set
+  TCODPATH_SearchStats* stats;  // Optional counters, can be NULL
+  TCODPATH_Allocator* allocator;  // Allocator of `frontiers` and of every heap, NULL for the global one
+} TCODPATH_TiledSearch;
@@ -4,26 +4,178 @@
 #include "graph_types.h"
 #include "heapq_tools.h"
 #include "heuristic_tools.h"
+#include "indexes.h"
 #include "map_tools.h"
 #include "map_types.h"
+#include "partition.h"
+#include "ring_buffer.h"
+#include "search_stats.h"
 #include "uniform_cost_search_types.h"
 
-static inline void TCODPATH_ucs_set_edge(
-    void* ucs_data_,
+/// @brief Return the unweighted heuristic of `index` at `distance`, counting the call in the search stats.
+/// Used internally.
+static inline TCODPATH_ValueType TCODPATH_ucs_heuristic_at_(
+    const TCODPATH_UniformCostSearch* __restrict ucs_data,
+    const TCODPATH_IndexType* __restrict index,
+    TCODPATH_ValueType distance) {
+  if (ucs_data->heuristic) TCODPATH_STATS_ADD(ucs_data->stats, heuristic_calls, 1);
+  return TCODPATH_heuristic_at(ucs_data->heuristic, ucs_data->dimensions, index, distance);
+}
+/// @brief Return the frontier priority of a node at `distance` with the unweighted heuristic `f`.
+/// Used internally.
+static inline int TCODPATH_ucs_weighted_(
+    const TCODPATH_UniformCostSearch* __restrict ucs_data, TCODPATH_ValueType f, TCODPATH_ValueType distance) {
+  if (!ucs_data->heuristic_weight || ucs_data->heuristic_weight == 100) return f;
+  return distance + (int)((int64_t)(f - distance) * ucs_data->heuristic_weight / 100);
+}
+/// @brief Return the frontier priority of `index` at `distance`, applying the heuristic weight.
+static inline int TCODPATH_ucs_priority(
+    const TCODPATH_UniformCostSearch* __restrict ucs_data,
+    const TCODPATH_IndexType* __restrict index,
+    TCODPATH_ValueType distance) {
+  return TCODPATH_ucs_weighted_(ucs_data, TCODPATH_ucs_heuristic_at_(ucs_data, index, distance), distance);
+}
+/// @brief Return true if anytime mode can discard a node with the unweighted heuristic `f`.
+/// Used internally.
+static inline bool TCODPATH_ucs_is_pruned_(
+    const TCODPATH_UniformCostSearch* __restrict ucs_data, TCODPATH_ValueType f) {
+  if (!ucs_data->anytime || ucs_data->incumbent == TCODPATH_VALUE_MAX) return false;
+  return f >= ucs_data->incumbent;
+}
+/// @brief Add `index` at `distance` to the frontier with the unweighted heuristic `f`.
+/// Records the push in the search stats and trace.
+/// Used internally.
+static inline int TCODPATH_ucs_frontier_push_(
+    TCODPATH_UniformCostSearch* __restrict ucs_data,
+    const TCODPATH_IndexType* __restrict index,
+    TCODPATH_ValueType distance,
+    TCODPATH_ValueType f) {
+#if TCODPATH_STATS_ENABLED
+  const int old_capacity = ucs_data->frontier.capacity;
+#endif
+  const int err = TCODPATH_minheap_push(&ucs_data->frontier, TCODPATH_ucs_weighted_(ucs_data, f, distance), index);
+  TCODPATH_TRACE(ucs_data->trace, TCODPATH_TRACE_PUSH, ucs_data->dimensions, index, distance);
+  TCODPATH_STATS_ADD(ucs_data->stats, pushes, 1);
+  TCODPATH_STATS_MAX(ucs_data->stats, peak_frontier, ucs_data->frontier.size);
+  TCODPATH_STATS_ADD(
+      ucs_data->stats,
+      bytes_allocated,
+      (int64_t)(ucs_data->frontier.capacity - old_capacity) * ucs_data->frontier.node_size);
+  return err;
+}
+/// @brief Record a path through `index` if the search from the other end has also reached it.
+/// Used internally.
+static inline void TCODPATH_ucs_meet_(
+    TCODPATH_UniformCostSearch* __restrict ucs_data,
+    const TCODPATH_IndexType* __restrict index,
+    TCODPATH_ValueType distance) {
+  if (!ucs_data->opposite || TCODPATH_map_is_max(ucs_data->opposite, index)) return;
+  const TCODPATH_ValueType total_distance = distance + TCODPATH_map_get(ucs_data->opposite, index);
+  if (total_distance >= ucs_data->meeting_distance) return;
+  ucs_data->meeting_distance = total_distance;
+  for (int i = 0; i < ucs_data->dimensions; ++i) ucs_data->meeting[i] = index[i];
+}
+
+/// @brief Relax the edge reaching `leaf_index` from the expanded node `root_index`.
+/// Used internally.
+static inline void TCODPATH_ucs_relax_(
+    TCODPATH_UniformCostSearch* __restrict ucs_data,
     const TCODPATH_IndexType* __restrict root_index,
     const TCODPATH_IndexType* __restrict leaf_index,
     TCODPATH_ValueType edge_cost) {
-  TCODPATH_UniformCostSearch* __restrict ucs_data = (TCODPATH_UniformCostSearch*)ucs_data_;
   const TCODPATH_ValueType distance_at_root = TCODPATH_map_get(ucs_data->distance, root_index);
   const TCODPATH_ValueType distance_at_leaf = TCODPATH_map_get(ucs_data->distance, leaf_index);
   const TCODPATH_ValueType total_distance = distance_at_root + edge_cost;
   if (distance_at_leaf <= total_distance) return;  // This edge is not better than a previous edge
+  if (ucs_data->has_distance_limit && total_distance > ucs_data->distance_limit) return;  // Out of range
+  if (ucs_data->closed && TCODPATH_map_get(ucs_data->closed, leaf_index)) {
+    // Do not reopen, but remember how much this node could have improved the lower bound
+    const TCODPATH_ValueType f = TCODPATH_ucs_heuristic_at_(ucs_data, leaf_index, total_distance);
+    ucs_data->inconsistent_bound = TCODPATH_MIN(ucs_data->inconsistent_bound, f);
+    return;
+  }
+  if (ucs_data->touched && TCODPATH_map_is_max(ucs_data->distance, leaf_index)) {
+    TCODPATH_ring_buffer_append(ucs_data->touched, sizeof(*leaf_index) * ucs_data->dimensions, leaf_index);
+  }
   TCODPATH_map_set(ucs_data->distance, leaf_index, total_distance);
-  TCODPATH_minheap_push(
-      &ucs_data->frontier,
-      TCODPATH_heuristic_at(ucs_data->heuristic, ucs_data->dimensions, leaf_index, total_distance),
-      leaf_index);
   if (ucs_data->flow) TCODPATH_map_set_index(ucs_data->flow, leaf_index, root_index);
+  if (ucs_data->label) TCODPATH_map_set(ucs_data->label, leaf_index, TCODPATH_map_get(ucs_data->label, root_index));
+  TCODPATH_ucs_meet_(ucs_data, leaf_index, total_distance);
+  if (ucs_data->anytime && ucs_data->has_goal &&
+      TCODPATH_indexes_equal(ucs_data->dimensions, leaf_index, ucs_data->goal)) {
+    ucs_data->incumbent = total_distance;  // Improved solution, the goal itself is never expanded
+    return;
+  }
+  const TCODPATH_ValueType f = TCODPATH_ucs_heuristic_at_(ucs_data, leaf_index, total_distance);
+  if (TCODPATH_ucs_is_pruned_(ucs_data, f)) return;
+  TCODPATH_ucs_frontier_push_(ucs_data, leaf_index, total_distance, f);
+}
+static inline void TCODPATH_ucs_set_edge(
+    void* ucs_data_,
+    const TCODPATH_IndexType* __restrict root_index,
+    const TCODPATH_IndexType* __restrict leaf_index,
+    TCODPATH_ValueType edge_cost) {
+  TCODPATH_ucs_relax_((TCODPATH_UniformCostSearch*)ucs_data_, root_index, leaf_index, edge_cost);
+}
+/// @brief Edge callback for reverse searches, the expanded node is `leaf_index` and the new node is `root_index`.
+static inline void TCODPATH_ucs_set_reverse_edge(
+    void* ucs_data_,
+    const TCODPATH_IndexType* __restrict root_index,
+    const TCODPATH_IndexType* __restrict leaf_index,
+    TCODPATH_ValueType edge_cost) {
+  TCODPATH_ucs_relax_((TCODPATH_UniformCostSearch*)ucs_data_, leaf_index, root_index, edge_cost);
+}
+
+/// @brief Setup `ucs_data` for a new search. The frontier will be empty.
+/// @return 0 on success, negative value on error.
+static inline int TCODPATH_ucs_init(
+    TCODPATH_UniformCostSearch* __restrict ucs_data,
+    TCODPATH_Graph* __restrict graph,
+    TCODPATH_Heuristic* __restrict heuristic,
+    TCODPATH_Map* __restrict distance,
+    TCODPATH_Map* __restrict flow) {
+  if (!ucs_data || !graph || !distance) return TCODPATH_E_INVALID_ARGUMENT;
+  *ucs_data = TCODPATH_UniformCostSearch{};
+  ucs_data->dimensions = TCODPATH_map_get_dimensions(distance);
+  ucs_data->graph = graph;
+  ucs_data->heuristic = heuristic;
+  ucs_data->distance = distance;
+  ucs_data->flow = flow;
+  ucs_data->incumbent = TCODPATH_VALUE_MAX;
+  ucs_data->inconsistent_bound = TCODPATH_VALUE_MAX;
+  ucs_data->meeting_distance = TCODPATH_VALUE_MAX;
+  return TCODPATH_heap_init(&ucs_data->frontier, ucs_data->dimensions * sizeof(TCODPATH_IndexType));
+}
+/// @brief Free the frontier of `ucs_data`.
+static inline void TCODPATH_ucs_uninit(TCODPATH_UniformCostSearch* __restrict ucs_data) {
+  if (!ucs_data) return;
+  TCODPATH_heap_uninit(&ucs_data->frontier);
+}
+/// @brief Add `index` to the frontier using its current distance.
+/// @return 0 on success, negative value on error.
+static inline int TCODPATH_ucs_push(TCODPATH_UniformCostSearch* __restrict ucs_data, const TCODPATH_IndexType* index) {
+  const TCODPATH_ValueType distance_here = TCODPATH_map_get(ucs_data->distance, index);
+  TCODPATH_ucs_meet_(ucs_data, index, distance_here);
+  if (ucs_data->anytime && ucs_data->has_goal && TCODPATH_indexes_equal(ucs_data->dimensions, index, ucs_data->goal)) {
+    ucs_data->incumbent = TCODPATH_MIN(ucs_data->incumbent, distance_here);
+    return TCODPATH_E_OK;
+  }
+  return TCODPATH_ucs_frontier_push_(
+      ucs_data, index, distance_here, TCODPATH_ucs_heuristic_at_(ucs_data, index, distance_here));
+}
+/// @brief Set the goal of `ucs_data`. The search will be complete once `goal` is reached.
+static inline void TCODPATH_ucs_set_goal(
+    TCODPATH_UniformCostSearch* __restrict ucs_data, const TCODPATH_IndexType* __restrict goal) {
+  ucs_data->has_goal = goal != NULL;
+  if (!goal) return;
+  for (int i = 0; i < ucs_data->dimensions; ++i) ucs_data->goal[i] = goal[i];
+}
+/// @brief Return true if the distance at `index` can no longer be improved by `ucs_data`.
+/// Only valid for searches without a heuristic.
+static inline bool TCODPATH_ucs_is_settled(
+    const TCODPATH_UniformCostSearch* __restrict ucs_data, const TCODPATH_IndexType* index) {
+  if (TCODPATH_map_is_max(ucs_data->distance, index)) return false;
+  return TCODPATH_map_get(ucs_data->distance, index) <= TCODPATH_minheap_peek_priority(&ucs_data->frontier);
 }
 
 /// @brief Preform a single iteration of UCS. Return the status.
@@ -32,32 +184,283 @@ static inline int TCODPATH_ucs_step(TCODPATH_UniformCostSearch* __restrict ucs_d
   if (!ucs_data) return TCODPATH_E_INVALID_ARGUMENT;
   if (ucs_data->frontier.size <= 0) return 1;  // Iteration complete
 
+  const int priority = TCODPATH_minheap_peek_priority(&ucs_data->frontier);
   TCODPATH_IndexType index[TCODPATH_MAX_DIMENSIONS];
   TCODPATH_minheap_pop(&ucs_data->frontier, index);
-  TCODPATH_graph_foreach_edge(ucs_data->graph, ucs_data->dimensions, index, TCODPATH_ucs_set_edge, ucs_data);
+  if (ucs_data->has_goal && TCODPATH_indexes_equal(ucs_data->dimensions, index, ucs_data->goal)) return 1;
+  const TCODPATH_ValueType distance_here = TCODPATH_map_get(ucs_data->distance, index);
+  const TCODPATH_ValueType f = TCODPATH_ucs_heuristic_at_(ucs_data, index, distance_here);  // Once per pop
+  if (priority > TCODPATH_ucs_weighted_(ucs_data, f, distance_here)) {
+    TCODPATH_STATS_ADD(ucs_data->stats, stale_pops, 1);
+    return 0;  // Stale entry, this node was already expanded with a shorter distance
+  }
+  if (TCODPATH_ucs_is_pruned_(ucs_data, f)) return 0;
+  if (ucs_data->closed) TCODPATH_map_set(ucs_data->closed, index, 1);
+  TCODPATH_STATS_ADD(ucs_data->stats, expansions, 1);
+  TCODPATH_TRACE(ucs_data->trace, TCODPATH_TRACE_EXPAND, ucs_data->dimensions, index, distance_here);
+  if (ucs_data->reverse) {
+    TCODPATH_graph_foreach_reverse_edge(
+        ucs_data->graph, ucs_data->dimensions, index, TCODPATH_ucs_set_reverse_edge, ucs_data);
+  } else {
+    TCODPATH_graph_foreach_edge(ucs_data->graph, ucs_data->dimensions, index, TCODPATH_ucs_set_edge, ucs_data);
+  }
   return 0;  // Iteration continues
 }
+/// @brief Return a lower bound on the distance to the goal of `ucs_data`, using the unweighted heuristic.
+/// @details This is the lowest `f` of any frontier node, closed node found again at a shorter distance, or the goal.
+/// The heuristic must be admissible for this to be a true lower bound.
+static inline TCODPATH_ValueType TCODPATH_ucs_lower_bound(TCODPATH_UniformCostSearch* __restrict ucs_data) {
+  TCODPATH_ValueType lower_bound = ucs_data->inconsistent_bound;
+  if (ucs_data->has_goal) lower_bound = TCODPATH_MIN(lower_bound, TCODPATH_map_get(ucs_data->distance, ucs_data->goal));
+  for (int i = 0; i < ucs_data->frontier.size; ++i) {
+    const TCODPATH_IndexType* index = (const TCODPATH_IndexType*)TCODPATH_heap_address_data_(&ucs_data->frontier, i);
+    const TCODPATH_ValueType f =
+        TCODPATH_ucs_heuristic_at_(ucs_data, index, TCODPATH_map_get(ucs_data->distance, index));
+    lower_bound = TCODPATH_MIN(lower_bound, f);
+  }
+  return lower_bound;
+}
+/// @brief Run up to `max_steps` iterations of UCS. The search can be resumed by calling this again.
+/// @param ucs_data Search state.
+/// @param max_steps Maximum number of iterations to run.
+/// @param steps_out Optional output for the number of iterations which were run.
+/// @return `1` when complete, `0` when the budget ran out first, negative value on error.
+/// The time spent is added to the search phase of `ucs_data->stats`.
+static inline int TCODPATH_ucs_run(TCODPATH_UniformCostSearch* __restrict ucs_data, int max_steps, int* steps_out) {
+  const int64_t begin_ns = TCODPATH_stats_phase_begin_(ucs_data ? ucs_data->stats : NULL);
+  int steps = 0;
+  int result = 0;
+  while (steps < max_steps) {
+    result = TCODPATH_ucs_step(ucs_data);
+    if (result != 0) break;
+    ++steps;
+  }
+  if (steps_out) *steps_out = steps;
+  if (ucs_data) TCODPATH_stats_phase_end_(ucs_data->stats, TCODPATH_STATS_PHASE_SEARCH, begin_ns);
+  return result;
+}
 
-static inline void TCODPATH_dijkstra(
-    TCODPATH_Graph* __restrict graph, TCODPATH_Map* __restrict distance, TCODPATH_Map* __restrict flow) {
-  TCODPATH_UniformCostSearch ucs_data = {0};
-  const int dimensions = ucs_data.dimensions = TCODPATH_map_get_dimensions(distance);
+/// @brief Run a Dijkstra search from the non-max values of `distance`, updating `stats` when it is not `NULL`.
+/// Used internally.
+static inline void TCODPATH_dijkstra_from_sources_(
+    TCODPATH_Graph* __restrict graph,
+    TCODPATH_Map* __restrict distance,
+    TCODPATH_Map* __restrict flow,
+    bool reverse,
+    TCODPATH_SearchStats* __restrict stats) {
+  TCODPATH_UniformCostSearch ucs_data;
+  if (TCODPATH_ucs_init(&ucs_data, graph, NULL, distance, flow) < 0) return;
+  ucs_data.reverse = reverse;
+  ucs_data.stats = stats;
+  const int64_t begin_ns = TCODPATH_stats_phase_begin_(stats);
+  const int dimensions = ucs_data.dimensions;
   TCODPATH_IndexType index[TCODPATH_MAX_DIMENSIONS];
-  TCODPATH_heap_init(&ucs_data.frontier, dimensions * sizeof(*index));
-  ucs_data.graph = graph;
-  ucs_data.distance = distance;
-  ucs_data.flow = flow;
 
   // Use non-max values of distance to initialize the frontier
   for (TCODPATH_indexes_iter_begin(dimensions, index);
        TCODPATH_indexes_iter_step(dimensions, TCODPATH_map_get_shape(distance), index);) {
     if (TCODPATH_map_is_max(distance, index)) continue;
-    const TCODPATH_ValueType distance_here = TCODPATH_map_get(distance, index);
-    TCODPATH_minheap_push(&ucs_data.frontier, TCODPATH_heuristic_at(NULL, dimensions, index, distance_here), index);
+    TCODPATH_ucs_push(&ucs_data, index);
   }
   while (true) {
     int err = TCODPATH_ucs_step(&ucs_data);
     if (err != 0) break;
   }
-  TCODPATH_heap_uninit(&ucs_data.frontier);
+  TCODPATH_stats_phase_end_(stats, TCODPATH_STATS_PHASE_SEARCH, begin_ns);
+  TCODPATH_ucs_uninit(&ucs_data);
+}
+/// @brief Compute a Dijkstra distance map over `graph`, using the non-max values of `distance` as sources.
+/// @param graph Graph to traverse.
+/// @param distance Distance map to update in-place.
+/// @param flow Optional flow map to write during the search. Can be `NULL` to only write `distance`, in which case
+/// the flow can be derived afterwards with `TCODPATH_flow_from_distance`.
+static inline void TCODPATH_dijkstra(
+    TCODPATH_Graph* __restrict graph, TCODPATH_Map* __restrict distance, TCODPATH_Map* __restrict flow) {
+  TCODPATH_dijkstra_from_sources_(graph, distance, flow, false, NULL);
+}
+/// @brief Compute the distance from every node to the nearest non-max value of `distance`, following edges backwards.
+/// @details On graphs with asymmetric costs this differs from `TCODPATH_dijkstra`, which measures distances from the
+/// sources. With a single goal as the source the result is an exact heuristic for searches towards that goal.
+/// @param graph Graph to traverse.
+/// @param distance Distance map to update in-place.
+/// @param flow Optional flow map to write. Each node points to the next node on its path to the nearest source.
+static inline void TCODPATH_dijkstra_reverse(
+    TCODPATH_Graph* __restrict graph, TCODPATH_Map* __restrict distance, TCODPATH_Map* __restrict flow) {
+  TCODPATH_dijkstra_from_sources_(graph, distance, flow, true, NULL);
+}
+/// @brief Multi-source Dijkstra which labels every reached node with the id of its nearest source.
+/// @details This is a graph Voronoi partition of `sources`. All sources are searched in a single pass.
+/// `distance` should be cleared with `TCODPATH_map_clear_max` beforehand, and nodes which are never reached keep their
+/// previous `label` value.
+/// @param graph Graph to traverse.
+/// @param distance Distance map to write. Each source is set to zero.
+/// @param flow Optional flow map to write, can be `NULL`.
+/// @param label Output map of source ids. The source at `sources[i]` has the id `i`.
+/// @param source_n Number of sources.
+/// @param sources Contiguous array of `source_n` indexes.
+/// @param query_n Number of query indexes, or zero to search the entire graph.
+/// @param queries Contiguous array of `query_n` indexes. The search stops once all of these have been settled.
+/// @return 0 on success, negative value on error.
+static inline int TCODPATH_dijkstra_nearest(
+    TCODPATH_Graph* __restrict graph,
+    TCODPATH_Map* __restrict distance,
+    TCODPATH_Map* __restrict flow,
+    TCODPATH_Map* __restrict label,
+    int source_n,
+    const TCODPATH_IndexType* __restrict sources,
+    int query_n,
+    const TCODPATH_IndexType* __restrict queries) {
+  if (!label || (source_n > 0 && !sources) || (query_n > 0 && !queries)) return TCODPATH_E_INVALID_ARGUMENT;
+  TCODPATH_UniformCostSearch ucs_data;
+  int err = TCODPATH_ucs_init(&ucs_data, graph, NULL, distance, flow);
+  if (err < 0) return err;
+  ucs_data.label = label;
+  const int dimensions = ucs_data.dimensions;
+  for (int i = 0; i < source_n; ++i) {
+    const TCODPATH_IndexType* source = sources + i * dimensions;
+    TCODPATH_map_set(distance, source, 0);
+    TCODPATH_map_set(label, source, i);
+    err = TCODPATH_ucs_push(&ucs_data, source);
+    if (err < 0) break;
+  }
+  int pending_queries = 0;  // Queries before this index have been settled
+  while (err >= 0) {
+    while (pending_queries < query_n && TCODPATH_ucs_is_settled(&ucs_data, queries + pending_queries * dimensions)) {
+      ++pending_queries;
+    }
+    if (query_n > 0 && pending_queries == query_n) break;  // All queries have their final distance and label
+    err = TCODPATH_ucs_step(&ucs_data);
+    if (err != 0) break;
+  }
+  TCODPATH_ucs_uninit(&ucs_data);
+  return err < 0 ? err : TCODPATH_E_OK;
+}
+/// @brief Dijkstra search from `sources` which stops at `limit` and only visits the nodes within range.
+/// @details Unlike `TCODPATH_dijkstra` this never scans the whole map, the cost follows the area searched.
+/// `distance` must be all max values before the call. Afterwards it can be restored with `TCODPATH_map_reset_touched`
+/// instead of `TCODPATH_map_clear_max`. The flow map does not need to be reset, it is only valid where `distance` is.
+/// @param graph Graph to traverse.
+/// @param distance Distance map to write. Each source is set to zero.
+/// @param flow Optional flow map to write, can be `NULL`.
+/// @param source_n Number of sources.
+/// @param sources Contiguous array of `source_n` indexes.
+/// @param limit Maximum distance to reach. Nodes further than this keep their max value.
+/// @param touched Optional output, every index given a distance is appended to this buffer.
+/// @return 0 on success, negative value on error.
+static inline int TCODPATH_dijkstra_bounded(
+    TCODPATH_Graph* __restrict graph,
+    TCODPATH_Map* __restrict distance,
+    TCODPATH_Map* __restrict flow,
+    int source_n,
+    const TCODPATH_IndexType* __restrict sources,
+    TCODPATH_ValueType limit,
+    TCODPATH_RingBuffer* __restrict touched) {
+  if (source_n > 0 && !sources) return TCODPATH_E_INVALID_ARGUMENT;
+  TCODPATH_UniformCostSearch ucs_data;
+  int err = TCODPATH_ucs_init(&ucs_data, graph, NULL, distance, flow);
+  if (err < 0) return err;
+  ucs_data.has_distance_limit = true;
+  ucs_data.distance_limit = limit;
+  ucs_data.touched = touched;
+  const int dimensions = ucs_data.dimensions;
+  for (int i = 0; i < source_n && err >= 0; ++i) {
+    const TCODPATH_IndexType* source = sources + i * dimensions;
+    if (!TCODPATH_map_in_bounds(distance, source)) continue;
+    if (touched && TCODPATH_map_is_max(distance, source)) {
+      err = TCODPATH_ring_buffer_append(touched, sizeof(*source) * dimensions, source);
+      if (err < 0) break;
+    }
+    TCODPATH_map_set(distance, source, 0);
+    err = TCODPATH_ucs_push(&ucs_data, source);
+  }
+  while (err >= 0) {
+    err = TCODPATH_ucs_step(&ucs_data);
+    if (err != 0) break;
+  }
+  TCODPATH_ucs_uninit(&ucs_data);
+  return err < 0 ? err : TCODPATH_E_OK;
+}
+/// @brief Search from `start` until `goal` is reached, using `heuristic` to guide the search.
+/// @details `distance` should be cleared with `TCODPATH_map_clear_max` beforehand.
+/// @param graph Graph to traverse.
+/// @param heuristic Optional heuristic, can be `NULL` for a Dijkstra search.
+/// @param distance Distance map to write. `start` is set to zero.
+/// @param flow Optional flow map to write, can be `NULL`.
+/// @param start Start index.
+/// @param goal Goal index.
+/// @param partition Optional connectivity labels, see `TCODPATH_partition_is_reachable`.
+/// When given, goals in a different partition are rejected without searching.
+/// @return 0 if `goal` was reached, 1 if `goal` is unreachable, negative value on error.
+static inline int TCODPATH_astar(
+    TCODPATH_Graph* __restrict graph,
+    TCODPATH_Heuristic* __restrict heuristic,
+    TCODPATH_Map* __restrict distance,
+    TCODPATH_Map* __restrict flow,
+    const TCODPATH_IndexType* __restrict start,
+    const TCODPATH_IndexType* __restrict goal,
+    const TCODPATH_Map* __restrict partition) {
+  if (!start || !goal) return TCODPATH_E_INVALID_ARGUMENT;
+  if (!TCODPATH_partition_is_reachable(partition, start, goal)) return 1;
+  TCODPATH_UniformCostSearch ucs_data;
+  int err = TCODPATH_ucs_init(&ucs_data, graph, heuristic, distance, flow);
+  if (err < 0) return err;
+  TCODPATH_ucs_set_goal(&ucs_data, goal);
+  TCODPATH_map_set(distance, start, 0);
+  err = TCODPATH_ucs_push(&ucs_data, start);
+  while (err >= 0) {
+    err = TCODPATH_ucs_step(&ucs_data);
+    if (err != 0) break;
+  }
+  TCODPATH_ucs_uninit(&ucs_data);
+  if (err < 0) return err;
+  return TCODPATH_map_is_max(distance, goal) ? 1 : 0;
+}
+/// @brief Weighted A* search from `start` to `goal` which reports how close the result is to optimal.
+/// @details Nodes are ordered by `g + h * weight / 100`, which bounds the path cost to `weight / 100` times the
+/// optimal cost when `heuristic` is admissible. The bound actually achieved is often much tighter and is written to
+/// `bound_out`. `distance` should be cleared with `TCODPATH_map_clear_max` beforehand.
+/// @param graph Graph to traverse.
+/// @param heuristic Admissible heuristic for `goal`.
+/// @param weight Heuristic weight in percent, at least 100.
+/// @param distance Distance map to write. `start` is set to zero.
+/// @param flow Optional flow map to write, can be `NULL`.
+/// @param closed Optional map of expanded nodes, all zero beforehand. When given, nodes are never reopened.
+/// This is the duplicate detection policy: reopening finds better paths while not reopening expands fewer nodes.
+/// Both keep the bound.
+/// @param start Start index.
+/// @param goal Goal index.
+/// @param bound_out Optional output for the achieved suboptimality bound in percent, `100` means optimal.
+/// @return 0 if `goal` was reached, 1 if `goal` is unreachable, negative value on error.
+static inline int TCODPATH_weighted_astar(
+    TCODPATH_Graph* __restrict graph,
+    TCODPATH_Heuristic* __restrict heuristic,
+    int weight,
+    TCODPATH_Map* __restrict distance,
+    TCODPATH_Map* __restrict flow,
+    TCODPATH_Map* __restrict closed,
+    const TCODPATH_IndexType* __restrict start,
+    const TCODPATH_IndexType* __restrict goal,
+    int* __restrict bound_out) {
+  if (!start || !goal || weight < 100) return TCODPATH_E_INVALID_ARGUMENT;
+  TCODPATH_UniformCostSearch ucs_data;
+  int err = TCODPATH_ucs_init(&ucs_data, graph, heuristic, distance, flow);
+  if (err < 0) return err;
+  ucs_data.heuristic_weight = weight;
+  ucs_data.closed = closed;
+  TCODPATH_ucs_set_goal(&ucs_data, goal);
+  TCODPATH_map_set(distance, start, 0);
+  err = TCODPATH_ucs_push(&ucs_data, start);
+  while (err >= 0) {
+    err = TCODPATH_ucs_step(&ucs_data);
+    if (err != 0) break;
+  }
+  if (err >= 0 && bound_out && !TCODPATH_map_is_max(distance, goal)) {
+    const TCODPATH_ValueType cost = TCODPATH_map_get(distance, goal);
+    const TCODPATH_ValueType lower_bound = TCODPATH_ucs_lower_bound(&ucs_data);
+    *bound_out = lower_bound > 0 ? (int)(((int64_t)cost * 100 + lower_bound - 1) / lower_bound) : 100;
+    *bound_out = TCODPATH_MIN(*bound_out, weight);
+  }
+  TCODPATH_ucs_uninit(&ucs_data);
+  if (err < 0) return err;
+  return TCODPATH_map_is_max(distance, goal) ? 1 : 0;
 }
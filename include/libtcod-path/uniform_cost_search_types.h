@@ -4,6 +4,8 @@
 #include "heapq_types.h"
 #include "heuristic_types.h"
 #include "map_types.h"
+#include "ring_buffer_types.h"
+#include "search_stats_types.h"
 
 /// @brief State for Uniform-cost-search.
 typedef struct TCODPATH_UniformCostSearch {
@@ -13,4 +15,21 @@ typedef struct TCODPATH_UniformCostSearch {
   TCODPATH_Heuristic* __restrict heuristic;
   TCODPATH_Map* __restrict distance;
   TCODPATH_Map* __restrict flow;
+  TCODPATH_Map* __restrict label;  // Optional map of source labels, propagated along with distance
+  bool has_goal;  // If true then the search is complete once `goal` is reached
+  TCODPATH_IndexType goal[TCODPATH_MAX_DIMENSIONS];
+  int heuristic_weight;  // Heuristic multiplier in percent, `0` is the same as `100`
+  bool anytime;  // If true then the search continues after reaching `goal`, improving `incumbent`
+  TCODPATH_ValueType incumbent;  // Best known distance to `goal` in anytime mode
+  bool has_distance_limit;  // If true then nodes further than `distance_limit` are never reached
+  TCODPATH_ValueType distance_limit;
+  TCODPATH_RingBuffer* __restrict touched;  // Optional record of every node given its first distance
+  TCODPATH_Map* __restrict closed;  // Optional map of expanded nodes, when set expanded nodes are never reopened
+  TCODPATH_ValueType inconsistent_bound;  // Lowest `f` of closed nodes which were found again at a shorter distance
+  bool reverse;  // If true then edges are traversed backwards, `distance` is then the distance to the sources
+  const TCODPATH_Map* __restrict opposite;  // Optional distance map of a search from the other end
+  TCODPATH_ValueType meeting_distance;  // Shortest path found through a node reached by both this and `opposite`
+  TCODPATH_IndexType meeting[TCODPATH_MAX_DIMENSIONS];  // Node where `meeting_distance` was found
+  TCODPATH_SearchStats* __restrict stats;  // Optional counters updated by each step
+  const TCODPATH_SearchTrace* __restrict trace;  // Optional callback for every push and expansion
 } TCODPATH_UniformCostSearch;
@@ -0,0 +1,315 @@
+#pragma once
+/// Per-query benchmark results saved as a baseline JSON file, and a paired comparison between two of them.
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <cstddef>
+#include <cstdlib>
+#include <istream>
+#include <iterator>
+#include <map>
+#include <ostream>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace bench {
+/// Identifies baseline files in their `format` field.
+inline constexpr const char* BASELINE_FORMAT = "libtcod-path-bench-baseline";
+inline constexpr int BASELINE_VERSION = 1;
+
+/// Results of every query of one benchmark run. Each metric holds one value per query, in scenario order.
+struct Baseline {
+  std::string map{};
+  std::size_t queries{};
+  int repeat{};
+  int weight{};
+  std::map<std::string, std::map<std::string, std::vector<double>>> modes{};  // mode -> metric -> values
+};
+
+/// A parsed JSON value, only what baseline files need.
+struct JsonValue {
+  enum class Type { null, boolean, number, string, array, object };
+  Type type{Type::null};
+  bool boolean{};
+  double number{};
+  std::string string{};
+  std::vector<JsonValue> items{};  // Array items or object values
+  std::vector<std::string> keys{};  // Object keys, parallel to `items`
+
+  /// Return the value of `key`, throw if this is not an object with that key.
+  [[nodiscard]] auto at(const std::string& key) const -> const JsonValue& {
+    const auto found = std::find(keys.begin(), keys.end(), key);
+    if (type != Type::object || found == keys.end()) throw std::runtime_error("missing JSON key: " + key);
+    return items.at(static_cast<std::size_t>(found - keys.begin()));
+  }
+  [[nodiscard]] auto as_number() const -> double {
+    if (type != Type::number) throw std::runtime_error("expected a JSON number");
+    return number;
+  }
+  [[nodiscard]] auto as_string() const -> const std::string& {
+    if (type != Type::string) throw std::runtime_error("expected a JSON string");
+    return string;
+  }
+};
+
+/// Recursive descent JSON parser. Throws `std::runtime_error` on malformed input.
+class JsonParser {
+ public:
+  explicit JsonParser(std::string text) : text_{std::move(text)} {}
+  auto parse() -> JsonValue {
+    auto value = parse_value();
+    skip_space();
+    if (position_ != text_.size()) fail("trailing characters");
+    return value;
+  }
+
+ private:
+  [[noreturn]] void fail(const std::string& message) const {
+    throw std::runtime_error("JSON parse error at offset " + std::to_string(position_) + ": " + message);
+  }
+  void skip_space() {
+    while (position_ < text_.size() && std::isspace(static_cast<unsigned char>(text_[position_]))) ++position_;
+  }
+  auto peek() -> char {
+    skip_space();
+    if (position_ >= text_.size()) fail("unexpected end of input");
+    return text_[position_];
+  }
+  void expect(char c) {
+    if (peek() != c) fail(std::string("expected '") + c + "'");
+    ++position_;
+  }
+  auto consume_word(const char* word) -> bool {
+    const auto length = std::char_traits<char>::length(word);
+    if (text_.compare(position_, length, word) != 0) return false;
+    position_ += length;
+    return true;
+  }
+  auto parse_string() -> std::string {
+    expect('"');
+    auto result = std::string{};
+    while (true) {
+      if (position_ >= text_.size()) fail("unterminated string");
+      const char c = text_[position_++];
+      if (c == '"') return result;
+      if (c != '\\') {
+        result.push_back(c);
+        continue;
+      }
+      if (position_ >= text_.size()) fail("unterminated string");
+      const char escaped = text_[position_++];
+      switch (escaped) {
+        case 'n':
+          result.push_back('\n');
+          break;
+        case 't':
+          result.push_back('\t');
+          break;
+        case 'r':
+          result.push_back('\r');
+          break;
+        case 'b':
+          result.push_back('\b');
+          break;
+        case 'f':
+          result.push_back('\f');
+          break;
+        case 'u':
+          fail("unicode escapes are not supported");
+        default:
+          result.push_back(escaped);  // Quotes, backslashes, and slashes
+      }
+    }
+  }
+  auto parse_value() -> JsonValue {
+    auto value = JsonValue{};
+    const char c = peek();
+    if (c == '{') {
+      value.type = JsonValue::Type::object;
+      ++position_;
+      while (peek() != '}') {
+        value.keys.push_back(parse_string());
+        expect(':');
+        value.items.push_back(parse_value());
+        if (peek() != ',') break;
+        ++position_;
+      }
+      expect('}');
+    } else if (c == '[') {
+      value.type = JsonValue::Type::array;
+      ++position_;
+      while (peek() != ']') {
+        value.items.push_back(parse_value());
+        if (peek() != ',') break;
+        ++position_;
+      }
+      expect(']');
+    } else if (c == '"') {
+      value.type = JsonValue::Type::string;
+      value.string = parse_string();
+    } else if (consume_word("true")) {
+      value.type = JsonValue::Type::boolean;
+      value.boolean = true;
+    } else if (consume_word("false")) {
+      value.type = JsonValue::Type::boolean;
+    } else if (consume_word("null")) {
+      value.type = JsonValue::Type::null;
+    } else {
+      const char* begin = text_.c_str() + position_;
+      char* end = nullptr;
+      value.type = JsonValue::Type::number;
+      value.number = std::strtod(begin, &end);
+      if (end == begin) fail("unexpected character");
+      position_ += static_cast<std::size_t>(end - begin);
+    }
+    return value;
+  }
+
+  std::string text_;
+  std::size_t position_{};
+};
+
+/// Write `baseline` as JSON.
+inline void save_baseline(std::ostream& out, const Baseline& baseline) {
+  const auto precision = out.precision(17);  // Round trips doubles exactly
+  out << "{\n  \"format\": \"" << BASELINE_FORMAT << "\",\n  \"version\": " << BASELINE_VERSION
+      << ",\n  \"map\": \"" << baseline.map << "\",\n  \"queries\": " << baseline.queries
+      << ",\n  \"repeat\": " << baseline.repeat << ",\n  \"weight\": " << baseline.weight << ",\n  \"modes\": {";
+  bool first_mode = true;
+  for (const auto& [mode, metrics] : baseline.modes) {
+    out << (first_mode ? "\n" : ",\n") << "    \"" << mode << "\": {";
+    bool first_metric = true;
+    for (const auto& [metric, values] : metrics) {
+      out << (first_metric ? "\n" : ",\n") << "      \"" << metric << "\": [";
+      for (std::size_t i = 0; i < values.size(); ++i) out << (i ? ", " : "") << values[i];
+      out << "]";
+      first_metric = false;
+    }
+    out << "\n    }";
+    first_mode = false;
+  }
+  out << "\n  }\n}\n";
+  out.precision(precision);
+}
+
+/// Read a baseline written by `save_baseline`. Throws `std::runtime_error` on malformed or mismatched files.
+inline auto load_baseline(std::istream& in) -> Baseline {
+  const auto text = std::string{std::istreambuf_iterator<char>{in}, std::istreambuf_iterator<char>{}};
+  const auto root = JsonParser{text}.parse();
+  if (root.at("format").as_string() != BASELINE_FORMAT) throw std::runtime_error("not a baseline file");
+  if (root.at("version").as_number() != BASELINE_VERSION) throw std::runtime_error("unsupported baseline version");
+  auto baseline = Baseline{};
+  baseline.map = root.at("map").as_string();
+  baseline.queries = static_cast<std::size_t>(root.at("queries").as_number());
+  baseline.repeat = static_cast<int>(root.at("repeat").as_number());
+  baseline.weight = static_cast<int>(root.at("weight").as_number());
+  const auto& modes = root.at("modes");
+  if (modes.type != JsonValue::Type::object) throw std::runtime_error("expected an object of modes");
+  for (std::size_t i = 0; i < modes.keys.size(); ++i) {
+    const auto& metrics = modes.items[i];
+    if (metrics.type != JsonValue::Type::object) throw std::runtime_error("expected an object of metrics");
+    for (std::size_t j = 0; j < metrics.keys.size(); ++j) {
+      auto& values = baseline.modes[modes.keys[i]][metrics.keys[j]];
+      for (const auto& it : metrics.items[j].items) values.push_back(it.as_number());
+      if (values.size() != baseline.queries) throw std::runtime_error("metric does not have a value per query");
+    }
+  }
+  return baseline;
+}
+
+/// Continued fraction of the regularized incomplete beta function, evaluated with the modified Lentz method.
+inline auto incomplete_beta_fraction(double a, double b, double x) -> double {
+  constexpr int MAX_ITERATIONS = 300;
+  constexpr double EPSILON = 1e-15;
+  constexpr double TINY = 1e-300;
+  auto clamp_tiny = [](double v) { return std::abs(v) < TINY ? TINY : v; };
+  double c = 1;
+  double d = 1 / clamp_tiny(1 - (a + b) * x / (a + 1));
+  double h = d;
+  for (int m = 1; m <= MAX_ITERATIONS; ++m) {
+    const double m2 = 2.0 * m;
+    const double even = m * (b - m) * x / ((a + m2 - 1) * (a + m2));
+    d = 1 / clamp_tiny(1 + even * d);
+    c = clamp_tiny(1 + even / c);
+    h *= d * c;
+    const double odd = -(a + m) * (a + b + m) * x / ((a + m2) * (a + m2 + 1));
+    d = 1 / clamp_tiny(1 + odd * d);
+    c = clamp_tiny(1 + odd / c);
+    const double delta = d * c;
+    h *= delta;
+    if (std::abs(delta - 1) < EPSILON) break;
+  }
+  return h;
+}
+/// Regularized incomplete beta function `I_x(a, b)`.
+inline auto regularized_incomplete_beta(double a, double b, double x) -> double {
+  if (x <= 0) return 0;
+  if (x >= 1) return 1;
+  const double front =
+      std::exp(std::lgamma(a + b) - std::lgamma(a) - std::lgamma(b) + a * std::log(x) + b * std::log1p(-x));
+  if (x < (a + 1) / (a + b + 2)) return front * incomplete_beta_fraction(a, b, x) / a;
+  return 1 - front * incomplete_beta_fraction(b, a, 1 - x) / b;
+}
+/// Two-sided p-value of Student's t statistic `t` with `df` degrees of freedom.
+inline auto student_t_p_value(double t, double df) -> double {
+  return regularized_incomplete_beta(df / 2, 0.5, df / (df + t * t));
+}
+
+/// Comparison of one metric of one mode between two baselines.
+struct Comparison {
+  std::string mode{};
+  std::string metric{};
+  std::size_t queries{};  // Queries with a positive value in both runs
+  double ratio{1};  // Geometric mean of the per-query ratios, above 1 means the second run is slower
+  double p_value{1};
+  bool regression{};
+  bool improvement{};
+};
+
+/// Compare every metric found in both `before` and `after`, query by query.
+/// @details The per-query log ratios are tested with a paired t-test, which removes the large differences between
+/// short and long queries from the variance. A change is flagged when it is significant at `alpha` and the geometric
+/// mean ratio moved by more than `threshold`, so tiny but consistent changes are not reported.
+inline auto compare_baselines(const Baseline& before, const Baseline& after, double threshold, double alpha)
+    -> std::vector<Comparison> {
+  if (before.map != after.map || before.queries != after.queries) {
+    throw std::runtime_error("baselines were not run on the same map and queries");
+  }
+  auto results = std::vector<Comparison>{};
+  for (const auto& [mode, metrics] : after.modes) {
+    const auto before_mode = before.modes.find(mode);
+    if (before_mode == before.modes.end()) continue;
+    for (const auto& [metric, after_values] : metrics) {
+      const auto before_metric = before_mode->second.find(metric);
+      if (before_metric == before_mode->second.end()) continue;
+      const auto& before_values = before_metric->second;
+      auto log_ratios = std::vector<double>{};
+      for (std::size_t i = 0; i < after_values.size() && i < before_values.size(); ++i) {
+        if (before_values[i] <= 0 || after_values[i] <= 0) continue;  // Unavailable counters are zero
+        log_ratios.push_back(std::log(after_values[i] / before_values[i]));
+      }
+      auto result = Comparison{mode, metric, log_ratios.size()};
+      if (log_ratios.size() >= 2) {
+        const auto n = static_cast<double>(log_ratios.size());
+        double mean = 0;
+        for (const auto& it : log_ratios) mean += it / n;
+        double variance = 0;
+        for (const auto& it : log_ratios) variance += (it - mean) * (it - mean) / (n - 1);
+        result.ratio = std::exp(mean);
+        if (variance > 0) {
+          result.p_value = student_t_p_value(mean / std::sqrt(variance / n), n - 1);
+        } else {
+          result.p_value = mean != 0 ? 0 : 1;
+        }
+        const bool significant = result.p_value < alpha;
+        result.regression = significant && result.ratio > 1 + threshold;
+        result.improvement = significant && result.ratio < 1 - threshold;
+      }
+      results.push_back(result);
+    }
+  }
+  return results;
+}
+}  // namespace bench
@@ -0,0 +1,560 @@
+/// Headless benchmark runner for Moving AI scenario sets.
+/// Every query is run with each search mode, checked against the optimal length of the scenario, and timed.
+/// Per-query results can be saved as a baseline, and two baselines compared to find significant regressions.
+#include <libtcod-path/focal_search.h>
+#include <libtcod-path/fringe_search.h>
+#include <libtcod-path/graph_tools.h>
+#include <libtcod-path/heuristic_tools.h>
+#include <libtcod-path/map_tools.h>
+#include <libtcod-path/uniform_cost_search.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <libtcod-path/map.hpp>
+#include <libtcod-path/movingai.hpp>
+#include <map>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "baseline.hpp"
+#include "perf_counters.hpp"
+
+namespace {
+using tcod::path::Map2D;
+using tcod::path::MovingAIMap;
+using tcod::path::MovingAIScenario;
+
+constexpr TCODPATH_ValueType CARDINAL = 10000;  // Fixed point scale of path costs
+constexpr TCODPATH_ValueType DIAGONAL = 14142;  // sqrt(2) rounded down, so the octile heuristic stays admissible
+constexpr double RELATIVE_TOLERANCE = 1e-4;  // Covers the rounding of `DIAGONAL` over long paths
+constexpr double ABSOLUTE_TOLERANCE = 1e-3;
+constexpr double SIGNIFICANCE = 0.01;  // Largest p-value of a change reported by --compare
+static_assert(TCODPATH_STATS_ENABLED, "expansions are read from TCODPATH_SearchStats");
+
+enum class Mode { dijkstra, astar, wastar, focal, fringe };
+
+struct ModeInfo {
+  Mode mode;
+  const char* name;
+  bool bounded;  // True if the result is only within `weight` percent of optimal
+};
+constexpr ModeInfo MODES[] = {
+    {Mode::dijkstra, "dijkstra", false},
+    {Mode::astar, "astar", false},
+    {Mode::wastar, "wastar", true},
+    {Mode::focal, "focal", true},
+    {Mode::fringe, "fringe", false},
+};
+
+struct Options {
+  std::string map_path{};
+  std::string scen_path{};
+  std::string write_map_path{};
+  std::string write_scen_path{};
+  std::string output_path{};
+  std::string baseline_path{};
+  std::string compare_before_path{};
+  std::string compare_after_path{};
+  std::string format{"json"};
+  bool generate{};
+  tcod::path::SyntheticMapOptions synthetic{};
+  int queries{1000};
+  int weight{150};
+  int repeat{1};
+  bool perf{};
+  double threshold{0.02};  // Smallest relative change reported by --compare
+  std::vector<ModeInfo> modes{std::begin(MODES), std::end(MODES)};
+};
+
+struct QueryResult {
+  double micros{};
+  std::int64_t expansions{};  // Nodes whose edges were visited, from `TCODPATH_SearchStats`
+  std::int64_t stale_pops{};  // Outdated frontier entries which were discarded
+  std::size_t memory_bytes{};
+  bench::CounterValues counters{};
+  bool reached{};
+  bool valid{};
+};
+
+struct Summary {
+  std::vector<double> micros{};
+  std::int64_t expansions{};
+  std::int64_t max_expansions{};
+  std::int64_t stale_pops{};
+  std::size_t memory_bytes{};
+  std::size_t max_memory_bytes{};
+  bench::CounterValues counters{};
+  int unsolved{};
+  int mismatched{};
+
+  void add(const QueryResult& result) {
+    micros.push_back(result.micros);
+    expansions += result.expansions;
+    max_expansions = std::max(max_expansions, result.expansions);
+    stale_pops += result.stale_pops;
+    memory_bytes += result.memory_bytes;
+    max_memory_bytes = std::max(max_memory_bytes, result.memory_bytes);
+    for (int i = 0; i < bench::COUNTER_COUNT; ++i) counters[i] += result.counters[i];
+    unsolved += !result.reached;
+    mismatched += result.reached && !result.valid;
+  }
+  /// Nearest-rank percentile, `micros` must be sorted.
+  auto percentile(double q) const -> double {
+    if (micros.empty()) return 0;
+    const auto rank = static_cast<std::size_t>(std::ceil(q * static_cast<double>(micros.size())));
+    return micros.at(std::clamp<std::size_t>(rank, 1, micros.size()) - 1);
+  }
+  auto mean_micros() const -> double {
+    double total = 0;
+    for (const auto& it : micros) total += it;
+    return micros.empty() ? 0 : total / static_cast<double>(micros.size());
+  }
+};
+
+/// Octile distance to the goal in `userdata`, an array of 2 indexes.
+TCODPATH_ValueType octile_heuristic(
+    void* userdata, int, const TCODPATH_IndexType* __restrict index, TCODPATH_ValueType distance) {
+  const auto* goal = static_cast<const TCODPATH_IndexType*>(userdata);
+  const TCODPATH_ValueType dy = std::abs(index[0] - goal[0]);
+  const TCODPATH_ValueType dx = std::abs(index[1] - goal[1]);
+  return distance + CARDINAL * (std::max(dx, dy) - std::min(dx, dy)) + DIAGONAL * std::min(dx, dy);
+}
+
+auto heap_bytes(const TCODPATH_Heap& heap) -> std::size_t {
+  return static_cast<std::size_t>(heap.capacity) * static_cast<std::size_t>(heap.node_size);
+}
+
+/// Working maps shared by every query on one map.
+struct Workspace {
+  explicit Workspace(const MovingAIMap& map)
+      : costs{map.to_costs()},
+        distance{std::array{map.height, map.width}},
+        closed{std::array{map.height, map.width}},
+        map_bytes{static_cast<std::size_t>(map.width) * map.height * sizeof(TCODPATH_ValueType)} {
+    graph.basic2d = TCODPATH_GraphBasic2D{
+        .type = TCODPATH_GRAPH_BASIC2D,
+        .map = costs.c_data(),
+        .cardinal = CARDINAL,
+        .diagonal = DIAGONAL,
+        .clearance = nullptr,
+        .agent_size = 0,
+        .no_corner_cutting = true};
+  }
+  Map2D<> costs;
+  Map2D<> distance;
+  Map2D<> closed;
+  TCODPATH_Graph graph{};
+  std::size_t map_bytes;
+};
+
+/// Run a single query and return its measurements. Clearing the maps is not timed.
+/// Hardware counters are read around the search when `perf` is open.
+auto run_query(
+    Workspace& work, const ModeInfo& mode, const MovingAIScenario& scenario, int weight, bench::PerfCounters& perf)
+    -> QueryResult {
+  const TCODPATH_IndexType start[2] = {scenario.start_y, scenario.start_x};
+  TCODPATH_IndexType goal[2] = {scenario.goal_y, scenario.goal_x};
+  auto heuristic = TCODPATH_Heuristic{};
+  heuristic.callback = TCODPATH_HeuristicCallback{TCODPATH_HEURISTIC_CALLBACK, octile_heuristic, goal};
+  TCODPATH_map_fill_max(work.distance.c_data());
+  if (mode.mode == Mode::focal) TCODPATH_map_fill(work.closed.c_data(), 0);
+
+  auto result = QueryResult{};
+  auto stats = TCODPATH_SearchStats{};  // Steps are not counted directly, some steps only discard stale entries
+  int err = 0;
+  perf.start();
+  const auto time_begin = std::chrono::steady_clock::now();
+  if (mode.mode == Mode::focal) {
+    TCODPATH_FocalSearch focal;
+    err = TCODPATH_focal_init(
+        &focal, &work.graph, &heuristic, nullptr, weight, work.distance.c_data(), nullptr, work.closed.c_data());
+    if (err >= 0) {
+      focal.stats = &stats;
+      focal.has_goal = true;
+      for (int i = 0; i < 2; ++i) focal.goal[i] = goal[i];
+      TCODPATH_map_set(work.distance.c_data(), start, 0);
+      err = TCODPATH_focal_push(&focal, start);
+    }
+    while (err == 0) err = TCODPATH_focal_step(&focal);
+    result.memory_bytes = work.map_bytes * 2 + heap_bytes(focal.open) + heap_bytes(focal.waiting) +
+                          heap_bytes(focal.focal);
+    TCODPATH_focal_uninit(&focal);
+  } else if (mode.mode == Mode::fringe) {
+    TCODPATH_FringeSearch fringe;
+    err = TCODPATH_fringe_init(&fringe, &work.graph, &heuristic, work.distance.c_data(), nullptr);
+    if (err >= 0) {
+      fringe.stats = &stats;
+      TCODPATH_fringe_set_goal(&fringe, goal);
+      TCODPATH_map_set(work.distance.c_data(), start, 0);
+      err = TCODPATH_fringe_push(&fringe, start);
+    }
+    while (err == 0) err = TCODPATH_fringe_step(&fringe);
+    result.memory_bytes = work.map_bytes + static_cast<std::size_t>(fringe.node_count + 1) * sizeof(*fringe.nodes);
+    TCODPATH_fringe_uninit(&fringe);
+  } else {
+    TCODPATH_UniformCostSearch ucs;
+    err = TCODPATH_ucs_init(
+        &ucs, &work.graph, mode.mode == Mode::dijkstra ? nullptr : &heuristic, work.distance.c_data(), nullptr);
+    if (err >= 0) {
+      ucs.stats = &stats;
+      if (mode.mode == Mode::wastar) ucs.heuristic_weight = weight;
+      TCODPATH_ucs_set_goal(&ucs, goal);
+      TCODPATH_map_set(work.distance.c_data(), start, 0);
+      err = TCODPATH_ucs_push(&ucs, start);
+    }
+    while (err == 0) err = TCODPATH_ucs_step(&ucs);
+    result.memory_bytes = work.map_bytes + heap_bytes(ucs.frontier);
+    TCODPATH_ucs_uninit(&ucs);
+  }
+  const auto time_end = std::chrono::steady_clock::now();
+  result.counters = perf.stop();
+  result.micros = std::chrono::duration<double, std::micro>(time_end - time_begin).count();
+  result.expansions = stats.expansions;
+  result.stale_pops = stats.stale_pops;
+  if (err < 0) throw std::runtime_error(std::string("search failed in mode ") + mode.name);
+
+  result.reached = !TCODPATH_map_is_max(work.distance.c_data(), goal);
+  if (!result.reached) return result;
+  const double length = static_cast<double>(TCODPATH_map_get(work.distance.c_data(), goal)) / CARDINAL;
+  const double optimal = scenario.optimal_length;
+  const double upper = mode.bounded ? optimal * weight / 100 : optimal;
+  result.valid = length >= optimal * (1 - RELATIVE_TOLERANCE) - ABSOLUTE_TOLERANCE &&
+                 length <= upper * (1 + RELATIVE_TOLERANCE) + ABSOLUTE_TOLERANCE;
+  return result;
+}
+
+void print_usage(std::ostream& out) {
+  out << "Usage: libtcod-path-bench [options]\n"
+         "  --map FILE          Moving AI .map file, queries are generated if --scen is not given\n"
+         "  --scen FILE         Moving AI .scen file of queries for --map\n"
+         "  --generate TYPE     Generate a synthetic map instead: open, rooms, or maze\n"
+         "  --size WxH          Size of the generated map (default 256x256)\n"
+         "  --feature N         Obstacle size, room size, or corridor width of the generated map (default 8)\n"
+         "  --seed N            Random seed of generated maps and queries (default 0)\n"
+         "  --queries N         Number of generated queries (default 1000)\n"
+         "  --write-map FILE    Save the generated map\n"
+         "  --write-scen FILE   Save the generated queries\n"
+         "  --modes LIST        Comma separated search modes: dijkstra,astar,wastar,focal,fringe (default all)\n"
+         "  --weight N          Suboptimality bound of wastar and focal in percent (default 150)\n"
+         "  --repeat N          Run each query N times (default 1)\n"
+         "  --format FORMAT     Report format: json or csv (default json)\n"
+         "  --output FILE       Write the report to FILE instead of stdout\n"
+         "  --perf              Read hardware counters around each query: cycles, instructions, LLC and branch misses\n"
+         "  --save-baseline FILE  Save the results of every query for --compare\n"
+         "  --compare BEFORE AFTER  Compare two saved baselines instead of running, query by query\n"
+         "  --threshold PCT     Smallest change reported by --compare (default 2)\n"
+         "Exits with 1 if any query is unsolved or does not match its optimal length,\n"
+         "or with --compare if any metric regressed significantly.\n";
+}
+
+auto parse_options(int argc, char** argv) -> Options {
+  auto options = Options{};
+  auto next = [&](int& i) -> std::string {
+    if (i + 1 >= argc) throw std::invalid_argument(std::string("missing value for ") + argv[i]);
+    return argv[++i];
+  };
+  for (int i = 1; i < argc; ++i) {
+    const auto arg = std::string{argv[i]};
+    if (arg == "--help" || arg == "-h") {
+      print_usage(std::cout);
+      std::exit(0);
+    } else if (arg == "--map") {
+      options.map_path = next(i);
+    } else if (arg == "--scen") {
+      options.scen_path = next(i);
+    } else if (arg == "--generate") {
+      const auto type = next(i);
+      options.generate = true;
+      if (type == "open") {
+        options.synthetic.type = tcod::path::SyntheticMapType::open;
+      } else if (type == "rooms") {
+        options.synthetic.type = tcod::path::SyntheticMapType::rooms;
+      } else if (type == "maze") {
+        options.synthetic.type = tcod::path::SyntheticMapType::maze;
+      } else {
+        throw std::invalid_argument("unknown map type: " + type);
+      }
+    } else if (arg == "--size") {
+      const auto size = next(i);
+      const auto split = size.find('x');
+      options.synthetic.width = std::stoi(size.substr(0, split));
+      options.synthetic.height =
+          split == std::string::npos ? options.synthetic.width : std::stoi(size.substr(split + 1));
+    } else if (arg == "--feature") {
+      options.synthetic.feature_size = std::stoi(next(i));
+    } else if (arg == "--seed") {
+      options.synthetic.seed = static_cast<std::uint32_t>(std::stoul(next(i)));
+    } else if (arg == "--queries") {
+      options.queries = std::stoi(next(i));
+    } else if (arg == "--write-map") {
+      options.write_map_path = next(i);
+    } else if (arg == "--write-scen") {
+      options.write_scen_path = next(i);
+    } else if (arg == "--modes") {
+      options.modes.clear();
+      auto list = std::istringstream{next(i)};
+      for (std::string name; std::getline(list, name, ',');) {
+        const auto* found = std::find_if(
+            std::begin(MODES), std::end(MODES), [&](const ModeInfo& mode) { return name == mode.name; });
+        if (found == std::end(MODES)) throw std::invalid_argument("unknown mode: " + name);
+        options.modes.push_back(*found);
+      }
+    } else if (arg == "--weight") {
+      options.weight = std::stoi(next(i));
+    } else if (arg == "--repeat") {
+      options.repeat = std::stoi(next(i));
+    } else if (arg == "--format") {
+      options.format = next(i);
+      if (options.format != "json" && options.format != "csv") throw std::invalid_argument("unknown format");
+    } else if (arg == "--output") {
+      options.output_path = next(i);
+    } else if (arg == "--perf") {
+      options.perf = true;
+    } else if (arg == "--save-baseline") {
+      options.baseline_path = next(i);
+    } else if (arg == "--compare") {
+      options.compare_before_path = next(i);
+      options.compare_after_path = next(i);
+    } else if (arg == "--threshold") {
+      options.threshold = std::stod(next(i)) / 100;
+    } else {
+      throw std::invalid_argument("unknown option: " + arg);
+    }
+  }
+  if (!options.compare_before_path.empty()) {
+    if (options.generate || !options.map_path.empty()) throw std::invalid_argument("--compare does not run queries");
+    if (options.threshold < 0) throw std::invalid_argument("invalid --threshold");
+    return options;
+  }
+  if (options.generate == !options.map_path.empty()) {
+    throw std::invalid_argument("give exactly one of --map or --generate");
+  }
+  if (options.weight < 100 || options.repeat < 1 || options.queries < 1 || options.modes.empty()) {
+    throw std::invalid_argument("invalid --weight, --repeat, --queries, or --modes");
+  }
+  return options;
+}
+
+void write_json(
+    std::ostream& out,
+    const Options& options,
+    const std::string& map_name,
+    std::size_t query_count,
+    const std::map<std::pair<std::string, int>, Summary>& summaries,
+    const bench::PerfCounters& perf) {
+  out << "{\n  \"map\": \"" << map_name << "\",\n  \"queries\": " << query_count << ",\n  \"repeat\": "
+      << options.repeat << ",\n  \"weight\": " << options.weight << ",\n  \"results\": [";
+  bool first = true;
+  for (const auto& [key, summary] : summaries) {
+    const auto count = static_cast<double>(summary.micros.size());
+    out << (first ? "\n" : ",\n") << "    {\"mode\": \"" << key.first << "\", \"bucket\": ";
+    if (key.second < 0) {
+      out << "\"all\"";
+    } else {
+      out << key.second;
+    }
+    out << ", \"queries\": " << summary.micros.size() << ", \"unsolved\": " << summary.unsolved
+        << ", \"mismatched\": " << summary.mismatched << ", \"latency_us\": {\"p50\": " << summary.percentile(0.5)
+        << ", \"p90\": " << summary.percentile(0.9) << ", \"p99\": " << summary.percentile(0.99)
+        << ", \"max\": " << summary.percentile(1.0) << ", \"mean\": " << summary.mean_micros()
+        << "}, \"expansions\": {\"mean\": " << summary.expansions / count << ", \"max\": " << summary.max_expansions
+        << "}, \"stale_pops_mean\": " << static_cast<double>(summary.stale_pops) / count
+        << ", \"memory_bytes\": {\"mean\": " << static_cast<double>(summary.memory_bytes) / count
+        << ", \"max\": " << summary.max_memory_bytes << "}";
+    if (perf.is_open()) {
+      out << ", \"counters_mean\": {";
+      bool first_counter = true;
+      for (int i = 0; i < bench::COUNTER_COUNT; ++i) {
+        if (!perf.is_available(i)) continue;
+        out << (first_counter ? "" : ", ") << '"' << bench::COUNTER_NAMES[i]
+            << "\": " << static_cast<double>(summary.counters[i]) / count;
+        first_counter = false;
+      }
+      out << "}";
+    }
+    out << "}";
+    first = false;
+  }
+  out << "\n  ]\n}\n";
+}
+
+void write_csv(
+    std::ostream& out,
+    const std::map<std::pair<std::string, int>, Summary>& summaries,
+    const bench::PerfCounters& perf) {
+  out << "mode,bucket,queries,unsolved,mismatched,p50_us,p90_us,p99_us,max_us,mean_us,mean_expansions,"
+         "max_expansions,mean_stale_pops,mean_memory_bytes,max_memory_bytes";
+  for (int i = 0; i < bench::COUNTER_COUNT; ++i) {
+    if (perf.is_open() && perf.is_available(i)) out << ",mean_" << bench::COUNTER_NAMES[i];
+  }
+  out << '\n';
+  for (const auto& [key, summary] : summaries) {
+    const auto count = static_cast<double>(summary.micros.size());
+    out << key.first << ',' << (key.second < 0 ? std::string("all") : std::to_string(key.second)) << ','
+        << summary.micros.size() << ',' << summary.unsolved << ',' << summary.mismatched << ','
+        << summary.percentile(0.5) << ',' << summary.percentile(0.9) << ',' << summary.percentile(0.99) << ','
+        << summary.percentile(1.0) << ',' << summary.mean_micros() << ',' << summary.expansions / count << ','
+        << summary.max_expansions << ',' << static_cast<double>(summary.stale_pops) / count << ','
+        << static_cast<double>(summary.memory_bytes) / count << ','
+        << summary.max_memory_bytes;
+    for (int i = 0; i < bench::COUNTER_COUNT; ++i) {
+      if (perf.is_open() && perf.is_available(i)) out << ',' << static_cast<double>(summary.counters[i]) / count;
+    }
+    out << '\n';
+  }
+}
+
+void write_comparisons(std::ostream& out, const std::string& format, const std::vector<bench::Comparison>& results) {
+  auto verdict = [](const bench::Comparison& it) {
+    return it.regression ? "regression" : it.improvement ? "improvement" : "unchanged";
+  };
+  if (format == "csv") {
+    out << "mode,metric,queries,ratio,p_value,result\n";
+    for (const auto& it : results) {
+      out << it.mode << ',' << it.metric << ',' << it.queries << ',' << it.ratio << ',' << it.p_value << ','
+          << verdict(it) << '\n';
+    }
+    return;
+  }
+  out << "{\n  \"comparisons\": [";
+  bool first = true;
+  for (const auto& it : results) {
+    out << (first ? "\n" : ",\n") << "    {\"mode\": \"" << it.mode << "\", \"metric\": \"" << it.metric
+        << "\", \"queries\": " << it.queries << ", \"ratio\": " << it.ratio << ", \"p_value\": " << it.p_value
+        << ", \"result\": \"" << verdict(it) << "\"}";
+    first = false;
+  }
+  out << "\n  ]\n}\n";
+}
+
+/// Compare two saved baselines. Return 1 if any metric regressed.
+auto run_compare(const Options& options) -> int {
+  auto load = [](const std::string& path) {
+    auto file = std::ifstream{path};
+    if (!file) throw std::runtime_error("could not open " + path);
+    return bench::load_baseline(file);
+  };
+  const auto before = load(options.compare_before_path);
+  const auto after = load(options.compare_after_path);
+  if (before.weight != after.weight) std::cerr << "Warning: the baselines were run with different weights\n";
+  const auto results = bench::compare_baselines(before, after, options.threshold, SIGNIFICANCE);
+
+  auto file = std::ofstream{};
+  if (!options.output_path.empty()) file.open(options.output_path);
+  auto& out = options.output_path.empty() ? std::cout : file;
+  write_comparisons(out, options.format, results);
+  int regressions = 0;
+  for (const auto& it : results) {
+    if (!it.regression) continue;
+    std::cerr << "Regression: " << it.mode << ' ' << it.metric << " is " << (it.ratio - 1) * 100
+              << "% higher (p=" << it.p_value << ")\n";
+    ++regressions;
+  }
+  return regressions ? 1 : 0;
+}
+
+auto run(const Options& options) -> int {
+  if (!options.compare_before_path.empty()) return run_compare(options);
+  auto map = MovingAIMap{};
+  auto map_name = std::string{};
+  if (options.generate) {
+    map = tcod::path::generate_synthetic_map(options.synthetic);
+    map_name = options.write_map_path.empty() ? "synthetic.map"
+                                              : std::filesystem::path{options.write_map_path}.filename().string();
+    if (!options.write_map_path.empty()) {
+      auto file = std::ofstream{options.write_map_path};
+      tcod::path::save_movingai_map(file, map);
+    }
+  } else {
+    map = tcod::path::load_movingai_map(options.map_path);
+    map_name = std::filesystem::path{options.map_path}.filename().string();
+  }
+  auto scenarios = std::vector<MovingAIScenario>{};
+  if (!options.scen_path.empty()) {
+    scenarios = tcod::path::load_movingai_scenarios(options.scen_path);
+  } else {
+    std::cerr << "Generating " << options.queries << " queries...\n";
+    scenarios = tcod::path::generate_movingai_scenarios(map, map_name, options.queries, options.synthetic.seed);
+    if (!options.write_scen_path.empty()) {
+      auto file = std::ofstream{options.write_scen_path};
+      tcod::path::save_movingai_scenarios(file, scenarios);
+    }
+  }
+  for (const auto& it : scenarios) {
+    if (it.map_width != map.width || it.map_height != map.height || !map.is_passable(it.start_x, it.start_y) ||
+        !map.is_passable(it.goal_x, it.goal_y)) {
+      throw std::runtime_error("scenario does not match the map: " + it.map);
+    }
+  }
+
+  auto perf = bench::PerfCounters{};
+  if (options.perf && !perf.open()) {
+    std::cerr << "Warning: hardware counters are unavailable, check /proc/sys/kernel/perf_event_paranoid\n";
+  }
+  auto baseline = bench::Baseline{map_name, scenarios.size(), options.repeat, options.weight};
+  auto work = Workspace{map};
+  auto summaries = std::map<std::pair<std::string, int>, Summary>{};
+  for (const auto& mode : options.modes) {
+    std::cerr << "Running " << mode.name << "...\n";
+    auto& metrics = baseline.modes[mode.name];
+    auto& micros = metrics["micros"] = std::vector<double>(scenarios.size());
+    for (int c = 0; c < bench::COUNTER_COUNT; ++c) {
+      if (perf.is_open() && perf.is_available(c)) metrics[bench::COUNTER_NAMES[c]].resize(scenarios.size());
+    }
+    for (std::size_t q = 0; q < scenarios.size(); ++q) {
+      for (int i = 0; i < options.repeat; ++i) {
+        const auto result = run_query(work, mode, scenarios[q], options.weight, perf);
+        summaries[{mode.name, scenarios[q].bucket}].add(result);
+        summaries[{mode.name, -1}].add(result);
+        // Each baseline value is the mean over repeats
+        micros[q] += result.micros / options.repeat;
+        for (int c = 0; c < bench::COUNTER_COUNT; ++c) {
+          const auto found = metrics.find(bench::COUNTER_NAMES[c]);
+          if (found != metrics.end()) found->second[q] += static_cast<double>(result.counters[c]) / options.repeat;
+        }
+      }
+    }
+  }
+  if (!options.baseline_path.empty()) {
+    auto file = std::ofstream{options.baseline_path};
+    bench::save_baseline(file, baseline);
+  }
+  int failures = 0;
+  for (auto& [key, summary] : summaries) {
+    std::sort(summary.micros.begin(), summary.micros.end());
+    if (key.second < 0) failures += summary.unsolved + summary.mismatched;
+  }
+
+  auto file = std::ofstream{};
+  if (!options.output_path.empty()) file.open(options.output_path);
+  auto& out = options.output_path.empty() ? std::cout : file;
+  if (options.format == "csv") {
+    write_csv(out, summaries, perf);
+  } else {
+    write_json(out, options, map_name, scenarios.size(), summaries, perf);
+  }
+  if (failures) std::cerr << failures << " queries were unsolved or did not match their optimal length\n";
+  return failures ? 1 : 0;
+}
+}  // namespace
+
+int main(int argc, char** argv) {
+  try {
+    return run(parse_options(argc, argv));
+  } catch (const std::invalid_argument& e) {
+    std::cerr << "Error: " << e.what() << "\n\n";
+    print_usage(std::cerr);
+    return 2;
+  } catch (const std::exception& e) {
+    std::cerr << "Error: " << e.what() << "\n";
+    return 2;
+  }
+}
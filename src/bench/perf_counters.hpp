@@ -0,0 +1,115 @@
+#pragma once
+/// Hardware performance counters read through Linux `perf_event_open`.
+/// On other platforms, or when the kernel refuses access, no counters are available and readings are all zero.
+#include <array>
+#include <cstdint>
+#include <cstring>
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace bench {
+inline constexpr int COUNTER_COUNT = 4;
+/// Names of the counters in the order of `CounterValues`.
+inline constexpr std::array<const char*, COUNTER_COUNT> COUNTER_NAMES{
+    "cycles", "instructions", "llc_misses", "branch_misses"};
+using CounterValues = std::array<std::int64_t, COUNTER_COUNT>;
+
+/// A group of user space counters for the calling thread, read around each measured region.
+class PerfCounters {
+ public:
+  PerfCounters() = default;
+  PerfCounters(const PerfCounters&) = delete;
+  auto operator=(const PerfCounters&) -> PerfCounters& = delete;
+  ~PerfCounters() { close(); }
+
+  /// Open every counter the kernel allows. Return false if none are available.
+  auto open() -> bool {
+    close();
+#ifdef __linux__
+    static constexpr std::array<std::uint64_t, COUNTER_COUNT> CONFIGS{
+        PERF_COUNT_HW_CPU_CYCLES,
+        PERF_COUNT_HW_INSTRUCTIONS,
+        PERF_COUNT_HW_CACHE_MISSES,  // Last level cache misses on most CPUs
+        PERF_COUNT_HW_BRANCH_MISSES};
+    for (int i = 0; i < COUNTER_COUNT; ++i) {
+      perf_event_attr attr;
+      std::memset(&attr, 0, sizeof(attr));
+      attr.size = sizeof(attr);
+      attr.type = PERF_TYPE_HARDWARE;
+      attr.config = CONFIGS[i];
+      attr.disabled = leader_ < 0;  // The group is enabled and disabled through its leader
+      attr.exclude_kernel = 1;
+      attr.exclude_hv = 1;
+      attr.read_format =
+          PERF_FORMAT_GROUP | PERF_FORMAT_ID | PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+      const int fd = static_cast<int>(syscall(SYS_perf_event_open, &attr, 0, -1, leader_, 0));
+      if (fd < 0) continue;  // Not supported by this CPU or not permitted
+      if (ioctl(fd, PERF_EVENT_IOC_ID, &ids_[i]) != 0) {
+        ::close(fd);
+        continue;
+      }
+      fds_[i] = fd;
+      if (leader_ < 0) leader_ = fd;
+    }
+#endif
+    return leader_ >= 0;
+  }
+  void close() noexcept {
+#ifdef __linux__
+    for (auto& fd : fds_) {
+      if (fd >= 0) ::close(fd);
+      fd = -1;
+    }
+#endif
+    leader_ = -1;
+  }
+  [[nodiscard]] auto is_open() const noexcept -> bool { return leader_ >= 0; }
+  /// Return true if counter `i` of `COUNTER_NAMES` is being read.
+  [[nodiscard]] auto is_available(int i) const noexcept -> bool { return fds_.at(i) >= 0; }
+
+  /// Reset and start counting.
+  void start() noexcept {
+#ifdef __linux__
+    if (leader_ < 0) return;
+    ioctl(leader_, PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+    ioctl(leader_, PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+#endif
+  }
+  /// Stop counting and return the counts since `start`, scaled up if the kernel multiplexed the group.
+  auto stop() noexcept -> CounterValues {
+    auto values = CounterValues{};
+#ifdef __linux__
+    if (leader_ < 0) return values;
+    ioctl(leader_, PERF_EVENT_IOC_DISABLE, PERF_IOC_FLAG_GROUP);
+    struct {
+      std::uint64_t nr;
+      std::uint64_t time_enabled;
+      std::uint64_t time_running;
+      struct {
+        std::uint64_t value;
+        std::uint64_t id;
+      } counters[COUNTER_COUNT];
+    } group{};
+    if (read(leader_, &group, sizeof(group)) <= 0 || group.time_running == 0) return values;
+    const double scale = static_cast<double>(group.time_enabled) / static_cast<double>(group.time_running);
+    for (std::uint64_t n = 0; n < group.nr && n < COUNTER_COUNT; ++n) {
+      for (int i = 0; i < COUNTER_COUNT; ++i) {
+        if (fds_[i] < 0 || ids_[i] != group.counters[n].id) continue;
+        values[i] = static_cast<std::int64_t>(static_cast<double>(group.counters[n].value) * scale);
+      }
+    }
+#endif
+    return values;
+  }
+
+ private:
+  std::array<int, COUNTER_COUNT> fds_{-1, -1, -1, -1};
+  std::array<std::uint64_t, COUNTER_COUNT> ids_{};
+  int leader_{-1};
+};
+}  // namespace bench
@@ -6,15 +6,29 @@
 #include <libtcod-path/map_tools.h>
 #include <libtcod.h>
 
+#include <algorithm>
+#include <array>
+#include <cmath>
 #include <fstream>
 #include <libtcod-path/map.hpp>
+#include <libtcod-path/movingai.hpp>
+#include <optional>
 #include <string>
 
+#include "replay.hpp"
+
+// Controls:
+//   Drop a Moving AI .map file on the window to load it.
+//   Left click sets the start, right click sets the goal. Both panes are searched again from these points.
+//   1-5 select the engine of the left pane, Shift+1-5 the engine of the right pane.
+//   C toggles the side-by-side comparison, V cycles the view: expansion order, frontier, and distance.
+//   Space plays or pauses the replay, Left/Right step through it (10x with Shift), Home/End jump to either end.
+
 static SDL_Window* g_window{};  // Active window
 static SDL_Renderer* g_renderer{};  // Active renderer
 
 static std::optional<tcod::Console> g_console{};  // Map console
-static SDL_Texture* g_texture{};  // Map texture
+static std::array<SDL_Texture*, 2> g_textures{};  // Pane textures
 
 struct Deleter {
   void operator()(SDL_Texture* texture) { SDL_DestroyTexture(texture); }
@@ -28,67 +42,106 @@ struct MapData {
   TCODPATH_Graph graph;
   tcod::path::Map2D<> distance{};
   MapPtr flow{};
+  std::vector<bool> passable{};  // Indexed by `y * width + x`
 };
 
 static MapData g_map_data{};
 
+/// Search and replay state.
+struct ReplayState {
+  std::optional<std::array<int, 2>> start{};  // y, x
+  std::optional<std::array<int, 2>> goal{};
+  std::array<int, 2> engines{2, 1};  // Engine of each pane, A* and Dijkstra by default
+  std::array<std::optional<replay::Recording>, 2> recordings{};
+  bool compare{true};  // Show both panes side by side
+  replay::View view{replay::View::heatmap};
+  int step{};  // Number of expansions shown
+  bool playing{};
+};
+
+static ReplayState g_replay{};
+
+static auto pane_count() -> int { return g_replay.compare ? 2 : 1; }
+
+/// Number of expansions of the longest recording.
+static auto replay_length() -> int {
+  int length = 0;
+  for (const auto& it : g_replay.recordings) {
+    if (it) length = std::max(length, it->expansions);
+  }
+  return length;
+}
+
+/// Resize the window to one pixel per tile for each pane.
+static void fit_window() {
+  if (!g_console) return;
+  SDL_SetWindowSize(g_window, g_console->get_width() * pane_count(), g_console->get_height());
+}
+
+/// Record the searches of every visible pane and restart the replay.
+static void run_searches() {
+  g_replay.recordings = {};
+  if (!g_console || !g_replay.start || !g_replay.goal) return;
+  for (int pane = 0; pane < pane_count(); ++pane) {
+    g_replay.recordings[pane] = replay::record_search(
+        g_map_data.graph,
+        g_map_data.distance,
+        *g_map_data.flow,
+        g_replay.engines[pane],
+        *g_replay.start,
+        *g_replay.goal);
+  }
+  g_replay.step = 0;
+  g_replay.playing = true;
+}
+
 /// @brief Load a map from `path` and make it active.
 /// @details See specification: https://movingai.com/benchmarks/formats.html
 void load_map(const char* path) {
-  auto file = std::ifstream{path, std::ios_base::in};
-  std::string line{};
-  std::getline(file, line);
-  assert(line == std::string("type octile"));
-
-  std::getline(file, line, ' ');
-  assert(line == std::string("height"));
-  int height{};
-  file >> height;
-  file.get();
-  std::getline(file, line, ' ');
-  assert(line == std::string("width"));
-  int width{};
-  file >> width;
-  file.get();
-  std::getline(file, line);
-  assert(line == std::string("map"));
+  const auto map = tcod::path::load_movingai_map(std::string{path});
+  const int width = map.width;
+  const int height = map.height;
 
   // Unpack map data into console
   g_console = tcod::Console{width, height};
   auto& console = g_console.value();
-  for (auto& it : console) it.ch = '@';
   for (int y = 0; y < height; ++y) {
-    std::getline(file, line);
-    for (int x = 0; x < width; ++x) console.at({x, y}).ch = line.at(x);
+    for (int x = 0; x < width; ++x) console.at({x, y}).ch = map.tiles[y][x];
   }
-  g_map_data.costs = tcod::path::Map2D{{height, width}};
+  g_map_data.costs = map.to_costs();
   g_map_data.distance = tcod::path::Map2D{{height, width}};
-  // Convert console into costs
+  g_map_data.passable.assign(static_cast<std::size_t>(width) * height, false);
   for (int y = 0; y < height; ++y) {
     for (int x = 0; x < width; ++x) {
-      switch (console.at({x, y}).ch) {
-        case '.':  // passable terrain
-        case 'G':  // passable terrain
-          g_map_data.costs[{y, x}] = 1;
-          break;
-        case 'T':  // trees (impassable)
-        case 'S':  // swamp (passable from regular terrain)
-        case 'W':  // water (traversable, but not passable from terrain)
-        case '@':  // out of bounds
-        case 'O':  // out of bounds
-        default:
-          g_map_data.costs[{y, x}] = 0;
-          break;
-      }
+      g_map_data.passable[static_cast<std::size_t>(y) * width + x] = map.is_passable(x, y);
     }
   }
-  SDL_SetWindowSize(g_window, width, height);
+  fit_window();
 
   g_map_data.graph.basic2d = TCODPATH_GraphBasic2D{
       .type = TCODPATH_GRAPH_BASIC2D, .map = g_map_data.costs.c_data(), .cardinal = 2, .diagonal = 3};
 
   auto flow_shape = std::vector<int>{height, width, 2};
   g_map_data.flow = MapPtr{TCODPATH_map_new(3, flow_shape.data(), -2)};
+  g_replay.start.reset();
+  g_replay.goal.reset();
+  g_replay.recordings = {};
+}
+
+/// Show the engines and their results in the window title.
+static void update_title() {
+  auto title = std::string{"Libtcod-path visualizer"};
+  if (g_console && !g_replay.recordings[0]) title += " - left click: start, right click: goal";
+  for (const auto& recording : g_replay.recordings) {
+    if (!recording) continue;
+    title += " | " + std::string{replay::ENGINES[recording->engine].name} + ": " +
+             std::to_string(std::min(g_replay.step, recording->expansions)) + "/" +
+             std::to_string(recording->expansions) + " expanded, peak frontier " +
+             std::to_string(recording->stats.peak_frontier) + ", cost " +
+             (recording->path.empty() ? std::string{"unreachable"} : std::to_string(recording->goal_distance()));
+  }
+  if (g_replay.recordings[0]) title += std::string{" | view: "} + replay::VIEW_NAMES[static_cast<int>(g_replay.view)];
+  if (title != SDL_GetWindowTitle(g_window)) SDL_SetWindowTitle(g_window, title.c_str());
 }
 
 SDL_AppResult SDL_AppInit(void**, [[maybe_unused]] int argc, [[maybe_unused]] char** argv) {
@@ -114,47 +167,119 @@ SDL_AppResult SDL_AppIterate(void*) {
     }
   } else {
     const auto& console = g_console.value();
-    if (g_texture) {
-      float w, h = 0;
-      SDL_GetTextureSize(g_texture, &w, &h);
-      if (w != console.get_width() || h != console.get_height()) {
-        SDL_DestroyTexture(g_texture);
-        g_texture = nullptr;
+    if (g_replay.playing) {
+      // Replays take about five seconds at 60 frames per second, however long the search was
+      g_replay.step += std::max(1, replay_length() / 300);
+      if (g_replay.step >= replay_length()) {
+        g_replay.step = replay_length();
+        g_replay.playing = false;
       }
     }
-    if (!g_texture) {
-      g_texture = SDL_CreateTexture(
-          g_renderer, SDL_PIXELFORMAT_RGB24, SDL_TEXTUREACCESS_STREAMING, console.get_width(), console.get_height());
-      assert(g_texture);
-      SDL_SetTextureScaleMode(g_texture, SDL_SCALEMODE_NEAREST);
-    }
-    auto pixels_rgb = std::vector<TCOD_ColorRGB>{};
-    pixels_rgb.reserve(console.get_width() * console.get_height());
-    for (int y = 0; y < console.get_height(); ++y) {
-      for (int x = 0; x < console.get_width(); ++x) {
-        switch (console.at({x, y}).ch) {
-          case '.':  // passable terrain
-          case 'G':  // passable terrain
-            pixels_rgb.push_back({255, 255, 255});
-            break;
-          case 'T':  // trees (impassable)
-          case 'S':  // swamp (passable from regular terrain)
-          case 'W':  // water (traversable, but not passable from terrain)
-          case '@':  // out of bounds
-          case 'O':  // out of bounds
-          default:
-            pixels_rgb.push_back({0, 0, 0});
-            break;
+    int output_w, output_h;
+    SDL_GetRenderOutputSize(g_renderer, &output_w, &output_h);
+    const float pane_w = static_cast<float>(output_w) / pane_count();
+    for (int pane = 0; pane < pane_count(); ++pane) {
+      auto& texture = g_textures[pane];
+      if (texture) {
+        float w, h = 0;
+        SDL_GetTextureSize(texture, &w, &h);
+        if (w != console.get_width() || h != console.get_height()) {
+          SDL_DestroyTexture(texture);
+          texture = nullptr;
         }
       }
+      if (!texture) {
+        texture = SDL_CreateTexture(
+            g_renderer, SDL_PIXELFORMAT_RGB24, SDL_TEXTUREACCESS_STREAMING, console.get_width(), console.get_height());
+        assert(texture);
+        SDL_SetTextureScaleMode(texture, SDL_SCALEMODE_NEAREST);
+      }
+      auto pixels_rgb = std::vector<replay::Rgb>{};
+      if (const auto& recording = g_replay.recordings[pane]) {
+        pixels_rgb = replay::render(*recording, g_map_data.passable, g_replay.view, g_replay.step);
+      } else {
+        pixels_rgb.reserve(g_map_data.passable.size());
+        for (const bool passable : g_map_data.passable) {
+          pixels_rgb.push_back(passable ? replay::Rgb{255, 255, 255} : replay::Rgb{0, 0, 0});
+        }
+        if (g_replay.start) {
+          pixels_rgb[(*g_replay.start)[0] * console.get_width() + (*g_replay.start)[1]] = {0, 255, 0};
+        }
+      }
+      SDL_UpdateTexture(texture, NULL, pixels_rgb.data(), console.get_width() * 3);
+      const auto dest = SDL_FRect{pane_w * pane, 0, pane_w - (pane_count() > 1 ? 1 : 0), (float)output_h};
+      SDL_RenderTexture(g_renderer, texture, NULL, &dest);
     }
-    SDL_UpdateTexture(g_texture, NULL, pixels_rgb.data(), console.get_width() * 3);
-
-    SDL_RenderTexture(g_renderer, g_texture, NULL, NULL);
+    update_title();
   }
   SDL_RenderPresent(g_renderer);
   return SDL_APP_CONTINUE;
 }
+/// Handle a click on the map, setting the start or goal under the cursor.
+static void on_click(SDL_Event* event) {
+  if (!g_console) return;
+  SDL_ConvertEventToRenderCoordinates(g_renderer, event);
+  int output_w, output_h;
+  SDL_GetRenderOutputSize(g_renderer, &output_w, &output_h);
+  const float pane_w = static_cast<float>(output_w) / pane_count();
+  const float pane_x = std::fmod(event->button.x, pane_w);
+  const int x = static_cast<int>(pane_x * g_console->get_width() / pane_w);
+  const int y = static_cast<int>(event->button.y * g_console->get_height() / output_h);
+  if (x < 0 || y < 0 || x >= g_console->get_width() || y >= g_console->get_height()) return;
+  if (!g_map_data.passable[static_cast<std::size_t>(y) * g_console->get_width() + x]) return;
+  if (event->button.button == SDL_BUTTON_LEFT) {
+    g_replay.start = std::array{y, x};
+  } else if (event->button.button == SDL_BUTTON_RIGHT) {
+    g_replay.goal = std::array{y, x};
+  }
+  run_searches();
+}
+static void on_key(const SDL_KeyboardEvent& key) {
+  const bool shift = key.mod & SDL_KMOD_SHIFT;
+  switch (key.key) {
+    case SDLK_1:
+    case SDLK_2:
+    case SDLK_3:
+    case SDLK_4:
+    case SDLK_5: {
+      const int engine = static_cast<int>(key.key - SDLK_1);
+      if (engine >= replay::ENGINE_COUNT) break;
+      g_replay.engines[shift ? 1 : 0] = engine;
+      run_searches();
+      break;
+    }
+    case SDLK_C:
+      g_replay.compare = !g_replay.compare;
+      fit_window();
+      run_searches();
+      break;
+    case SDLK_V:
+      g_replay.view = static_cast<replay::View>((static_cast<int>(g_replay.view) + 1) % std::size(replay::VIEW_NAMES));
+      break;
+    case SDLK_SPACE:
+      if (g_replay.step >= replay_length()) g_replay.step = 0;
+      g_replay.playing = !g_replay.playing;
+      break;
+    case SDLK_LEFT:
+      g_replay.playing = false;
+      g_replay.step = std::max(0, g_replay.step - (shift ? 10 : 1));
+      break;
+    case SDLK_RIGHT:
+      g_replay.playing = false;
+      g_replay.step = std::min(replay_length(), g_replay.step + (shift ? 10 : 1));
+      break;
+    case SDLK_HOME:
+      g_replay.playing = false;
+      g_replay.step = 0;
+      break;
+    case SDLK_END:
+      g_replay.playing = false;
+      g_replay.step = replay_length();
+      break;
+    default:
+      break;
+  }
+}
 SDL_AppResult SDL_AppEvent(void*, SDL_Event* event) {
   switch (event->type) {
     case SDL_EVENT_QUIT:
@@ -162,6 +287,12 @@ SDL_AppResult SDL_AppEvent(void*, SDL_Event* event) {
     case SDL_EVENT_DROP_FILE:
       load_map(event->drop.data);
       break;
+    case SDL_EVENT_MOUSE_BUTTON_DOWN:
+      on_click(event);
+      break;
+    case SDL_EVENT_KEY_DOWN:
+      on_key(event->key);
+      break;
     default:
       break;
   }
@@ -0,0 +1,213 @@
+#pragma once
+/// Recorded searches for the visualizer, and their rendering as expansion heatmaps, frontiers, and distance fields.
+/// Nothing here depends on SDL so the recordings can be inspected without a window.
+#include <libtcod-path/breadth_first_search.h>
+#include <libtcod-path/flow_tools.h>
+#include <libtcod-path/map_tools.h>
+#include <libtcod-path/search_stats.h>
+#include <libtcod-path/uniform_cost_search.h>
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <cstdlib>
+#include <libtcod-path/map.hpp>
+#include <limits>
+#include <vector>
+
+namespace replay {
+/// Search engines which can be recorded.
+enum class Engine { bfs, dijkstra, astar_octile, astar_manhattan, wastar_octile };
+
+struct EngineInfo {
+  Engine engine;
+  const char* name;
+};
+inline constexpr EngineInfo ENGINES[] = {
+    {Engine::bfs, "BFS"},
+    {Engine::dijkstra, "Dijkstra"},
+    {Engine::astar_octile, "A* octile"},
+    {Engine::astar_manhattan, "A* manhattan"},
+    {Engine::wastar_octile, "WA* octile x1.5"},
+};
+inline constexpr int ENGINE_COUNT = static_cast<int>(std::size(ENGINES));
+
+/// What a pane shows at the current replay step.
+enum class View { heatmap, frontier, distance };
+inline constexpr const char* VIEW_NAMES[] = {"expansion order", "frontier", "distance"};
+
+/// Every push and expansion of one search, indexed by `y * width + x`.
+struct Recording {
+  int engine{};  // Index into `ENGINES`
+  int width{};
+  int height{};
+  std::array<int, 2> start{};  // y, x
+  std::array<int, 2> goal{};
+  std::vector<int> push_step{};  // Number of expansions before each node was first pushed, -1 if never pushed
+  std::vector<int> expand_step{};  // Expansion order of each node, -1 if never expanded
+  std::vector<int> distance{};  // Final distance of each node, -1 if never reached
+  int expansions{};
+  int max_distance{};
+  std::vector<std::array<int, 2>> path{};  // Goal to start, empty if the goal was not reached
+  TCODPATH_SearchStats stats{};
+
+  /// Return the final distance of the goal, -1 if it was not reached.
+  [[nodiscard]] auto goal_distance() const -> int {
+    return distance.at(static_cast<std::size_t>(goal[0]) * width + goal[1]);
+  }
+};
+
+/// Trace callback which fills a `Recording`.
+inline void record_event(
+    void* userdata, TCODPATH_TraceEvent event, int, const TCODPATH_IndexType* __restrict index, TCODPATH_ValueType) {
+  auto& recording = *static_cast<Recording*>(userdata);
+  const auto i = static_cast<std::size_t>(index[0]) * recording.width + index[1];
+  if (event == TCODPATH_TRACE_PUSH) {
+    if (recording.push_step[i] < 0) recording.push_step[i] = recording.expansions;
+  } else {
+    if (recording.expand_step[i] < 0) recording.expand_step[i] = recording.expansions;
+    ++recording.expansions;
+  }
+}
+
+/// Octile distance to the goal in `userdata` for cardinal cost 2 and diagonal cost 3.
+inline auto octile_heuristic(
+    void* userdata, int, const TCODPATH_IndexType* __restrict index, TCODPATH_ValueType distance)
+    -> TCODPATH_ValueType {
+  const auto* goal = static_cast<const TCODPATH_IndexType*>(userdata);
+  const TCODPATH_ValueType dy = std::abs(index[0] - goal[0]);
+  const TCODPATH_ValueType dx = std::abs(index[1] - goal[1]);
+  return distance + 2 * (std::max(dx, dy) - std::min(dx, dy)) + 3 * std::min(dx, dy);
+}
+
+/// Run `engine` on `graph` from `start` to `goal` and record it. `graph` must have cardinal cost 2 and diagonal 3.
+/// @param distance Work map of the same shape as the graph, overwritten.
+/// @param flow Work flow map of shape `{height, width, 2}`, overwritten.
+inline auto record_search(
+    TCODPATH_Graph& graph,
+    tcod::path::Map2D<>& distance,
+    TCODPATH_Map& flow,
+    int engine,
+    std::array<int, 2> start,
+    std::array<int, 2> goal) -> Recording {
+  auto recording = Recording{engine, distance.get_shape().at(1), distance.get_shape().at(0), start, goal};
+  const auto size = static_cast<std::size_t>(recording.width) * recording.height;
+  recording.push_step.assign(size, -1);
+  recording.expand_step.assign(size, -1);
+  recording.distance.assign(size, -1);
+  const auto trace = TCODPATH_SearchTrace{record_event, &recording};
+  const TCODPATH_IndexType start_ij[2] = {start[0], start[1]};
+  TCODPATH_IndexType goal_ij[2] = {goal[0], goal[1]};
+  TCODPATH_map_fill_max(distance.c_data());
+  TCODPATH_flow_reset(&flow);
+  TCODPATH_map_set(distance.c_data(), start_ij, 0);
+
+  if (ENGINES[engine].engine == Engine::bfs) {
+    auto bfs = TCODPATH_BreadthFirstSearch{};
+    if (TCODPATH_bfs_init(&bfs, &graph, distance.c_data(), &flow) == 0) {
+      bfs.has_goal = true;
+      bfs.goal[0] = goal_ij[0];
+      bfs.goal[1] = goal_ij[1];
+      bfs.stats = &recording.stats;
+      bfs.trace = &trace;
+      TCODPATH_bfs_push(&bfs, start_ij);
+      while (TCODPATH_bfs_step(&bfs) == 0) {
+      }
+    }
+    TCODPATH_bfs_uninit(&bfs);
+  } else {
+    auto heuristic = TCODPATH_Heuristic{};
+    if (ENGINES[engine].engine == Engine::astar_manhattan) {
+      heuristic.basic = TCODPATH_HeuristicBasic{TCODPATH_HEURISTIC_BASIC, {goal_ij[0], goal_ij[1]}, {2, 2}};
+    } else {
+      heuristic.callback = TCODPATH_HeuristicCallback{TCODPATH_HEURISTIC_CALLBACK, octile_heuristic, goal_ij};
+    }
+    auto ucs = TCODPATH_UniformCostSearch{};
+    const bool use_heuristic = ENGINES[engine].engine != Engine::dijkstra;
+    if (TCODPATH_ucs_init(&ucs, &graph, use_heuristic ? &heuristic : nullptr, distance.c_data(), &flow) == 0) {
+      if (ENGINES[engine].engine == Engine::wastar_octile) ucs.heuristic_weight = 150;
+      ucs.stats = &recording.stats;
+      ucs.trace = &trace;
+      TCODPATH_ucs_set_goal(&ucs, goal_ij);
+      TCODPATH_ucs_push(&ucs, start_ij);
+      while (TCODPATH_ucs_run(&ucs, std::numeric_limits<int>::max(), nullptr) == 0) {
+      }
+    }
+    TCODPATH_ucs_uninit(&ucs);
+  }
+
+  for (int y = 0; y < recording.height; ++y) {
+    for (int x = 0; x < recording.width; ++x) {
+      if (distance[{y, x}] == TCODPATH_VALUE_MAX) continue;
+      recording.distance[static_cast<std::size_t>(y) * recording.width + x] = distance[{y, x}];
+      recording.max_distance = std::max(recording.max_distance, static_cast<int>(distance[{y, x}]));
+    }
+  }
+  if (distance[{goal[0], goal[1]}] == TCODPATH_VALUE_MAX) return recording;
+  TCODPATH_IndexType ij[2] = {goal_ij[0], goal_ij[1]};
+  for (std::size_t guard = 0; guard < size; ++guard) {  // Flow maps from a finished search have no cycles
+    recording.path.push_back({ij[0], ij[1]});
+    TCODPATH_IndexType next[2];
+    TCODPATH_map_get_index(&flow, ij, next);
+    if (next[0] == ij[0] && next[1] == ij[1]) break;
+    ij[0] = next[0];
+    ij[1] = next[1];
+  }
+  return recording;
+}
+
+/// 8-bit RGB pixel, laid out like `SDL_PIXELFORMAT_RGB24`.
+struct Rgb {
+  std::uint8_t r, g, b;
+};
+static_assert(sizeof(Rgb) == 3);
+
+/// Map `t` in `[0, 1]` from blue through cyan, green, and yellow to red.
+inline auto colormap(float t) -> Rgb {
+  static constexpr Rgb STOPS[] = {{48, 18, 160}, {30, 160, 220}, {60, 200, 90}, {240, 220, 40}, {220, 40, 30}};
+  constexpr int LAST = static_cast<int>(std::size(STOPS)) - 1;
+  t = std::clamp(t, 0.0f, 1.0f) * LAST;
+  const int i = std::min(static_cast<int>(t), LAST - 1);
+  const float f = t - static_cast<float>(i);
+  auto lerp = [f](std::uint8_t a, std::uint8_t b) { return static_cast<std::uint8_t>(a + (b - a) * f); };
+  return {lerp(STOPS[i].r, STOPS[i + 1].r), lerp(STOPS[i].g, STOPS[i + 1].g), lerp(STOPS[i].b, STOPS[i + 1].b)};
+}
+
+/// Render `recording` as it was after `step` expansions over `passable` terrain.
+inline auto render(const Recording& recording, const std::vector<bool>& passable, View view, int step)
+    -> std::vector<Rgb> {
+  auto pixels = std::vector<Rgb>(passable.size());
+  const float expansions = static_cast<float>(std::max(recording.expansions, 1));
+  const float max_distance = static_cast<float>(std::max(recording.max_distance, 1));
+  for (std::size_t i = 0; i < pixels.size(); ++i) {
+    pixels[i] = passable[i] ? Rgb{96, 96, 96} : Rgb{0, 0, 0};
+    const int pushed = recording.push_step[i];
+    const int expanded = recording.expand_step[i];
+    const bool is_expanded = expanded >= 0 && expanded < step;
+    const bool is_reached = pushed >= 0 && pushed <= step;
+    switch (view) {
+      case View::heatmap:
+        if (is_expanded) pixels[i] = colormap(static_cast<float>(expanded) / expansions);
+        break;
+      case View::frontier:
+        if (is_expanded) {
+          pixels[i] = Rgb{40, 60, 110};
+        } else if (is_reached) {
+          pixels[i] = Rgb{250, 220, 60};
+        }
+        break;
+      case View::distance:
+        if (is_reached && recording.distance[i] >= 0) {
+          pixels[i] = colormap(static_cast<float>(recording.distance[i]) / max_distance);
+        }
+        break;
+    }
+  }
+  if (step >= recording.expansions) {
+    for (const auto& [y, x] : recording.path) pixels[static_cast<std::size_t>(y) * recording.width + x] = {255, 0, 255};
+  }
+  pixels[static_cast<std::size_t>(recording.start[0]) * recording.width + recording.start[1]] = {0, 255, 0};
+  pixels[static_cast<std::size_t>(recording.goal[0]) * recording.width + recording.goal[1]] = {255, 0, 0};
+  return pixels;
+}
+}  // namespace replay
@@ -0,0 +1,59 @@
+#pragma once
+
+#include <libtcod-path/config.h>
+#include <libtcod-path/indexes.h>
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <random>
+#include <string>
+#include <vector>
+
+/// Square map sides whose int32 arrays are about 16 KiB, 256 KiB, 4 MiB, and 64 MiB: L1, L2, L3, and main memory.
+inline constexpr std::array<int, 4> BENCH_SIDES{64, 256, 1024, 4096};
+/// Number of operations timed by each run of a benchmark.
+inline constexpr int BENCH_OPERATIONS = 1 << 14;
+/// Number of precomputed random indexes, enough that the nodes touched across all samples do not stay in cache.
+inline constexpr int BENCH_RANDOM_INDEXES = 1 << 20;
+
+/// Return the name of a benchmark, `name` followed by its parameters.
+template <typename... Args>
+inline auto bench_name(const std::string& name, const Args&... args) -> std::string {
+  auto result = name;
+  ((result += ' ', result += args), ...);
+  return result;
+}
+inline auto bench_size_name(int side) -> std::string { return std::to_string(side) + "x" + std::to_string(side); }
+
+/// Cycles through random 2D indexes of a `side x side` map. Each run continues where the last one stopped.
+class BenchRandomCursor {
+ public:
+  explicit BenchRandomCursor(int side, std::uint32_t seed = 0) : indexes_(std::size_t{BENCH_RANDOM_INDEXES} * 2) {
+    auto rng = std::mt19937{seed};
+    for (auto& it : indexes_) it = static_cast<TCODPATH_IndexType>(rng() % static_cast<std::uint32_t>(side));
+  }
+  auto next() noexcept -> const TCODPATH_IndexType* {
+    const TCODPATH_IndexType* index = &indexes_[position_ * 2];
+    if (++position_ == BENCH_RANDOM_INDEXES) position_ = 0;
+    return index;
+  }
+
+ private:
+  std::vector<TCODPATH_IndexType> indexes_;
+  std::size_t position_{};
+};
+
+/// Sweeps a `side x side` map in row-major order, wrapping around at the end.
+class BenchSequentialCursor {
+ public:
+  explicit BenchSequentialCursor(int side) : shape_{side, side} {}
+  auto next() noexcept -> const TCODPATH_IndexType* {
+    TCODPATH_indexes_iter_step(2, shape_.data(), index_.data());  // Resets to zero after the last index
+    return index_.data();
+  }
+
+ private:
+  std::array<TCODPATH_IndexType, 2> shape_;
+  std::array<TCODPATH_IndexType, 2> index_{};
+};
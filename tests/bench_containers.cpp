@@ -0,0 +1,146 @@
+#include <libtcod-path/heapq_tools.h>
+#include <libtcod-path/queue.h>
+#include <libtcod-path/ring_buffer.h>
+
+#include <algorithm>
+#include <array>
+#include <catch2/catch_all.hpp>
+#include <cstdint>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "bench_common.h"
+
+namespace {
+/// Node counts whose heap arrays are about 12 KiB, 192 KiB, 3 MiB, and 24 MiB with 2D indexes as node data.
+constexpr std::array<int, 4> BENCH_NODE_COUNTS{1 << 10, 1 << 14, 1 << 18, 1 << 21};
+
+/// Return `count` priorities following `distribution`.
+auto make_priorities(const std::string& distribution, int count) -> std::vector<int> {
+  auto rng = std::mt19937{0};
+  auto priorities = std::vector<int>(count);
+  for (int i = 0; i < count; ++i) {
+    if (distribution == "uniform") {
+      priorities[i] = static_cast<int>(rng() & 0x3fffffff);
+    } else if (distribution == "ties") {
+      priorities[i] = static_cast<int>(rng() % 16);  // Few distinct values, like A* with a tight heuristic
+    } else if (distribution == "ascending") {
+      priorities[i] = i;
+    } else {
+      priorities[i] = count - i;  // Every push sifts up to the root
+    }
+  }
+  return priorities;
+}
+}  // namespace
+
+TEST_CASE("Heap benchmarks", "[benchmark]") {
+  for (const int count : BENCH_NODE_COUNTS) {
+    auto heap = TCODPATH_Heap{};
+    REQUIRE(TCODPATH_heap_init(&heap, sizeof(TCODPATH_IndexType) * 2) == 0);
+    // Fill then drain the heap, the largest size is skipped since a single run would take too long
+    if (count < BENCH_NODE_COUNTS.back()) {
+      for (const auto* distribution : {"uniform", "ties", "ascending", "descending"}) {
+        const auto priorities = make_priorities(distribution, count);
+        BENCHMARK(bench_name("minheap push+pop", distribution, std::to_string(count))) {
+          TCODPATH_heap_clear(&heap);
+          TCODPATH_IndexType index[2] = {};
+          for (const int priority : priorities) {
+            index[1] = priority;
+            TCODPATH_minheap_push(&heap, priority, index);
+          }
+          std::int64_t sum = 0;
+          while (heap.size) {
+            TCODPATH_minheap_pop(&heap, index);
+            sum += index[1];
+          }
+          return sum;
+        };
+      }
+    }
+    // Pop the best node and push a neighbor with a cardinal or diagonal edge, as Dijkstra does at a steady size
+    {
+      TCODPATH_heap_clear(&heap);
+      auto rng = std::mt19937{1};
+      TCODPATH_IndexType index[2] = {};
+      for (int i = 0; i < count; ++i) TCODPATH_minheap_push(&heap, static_cast<int>(rng() % (1 << 16)), index);
+      BENCHMARK(bench_name("minheap steady state dijkstra", std::to_string(count))) {
+        for (int i = 0; i < BENCH_OPERATIONS; ++i) {
+          const int priority = TCODPATH_minheap_peek_priority(&heap);
+          TCODPATH_minheap_pop(&heap, index);
+          TCODPATH_minheap_push(&heap, priority + (i & 1 ? 3 : 2), index);
+        }
+        return TCODPATH_minheap_peek_priority(&heap);
+      };
+    }
+    TCODPATH_heap_uninit(&heap);
+  }
+}
+
+TEST_CASE("Ring buffer benchmarks", "[benchmark]") {
+  for (const int count : BENCH_NODE_COUNTS) {
+    auto buffer = TCODPATH_RingBuffer{};
+    const TCODPATH_IndexType index_in[2] = {1, 2};
+    TCODPATH_IndexType index_out[2] = {};
+    if (count < BENCH_NODE_COUNTS.back()) {
+      BENCHMARK(bench_name("ring_buffer append+pop", std::to_string(count))) {
+        for (int i = 0; i < count; ++i) TCODPATH_ring_buffer_append(&buffer, sizeof(index_in), index_in);
+        std::int64_t sum = 0;
+        while (TCODPATH_ring_buffer_pop(&buffer, sizeof(index_out), index_out) == 0) sum += index_out[1];
+        return sum;
+      };
+    }
+    // A breadth-first frontier of a steady size
+    for (int i = 0; i < count; ++i) TCODPATH_ring_buffer_append(&buffer, sizeof(index_in), index_in);
+    BENCHMARK(bench_name("ring_buffer steady state", std::to_string(count))) {
+      std::int64_t sum = 0;
+      for (int i = 0; i < BENCH_OPERATIONS; ++i) {
+        TCODPATH_ring_buffer_pop(&buffer, sizeof(index_out), index_out);
+        TCODPATH_ring_buffer_append(&buffer, sizeof(index_in), index_in);
+        sum += index_out[0];
+      }
+      return sum;
+    };
+    TCODPATH_ring_buffer_uninit(&buffer);
+  }
+}
+
+TEST_CASE("Queue benchmarks", "[benchmark]") {
+  for (const int count : BENCH_NODE_COUNTS) {
+    auto queue = TCODPATH_Queue{};
+    REQUIRE(TCODPATH_queue_init(&queue, sizeof(TCODPATH_IndexType) * 2) == 0);
+    const TCODPATH_IndexType index_in[2] = {1, 2};
+    TCODPATH_IndexType index_out[2] = {};
+    if (count < BENCH_NODE_COUNTS.back()) {
+      BENCHMARK(bench_name("queue push+pop", std::to_string(count))) {
+        for (int i = 0; i < count; ++i) TCODPATH_queue_push(&queue, index_in);
+        std::int64_t sum = 0;
+        while (TCODPATH_queue_pop(&queue, index_out) == 0) sum += index_out[1];
+        return sum;
+      };
+    }
+    // A breadth-first frontier of a steady size, with the neighbors of each expanded node pushed together
+    for (int i = 0; i < count; ++i) TCODPATH_queue_push(&queue, index_in);
+    BENCHMARK(bench_name("queue steady state", std::to_string(count))) {
+      std::int64_t sum = 0;
+      for (int i = 0; i < BENCH_OPERATIONS; ++i) {
+        TCODPATH_queue_pop(&queue, index_out);
+        TCODPATH_queue_push(&queue, index_in);
+        sum += index_out[0];
+      }
+      return sum;
+    };
+    const TCODPATH_IndexType neighbors[8][2] = {};
+    BENCHMARK(bench_name("queue steady state push_n", std::to_string(count))) {
+      std::int64_t sum = 0;
+      for (int i = 0; i < BENCH_OPERATIONS; i += 8) {
+        TCODPATH_queue_pop_n(&queue, 8, nullptr);
+        TCODPATH_queue_push_n(&queue, 8, neighbors);
+        sum += queue.head;
+      }
+      return sum;
+    };
+    TCODPATH_queue_uninit(&queue);
+  }
+}
@@ -0,0 +1,132 @@
+#include <libtcod-path/graph_tools.h>
+#include <libtcod-path/heuristic_tools.h>
+#include <libtcod-path/map_tools.h>
+
+#include <algorithm>
+#include <array>
+#include <catch2/catch_all.hpp>
+#include <cstdint>
+#include <cstdlib>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "bench_common.h"
+
+namespace {
+void sum_edge_costs(void* userdata, const TCODPATH_IndexType*, const TCODPATH_IndexType*, TCODPATH_ValueType cost) {
+  *static_cast<std::int64_t*>(userdata) += cost;
+}
+
+auto octile_heuristic(void* userdata, int, const TCODPATH_IndexType* index, TCODPATH_ValueType distance)
+    -> TCODPATH_ValueType {
+  const auto* target = static_cast<const TCODPATH_IndexType*>(userdata);
+  const TCODPATH_ValueType dy = std::abs(index[0] - target[0]);
+  const TCODPATH_ValueType dx = std::abs(index[1] - target[1]);
+  return distance + 2 * std::max(dx, dy) + std::min(dx, dy);
+}
+
+/// Benchmark `TCODPATH_graph_foreach_edge` on `graph` in sequential and random node order.
+void bench_graph_edges(const std::string& label, TCODPATH_Graph& graph, int side) {
+  auto sequential = BenchSequentialCursor{side};
+  auto random = BenchRandomCursor{side};
+  BENCHMARK(bench_name("graph_foreach_edge sequential", label, bench_size_name(side))) {
+    std::int64_t sum = 0;
+    for (int i = 0; i < BENCH_OPERATIONS; ++i) {
+      TCODPATH_graph_foreach_edge(&graph, 2, sequential.next(), sum_edge_costs, &sum);
+    }
+    return sum;
+  };
+  BENCHMARK(bench_name("graph_foreach_edge random", label, bench_size_name(side))) {
+    std::int64_t sum = 0;
+    for (int i = 0; i < BENCH_OPERATIONS; ++i) {
+      TCODPATH_graph_foreach_edge(&graph, 2, random.next(), sum_edge_costs, &sum);
+    }
+    return sum;
+  };
+}
+
+/// Benchmark `TCODPATH_heuristic_at` with `heuristic` at random nodes.
+void bench_heuristic(const std::string& label, TCODPATH_Heuristic& heuristic, int side) {
+  auto random = BenchRandomCursor{side};
+  BENCHMARK(bench_name("heuristic_at", label, bench_size_name(side))) {
+    std::int64_t sum = 0;
+    TCODPATH_IndexType index[TCODPATH_MAX_DIMENSIONS + 1] = {};  // Padded, some heuristics read past the node index
+    for (int i = 0; i < BENCH_OPERATIONS; ++i) {
+      const TCODPATH_IndexType* next = random.next();
+      index[0] = next[0];
+      index[1] = next[1];
+      sum += TCODPATH_heuristic_at(&heuristic, 2, index, 0);
+    }
+    return sum;
+  };
+}
+}  // namespace
+
+TEST_CASE("Graph edge benchmarks", "[benchmark]") {
+  for (const int side : BENCH_SIDES) {
+    auto shape = std::array<TCODPATH_IndexType, 2>{side, side};
+    auto costs = TCODPATH_Map{};
+    TCODPATH_map_init_contigious(&costs, 2, shape.data(), -4);
+    REQUIRE(costs.type == TCODPATH_MAP_CONTIGIOUS);
+    auto rng = std::mt19937{static_cast<std::uint32_t>(side)};
+    auto index = std::array<TCODPATH_IndexType, 2>{};
+    for (TCODPATH_indexes_iter_begin(2, index.data()); TCODPATH_indexes_iter_step(2, shape.data(), index.data());) {
+      TCODPATH_map_set(&costs, index.data(), rng() % 5 != 0);  // 20% walls
+    }
+
+    auto graph = TCODPATH_Graph{};
+    graph.basic2d = TCODPATH_GraphBasic2D{
+        .type = TCODPATH_GRAPH_BASIC2D,
+        .map = &costs,
+        .cardinal = 2,
+        .diagonal = 3,
+        .clearance = nullptr,
+        .agent_size = 0,
+        .no_corner_cutting = false};
+    bench_graph_edges("basic2d", graph, side);
+    graph.basic2d.no_corner_cutting = true;
+    bench_graph_edges("basic2d no_corner_cutting", graph, side);
+
+    static constexpr std::array<TCODPATH_ValueType, 2> AXIS_COSTS{2, 3};
+    auto edges = std::vector<int>(8 * 3);
+    REQUIRE(TCODPATH_graph_stencil_fill(2, 2, AXIS_COSTS.data(), edges.data()) == 8);
+    graph.static_edges = TCODPATH_GraphStatic{
+        .type = TCODPATH_GRAPH_STATIC,
+        .map = &costs,
+        .dimensions = 2,
+        .edge_count = 8,
+        .edges = edges.data(),
+        .offsets = nullptr,
+        .radius = 0};
+    bench_graph_edges("static", graph, side);
+    auto offsets = std::vector<ptrdiff_t>(8);
+    REQUIRE(TCODPATH_graph_static_init_offsets(&graph, offsets.data()) == 0);
+    bench_graph_edges("static offsets", graph, side);
+    TCODPATH_map_uninit(&costs);
+  }
+}
+
+TEST_CASE("Heuristic benchmarks", "[benchmark]") {
+  static constexpr int PIVOTS = 2;
+  for (const int side : BENCH_SIDES) {
+    const TCODPATH_IndexType target[2] = {side / 3, side / 2};
+    auto heuristic = TCODPATH_Heuristic{};
+    heuristic.basic = TCODPATH_HeuristicBasic{TCODPATH_HEURISTIC_BASIC, {target[0], target[1]}, {1, 1}};
+    bench_heuristic("basic", heuristic, side);
+    heuristic.callback = TCODPATH_HeuristicCallback{
+        TCODPATH_HEURISTIC_CALLBACK, octile_heuristic, const_cast<TCODPATH_IndexType*>(target)};
+    bench_heuristic("callback", heuristic, side);
+
+    // The table is read at the node and the target, so its size decides whether lookups hit the cache
+    auto shape = std::array<TCODPATH_IndexType, 3>{side, side, PIVOTS};
+    auto differentials = TCODPATH_Map{};
+    TCODPATH_map_init_contigious(&differentials, 3, shape.data(), -4);
+    REQUIRE(differentials.type == TCODPATH_MAP_CONTIGIOUS);
+    REQUIRE(TCODPATH_map_fill(&differentials, 1) == 0);
+    heuristic.differential = TCODPATH_HeuristicDifferential{
+        TCODPATH_HEURISTIC_DIFFERENTIAL, &differentials, 0, PIVOTS, {target[0], target[1]}, true};
+    bench_heuristic("differential", heuristic, side);
+    TCODPATH_map_uninit(&differentials);
+  }
+}
@@ -0,0 +1,118 @@
+#include <libtcod-path/indexes.h>
+#include <libtcod-path/map_tools.h>
+#include <libtcod-path/map_types.h>
+
+#include <array>
+#include <catch2/catch_all.hpp>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "bench_common.h"
+
+namespace {
+/// Callback map over a plain array, measures the cost of the indirect calls.
+struct CallbackData {
+  static auto get(void* userdata, const TCODPATH_IndexType* ij) -> TCODPATH_ValueType {
+    const auto& data = *static_cast<CallbackData*>(userdata);
+    return data.values[static_cast<std::size_t>(ij[0]) * data.side + ij[1]];
+  }
+  static void set(void* userdata, const TCODPATH_IndexType* ij, TCODPATH_ValueType value) {
+    auto& data = *static_cast<CallbackData*>(userdata);
+    data.values[static_cast<std::size_t>(ij[0]) * data.side + ij[1]] = value;
+  }
+  int side;
+  std::vector<TCODPATH_ValueType> values;
+};
+
+/// Benchmark reading and writing `map` in sequential and random order.
+void bench_map_access(const std::string& label, TCODPATH_Map& map, int side) {
+  auto sequential = BenchSequentialCursor{side};
+  auto random = BenchRandomCursor{side};
+  BENCHMARK(bench_name("map_get sequential", label, bench_size_name(side))) {
+    std::int64_t sum = 0;
+    for (int i = 0; i < BENCH_OPERATIONS; ++i) sum += TCODPATH_map_get(&map, sequential.next());
+    return sum;
+  };
+  BENCHMARK(bench_name("map_get random", label, bench_size_name(side))) {
+    std::int64_t sum = 0;
+    for (int i = 0; i < BENCH_OPERATIONS; ++i) sum += TCODPATH_map_get(&map, random.next());
+    return sum;
+  };
+  BENCHMARK(bench_name("map_set random", label, bench_size_name(side))) {
+    for (int i = 0; i < BENCH_OPERATIONS; ++i) TCODPATH_map_set(&map, random.next(), i & 63);
+  };
+}
+}  // namespace
+
+TEST_CASE("Map access benchmarks", "[benchmark]") {
+  for (const int side : BENCH_SIDES) {
+    auto shape = std::array<TCODPATH_IndexType, 2>{side, side};
+    for (const int8_t int_type : {1, -1, 2, -2, 4, -4, 8, -8}) {
+      auto map = TCODPATH_Map{};
+      TCODPATH_map_init_contigious(&map, 2, shape.data(), int_type);
+      REQUIRE(map.type == TCODPATH_MAP_CONTIGIOUS);
+      bench_map_access(bench_name("contiguous", "int_type=" + std::to_string(int_type)), map, side);
+      TCODPATH_map_uninit(&map);
+    }
+    {
+      // A transposed view, sequential sweeps jump a whole row between nodes
+      auto data = std::vector<std::int32_t>(static_cast<std::size_t>(side) * side);
+      auto map = TCODPATH_Map{};
+      map.strides = TCODPATH_MapStrides{
+          .type = TCODPATH_MAP_STRIDES,
+          .dimensions = 2,
+          .shape = {side, side},
+          .int_type = -4,
+          .data = reinterpret_cast<unsigned char*>(data.data()),
+          .strides = {4, static_cast<ptrdiff_t>(side) * 4},
+          .journal = nullptr};
+      bench_map_access("strided transposed int_type=-4", map, side);
+    }
+    {
+      auto map = TCODPATH_Map{};
+      REQUIRE(TCODPATH_map_init_chunked(&map, 2, shape.data(), nullptr, 0) == 0);
+      auto index = std::array<TCODPATH_IndexType, 2>{};
+      for (TCODPATH_indexes_iter_begin(2, index.data()); TCODPATH_indexes_iter_step(2, shape.data(), index.data());) {
+        TCODPATH_map_set(&map, index.data(), 1 + ((index[0] ^ index[1]) & 7));  // Allocate every chunk
+      }
+      bench_map_access("chunked", map, side);
+      TCODPATH_map_uninit(&map);
+    }
+    {
+      auto data = CallbackData{side, std::vector<TCODPATH_ValueType>(static_cast<std::size_t>(side) * side)};
+      auto map = TCODPATH_Map{};
+      map.callback = TCODPATH_MapCallback{
+          .type = TCODPATH_MAP_CALLBACK,
+          .dimensions = 2,
+          .shape = {side, side},
+          .userdata = &data,
+          .get = CallbackData::get,
+          .set = CallbackData::set,
+          .journal = nullptr,
+          .get_block = nullptr,
+          .set_block = nullptr,
+          .tile_cache = nullptr};
+      bench_map_access("callback", map, side);
+    }
+  }
+}
+
+TEST_CASE("Index iteration benchmarks", "[benchmark]") {
+  // The same number of nodes split over more axes, the cost per node grows with each carry
+  const auto shapes = std::vector<std::vector<TCODPATH_IndexType>>{
+      {1 << 16}, {256, 256}, {64, 32, 32}, {16, 16, 16, 16}};
+  for (const auto& shape : shapes) {
+    auto shape_name = std::string{};
+    for (const auto& it : shape) shape_name += (shape_name.empty() ? "" : "x") + std::to_string(it);
+    const int n = static_cast<int>(shape.size());
+    BENCHMARK(bench_name("indexes_iter_step", shape_name)) {
+      TCODPATH_IndexType index[TCODPATH_MAX_DIMENSIONS];
+      std::int64_t sum = 0;
+      for (TCODPATH_indexes_iter_begin(n, index); TCODPATH_indexes_iter_step(n, shape.data(), index);) {
+        sum += index[n - 1];
+      }
+      return sum;
+    };
+  }
+}
@@ -18,10 +18,13 @@ template <typename T = int>
 inline auto as_2d_graph(Map2D<T>& map, TCODPATH_ValueType cardinal, TCODPATH_ValueType diagonal) -> TCODPATH_Graph {
   auto graph = TCODPATH_Graph{};
   graph.basic2d = TCODPATH_GraphBasic2D{
-      TCODPATH_GRAPH_BASIC2D,
-      map.c_data(),
-      cardinal,
-      diagonal,
+      .type = TCODPATH_GRAPH_BASIC2D,
+      .map = map.c_data(),
+      .cardinal = cardinal,
+      .diagonal = diagonal,
+      .clearance = nullptr,
+      .agent_size = 0,
+      .no_corner_cutting = false,
   };
   return graph;
 }
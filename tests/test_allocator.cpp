@@ -0,0 +1,231 @@
+#include <libtcod-path/allocator.h>
+#include <libtcod-path/breadth_first_search.h>
+#include <libtcod-path/connectivity.h>
+#include <libtcod-path/differential.h>
+#include <libtcod-path/fringe_search.h>
+#include <libtcod-path/linear_search.h>
+#include <libtcod-path/map_tools.h>
+#include <libtcod-path/partition.h>
+#include <libtcod-path/tiled_search.h>
+#include <libtcod-path/uniform_cost_search.h>
+
+#include <array>
+#include <catch2/catch_all.hpp>
+#include <cstdint>
+#include <limits>
+
+#include "common.h"
+
+namespace {
+/// Install `allocator` as the global allocator for the lifetime of this object.
+struct GlobalAllocator {
+  explicit GlobalAllocator(TCODPATH_Allocator* allocator) { TCODPATH_set_allocator(allocator); }
+  GlobalAllocator(const GlobalAllocator&) = delete;
+  auto operator=(const GlobalAllocator&) -> GlobalAllocator& = delete;
+  ~GlobalAllocator() { TCODPATH_set_allocator(nullptr); }
+};
+
+const auto TEST_DATA = std::vector<std::string>{
+    "..........",
+    ".########.",
+    "..........",
+    "#########.",
+    "..........",
+};
+constexpr auto MAX = std::numeric_limits<TCODPATH_ValueType>::max();
+}  // namespace
+
+TEST_CASE("TCODPATH_Allocator counts the memory of the library", "") {
+  auto costs = wall_costs_from_test_data(TEST_DATA);
+  auto graph = as_2d_graph(costs, 2, 3);
+  auto counting = TCODPATH_allocator_malloc();
+  {
+    const auto global = GlobalAllocator{&counting};
+    auto shape = std::array<TCODPATH_IndexType, 2>{costs.get_shape().at(0), costs.get_shape().at(1)};
+    auto distance = TCODPATH_Map{};
+    TCODPATH_map_init_contigious(&distance, 2, shape.data(), -4);
+    REQUIRE(distance.contigious.data);
+    CHECK(counting.live_bytes == static_cast<int64_t>(sizeof(int) * shape[0] * shape[1]));
+
+    TCODPATH_map_clear_max(&distance);
+    const auto start = std::array{0, 0};
+    TCODPATH_map_set(&distance, start.data(), 0);
+    TCODPATH_dijkstra(&graph, &distance, nullptr);
+    TCODPATH_map_clear_max(&distance);
+    const auto goal = std::array{4, 0};
+    REQUIRE(TCODPATH_bfs_to(&graph, &distance, nullptr, start.data(), goal.data(), nullptr) == 0);
+    REQUIRE(TCODPATH_partition_from_graph(&graph, &distance) == 1);
+
+    auto chunked = TCODPATH_Map{};
+    REQUIRE(TCODPATH_map_init_chunked(&chunked, 2, nullptr, nullptr, 0) == 0);
+    for (int i = 0; i < 100; ++i) {
+      const auto ij = std::array{i * 20, -i * 20};
+      TCODPATH_map_set(&chunked, ij.data(), 1);
+    }
+    CHECK(TCODPATH_map_get_chunk_count(&chunked) == 100);
+    TCODPATH_map_uninit(&chunked);
+    TCODPATH_map_uninit(&distance);
+  }
+  CHECK(counting.live_bytes == 0);  // Everything given back with the sizes it was allocated with
+  const auto chunk_bytes = static_cast<int64_t>(sizeof(int) * TCODPATH_MAP_CHUNK_SIZE * TCODPATH_MAP_CHUNK_SIZE);
+  CHECK(counting.peak_bytes > 100 * chunk_bytes);
+}
+
+TEST_CASE("TCODPATH_Allocator limit", "") {
+  auto costs = wall_costs_from_test_data(TEST_DATA);
+  auto graph = as_2d_graph(costs, 1, 1);
+  auto distance = Map2D(costs.get_shape(), MAX);
+  auto limited = TCODPATH_allocator_malloc();
+  limited.limit_bytes = 16;
+  const auto global = GlobalAllocator{&limited};
+  const auto start = std::array{0, 0};
+  const auto goal = std::array{4, 0};
+  CHECK(TCODPATH_bfs_to(&graph, distance.c_data(), nullptr, start.data(), goal.data(), nullptr) ==
+        TCODPATH_E_OUT_OF_MEMORY);
+  CHECK(limited.live_bytes == 0);
+  limited.limit_bytes = 0;
+  TCODPATH_map_fill_max(distance.c_data());
+  CHECK(TCODPATH_bfs_to(&graph, distance.c_data(), nullptr, start.data(), goal.data(), nullptr) == 0);
+  CHECK(limited.live_bytes == 0);
+}
+
+TEST_CASE("TCODPATH_calloc_ rejects sizes which overflow", "") {
+  auto counting = TCODPATH_allocator_malloc();
+  CHECK(TCODPATH_calloc_(&counting, SIZE_MAX / 2 + 1, 2) == nullptr);
+  CHECK(counting.live_bytes == 0);
+  void* ptr = TCODPATH_calloc_(&counting, 3, 4);
+  REQUIRE(ptr);
+  CHECK(counting.live_bytes == 12);
+  TCODPATH_free_(&counting, ptr, 12);
+}
+
+TEST_CASE("Search workspaces allocate from their own allocator", "") {
+  auto costs = wall_costs_from_test_data(TEST_DATA);
+  auto graph = as_2d_graph(costs, 2, 3);
+  auto counting = TCODPATH_allocator_malloc();
+  const auto start = std::array<TCODPATH_IndexType, 2>{0, 0};
+
+  auto linear = TCODPATH_LinearGraph{};
+  REQUIRE(TCODPATH_linear_graph_init_with_allocator(&linear, &graph, &counting) == 0);
+  const auto graph_bytes = counting.live_bytes;
+  CHECK(graph_bytes > 0);
+  auto distance = Map2D(costs.get_shape(), MAX);
+  distance[start] = 0;
+  REQUIRE(TCODPATH_linear_dijkstra(&linear, distance.c_data(), nullptr) == 0);
+  CHECK(counting.live_bytes == graph_bytes);
+  CHECK(counting.peak_bytes > graph_bytes);  // The search arrays came from the same allocator
+  TCODPATH_linear_graph_uninit(&linear);
+  CHECK(counting.live_bytes == 0);
+
+  auto labels = Map2D(costs.get_shape(), 0);
+  auto connectivity = TCODPATH_Connectivity{};
+  REQUIRE(TCODPATH_connectivity_init_with_allocator(&connectivity, &graph, labels.c_data(), &counting) == 0);
+  CHECK(counting.live_bytes > 0);
+  TCODPATH_connectivity_uninit(&connectivity);
+  CHECK(counting.live_bytes == 0);
+
+  auto fringe = TCODPATH_FringeSearch{};
+  distance = Map2D(costs.get_shape(), MAX);
+  distance[start] = 0;
+  REQUIRE(TCODPATH_fringe_init(&fringe, &graph, nullptr, distance.c_data(), nullptr) == 0);
+  fringe.allocator = &counting;
+  REQUIRE(TCODPATH_fringe_push(&fringe, start.data()) == 0);
+  CHECK(counting.live_bytes > 0);
+  TCODPATH_fringe_uninit(&fringe);
+  CHECK(counting.live_bytes == 0);
+
+  const auto value_size = static_cast<ptrdiff_t>(sizeof(TCODPATH_ValueType));
+  const auto height = costs.get_shape().at(0);
+  const auto width = costs.get_shape().at(1);
+  auto tiled_costs = TCODPATH_TiledMap{};
+  auto tiled_distance = TCODPATH_TiledMap{};
+  REQUIRE(TCODPATH_tiled_map_init(&tiled_costs, height, width, 4, value_size, nullptr) == 0);
+  REQUIRE(TCODPATH_tiled_map_init(&tiled_distance, height, width, 4, value_size, nullptr) == 0);
+  REQUIRE(TCODPATH_tiled_map_copy_from(&tiled_costs, costs.c_data()) == 0);
+  REQUIRE(TCODPATH_tiled_map_fill(&tiled_distance, MAX) == 0);
+  auto tiled = TCODPATH_TiledSearch{};
+  counting.peak_bytes = 0;
+  REQUIRE(
+      TCODPATH_tiled_search_init_with_allocator(&tiled, &tiled_costs, &tiled_distance, nullptr, 2, 3, &counting) == 0);
+  const auto tile_count = TCODPATH_tiled_map_tile_count(&tiled_costs);
+  const auto frontiers_bytes = static_cast<int64_t>(sizeof(TCODPATH_Heap)) * tile_count;
+  CHECK(counting.live_bytes == frontiers_bytes);
+  REQUIRE(TCODPATH_tiled_search_add_source(&tiled, start[0], start[1], 0) == 0);
+  REQUIRE(TCODPATH_tiled_search_run(&tiled) == 0);
+  CHECK(counting.peak_bytes > frontiers_bytes);  // Including the heap of each tile
+  TCODPATH_tiled_search_uninit(&tiled);
+  CHECK(counting.live_bytes == 0);
+  TCODPATH_tiled_map_uninit(&tiled_distance);
+  TCODPATH_tiled_map_uninit(&tiled_costs);
+
+  auto partition = Map2D(costs.get_shape(), 0);
+  REQUIRE(TCODPATH_partition_from_graph(&graph, partition.c_data()) == 1);
+  auto differentials_shape =
+      std::array<TCODPATH_IndexType, 3>{costs.get_shape().at(0), costs.get_shape().at(1), 2};
+  auto differentials = TCODPATH_Map{};
+  TCODPATH_map_init_contigious_with_allocator(&differentials, 3, differentials_shape.data(), -4, &counting);
+  REQUIRE(differentials.contigious.data);
+  counting.peak_bytes = counting.live_bytes;
+  TCODPATH_differential_generate_all_auto(&graph, 1, partition.c_data(), &differentials);
+  CHECK(counting.peak_bytes > counting.live_bytes);  // Pivot selection used the allocator of the differentials
+  TCODPATH_map_uninit(&differentials);
+  CHECK(counting.live_bytes == 0);
+}
+
+TEST_CASE("TCODPATH_Arena", "") {
+  auto arena = TCODPATH_Arena{};
+  REQUIRE(TCODPATH_arena_init(&arena, 1 << 16) == 0);
+  auto allocator = TCODPATH_arena_allocator(&arena);
+
+  SECTION("The most recent allocation grows in place") {
+    auto heap = TCODPATH_Heap{};
+    REQUIRE(TCODPATH_heap_init(&heap, sizeof(int)) == 0);
+    heap.allocator = &allocator;
+    for (int i = 0; i < TCODPATH_HEAP_DEFAULT_CAPACITY; ++i) REQUIRE(TCODPATH_minheap_push(&heap, i, &i) == 0);
+    const unsigned char* first_block = heap.heap;
+    CHECK(first_block == arena.data);
+    for (int i = 0; i < TCODPATH_HEAP_DEFAULT_CAPACITY * 4; ++i) REQUIRE(TCODPATH_minheap_push(&heap, i, &i) == 0);
+    CHECK(heap.heap == first_block);
+    CHECK(allocator.live_bytes == heap.capacity * heap.node_size);
+    int value = -1;
+    TCODPATH_minheap_pop(&heap, &value);
+    CHECK(value == 0);
+    TCODPATH_heap_uninit(&heap);
+    CHECK(allocator.live_bytes == 0);
+    CHECK(arena.used == 0);  // The only allocation was given back
+  }
+  SECTION("Allocations fail once the arena is full") {
+    auto queue = TCODPATH_Queue{};
+    REQUIRE(TCODPATH_queue_init(&queue, 256) == 0);
+    queue.allocator = &allocator;
+    const auto element = std::array<unsigned char, 256>{};
+    int err = 0;
+    int pushed = 0;
+    for (; err == 0 && pushed < 1000; ++pushed) err = TCODPATH_queue_push(&queue, element.data());
+    CHECK(err == TCODPATH_E_OUT_OF_MEMORY);
+    CHECK(queue.size == 128);  // The next capacity of 256 elements does not fit beside the current block
+    TCODPATH_queue_uninit(&queue);
+    TCODPATH_arena_reset(&arena);
+    REQUIRE(TCODPATH_queue_init(&queue, 256) == 0);
+    queue.allocator = &allocator;
+    CHECK(TCODPATH_queue_reserve(&queue, 255) == 0);  // Fills the whole arena
+    TCODPATH_queue_uninit(&queue);
+  }
+  TCODPATH_arena_uninit(&arena);
+}
+
+TEST_CASE("TCODPATH_allocator_huge_pages", "") {
+  auto allocator = TCODPATH_allocator_huge_pages();
+  auto shape = std::array<TCODPATH_IndexType, 2>{1024, 1024};  // 4 MiB, at least one huge page
+  auto map = TCODPATH_Map{};
+  TCODPATH_map_init_contigious_with_allocator(&map, 2, shape.data(), -4, &allocator);
+  REQUIRE(map.contigious.data);
+  CHECK(allocator.live_bytes == static_cast<int64_t>(sizeof(int) * shape[0] * shape[1]));
+  const auto ij = std::array{1023, 1023};
+  CHECK(TCODPATH_map_get(&map, ij.data()) == 0);
+  TCODPATH_map_set(&map, ij.data(), 7);
+  CHECK(TCODPATH_map_get(&map, ij.data()) == 7);
+  TCODPATH_map_uninit(&map);
+  CHECK(allocator.live_bytes == 0);
+  CHECK(allocator.peak_bytes == static_cast<int64_t>(sizeof(int) * shape[0] * shape[1]));
+}
@@ -0,0 +1,191 @@
+#include <libtcod-path/bidirectional_search.h>
+#include <libtcod-path/flow_tools.h>
+
+#include <array>
+#include <catch2/catch_all.hpp>
+#include <limits>
+#include <random>
+#include <type_traits>
+#include <vector>
+
+#include "common.h"
+
+namespace {
+constexpr auto MAX = std::numeric_limits<Map2D<>::value_type>::max();
+using Index = std::array<TCODPATH_IndexType, 2>;
+
+/// Flow map for a 2D map of `height` by `width`, reset before use.
+struct FlowMap {
+  FlowMap(TCODPATH_IndexType height, TCODPATH_IndexType width) : data(height * width * 2) {
+    auto shape = std::array<TCODPATH_IndexType, 3>{height, width, 2};
+    TCODPATH_map_init_contigious_from(
+        &map,
+        3,
+        shape.data(),
+        static_cast<int>(sizeof(TCODPATH_IndexType)) * (std::is_signed_v<TCODPATH_IndexType> ? -1 : 1),
+        static_cast<void*>(data.data()));
+    TCODPATH_flow_reset(&map);
+  }
+  std::vector<TCODPATH_IndexType> data;
+  TCODPATH_Map map{};
+};
+
+/// Return a map of random costs from 0 to `max_cost`, where 0 is a wall.
+auto random_costs(std::mt19937& rng, int max_cost) -> Map2D<> {
+  auto costs = Map2D({40, 40}, 1);
+  for (int i = 0; i < 500; ++i) {
+    costs[{static_cast<int>(rng() % 40), static_cast<int>(rng() % 40)}] = rng() % (max_cost + 1);
+  }
+  return costs;
+}
+
+/// Check that the flow from `goal` leads to `start`, each step matching the recorded distances.
+void check_path(
+    const Map2D<>& costs, const Map2D<>& distance, FlowMap& flow, Index start, Index goal, bool unit_costs) {
+  auto previous = goal;
+  for (const auto& index : get_path(flow.map, goal)) {
+    const bool diagonal = index[0] != previous[0] && index[1] != previous[1];
+    const int edge_cost = unit_costs ? 1 : (diagonal ? 3 : 2) * costs[previous];
+    REQUIRE(distance[previous] == distance[index] + edge_cost);
+    previous = index;
+  }
+  REQUIRE(previous == start);
+}
+}  // namespace
+
+TEST_CASE("Bidirectional searches match one-sided searches", "") {
+  auto rng = std::mt19937{21};
+  for (int round = 0; round < 30; ++round) {
+    INFO("round " << round);
+    // Uniform costs are the same both ways, otherwise each edge costs more in one direction
+    const bool undirected = round % 3 == 0;
+    auto costs = random_costs(rng, undirected ? 1 : 3);
+    const auto start = Index{static_cast<int>(rng() % 40), static_cast<int>(rng() % 40)};
+    const auto goal = Index{static_cast<int>(rng() % 40), static_cast<int>(rng() % 40)};
+    costs[start] = costs[goal] = 1;
+    auto graph = as_2d_graph(costs, 2, 3);
+    auto heuristic = TCODPATH_Heuristic{};
+    heuristic.basic = TCODPATH_HeuristicBasic{TCODPATH_HEURISTIC_BASIC, {goal[0], goal[1]}, {1, 1}};
+    auto reverse_heuristic = TCODPATH_Heuristic{};
+    reverse_heuristic.basic = TCODPATH_HeuristicBasic{TCODPATH_HEURISTIC_BASIC, {start[0], start[1]}, {1, 1}};
+
+    auto expected = Map2D(costs.get_shape(), MAX);
+    const int reachable =
+        TCODPATH_astar(&graph, nullptr, expected.c_data(), nullptr, start.data(), goal.data(), nullptr);
+    REQUIRE(reachable >= 0);
+    auto expected_steps = Map2D(costs.get_shape(), MAX);
+    REQUIRE(
+        TCODPATH_bfs_to(&graph, expected_steps.c_data(), nullptr, start.data(), goal.data(), nullptr) == reachable);
+
+    for (int mode = 0; mode < 3; ++mode) {
+      INFO("mode " << mode);
+      auto distance = Map2D(costs.get_shape(), MAX);
+      auto reverse_distance = Map2D(costs.get_shape(), MAX);
+      auto flow = FlowMap(40, 40);
+      auto reverse_flow = FlowMap(40, 40);
+      int result = 0;
+      if (mode == 0) {
+        result = TCODPATH_bidirectional_dijkstra(
+            &graph,
+            undirected,
+            distance.c_data(),
+            &flow.map,
+            reverse_distance.c_data(),
+            &reverse_flow.map,
+            start.data(),
+            goal.data(),
+            nullptr);
+      } else if (mode == 1) {
+        result = TCODPATH_bidirectional_astar(
+            &graph,
+            &heuristic,
+            &reverse_heuristic,
+            undirected,
+            distance.c_data(),
+            &flow.map,
+            reverse_distance.c_data(),
+            &reverse_flow.map,
+            start.data(),
+            goal.data(),
+            nullptr);
+      } else {
+        result = TCODPATH_bidirectional_bfs(
+            &graph,
+            undirected,
+            distance.c_data(),
+            &flow.map,
+            reverse_distance.c_data(),
+            &reverse_flow.map,
+            start.data(),
+            goal.data(),
+            nullptr);
+      }
+      REQUIRE(result == reachable);
+      if (reachable == 1) continue;
+      REQUIRE(distance[goal] == (mode == 2 ? expected_steps : expected)[goal]);
+      check_path(costs, distance, flow, start, goal, mode == 2);
+    }
+  }
+}
+
+TEST_CASE("Bidirectional search edge cases", "") {
+  auto costs = wall_costs_from_test_data({
+      "...#....",
+      "...#....",
+      "...#....",
+  });
+  auto int_costs = Map2D(costs.get_shape(), 0);
+  for (int y = 0; y < 3; ++y) {
+    for (int x = 0; x < 8; ++x) int_costs[{y, x}] = costs[{y, x}];
+  }
+  auto graph = as_2d_graph(int_costs, 1, 1);
+  auto distance = Map2D(int_costs.get_shape(), MAX);
+  auto reverse_distance = Map2D(int_costs.get_shape(), MAX);
+  auto flow = FlowMap(3, 8);
+  auto reverse_flow = FlowMap(3, 8);
+  const auto start = Index{1, 1};
+  const auto goal = Index{1, 6};
+
+  SECTION("Unreachable goal") {
+    CHECK(
+        TCODPATH_bidirectional_bfs(
+            &graph,
+            false,
+            distance.c_data(),
+            &flow.map,
+            reverse_distance.c_data(),
+            &reverse_flow.map,
+            start.data(),
+            goal.data(),
+            nullptr) == 1);
+    CHECK(distance[goal] == MAX);
+  }
+  SECTION("Start is the goal") {
+    CHECK(
+        TCODPATH_bidirectional_dijkstra(
+            &graph,
+            false,
+            distance.c_data(),
+            &flow.map,
+            reverse_distance.c_data(),
+            &reverse_flow.map,
+            start.data(),
+            start.data(),
+            nullptr) == 0);
+    CHECK(distance[start] == 0);
+    CHECK(get_path(flow.map, start).empty());
+  }
+  SECTION("The backward flow map is required") {
+    CHECK(
+        TCODPATH_bidirectional_dijkstra(
+            &graph,
+            false,
+            distance.c_data(),
+            &flow.map,
+            reverse_distance.c_data(),
+            nullptr,
+            start.data(),
+            goal.data(),
+            nullptr) == TCODPATH_E_INVALID_ARGUMENT);
+  }
+}
@@ -53,3 +53,47 @@ TEST_CASE("TCODPATH_bfs large", "[.slow]") {
   CHECK(distance[{0, 0}] == 0);
   CHECK(distance[{SIZE - 1, SIZE - 1}] == SIZE - 1);
 }
+
+TEST_CASE("TCODPATH_bfs_to on unbounded maps", "") {
+  static constexpr auto MAX = std::numeric_limits<TCODPATH_ValueType>::max();
+  const auto start = std::array<TCODPATH_IndexType, 2>{0, 0};
+  const auto goal = std::array<TCODPATH_IndexType, 2>{3, 3};
+  auto costs = TCODPATH_Map{};
+  REQUIRE(TCODPATH_map_init_chunked(&costs, 2, nullptr, nullptr, 1) == 0);
+  auto graph = TCODPATH_Graph{};
+  graph.basic2d.type = TCODPATH_GRAPH_BASIC2D;
+  graph.basic2d.map = &costs;
+  graph.basic2d.cardinal = 1;
+  auto distance = TCODPATH_Map{};
+  REQUIRE(TCODPATH_map_init_chunked(&distance, 2, nullptr, nullptr, MAX) == 0);
+  REQUIRE(TCODPATH_map_get_shape(&distance) == nullptr);
+  REQUIRE(TCODPATH_bfs_to(&graph, &distance, nullptr, start.data(), goal.data(), nullptr) == 0);
+  CHECK(TCODPATH_map_get(&distance, goal.data()) == 6);
+  TCODPATH_map_uninit(&distance);
+  TCODPATH_map_uninit(&costs);
+}
+
+TEST_CASE("TCODPATH_bfs_bounded", "") {
+  static constexpr auto MAX = std::numeric_limits<Map2D<>::value_type>::max();
+  static const auto TEST_DATA = std::vector<std::string>{
+      "012#####",
+      "112#####",
+      "222#####",
+      "########",
+  };
+  auto costs = Map2D({4, 8}, 1);
+  auto graph = as_2d_graph(costs, 1, 1);
+  auto distance = Map2D(costs.get_shape(), MAX);
+  auto touched = TCODPATH_RingBuffer{};
+  static const auto SOURCE = std::array<TCODPATH_IndexType, 2>{0, 0};
+  REQUIRE(TCODPATH_bfs_bounded(&graph, distance.c_data(), nullptr, 1, SOURCE.data(), 2, &touched) == 0);
+  CHECK(as_string(distance) == as_string(TEST_DATA));
+  CHECK(touched.used_bytes == 9 * 2 * sizeof(TCODPATH_IndexType));
+  TCODPATH_map_reset_touched(distance.c_data(), &touched);
+  CHECK(as_string(distance) == as_string(Map2D(costs.get_shape(), MAX)));
+  // A limit of zero only reaches the source
+  REQUIRE(TCODPATH_bfs_bounded(&graph, distance.c_data(), nullptr, 1, SOURCE.data(), 0, &touched) == 0);
+  CHECK(touched.used_bytes == 2 * sizeof(TCODPATH_IndexType));
+  CHECK(distance[{0, 0}] == 0);
+  TCODPATH_ring_buffer_uninit(&touched);
+}
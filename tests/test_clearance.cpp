@@ -0,0 +1,96 @@
+#include <libtcod-path/clearance.h>
+#include <libtcod-path/linear_search.h>
+#include <libtcod-path/uniform_cost_search.h>
+
+#include <algorithm>
+#include <array>
+#include <catch2/catch_all.hpp>
+#include <limits>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "common.h"
+
+namespace {
+/// Return the largest open square at `y, x` by checking every node.
+auto brute_force_clearance(const Map2D<TCODPATH_IndexType>& costs, int y, int x, int max_clearance) -> int {
+  const auto shape = costs.get_shape();
+  int size = 0;
+  while (size < max_clearance && y + size < shape[0] && x + size < shape[1]) {
+    for (int i = 0; i <= size; ++i) {
+      if (!costs[{y + size, x + i}] || !costs[{y + i, x + size}]) return size;
+    }
+    ++size;
+  }
+  return size;
+}
+}  // namespace
+
+TEST_CASE("TCODPATH_clearance_generate", "") {
+  static constexpr int MAX_CLEARANCE = 6;
+  auto rng = std::mt19937{5};
+  auto costs = Map2D<TCODPATH_IndexType>({40, 50}, 1);
+  for (int i = 0; i < 120; ++i) costs[{static_cast<int>(rng() % 40), static_cast<int>(rng() % 50)}] = 0;
+  auto clearance = Map2D(costs.get_shape(), 0);
+  REQUIRE(TCODPATH_clearance_generate(costs.c_data(), clearance.c_data(), MAX_CLEARANCE) == 0);
+  for (int y = 0; y < 40; ++y) {
+    for (int x = 0; x < 50; ++x) REQUIRE(clearance[{y, x}] == brute_force_clearance(costs, y, x, MAX_CLEARANCE));
+  }
+
+  // Rows of the first pass are independent and can be split between threads
+  auto threaded = Map2D(costs.get_shape(), 0);
+  auto threads = std::vector<std::thread>{};
+  for (int row = 0; row < 40; row += 10) {
+    threads.emplace_back([&, row]() {
+      TCODPATH_clearance_rows(costs.c_data(), threaded.c_data(), MAX_CLEARANCE, row, row + 10);
+    });
+  }
+  for (auto& thread : threads) thread.join();
+  for (int y = 39; y >= 0; --y) REQUIRE(TCODPATH_clearance_combine(threaded.c_data(), y, 0, 50) == 0);
+  CHECK(as_string(threaded) == as_string(clearance));
+}
+
+TEST_CASE("Agent size", "") {
+  static constexpr auto MAX = std::numeric_limits<TCODPATH_ValueType>::max();
+  auto costs = wall_costs_from_test_data({
+      "##########",
+      "#........#",
+      "#........#",
+      "######.###",
+      "#........#",
+      "#........#",
+      "###..#####",
+      "#........#",
+      "#........#",
+      "##########",
+  });
+  auto clearance = Map2D(costs.get_shape(), 0);
+  REQUIRE(TCODPATH_clearance_generate(costs.c_data(), clearance.c_data(), 4) == 0);
+  auto graph = as_2d_graph(costs, 2, 3);
+  graph.basic2d.clearance = clearance.c_data();
+  const auto start = std::array{1, 1};
+  const auto goal = std::array{7, 1};
+
+  for (const TCODPATH_ValueType agent_size : {1, 2}) {
+    graph.basic2d.agent_size = agent_size;
+    auto distance = Map2D(costs.get_shape(), MAX);
+    // The upper gap is one node wide, only agents of size 1 fit through it
+    REQUIRE(TCODPATH_astar(&graph, nullptr, distance.c_data(), nullptr, start.data(), goal.data(), nullptr) ==
+            (agent_size == 1 ? 0 : 1));
+
+    // The linear search core rejects the same nodes
+    auto linear = TCODPATH_LinearGraph{};
+    REQUIRE(TCODPATH_linear_graph_init(&linear, &graph) == 0);
+    auto linear_distance = Map2D(costs.get_shape(), MAX);
+    linear_distance[start] = 0;
+    auto expected = Map2D(costs.get_shape(), MAX);
+    expected[start] = 0;
+    TCODPATH_dijkstra(&graph, expected.c_data(), nullptr);
+    CHECK(expected[{2, 8}] == (agent_size == 1 ? 15 : MAX));  // Too close to the wall for size 2
+    REQUIRE(TCODPATH_linear_dijkstra(&linear, linear_distance.c_data(), nullptr) == 0);
+    CHECK(as_string(linear_distance) == as_string(expected));
+    TCODPATH_linear_graph_uninit(&linear);
+  }
+}
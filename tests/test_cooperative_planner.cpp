@@ -0,0 +1,129 @@
+#include <libtcod-path/cooperative_planner.hpp>
+
+#include <array>
+#include <catch2/catch_all.hpp>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "common.h"
+
+using tcod::path::CooperativePlanner;
+using tcod::path::PlannerAgent;
+using tcod::path::PlannerOptions;
+using tcod::path::ReservationTable;
+using tcod::path::SpaceTimePath;
+
+namespace {
+/// Return the number of vertex and swap conflicts between `paths`.
+auto count_conflicts(const std::vector<SpaceTimePath>& paths) -> int {
+  int conflicts = 0;
+  const auto at = [](const SpaceTimePath& path, size_t t) {
+    return std::pair{path.steps[t * 2], path.steps[t * 2 + 1]};
+  };
+  for (size_t a = 0; a < paths.size(); ++a) {
+    for (size_t b = a + 1; b < paths.size(); ++b) {
+      for (size_t t = 0; t < paths[a].steps.size() / 2; ++t) {
+        if (at(paths[a], t) == at(paths[b], t)) ++conflicts;
+        if (t > 0 && at(paths[a], t - 1) == at(paths[b], t) && at(paths[a], t) == at(paths[b], t - 1)) ++conflicts;
+      }
+    }
+  }
+  return conflicts;
+}
+}  // namespace
+
+TEST_CASE("ReservationTable", "") {
+  auto table = ReservationTable{};
+  CHECK(table.get_agent(5, 0) == ReservationTable::no_agent);
+  table.reserve(5, 0, 1);
+  table.reserve(6, 1, 1);
+  CHECK(table.get_agent(5, 0) == 1);
+  CHECK(table.is_free(5, 0, 1));
+  CHECK(!table.is_free(5, 0, 2));
+  CHECK(table.is_free(5, 1, 2));
+  CHECK(!table.can_move(6, 5, 0, 2));  // Would swap places with agent 1
+  CHECK(table.can_move(7, 5, 0, 2));
+  for (int i = 0; i < 10000; ++i) table.reserve(i, i % 100, i);
+  CHECK(table.size() == 10000 + 2);
+  CHECK(table.get_agent(9999, 99) == 9999);
+  table.clear();
+  CHECK(table.size() == 0);
+  CHECK(table.get_agent(9999, 99) == ReservationTable::no_agent);
+}
+
+TEST_CASE("CooperativePlanner corridor", "") {
+  auto costs = wall_costs_from_test_data({
+      "#########",
+      "#.......#",
+      "#####.###",
+      "#########",
+  });
+  auto graph = as_2d_graph(costs, 1, 0);
+  auto planner = CooperativePlanner{graph, PlannerOptions{16, 1, 1 << 14, 64, 1}};
+  const auto paths = planner.plan({PlannerAgent{{1, 1}, {1, 7}}, PlannerAgent{{1, 7}, {1, 1}}});
+  REQUIRE(paths.size() == 2);
+  for (const auto& path : paths) {
+    CHECK(path.planned);
+    CHECK(path.reached_goal);
+    CHECK(path.steps.size() == 17 * 2);
+  }
+  CHECK(count_conflicts(paths) == 0);
+  CHECK(paths[0].cost == 6);  // The first agent has priority and goes straight through
+  CHECK(paths[1].cost > 6);  // The second agent steps into the side pocket
+}
+
+TEST_CASE("CooperativePlanner rejects graphs which are not thread-safe", "") {
+  auto costs = TCODPATH_Map{};
+  REQUIRE(TCODPATH_map_init_chunked(&costs, 2, std::array<TCODPATH_IndexType, 2>{8, 8}.data(), nullptr, 1) == 0);
+  auto graph = TCODPATH_Graph{};
+  graph.basic2d.type = TCODPATH_GRAPH_BASIC2D;
+  graph.basic2d.map = &costs;
+  graph.basic2d.cardinal = 1;
+  CHECK_THROWS_AS(CooperativePlanner(graph, PlannerOptions{16, 1, 1 << 14, 64, 0}), std::invalid_argument);
+  // A single thread never reads the graph concurrently
+  auto planner = CooperativePlanner{graph, PlannerOptions{16, 1, 1 << 14, 64, 1}};
+  const auto paths = planner.plan({PlannerAgent{{0, 0}, {0, 7}}});
+  REQUIRE(paths.size() == 1);
+  CHECK(paths[0].reached_goal);
+  TCODPATH_map_uninit(&costs);
+}
+
+TEST_CASE("CooperativePlanner batches", "") {
+  auto rng = std::mt19937{7};
+  auto costs = Map2D({32, 32}, 1);
+  for (int i = 0; i < 150; ++i) costs[{static_cast<int>(rng() % 32), static_cast<int>(rng() % 32)}] = 0;
+  auto graph = as_2d_graph(costs, 2, 3);
+  auto open_cells = std::vector<std::array<int, 2>>{};
+  for (int y = 0; y < 32; ++y) {
+    for (int x = 0; x < 32; ++x) {
+      if (costs[{y, x}]) open_cells.push_back({y, x});
+    }
+  }
+  std::shuffle(open_cells.begin(), open_cells.end(), rng);
+  auto agents = std::vector<PlannerAgent>{};
+  for (int i = 0; i < 100; ++i) {
+    const auto& start = open_cells.at(i);
+    const auto& goal = open_cells.at(open_cells.size() - 1 - i);
+    agents.push_back(PlannerAgent{{start[0], start[1]}, {goal[0], goal[1]}});
+  }
+  for (int threads : {1, 4}) {
+    auto planner = CooperativePlanner{graph, PlannerOptions{24, 1, 1 << 14, 16, threads}};
+    const auto paths = planner.plan(agents);
+    int planned = 0;
+    for (const auto& path : paths) planned += path.planned;
+    CHECK(planned == 100);
+    CHECK(count_conflicts(paths) == 0);
+    if (threads == 1) CHECK(planner.get_replanned_count() > 0);  // Agents of the same batch do not see each other
+
+    // Re-plan the next window from the positions reached so far
+    auto next_agents = agents;
+    for (size_t i = 0; i < agents.size(); ++i) {
+      next_agents[i].start = {paths[i].steps[8 * 2], paths[i].steps[8 * 2 + 1]};
+    }
+    const auto next_paths = planner.plan(next_agents, 8);
+    CHECK(count_conflicts(next_paths) == 0);
+  }
+}
@@ -22,3 +22,57 @@ TEST_CASE("TCODPATH_differentials", "") {
 
   TCODPATH_differential_generate_all_auto(&graph, 1, partition.c_data(), &differentials);
 }
+
+TEST_CASE("TCODPATH_differential_refresh_all", "") {
+  static const auto TEST_DATA = std::vector<std::string>{
+      "..........#.",
+      "..........##",
+      "............",
+      "............",
+      "............",
+      "............",
+      "............",
+      "............",
+      "............",
+      "............",
+  };
+  auto cost = wall_costs_from_test_data(TEST_DATA);
+  auto graph = as_2d_graph(cost, 2, 3);
+  auto pivots = std::vector<int>{0, 0, 9, 11, 0, 11};
+  auto differentials_shape = std::vector<int>{10, 12, 3};
+  auto generate = [&](std::vector<int>& data) {
+    auto differentials = TCODPATH_Map{};
+    TCODPATH_map_init_contigious_from(&differentials, 3, differentials_shape.data(), -4, (void*)data.data());
+    for (int i = 0; i < 3; ++i) TCODPATH_differential_generate_one(&graph, &differentials, i, 1, &pivots.at(i * 2));
+    return differentials;
+  };
+  auto differentials_data = std::vector<int>(10 * 12 * 3);
+  auto differentials = generate(differentials_data);
+
+  auto journal = TCODPATH_MapJournal{};
+  TCODPATH_map_set_journal(cost.c_data(), &journal);
+  for (int y = 0; y < 8; ++y) TCODPATH_map_set(cost.c_data(), std::array{y, 5}.data(), 0);  // New wall
+  TCODPATH_map_set(cost.c_data(), std::array{8, 8}.data(), 4);  // Higher cost
+  TCODPATH_map_set(cost.c_data(), std::array{9, 0}.data(), 2);
+  CHECK(journal.version == 10);
+  CHECK(journal.dirty_count == 3);
+  TCODPATH_map_set(cost.c_data(), std::array{9, 1}.data(), 2);  // Extends an existing rectangle
+  CHECK(journal.dirty_count == 3);
+
+  CHECK(TCODPATH_differential_refresh_all(&graph, &differentials, &journal) == 2);  // Corner slice is untouched
+  TCODPATH_map_journal_clear_dirty(&journal);
+
+  auto expected_data = std::vector<int>(10 * 12 * 3);
+  generate(expected_data);
+  CHECK(differentials_data == expected_data);
+
+  // Opened walls and lowered costs make paths cheaper, which must be propagated out of the dirty region
+  for (int y = 3; y < 5; ++y) TCODPATH_map_set(cost.c_data(), std::array{y, 5}.data(), 1);  // Gap in the wall
+  TCODPATH_map_set(cost.c_data(), std::array{8, 8}.data(), 1);  // Lower cost
+  TCODPATH_map_set(cost.c_data(), std::array{9, 0}.data(), 1);
+  TCODPATH_map_set(cost.c_data(), std::array{9, 1}.data(), 1);
+  CHECK(TCODPATH_differential_refresh_all(&graph, &differentials, &journal) == 2);
+  TCODPATH_map_journal_clear_dirty(&journal);
+  generate(expected_data);
+  CHECK(differentials_data == expected_data);
+}
@@ -9,6 +9,7 @@
 #include <array>
 #include <catch2/catch_all.hpp>
 #include <limits>
+#include <random>
 #include <stdexcept>
 
 #include "common.h"
@@ -20,10 +21,13 @@ TEST_CASE("TCODPATH_dijkstra", "") {
   map[{1, 1}] = 0;
   auto graph = TCODPATH_Graph{};
   graph.basic2d = TCODPATH_GraphBasic2D{
-      TCODPATH_GRAPH_BASIC2D,
-      map.c_data(),
-      2,
-      3,
+      .type = TCODPATH_GRAPH_BASIC2D,
+      .map = map.c_data(),
+      .cardinal = 2,
+      .diagonal = 3,
+      .clearance = nullptr,
+      .agent_size = 0,
+      .no_corner_cutting = false,
   };
 
   auto flow_data = std::vector<TCODPATH_IndexType>(distance.get_shape().at(0) * distance.get_shape().at(1) * 2);
@@ -48,3 +52,110 @@ TEST_CASE("TCODPATH_dijkstra", "") {
   auto path = get_path(flow_map, {1, 2});
   REQUIRE(path == EXPECTED_PATH);
 }
+
+TEST_CASE("TCODPATH_dijkstra_nearest", "") {
+  static constexpr auto MAX = std::numeric_limits<Map2D<>::value_type>::max();
+  auto costs = Map2D({12, 12}, 1);
+  for (int y = 0; y < 9; ++y) costs[{y, 6}] = 0;
+  auto graph = as_2d_graph(costs, 2, 3);
+  static const auto SOURCES = std::vector<TCODPATH_IndexType>{0, 0, 11, 0, 0, 11};
+
+  // Brute force: one full search per source
+  auto singles = std::vector<Map2D<>>{};
+  auto expected_distance = Map2D(costs.get_shape(), MAX);
+  for (int i = 0; i < 3; ++i) {
+    auto& single = singles.emplace_back(costs.get_shape(), MAX);
+    single[{SOURCES.at(i * 2), SOURCES.at(i * 2 + 1)}] = 0;
+    TCODPATH_dijkstra(&graph, single.c_data(), nullptr);
+    for (int y = 0; y < 12; ++y) {
+      for (int x = 0; x < 12; ++x) {
+        expected_distance[{y, x}] = std::min(expected_distance[{y, x}], single[{y, x}]);
+      }
+    }
+  }
+
+  auto distance = Map2D(costs.get_shape(), MAX);
+  auto label = Map2D(costs.get_shape(), -1);
+  REQUIRE(
+      TCODPATH_dijkstra_nearest(
+          &graph, distance.c_data(), nullptr, label.c_data(), 3, SOURCES.data(), 0, nullptr) == TCODPATH_E_OK);
+  for (int y = 0; y < 12; ++y) {
+    for (int x = 0; x < 12; ++x) {
+      CHECK(distance[{y, x}] == expected_distance[{y, x}]);
+      if (distance[{y, x}] == MAX) continue;
+      REQUIRE(0 <= label[{y, x}]);
+      REQUIRE(label[{y, x}] < 3);
+      CHECK(singles.at(label[{y, x}])[{y, x}] == distance[{y, x}]);  // Labeled source is a nearest source
+    }
+  }
+
+  // Stop early once the queries are settled
+  static const auto QUERIES = std::vector<TCODPATH_IndexType>{1, 1, 10, 2};
+  distance = Map2D(costs.get_shape(), MAX);
+  label = Map2D(costs.get_shape(), -1);
+  REQUIRE(
+      TCODPATH_dijkstra_nearest(
+          &graph, distance.c_data(), nullptr, label.c_data(), 3, SOURCES.data(), 2, QUERIES.data()) == TCODPATH_E_OK);
+  CHECK(distance[{1, 1}] == expected_distance[{1, 1}]);
+  CHECK(label[{1, 1}] == 0);
+  CHECK(distance[{10, 2}] == expected_distance[{10, 2}]);
+  CHECK(label[{10, 2}] == 1);
+  CHECK(distance[{0, 7}] == MAX);  // Far side of the wall was never reached
+}
+
+TEST_CASE("TCODPATH_dijkstra_bounded", "") {
+  static constexpr auto MAX = std::numeric_limits<Map2D<>::value_type>::max();
+  static constexpr TCODPATH_ValueType LIMIT = 20;
+  auto costs = Map2D({64, 64}, 1);
+  for (int y = 0; y < 40; ++y) costs[{y, 34}] = 0;
+  auto graph = as_2d_graph(costs, 2, 3);
+  static const auto SOURCES = std::vector<TCODPATH_IndexType>{30, 30, 34, 36};
+
+  auto expected = Map2D(costs.get_shape(), MAX);
+  for (size_t i = 0; i < SOURCES.size(); i += 2) expected[{SOURCES[i], SOURCES[i + 1]}] = 0;
+  TCODPATH_dijkstra(&graph, expected.c_data(), nullptr);
+
+  auto distance = Map2D(costs.get_shape(), MAX);
+  auto touched = TCODPATH_RingBuffer{};
+  REQUIRE(TCODPATH_dijkstra_bounded(&graph, distance.c_data(), nullptr, 2, SOURCES.data(), LIMIT, &touched) == 0);
+  int reached = 0;
+  for (int y = 0; y < 64; ++y) {
+    for (int x = 0; x < 64; ++x) {
+      const auto want = expected[{y, x}] <= LIMIT ? expected[{y, x}] : MAX;
+      REQUIRE(distance[{y, x}] == want);
+      reached += want != MAX;
+    }
+  }
+  // Each node is recorded once
+  CHECK(touched.used_bytes == static_cast<ptrdiff_t>(reached * 2 * sizeof(TCODPATH_IndexType)));
+
+  TCODPATH_map_reset_touched(distance.c_data(), &touched);
+  CHECK(touched.used_bytes == 0);
+  for (int y = 0; y < 64; ++y) {
+    for (int x = 0; x < 64; ++x) REQUIRE(distance[{y, x}] == MAX);
+  }
+  TCODPATH_ring_buffer_uninit(&touched);
+}
+
+TEST_CASE("TCODPATH_dijkstra_reverse", "") {
+  static constexpr auto MAX = std::numeric_limits<Map2D<>::value_type>::max();
+  auto rng = std::mt19937{3};
+  auto costs = Map2D({24, 24}, 1);
+  for (int y = 0; y < 24; ++y) {
+    for (int x = 0; x < 24; ++x) costs[{y, x}] = rng() % 4;  // Asymmetric, edge costs depend on the destination
+  }
+  const auto goal = std::array{12, 12};
+  costs[goal] = 1;
+  auto graph = as_2d_graph(costs, 2, 3);
+  auto to_goal = Map2D(costs.get_shape(), MAX);
+  to_goal[goal] = 0;
+  TCODPATH_dijkstra_reverse(&graph, to_goal.c_data(), nullptr);
+  for (int y = 0; y < 24; y += 3) {
+    for (int x = 0; x < 24; x += 5) {
+      auto from_here = Map2D(costs.get_shape(), MAX);
+      from_here[{y, x}] = 0;
+      TCODPATH_dijkstra(&graph, from_here.c_data(), nullptr);
+      REQUIRE(to_goal[{y, x}] == from_here[goal]);
+    }
+  }
+}
@@ -0,0 +1,105 @@
+#include <libtcod-path/distance_cache.hpp>
+
+#include <array>
+#include <atomic>
+#include <catch2/catch_all.hpp>
+#include <stdexcept>
+#include <thread>
+
+#include "common.h"
+
+using tcod::path::DistanceField;
+using tcod::path::DistanceFieldCache;
+using tcod::path::DistanceFieldKey;
+
+TEST_CASE("DistanceFieldCache", "") {
+  auto costs = Map2D({16, 16}, 1);
+  auto costs_journal = TCODPATH_MapJournal{};
+  TCODPATH_map_set_journal(costs.c_data(), &costs_journal);
+  auto graph = as_2d_graph(costs, 2, 3);
+  const auto field_bytes =
+      tcod::path::compute_distance_field(graph, DistanceFieldKey::from_graph(graph, {0, 0}))->size_bytes();
+  auto cache = DistanceFieldCache{field_bytes * 2};
+
+  const auto key_a = DistanceFieldKey::from_graph(graph, {0, 0});
+  const auto field_a = cache.get_or_compute(graph, key_a);
+  CHECK(TCODPATH_map_get(field_a->distance(), std::array<TCODPATH_IndexType, 2>{15, 15}.data()) == 15 * 3);
+  CHECK(cache.get_or_compute(graph, key_a) == field_a);
+  CHECK(cache.get_hits() == 1);
+  CHECK(cache.get_misses() == 1);
+
+  // Editing the cost map gives a new version, which is a different key
+  TCODPATH_map_set(costs.c_data(), std::array<TCODPATH_IndexType, 2>{15, 0}.data(), 1);
+  const auto key_a_v1 = DistanceFieldKey::from_graph(graph, {0, 0});
+  CHECK(key_a_v1.version == key_a.version + 1);
+  CHECK(cache.get_or_compute(graph, key_a_v1) != field_a);
+  CHECK(cache.size() == 2);
+
+  // Least recently used field is evicted
+  cache.get(key_a);
+  const auto key_b = DistanceFieldKey::from_graph(graph, {8, 8});
+  cache.get_or_compute(graph, key_b);
+  CHECK(cache.get(key_a_v1) == nullptr);
+  CHECK(cache.get(key_a) == field_a);
+  CHECK(cache.get_memory_used() <= cache.get_memory_budget());
+
+  // Fields larger than the budget are returned but not kept
+  const auto key_flow = DistanceFieldKey::from_graph(graph, {8, 8}, true);
+  const auto field_flow = cache.get_or_compute(graph, key_flow);
+  REQUIRE(field_flow->flow());
+  auto index = std::array<TCODPATH_IndexType, 2>{0, 0};
+  CHECK(TCODPATH_flow_iter_next(field_flow->flow(), index.data()) == 0);
+  CHECK(index == std::array<TCODPATH_IndexType, 2>{1, 1});
+  CHECK(cache.get(key_flow) == nullptr);
+}
+
+TEST_CASE("DistanceFieldKey follows the clearance version", "") {
+  auto costs = Map2D({16, 16}, 1);
+  auto clearance = Map2D({16, 16}, 2);
+  auto journal = TCODPATH_MapJournal{};
+  TCODPATH_map_set_journal(clearance.c_data(), &journal);
+  auto graph = as_2d_graph(costs, 2, 3);
+  graph.basic2d.clearance = clearance.c_data();
+  graph.basic2d.agent_size = 2;
+  const auto key = DistanceFieldKey::from_graph(graph, {0, 0});
+  CHECK(DistanceFieldKey::from_graph(graph, {0, 0}) == key);
+  // Updating the clearance in-place changes the key even though the cost version did not
+  TCODPATH_map_set(clearance.c_data(), std::array<TCODPATH_IndexType, 2>{4, 4}.data(), 1);
+  CHECK(!(DistanceFieldKey::from_graph(graph, {0, 0}) == key));
+}
+
+TEST_CASE("DistanceFieldCache rejects graphs which are not thread-safe", "") {
+  auto costs = TCODPATH_Map{};
+  REQUIRE(TCODPATH_map_init_chunked(&costs, 2, std::array<TCODPATH_IndexType, 2>{16, 16}.data(), nullptr, 1) == 0);
+  auto graph = TCODPATH_Graph{};
+  graph.basic2d.type = TCODPATH_GRAPH_BASIC2D;
+  graph.basic2d.map = &costs;
+  graph.basic2d.cardinal = 2;
+  graph.basic2d.diagonal = 3;
+  auto cache = DistanceFieldCache{1 << 20};
+  const auto key = DistanceFieldKey::from_graph(graph, {0, 0});
+  CHECK_THROWS_AS(cache.get_or_compute(graph, key), std::invalid_argument);
+  CHECK(cache.size() == 0);
+  TCODPATH_map_uninit(&costs);
+}
+
+TEST_CASE("DistanceFieldCache single-flight", "") {
+  auto costs = Map2D({16, 16}, 1);
+  auto graph = as_2d_graph(costs, 2, 3);
+  auto cache = DistanceFieldCache{1 << 20};
+  const auto key = DistanceFieldKey::from_graph(graph, {3, 4});
+  auto computed = std::atomic<int>{0};
+  auto compute = [&](const DistanceFieldKey& key) {
+    ++computed;
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    return tcod::path::compute_distance_field(graph, key);
+  };
+  auto results = std::array<DistanceFieldCache::FieldPtr, 8>{};
+  {
+    auto threads = std::vector<std::thread>{};
+    for (auto& result : results) threads.emplace_back([&] { result = cache.get_or_compute(key, compute); });
+    for (auto& thread : threads) thread.join();
+  }
+  CHECK(computed == 1);
+  for (const auto& result : results) CHECK(result == results.at(0));
+}
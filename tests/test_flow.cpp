@@ -0,0 +1,96 @@
+#include <libtcod-path/breadth_first_search.h>
+#include <libtcod-path/flow_tools.h>
+#include <libtcod-path/uniform_cost_search.h>
+
+#include <array>
+#include <catch2/catch_all.hpp>
+#include <limits>
+
+#include "common.h"
+
+TEST_CASE("TCODPATH_flow_from_distance", "") {
+  static const auto TEST_DATA = std::vector<std::string>{
+      ".........",
+      ".###.###.",
+      ".#.....#.",
+      ".#.###.#.",
+      "...#.....",
+  };
+  auto costs = wall_costs_from_test_data(TEST_DATA);
+  costs[{2, 4}] = 5;
+  auto graph = as_2d_graph(costs, 2, 3);
+  auto distance = Map2D(costs.get_shape(), std::numeric_limits<Map2D<>::value_type>::max());
+  distance[{0, 0}] = 0;
+  TCODPATH_dijkstra(&graph, distance.c_data(), nullptr);
+
+  auto flow_data = std::vector<TCODPATH_IndexType>(distance.get_shape().at(0) * distance.get_shape().at(1) * 2);
+  auto flow_shape = std::array<TCODPATH_IndexType, 3>{distance.get_shape().at(0), distance.get_shape().at(1), 2};
+  auto flow_map = TCODPATH_Map{};
+  TCODPATH_map_init_contigious_from(&flow_map, 3, flow_shape.data(), -4, static_cast<void*>(flow_data.data()));
+  TCODPATH_flow_from_distance(&graph, distance.c_data(), &flow_map);
+
+  for (TCODPATH_IndexType y = 0; y < distance.get_shape().at(0); ++y) {
+    for (TCODPATH_IndexType x = 0; x < distance.get_shape().at(1); ++x) {
+      if (distance[{y, x}] == std::numeric_limits<Map2D<>::value_type>::max()) continue;
+      // Walking the derived flow must account for the exact distance of each node
+      auto index = std::array<TCODPATH_IndexType, 2>{y, x};
+      auto cost = 0;
+      for (const auto& next : get_path(flow_map, index)) {
+        const bool diagonal = next.at(0) != index.at(0) && next.at(1) != index.at(1);
+        cost += (diagonal ? 3 : 2) * costs[index];
+        index = next;
+      }
+      CHECK(index == std::array<TCODPATH_IndexType, 2>{0, 0});
+      CHECK(cost == distance[{y, x}]);
+      // On-demand descent must agree with the derived flow map
+      auto on_demand = std::array<TCODPATH_IndexType, 2>{y, x};
+      auto from_flow = on_demand;
+      TCODPATH_distance_iter_next(&graph, distance.c_data(), on_demand.data());
+      TCODPATH_flow_iter_next(&flow_map, from_flow.data());
+      CHECK(on_demand == from_flow);
+    }
+  }
+}
+
+TEST_CASE("TCODPATH_flow_from_bfs_distance", "") {
+  static constexpr auto MAX = std::numeric_limits<Map2D<>::value_type>::max();
+  auto costs = wall_costs_from_test_data({
+      ".........",
+      ".###.###.",
+      ".#.....#.",
+      ".#.###.#.",
+      "...#.....",
+  });
+  costs[{2, 4}] = 5;  // Ignored by breadth-first distances
+  auto graph = as_2d_graph(costs, 2, 3);
+  const auto shape = costs.get_shape();
+  auto distance = Map2D(shape, MAX);
+  distance[{0, 0}] = 0;
+  auto flow_shape = std::array<TCODPATH_IndexType, 3>{shape.at(0), shape.at(1), 2};
+  auto bfs_flow_data = std::vector<TCODPATH_IndexType>(shape.at(0) * shape.at(1) * 2);
+  auto bfs_flow = TCODPATH_Map{};
+  TCODPATH_map_init_contigious_from(&bfs_flow, 3, flow_shape.data(), -4, static_cast<void*>(bfs_flow_data.data()));
+  TCODPATH_flow_reset(&bfs_flow);
+  TCODPATH_bfs(&graph, distance.c_data(), &bfs_flow);
+
+  auto flow_data = std::vector<TCODPATH_IndexType>(shape.at(0) * shape.at(1) * 2);
+  auto flow_map = TCODPATH_Map{};
+  TCODPATH_map_init_contigious_from(&flow_map, 3, flow_shape.data(), -4, static_cast<void*>(flow_data.data()));
+  TCODPATH_flow_from_bfs_distance(&graph, distance.c_data(), &flow_map);
+
+  for (TCODPATH_IndexType y = 0; y < shape.at(0); ++y) {
+    for (TCODPATH_IndexType x = 0; x < shape.at(1); ++x) {
+      // Ties may be broken differently, but both flows must step to a node one step closer to the source
+      auto derived = std::array<TCODPATH_IndexType, 2>{y, x};
+      auto written = derived;
+      const int derived_end = TCODPATH_flow_iter_next(&flow_map, derived.data());
+      CHECK(derived_end == TCODPATH_flow_iter_next(&bfs_flow, written.data()));
+      if (derived_end) continue;
+      CHECK(distance[derived] == distance[{y, x}] - 1);
+      CHECK(distance[derived] == distance[written]);
+      auto on_demand = std::array<TCODPATH_IndexType, 2>{y, x};
+      TCODPATH_flow_from_bfs_distance_at(&graph, distance.c_data(), on_demand.data(), on_demand.data());
+      CHECK(on_demand == derived);
+    }
+  }
+}
@@ -0,0 +1,95 @@
+#include <libtcod-path/flow_tools.h>
+#include <libtcod-path/fringe_search.h>
+#include <libtcod-path/uniform_cost_search.h>
+
+#include <array>
+#include <catch2/catch_all.hpp>
+#include <limits>
+#include <random>
+#include <type_traits>
+#include <vector>
+
+#include "common.h"
+
+static constexpr auto MAX = std::numeric_limits<Map2D<>::value_type>::max();
+
+TEST_CASE("TCODPATH_fringe_search matches TCODPATH_astar", "") {
+  auto rng = std::mt19937{7};
+  const auto start = std::array<TCODPATH_IndexType, 2>{0, 0};
+  const auto goal = std::array<TCODPATH_IndexType, 2>{39, 39};
+  auto heuristic = TCODPATH_Heuristic{};
+  heuristic.basic = TCODPATH_HeuristicBasic{TCODPATH_HEURISTIC_BASIC, {39, 39}, {1, 1}};  // Admissible
+
+  for (int round = 0; round < 20; ++round) {
+    INFO("round " << round);
+    auto costs = Map2D({40, 40}, 1);
+    for (int i = 0; i < 400; ++i) costs[{static_cast<int>(rng() % 40), static_cast<int>(rng() % 40)}] = rng() % 4;
+    costs[start] = costs[goal] = 1;
+    auto graph = as_2d_graph(costs, 2, 3);
+
+    auto expected = Map2D(costs.get_shape(), MAX);
+    const int reachable = TCODPATH_astar(&graph, &heuristic, expected.c_data(), nullptr, start.data(), goal.data(), 0);
+    REQUIRE(reachable >= 0);
+
+    auto distance = Map2D(costs.get_shape(), MAX);
+    auto flow_data = std::vector<TCODPATH_IndexType>(40 * 40 * 2);
+    auto flow_shape = std::array<TCODPATH_IndexType, 3>{40, 40, 2};
+    auto flow = TCODPATH_Map{};
+    TCODPATH_map_init_contigious_from(
+        &flow,
+        3,
+        flow_shape.data(),
+        static_cast<int>(sizeof(TCODPATH_IndexType)) * (std::is_signed_v<TCODPATH_IndexType> ? -1 : 1),
+        (void*)flow_data.data());
+    TCODPATH_flow_reset(&flow);
+    REQUIRE(
+        TCODPATH_fringe_search(
+            &graph, &heuristic, distance.c_data(), &flow, start.data(), goal.data(), nullptr) == reachable);
+    if (reachable == 1) continue;
+    REQUIRE(distance[goal] == expected[goal]);
+
+    // The flow leads back to the start, each step matching the recorded distances
+    auto previous = goal;
+    for (const auto& index : get_path(flow, goal)) {
+      const bool diagonal = index[0] != previous[0] && index[1] != previous[1];
+      REQUIRE(distance[previous] == distance[index] + (diagonal ? 3 : 2) * costs[previous]);
+      previous = index;
+    }
+    REQUIRE(previous == start);
+  }
+}
+
+TEST_CASE("TCODPATH_FringeSearch without a heuristic matches TCODPATH_dijkstra", "") {
+  auto rng = std::mt19937{13};
+  for (int round = 0; round < 10; ++round) {
+    const TCODPATH_IndexType height = 10 + rng() % 40;
+    const TCODPATH_IndexType width = 10 + rng() % 40;
+    auto costs = Map2D({height, width}, 1);
+    for (int i = 0; i < height * width / 3; ++i) {
+      costs[{static_cast<int>(rng() % height), static_cast<int>(rng() % width)}] = rng() % 4;
+    }
+    const auto source = std::array{static_cast<int>(rng() % height), static_cast<int>(rng() % width)};
+    auto graph = as_2d_graph(costs, 2, 3);
+    auto expected = Map2D(costs.get_shape(), MAX);
+    expected[source] = 0;
+    TCODPATH_dijkstra(&graph, expected.c_data(), nullptr);
+
+    auto distance = Map2D(costs.get_shape(), MAX);
+    distance[source] = 0;
+    auto stats = TCODPATH_SearchStats{};
+    auto fringe = TCODPATH_FringeSearch{};
+    REQUIRE(TCODPATH_fringe_init(&fringe, &graph, nullptr, distance.c_data(), nullptr) == 0);
+    fringe.stats = &stats;
+    REQUIRE(TCODPATH_fringe_push(&fringe, source.data()) == 0);
+    int steps = 0;
+    int err = 0;
+    while ((err = TCODPATH_fringe_step(&fringe)) == 0) ++steps;
+    REQUIRE(err == 1);
+    TCODPATH_fringe_uninit(&fringe);
+    REQUIRE(as_string(distance) == as_string(expected));
+    if (TCODPATH_STATS_ENABLED) {
+      CHECK(stats.expansions == steps);
+      CHECK(stats.bytes_allocated == (int64_t)sizeof(TCODPATH_FringeNode) * (height * width + 1));
+    }
+  }
+}
@@ -0,0 +1,125 @@
+#include <libtcod-path/graph_tools.h>
+#include <libtcod-path/uniform_cost_search.h>
+
+#include <array>
+#include <catch2/catch_all.hpp>
+#include <cstdlib>
+#include <limits>
+#include <vector>
+
+#include "common.h"
+
+namespace {
+/// A contiguous 3D map of int values.
+struct Map3D {
+  explicit Map3D(std::array<TCODPATH_IndexType, 3> shape, int fill) : shape{shape} {
+    data.resize(shape[0] * shape[1] * shape[2], fill);
+    TCODPATH_map_init_contigious_from(&map, 3, this->shape.data(), -static_cast<int>(sizeof(int)), data.data());
+  }
+  auto operator[](std::array<TCODPATH_IndexType, 3> ij) -> int& {
+    return data.at((ij[0] * shape[1] + ij[1]) * shape[2] + ij[2]);
+  }
+  std::array<TCODPATH_IndexType, 3> shape;
+  std::vector<int> data;
+  TCODPATH_Map map{};
+};
+}  // namespace
+
+TEST_CASE("TCODPATH_graph_stencil_fill", "") {
+  static const auto COSTS = std::array<TCODPATH_ValueType, 3>{1, 1, 1};
+  CHECK(TCODPATH_graph_stencil_fill(3, 1, COSTS.data(), nullptr) == 6);
+  CHECK(TCODPATH_graph_stencil_fill(3, 2, COSTS.data(), nullptr) == 18);
+  CHECK(TCODPATH_graph_stencil_fill(3, 3, COSTS.data(), nullptr) == 26);
+  CHECK(TCODPATH_graph_stencil_fill(2, 2, COSTS.data(), nullptr) == 8);
+  auto edges = std::vector<int>(4 * 3);
+  REQUIRE(TCODPATH_graph_stencil_fill(2, 1, COSTS.data(), edges.data()) == 4);
+  CHECK(edges == std::vector<int>{-1, 0, 1, 0, -1, 1, 0, 1, 1, 1, 0, 1});
+}
+
+TEST_CASE("TCODPATH_GRAPH_STATIC 3D", "") {
+  static constexpr auto MAX = std::numeric_limits<int>::max();
+  auto costs = Map3D({4, 8, 8}, 1);
+  for (int z = 0; z < 3; ++z) {
+    for (int y = 0; y < 7; ++y) costs[{z, y, 4}] = 0;  // Wall with a gap on the top floor and at the edge
+  }
+  static const auto AXIS_COSTS = std::array<TCODPATH_ValueType, 3>{2, 3, 4};
+  for (int max_axes = 1; max_axes <= 3; ++max_axes) {
+    auto edges = std::vector<int>(26 * 4);
+    const int edge_count = TCODPATH_graph_stencil_fill(3, max_axes, AXIS_COSTS.data(), edges.data());
+    auto graph = TCODPATH_Graph{};
+    graph.static_edges = TCODPATH_GraphStatic{
+        .type = TCODPATH_GRAPH_STATIC,
+        .map = &costs.map,
+        .dimensions = 3,
+        .edge_count = edge_count,
+        .edges = edges.data(),
+        .offsets = nullptr,
+        .radius = 0};
+
+    auto distance = Map3D(costs.shape, MAX);
+    distance[{0, 0, 0}] = 0;
+    TCODPATH_dijkstra(&graph, &distance.map, nullptr);
+
+    auto offsets = std::vector<ptrdiff_t>(edge_count);
+    REQUIRE(TCODPATH_graph_static_init_offsets(&graph, offsets.data()) == 0);
+    CHECK(graph.static_edges.radius == 1);
+    auto fast_distance = Map3D(costs.shape, MAX);
+    fast_distance[{0, 0, 0}] = 0;
+    TCODPATH_dijkstra(&graph, &fast_distance.map, nullptr);
+    CHECK(distance.data == fast_distance.data);  // Precomputed offsets give identical results
+
+    CHECK(distance[{0, 0, 3}] == 6);
+    CHECK(distance[{1, 0, 0}] == 2);
+    if (max_axes == 1) CHECK(distance[{1, 1, 1}] == 6);
+    if (max_axes == 3) CHECK(distance[{1, 1, 1}] == 4);
+    CHECK(distance[{0, 0, 4}] == MAX);  // Walls are never entered
+    CHECK(distance[{0, 0, 5}] != MAX);  // Reached around the wall
+
+    // Reverse edges lead back to every reached node along an edge of matching cost
+    for (TCODPATH_IndexType z = 0; z < 4; ++z) {
+      for (TCODPATH_IndexType y = 0; y < 8; ++y) {
+        for (TCODPATH_IndexType x = 0; x < 8; ++x) {
+          const auto index = std::array<TCODPATH_IndexType, 3>{z, y, x};
+          if (distance[index] == MAX || distance[index] == 0) continue;
+          struct Context {
+            Map3D* distance;
+            int best;
+          } context{&distance, MAX};
+          TCODPATH_graph_foreach_reverse_edge(
+              &graph,
+              3,
+              index.data(),
+              [](void* userdata, const TCODPATH_IndexType* root, const TCODPATH_IndexType*, TCODPATH_ValueType cost) {
+                auto& ctx = *static_cast<Context*>(userdata);
+                const int root_distance = (*ctx.distance)[{root[0], root[1], root[2]}];
+                if (root_distance != MAX) ctx.best = std::min(ctx.best, root_distance + cost);
+              },
+              &context);
+          REQUIRE(context.best == distance[index]);
+        }
+      }
+    }
+  }
+}
+
+TEST_CASE("TCODPATH_GRAPH_STATIC over the last axes", "") {
+  // A 2D stencil applied to a 3D map only moves within each layer
+  auto costs = Map3D({2, 4, 4}, 1);
+  static const auto AXIS_COSTS = std::array<TCODPATH_ValueType, 2>{1, 1};
+  auto edges = std::vector<int>(8 * 3);
+  const int edge_count = TCODPATH_graph_stencil_fill(2, 2, AXIS_COSTS.data(), edges.data());
+  auto graph = TCODPATH_Graph{};
+  graph.static_edges = TCODPATH_GraphStatic{
+      .type = TCODPATH_GRAPH_STATIC,
+      .map = &costs.map,
+      .dimensions = 2,
+      .edge_count = edge_count,
+      .edges = edges.data(),
+      .offsets = nullptr,
+      .radius = 0};
+  auto distance = Map3D(costs.shape, std::numeric_limits<int>::max());
+  distance[{0, 0, 0}] = 0;
+  TCODPATH_dijkstra(&graph, &distance.map, nullptr);
+  CHECK(distance[{0, 3, 3}] == 3);
+  CHECK(distance[{1, 0, 0}] == std::numeric_limits<int>::max());
+}
@@ -0,0 +1,121 @@
+#include <libtcod-path/breadth_first_search.h>
+#include <libtcod-path/flow_tools.h>
+#include <libtcod-path/linear_search.h>
+#include <libtcod-path/partition.h>
+#include <libtcod-path/uniform_cost_search.h>
+
+#include <array>
+#include <catch2/catch_all.hpp>
+#include <limits>
+#include <random>
+
+#include "common.h"
+
+static constexpr auto MAX = std::numeric_limits<Map2D<>::value_type>::max();
+
+TEST_CASE("TCODPATH_linear_graph ids", "") {
+  auto costs = Map2D({5, 7}, 1);
+  auto graph = as_2d_graph(costs, 2, 3);
+  auto linear = TCODPATH_LinearGraph{};
+  REQUIRE(TCODPATH_linear_graph_init(&linear, &graph) == 0);
+  CHECK(linear.node_count == 7 * 9);
+  CHECK(linear.edge_count == 8);
+  for (TCODPATH_IndexType y = 0; y < 5; ++y) {
+    for (TCODPATH_IndexType x = 0; x < 7; ++x) {
+      const auto index = std::array{y, x};
+      auto round_trip = std::array<TCODPATH_IndexType, 2>{};
+      TCODPATH_linear_graph_index(&linear, TCODPATH_linear_graph_id(&linear, index.data()), round_trip.data());
+      REQUIRE(round_trip == index);
+    }
+  }
+  TCODPATH_linear_graph_uninit(&linear);
+}
+
+TEST_CASE("TCODPATH_linear_search matches the generic searches", "") {
+  auto rng = std::mt19937{7};
+  for (int round = 0; round < 10; ++round) {
+    auto costs = Map2D({24, 31}, 1);
+    for (int i = 0; i < 250; ++i) costs[{static_cast<int>(rng() % 24), static_cast<int>(rng() % 31)}] = rng() % 4;
+    auto graph = as_2d_graph(costs, 2, 3);
+    auto linear = TCODPATH_LinearGraph{};
+    REQUIRE(TCODPATH_linear_graph_init(&linear, &graph) == 0);
+    const auto source = std::array<TCODPATH_IndexType, 2>{
+        static_cast<TCODPATH_IndexType>(rng() % 24), static_cast<TCODPATH_IndexType>(rng() % 31)};
+
+    auto expected = Map2D(costs.get_shape(), MAX);
+    expected[source] = 0;
+    TCODPATH_dijkstra(&graph, expected.c_data(), nullptr);
+    auto distance = Map2D(costs.get_shape(), MAX);
+    distance[source] = 0;
+    auto flow_data = std::vector<TCODPATH_IndexType>(24 * 31 * 2);
+    auto flow_shape = std::array<TCODPATH_IndexType, 3>{24, 31, 2};
+    auto flow_map = TCODPATH_Map{};
+    TCODPATH_map_init_contigious_from(
+        &flow_map, 3, flow_shape.data(), -static_cast<int>(sizeof(TCODPATH_IndexType)), flow_data.data());
+    TCODPATH_flow_reset(&flow_map);
+    REQUIRE(TCODPATH_linear_dijkstra(&linear, distance.c_data(), &flow_map) == 0);
+    REQUIRE(as_string(distance) == as_string(expected));
+    for (TCODPATH_IndexType y = 0; y < 24; ++y) {
+      for (TCODPATH_IndexType x = 0; x < 31; ++x) {
+        if (distance[{y, x}] == MAX) continue;
+        const auto path = get_path(flow_map, {y, x});
+        REQUIRE((path.empty() ? std::array{y, x} : path.back()) == source);  // Every flow leads back to the source
+      }
+    }
+
+    expected = Map2D(costs.get_shape(), MAX);
+    expected[source] = 0;
+    TCODPATH_bfs(&graph, expected.c_data(), nullptr);
+    distance = Map2D(costs.get_shape(), MAX);
+    distance[source] = 0;
+    REQUIRE(TCODPATH_linear_bfs(&linear, distance.c_data(), nullptr) == 0);
+    REQUIRE(as_string(distance) == as_string(expected));
+
+    auto expected_labels = Map2D(costs.get_shape(), 0);
+    auto labels = Map2D(costs.get_shape(), 0);
+    const int partitions = TCODPATH_partition_from_graph(&graph, expected_labels.c_data());
+    REQUIRE(TCODPATH_linear_partition(&linear, labels.c_data()) == partitions);
+    for (TCODPATH_IndexType y = 0; y < 24; ++y) {
+      for (TCODPATH_IndexType x = 0; x < 31; ++x) REQUIRE(labels[{y, x}] == expected_labels[{y, x}]);
+    }
+    TCODPATH_linear_graph_uninit(&linear);
+  }
+}
+
+TEST_CASE("TCODPATH_linear_graph from a 3D stencil", "") {
+  auto shape = std::array<TCODPATH_IndexType, 3>{3, 6, 5};
+  auto cost_data = std::vector<int>(3 * 6 * 5, 1);
+  cost_data.at(1 * 30 + 2 * 5 + 2) = 0;
+  auto costs = TCODPATH_Map{};
+  TCODPATH_map_init_contigious_from(&costs, 3, shape.data(), -4, cost_data.data());
+  static const auto AXIS_COSTS = std::array<TCODPATH_ValueType, 3>{2, 3, 4};
+  auto edges = std::vector<int>(26 * 4);
+  const int edge_count = TCODPATH_graph_stencil_fill(3, 3, AXIS_COSTS.data(), edges.data());
+  auto graph = TCODPATH_Graph{};
+  graph.static_edges = TCODPATH_GraphStatic{
+      .type = TCODPATH_GRAPH_STATIC,
+      .map = &costs,
+      .dimensions = 3,
+      .edge_count = edge_count,
+      .edges = edges.data(),
+      .offsets = nullptr,
+      .radius = 0};
+  auto linear = TCODPATH_LinearGraph{};
+  REQUIRE(TCODPATH_linear_graph_init(&linear, &graph) == 0);
+  CHECK(linear.node_count == 5 * 8 * 7);
+
+  auto expected_data = std::vector<int>(cost_data.size(), std::numeric_limits<int>::max());
+  auto distance_data = expected_data;
+  expected_data.at(0) = distance_data.at(0) = 0;
+  auto expected = TCODPATH_Map{};
+  auto distance = TCODPATH_Map{};
+  TCODPATH_map_init_contigious_from(&expected, 3, shape.data(), -4, expected_data.data());
+  TCODPATH_map_init_contigious_from(&distance, 3, shape.data(), -4, distance_data.data());
+  TCODPATH_dijkstra(&graph, &expected, nullptr);
+  REQUIRE(TCODPATH_linear_dijkstra(&linear, &distance, nullptr) == 0);
+  CHECK(distance_data == expected_data);
+  TCODPATH_linear_graph_uninit(&linear);
+
+  edges.at(0) = 2;  // Edges longer than one node per axis are not supported
+  CHECK(TCODPATH_linear_graph_init(&linear, &graph) < 0);
+}
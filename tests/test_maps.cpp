@@ -1,9 +1,12 @@
 
 #include <libtcod-path/map_tools.h>
 #include <libtcod-path/map_types.h>
+#include <libtcod-path/uniform_cost_search.h>
 
 #include <array>
 #include <catch2/catch_all.hpp>
+#include <limits>
+#include <vector>
 
 TEST_CASE("TCODPATH_MapContigious", "") {
   auto data = std::array<int, 16 * 24>{};
@@ -23,3 +26,235 @@ TEST_CASE("TCODPATH_MapContigious", "") {
   TCODPATH_map_set(&contigious, std::array{-1, -1}.data(), 1);
   REQUIRE(TCODPATH_map_get(&contigious, std::array{-1, -1}.data()) == 0);
 }
+
+namespace {
+/// Procedural terrain which counts how often it is called.
+struct Terrain {
+  static auto cost_at(const TCODPATH_IndexType* ij) -> TCODPATH_ValueType { return (ij[0] * 7 + ij[1] * 13) % 5 != 0; }
+  static auto get(void* userdata, const TCODPATH_IndexType* ij) -> TCODPATH_ValueType {
+    ++static_cast<Terrain*>(userdata)->calls;
+    return cost_at(ij);
+  }
+  static void set(void*, const TCODPATH_IndexType*, TCODPATH_ValueType) {}
+  static void get_block(void* userdata, const TCODPATH_IndexType* origin, const TCODPATH_IndexType* shape, int* out) {
+    ++static_cast<Terrain*>(userdata)->calls;
+    for (int y = 0; y < shape[0]; ++y) {
+      for (int x = 0; x < shape[1]; ++x) {
+        const auto ij = std::array{origin[0] + y, origin[1] + x};
+        *out++ = cost_at(ij.data());
+      }
+    }
+  }
+  int calls = 0;
+};
+}  // namespace
+
+TEST_CASE("TCODPATH_MapTileCache", "") {
+  auto terrain = Terrain{};
+  auto map = TCODPATH_Map{};
+  map.callback.type = TCODPATH_MAP_CALLBACK;
+  map.callback.dimensions = 2;
+  map.callback.shape[0] = 100;
+  map.callback.shape[1] = 70;
+  map.callback.userdata = &terrain;
+  map.callback.get = Terrain::get;
+  map.callback.set = Terrain::set;
+  map.callback.get_block = Terrain::get_block;
+
+  auto block = std::array<int, 3 * 4>{};
+  REQUIRE(TCODPATH_map_get_block(&map, std::array{10, 20}.data(), std::array{3, 4}.data(), block.data()) == 0);
+  CHECK(terrain.calls == 1);
+  CHECK(block.at(1 * 4 + 2) == Terrain::cost_at(std::array{11, 22}.data()));
+
+  CHECK(TCODPATH_map_is_thread_safe(&map));
+  auto cache = TCODPATH_MapTileCache{};
+  TCODPATH_map_set_tile_cache(&map, &cache);
+  CHECK(!TCODPATH_map_is_thread_safe(&map));  // Reads now fill the cache
+  terrain.calls = 0;
+  for (int y = 0; y < 100; ++y) {
+    for (int x = 0; x < 70; ++x) {
+      REQUIRE(TCODPATH_map_get(&map, std::array{y, x}.data()) == Terrain::cost_at(std::array{y, x}.data()));
+    }
+  }
+  CHECK(terrain.calls == 4 * 3);  // One call per tile, edge tiles are clipped to the map
+  CHECK(cache.fetches == 4 * 3);
+  CHECK(TCODPATH_map_get(&map, std::array{-1, 0}.data()) == Terrain::cost_at(std::array{-1, 0}.data()));
+
+  TCODPATH_map_set(&map, std::array{99, 69}.data(), 9);  // Writes update the cached tile
+  CHECK(TCODPATH_map_get(&map, std::array{99, 69}.data()) == 9);
+  TCODPATH_map_tile_cache_invalidate(&cache);
+  CHECK(TCODPATH_map_get(&map, std::array{99, 69}.data()) == Terrain::cost_at(std::array{99, 69}.data()));
+
+  // Searches over the cached map only fetch whole tiles
+  auto graph = TCODPATH_Graph{};
+  graph.basic2d.type = TCODPATH_GRAPH_BASIC2D;
+  graph.basic2d.map = &map;
+  graph.basic2d.cardinal = 2;
+  graph.basic2d.diagonal = 3;
+  CHECK(!TCODPATH_graph_is_thread_safe(&graph));
+  auto distance_data = std::vector<int>(100 * 70, std::numeric_limits<int>::max());
+  distance_data.at(0) = 0;
+  auto distance = TCODPATH_Map{};
+  TCODPATH_map_init_contigious_from(&distance, 2, std::array{100, 70}.data(), -4, distance_data.data());
+  terrain.calls = 0;
+  TCODPATH_dijkstra(&graph, &distance, nullptr);
+  CHECK(terrain.calls <= 4 * 3 * 4);
+}
+
+TEST_CASE("TCODPATH_MapChunked", "") {
+  static constexpr auto MAX = std::numeric_limits<TCODPATH_ValueType>::max();
+  SECTION("Bounded") {
+    auto map = TCODPATH_Map{};
+    REQUIRE(TCODPATH_map_init_chunked(&map, 2, std::array{100, 70}.data(), nullptr, 5) == 0);
+    REQUIRE(TCODPATH_map_get_shape(&map)[1] == 70);
+    CHECK(TCODPATH_map_get(&map, std::array{99, 69}.data()) == 5);
+    TCODPATH_map_set(&map, std::array{99, 69}.data(), 5);
+    CHECK(TCODPATH_map_get_chunk_count(&map) == 0);  // Writing the default value does not allocate
+    TCODPATH_map_set(&map, std::array{99, 69}.data(), 7);
+    CHECK(TCODPATH_map_get(&map, std::array{99, 69}.data()) == 7);
+    CHECK(TCODPATH_map_get(&map, std::array{99, 68}.data()) == 5);
+    CHECK(TCODPATH_map_get_chunk_count(&map) == 1);
+    TCODPATH_map_set(&map, std::array{100, 0}.data(), 7);
+    CHECK(TCODPATH_map_get(&map, std::array{100, 0}.data()) == 0);  // Out-of-bounds
+    CHECK(TCODPATH_map_get_chunk_count(&map) == 1);
+    TCODPATH_map_clear_max(&map);
+    CHECK(TCODPATH_map_get_chunk_count(&map) == 0);
+    CHECK(TCODPATH_map_is_max(&map, std::array{99, 69}.data()));
+    TCODPATH_map_uninit(&map);
+  }
+  SECTION("Unbounded") {
+    auto map = TCODPATH_Map{};
+    REQUIRE(TCODPATH_map_init_chunked(&map, 2, nullptr, std::array{16, 16}.data(), 0) == 0);
+    REQUIRE(TCODPATH_map_get_shape(&map) == nullptr);
+    auto index_at = [](int y, int x) { return std::array{y * 97, x * 89 - 1000000}; };
+    for (int y = -40; y < 40; ++y) {
+      for (int x = -40; x < 40; ++x) TCODPATH_map_set(&map, index_at(y, x).data(), y * 80 + x + 10000);
+    }
+    CHECK(TCODPATH_map_get_chunk_count(&map) == 80 * 80);
+    for (int y = -40; y < 40; ++y) {
+      for (int x = -40; x < 40; ++x) REQUIRE(TCODPATH_map_get(&map, index_at(y, x).data()) == y * 80 + x + 10000);
+    }
+    CHECK(TCODPATH_map_get(&map, std::array{-1, -1}.data()) == 0);
+    TCODPATH_map_uninit(&map);
+  }
+  SECTION("Dijkstra") {
+    auto costs = TCODPATH_Map{};
+    REQUIRE(TCODPATH_map_init_chunked(&costs, 2, std::array{64, 64}.data(), nullptr, 1) == 0);
+    for (int y = 0; y < 40; ++y) TCODPATH_map_set(&costs, std::array{y, 34}.data(), 0);
+    auto graph = TCODPATH_Graph{};
+    graph.basic2d.type = TCODPATH_GRAPH_BASIC2D;
+    graph.basic2d.map = &costs;
+    graph.basic2d.cardinal = 2;
+    graph.basic2d.diagonal = 3;
+    auto expected_data = std::vector<int>(64 * 64, MAX);
+    auto expected = TCODPATH_Map{};
+    TCODPATH_map_init_contigious_from(&expected, 2, std::array{64, 64}.data(), -4, expected_data.data());
+    auto distance = TCODPATH_Map{};
+    REQUIRE(TCODPATH_map_init_chunked(&distance, 2, std::array{64, 64}.data(), nullptr, MAX) == 0);
+    TCODPATH_map_set(&expected, std::array{30, 30}.data(), 0);
+    TCODPATH_map_set(&distance, std::array{30, 30}.data(), 0);
+    TCODPATH_dijkstra(&graph, &expected, nullptr);
+    TCODPATH_dijkstra(&graph, &distance, nullptr);
+    for (int y = 0; y < 64; ++y) {
+      for (int x = 0; x < 64; ++x) {
+        REQUIRE(TCODPATH_map_get(&distance, std::array{y, x}.data()) == expected_data[y * 64 + x]);
+      }
+    }
+    TCODPATH_map_uninit(&distance);
+    TCODPATH_map_uninit(&costs);
+  }
+  SECTION("Unbounded search") {
+    const auto start = std::array{-1000000, 2000000};
+    const auto goal = std::array{start[0] + 10, start[1] + 30};
+    auto costs = TCODPATH_Map{};
+    REQUIRE(TCODPATH_map_init_chunked(&costs, 2, nullptr, nullptr, 1) == 0);
+    auto graph = TCODPATH_Graph{};
+    graph.basic2d.type = TCODPATH_GRAPH_BASIC2D;
+    graph.basic2d.map = &costs;
+    graph.basic2d.cardinal = 2;
+    graph.basic2d.diagonal = 3;
+    auto distance = TCODPATH_Map{};
+    REQUIRE(TCODPATH_map_init_chunked(&distance, 2, nullptr, nullptr, MAX) == 0);
+    REQUIRE(TCODPATH_dijkstra_bounded(&graph, &distance, nullptr, 1, start.data(), 70, nullptr) == 0);
+    CHECK(TCODPATH_map_get(&distance, goal.data()) == 10 * 3 + 20 * 2);
+    CHECK(TCODPATH_map_is_max(&distance, std::array{start[0], start[1] - 36}.data()));
+    CHECK(TCODPATH_map_get_chunk_count(&distance) <= 6 * 6);  // Only the area within the limit is allocated
+
+    auto heuristic = TCODPATH_Heuristic{};
+    heuristic.basic = TCODPATH_HeuristicBasic{TCODPATH_HEURISTIC_BASIC, {goal[0], goal[1]}, {2, 2}};
+    TCODPATH_map_clear_max(&distance);
+    REQUIRE(TCODPATH_astar(&graph, &heuristic, &distance, nullptr, start.data(), goal.data(), nullptr) == 0);
+    CHECK(TCODPATH_map_get(&distance, goal.data()) == 10 * 3 + 20 * 2);
+    CHECK(TCODPATH_map_get_chunk_count(&distance) <= 3 * 4);
+    TCODPATH_map_uninit(&distance);
+    TCODPATH_map_uninit(&costs);
+  }
+}
+
+TEST_CASE("Bulk map operations", "") {
+  auto data = std::vector<int32_t>(6 * 8);
+  auto map = TCODPATH_Map{};
+  TCODPATH_map_init_contigious_from(&map, 2, std::array{6, 8}.data(), -4, data.data());
+  REQUIRE(TCODPATH_map_fill(&map, 3) == 0);
+  for (const auto& it : data) REQUIRE(it == 3);
+  REQUIRE(TCODPATH_map_fill_max(&map) == 0);
+  for (const auto& it : data) REQUIRE(it == INT32_MAX);
+
+  // A strided view of every other column
+  auto columns = TCODPATH_Map{};
+  columns.strides.type = TCODPATH_MAP_STRIDES;
+  columns.strides.dimensions = 2;
+  columns.strides.shape[0] = 6;
+  columns.strides.shape[1] = 4;
+  columns.strides.int_type = -4;
+  columns.strides.data = reinterpret_cast<unsigned char*>(data.data());
+  columns.strides.strides[0] = 8 * 4;
+  columns.strides.strides[1] = 2 * 4;
+  REQUIRE(TCODPATH_map_fill(&columns, 0) == 0);
+  for (int i = 0; i < 6 * 8; ++i) REQUIRE(data[i] == (i % 2 ? INT32_MAX : 0));
+
+  for (int i = 0; i < 6 * 8; ++i) data[i] = i - 10;
+  auto min_value = TCODPATH_ValueType{};
+  auto max_value = TCODPATH_ValueType{};
+  auto sum = int64_t{};
+  REQUIRE(TCODPATH_map_reduce(&map, &min_value, &max_value, &sum) == 0);
+  CHECK(min_value == -10);
+  CHECK(max_value == 37);
+  CHECK(sum == (6 * 8) * (6 * 8 - 1) / 2 - 10 * 6 * 8);
+  REQUIRE(TCODPATH_map_reduce(&columns, &min_value, &max_value, nullptr) == 0);
+  CHECK(min_value == -10);
+  CHECK(max_value == 36);
+
+  // Copy and convert a strided int32 view into a uint8 map
+  auto bytes = std::vector<uint8_t>(6 * 4);
+  auto byte_map = TCODPATH_Map{};
+  TCODPATH_map_init_contigious_from(&byte_map, 2, std::array{6, 4}.data(), 1, bytes.data());
+  REQUIRE(TCODPATH_map_copy(&columns, &byte_map) == 0);
+  for (int i = 0; i < 6 * 4; ++i) REQUIRE(bytes[i] == static_cast<uint8_t>(data[i * 2]));
+  CHECK(TCODPATH_map_copy(&map, &byte_map) == TCODPATH_E_INVALID_ARGUMENT);  // Shapes differ
+
+  REQUIRE(TCODPATH_map_threshold(&columns, &byte_map, 0, 20) == 0);
+  for (int i = 0; i < 6 * 4; ++i) REQUIRE(bytes[i] == (0 <= data[i * 2] && data[i * 2] <= 20));
+
+  // Callback maps use the generic path
+  auto terrain = Terrain{};
+  auto callback = TCODPATH_Map{};
+  callback.callback.type = TCODPATH_MAP_CALLBACK;
+  callback.callback.dimensions = 2;
+  callback.callback.shape[0] = 6;
+  callback.callback.shape[1] = 4;
+  callback.callback.userdata = &terrain;
+  callback.callback.get = Terrain::get;
+  callback.callback.set = Terrain::set;
+  REQUIRE(TCODPATH_map_copy(&callback, &byte_map) == 0);
+  REQUIRE(TCODPATH_map_reduce(&callback, nullptr, nullptr, &sum) == 0);
+  int64_t expected_sum = 0;
+  for (int y = 0; y < 6; ++y) {
+    for (int x = 0; x < 4; ++x) {
+      const auto ij = std::array{y, x};
+      REQUIRE(bytes[y * 4 + x] == Terrain::cost_at(ij.data()));
+      expected_sum += Terrain::cost_at(ij.data());
+    }
+  }
+  CHECK(sum == expected_sum);
+}
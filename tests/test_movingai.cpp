@@ -0,0 +1,119 @@
+#include <libtcod-path/graph_tools.h>
+#include <libtcod-path/linear_graph.h>
+#include <libtcod-path/uniform_cost_search.h>
+
+#include <array>
+#include <catch2/catch_all.hpp>
+#include <cmath>
+#include <libtcod-path/movingai.hpp>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "common.h"
+
+using tcod::path::MovingAIMap;
+using tcod::path::SyntheticMapType;
+
+TEST_CASE("Moving AI map and scenario files", "") {
+  auto map_file = std::istringstream{
+      "type octile\r\n"
+      "height 3\r\n"
+      "width 4\r\n"
+      "map\r\n"
+      ".G@T\r\n"
+      "S.W.\r\n"
+      "....\r\n"};
+  const auto map = tcod::path::load_movingai_map(map_file);
+  REQUIRE(map.width == 4);
+  REQUIRE(map.height == 3);
+  REQUIRE(map.tiles.at(1) == "S.W.");
+  REQUIRE(map.is_passable(1, 0));
+  REQUIRE(map.is_passable(0, 1));
+  REQUIRE(!map.is_passable(2, 1));
+  REQUIRE(!map.is_passable(4, 0));
+  const auto costs = map.to_costs();
+  REQUIRE(costs[{0, 2}] == 0);
+  REQUIRE(costs[{2, 3}] == 1);
+
+  auto saved = std::ostringstream{};
+  tcod::path::save_movingai_map(saved, map);
+  auto reloaded_file = std::istringstream{saved.str()};
+  REQUIRE(tcod::path::load_movingai_map(reloaded_file).tiles == map.tiles);
+
+  auto scen_file = std::istringstream{
+      "version 1\n"
+      "0\ttest.map\t4\t3\t0\t0\t3\t2\t4.41421356\n"
+      "\n"
+      "1\ttest.map\t4\t3\t3\t2\t0\t0\t4.41421356\n"};
+  const auto scenarios = tcod::path::load_movingai_scenarios(scen_file);
+  REQUIRE(scenarios.size() == 2);
+  REQUIRE(scenarios.at(1).bucket == 1);
+  REQUIRE(scenarios.at(1).map == "test.map");
+  REQUIRE(scenarios.at(1).start_x == 3);
+  REQUIRE(scenarios.at(1).goal_y == 0);
+  const auto reference = tcod::path::movingai_octile_distances(map, 0, 0);
+  REQUIRE(std::abs(reference.at(2 * map.width + 3) - scenarios.at(0).optimal_length) < 1e-6);  // Can not cut past W
+
+  auto malformed = std::istringstream{"version 1\n0 test.map 4 3 0 0\n"};
+  REQUIRE_THROWS(tcod::path::load_movingai_scenarios(malformed));
+  auto bad_header = std::istringstream{"type octile\nheight 2\nmap\n..\n..\n"};
+  REQUIRE_THROWS(tcod::path::load_movingai_map(bad_header));
+}
+
+TEST_CASE("Corner cutting rule", "") {
+  auto map = wall_costs_from_test_data({
+      ".#",
+      "..",
+  });
+  auto graph = as_2d_graph(map, 2, 3);
+  auto distance = Map2D<TCODPATH_IndexType>({2, 2}, std::numeric_limits<TCODPATH_IndexType>::max());
+  distance[{0, 0}] = 0;
+  TCODPATH_dijkstra(&graph, distance.c_data(), nullptr);
+  REQUIRE(distance[{1, 1}] == 3);  // Cuts the corner by default
+
+  graph.basic2d.no_corner_cutting = true;
+  TCODPATH_map_fill_max(distance.c_data());
+  distance[{0, 0}] = 0;
+  TCODPATH_dijkstra(&graph, distance.c_data(), nullptr);
+  REQUIRE(distance[{1, 1}] == 4);
+  TCODPATH_map_fill_max(distance.c_data());
+  distance[{0, 0}] = 0;
+  TCODPATH_dijkstra_reverse(&graph, distance.c_data(), nullptr);
+  REQUIRE(distance[{1, 1}] == 4);
+
+  TCODPATH_LinearGraph linear;
+  REQUIRE(TCODPATH_linear_graph_init(&linear, &graph) == TCODPATH_E_INVALID_ARGUMENT);
+}
+
+TEST_CASE("Synthetic Moving AI maps", "") {
+  for (const auto type : {SyntheticMapType::open, SyntheticMapType::rooms, SyntheticMapType::maze}) {
+    const auto options = tcod::path::SyntheticMapOptions{type, 64, 48, 4, 7};
+    const auto map = tcod::path::generate_synthetic_map(options);
+    REQUIRE(map.width == 64);
+    REQUIRE(map.height == 48);
+    REQUIRE(map.tiles.size() == 48);
+    REQUIRE(tcod::path::generate_synthetic_map(options).tiles == map.tiles);  // Deterministic
+
+    const auto scenarios = tcod::path::generate_movingai_scenarios(map, "synthetic.map", 40, 3);
+    REQUIRE(scenarios.size() == 40);
+    for (std::size_t i = 1; i < scenarios.size(); ++i) REQUIRE(scenarios[i - 1].bucket <= scenarios[i].bucket);
+
+    // The library agrees with the reference when using the Moving AI rules
+    auto costs = map.to_costs();
+    auto graph = as_2d_graph(costs, 10000, 14142);
+    graph.basic2d.no_corner_cutting = true;
+    auto distance = Map2D<>(std::array{map.height, map.width});
+    for (const auto& scenario : scenarios) {
+      REQUIRE(map.is_passable(scenario.start_x, scenario.start_y));
+      REQUIRE(scenario.bucket == static_cast<int>(scenario.optimal_length / 4));
+      TCODPATH_map_fill_max(distance.c_data());
+      const std::array<TCODPATH_IndexType, 2> start{scenario.start_y, scenario.start_x};
+      const std::array<TCODPATH_IndexType, 2> goal{scenario.goal_y, scenario.goal_x};
+      REQUIRE(TCODPATH_astar(&graph, nullptr, distance.c_data(), nullptr, start.data(), goal.data(), nullptr) == 0);
+      const double length = distance[{scenario.goal_y, scenario.goal_x}] / 10000.0;
+      REQUIRE(std::abs(length - scenario.optimal_length) <= scenario.optimal_length * 1e-4 + 1e-3);
+    }
+  }
+  REQUIRE_THROWS(tcod::path::generate_synthetic_map({SyntheticMapType::maze, 0, 10, 1, 0}));
+}
@@ -3,13 +3,17 @@
 #define TCODPATH_VALUE_MIN INT16_MIN
 #define TCODPATH_IndexType int16_t
 
+#include <libtcod-path/breadth_first_search.h>
+#include <libtcod-path/connectivity.h>
 #include <libtcod-path/graph_types.h>
 #include <libtcod-path/partition.h>
+#include <libtcod-path/uniform_cost_search.h>
 
 #include <array>
 #include <catch2/catch_all.hpp>
 #include <limits>
 #include <stdexcept>
+#include <vector>
 
 #include "common.h"
 
@@ -45,3 +49,59 @@ TEST_CASE("TCODPATH_partition large", "[.slow]") {
   auto partition = Map2D(costs.get_shape(), 0);
   TCODPATH_partition_from_graph(&graph, partition.c_data());
 }
+
+TEST_CASE("TCODPATH_partition rejects unreachable goals", "") {
+  static constexpr auto MAX = std::numeric_limits<Map2D<>::value_type>::max();
+  auto costs = Map2D<>({8, 8}, 1);
+  for (int y = 0; y < 8; ++y) costs[{y, 4}] = 0;
+  auto graph = as_2d_graph(costs, 1, 1);
+  auto partition = Map2D(costs.get_shape(), 0);
+  TCODPATH_partition_from_graph(&graph, partition.c_data());
+  auto distance = Map2D(costs.get_shape(), MAX);
+  const auto start = std::array<TCODPATH_IndexType, 2>{0, 0};
+  const auto goal = std::array<TCODPATH_IndexType, 2>{7, 7};
+  CHECK(
+      TCODPATH_astar(&graph, nullptr, distance.c_data(), nullptr, start.data(), goal.data(), partition.c_data()) == 1);
+  CHECK(TCODPATH_bfs_to(&graph, distance.c_data(), nullptr, start.data(), goal.data(), partition.c_data()) == 1);
+  CHECK(distance[{0, 0}] == MAX);  // Rejected without searching
+
+  const auto near_goal = std::array<TCODPATH_IndexType, 2>{7, 3};
+  CHECK(
+      TCODPATH_astar(&graph, nullptr, distance.c_data(), nullptr, start.data(), near_goal.data(), partition.c_data()) ==
+      0);
+  CHECK(distance[{7, 3}] == 7);
+}
+
+TEST_CASE("TCODPATH_connectivity", "") {
+  auto costs = Map2D<>({5, 5}, 1);
+  auto graph = as_2d_graph(costs, 1, 0);
+  auto labels = Map2D(costs.get_shape(), 0);
+  auto connectivity = TCODPATH_Connectivity{};
+  REQUIRE(TCODPATH_connectivity_init(&connectivity, &graph, labels.c_data()) == TCODPATH_E_OK);
+  const auto left = std::array<TCODPATH_IndexType, 2>{0, 0};
+  const auto right = std::array<TCODPATH_IndexType, 2>{4, 4};
+  CHECK(TCODPATH_connectivity_is_reachable(&connectivity, left.data(), right.data()));
+
+  // Close a wall through the middle, the last node splits the map in two
+  for (TCODPATH_IndexType y = 0; y < 5; ++y) {
+    costs[{y, 2}] = 0;
+    REQUIRE(TCODPATH_connectivity_update(&connectivity, std::array<TCODPATH_IndexType, 2>{y, 2}.data()) == 0);
+  }
+  CHECK_FALSE(TCODPATH_connectivity_is_reachable(&connectivity, left.data(), right.data()));
+  CHECK(TCODPATH_connectivity_label_at(&connectivity, std::array<TCODPATH_IndexType, 2>{2, 2}.data()) == 0);
+
+  // The view of the labels works as a partition map
+  auto partition = TCODPATH_Map{};
+  TCODPATH_connectivity_as_map(&connectivity, &partition);
+  auto distance = Map2D(costs.get_shape(), std::numeric_limits<Map2D<>::value_type>::max());
+  CHECK(TCODPATH_astar(&graph, nullptr, distance.c_data(), nullptr, left.data(), right.data(), &partition) == 1);
+
+  // Reopening a node merges the sides again
+  costs[{3, 2}] = 1;
+  REQUIRE(TCODPATH_connectivity_update(&connectivity, std::array<TCODPATH_IndexType, 2>{3, 2}.data()) == 0);
+  // Queries leave the union-find table untouched
+  const auto parents = std::vector(connectivity.parents, connectivity.parents + connectivity.label_count);
+  CHECK(TCODPATH_connectivity_is_reachable(&connectivity, left.data(), right.data()));
+  CHECK(std::vector(connectivity.parents, connectivity.parents + connectivity.label_count) == parents);
+  TCODPATH_connectivity_uninit(&connectivity);
+}
@@ -0,0 +1,95 @@
+#include <libtcod-path/queue.h>
+#include <libtcod-path/ring_buffer.h>
+
+#include <algorithm>
+#include <array>
+#include <catch2/catch_all.hpp>
+#include <deque>
+#include <random>
+#include <vector>
+
+using Index3 = std::array<int, 3>;
+
+TEST_CASE("TCODPATH_Queue", "") {
+  auto queue = TCODPATH_Queue{};
+  REQUIRE(TCODPATH_queue_init(&queue, sizeof(Index3)) == 0);
+  auto out = Index3{};
+  CHECK(TCODPATH_queue_pop(&queue, out.data()) < 0);
+  CHECK(TCODPATH_queue_peek(&queue, out.data()) < 0);
+  CHECK(TCODPATH_queue_pop_n(&queue, 4, out.data()) == 0);
+
+  SECTION("Reserve rounds up to a power of two and keeps the order") {
+    for (int i = 0; i < 50; ++i) {
+      const auto in = Index3{i, -i, 2 * i};
+      REQUIRE(TCODPATH_queue_push(&queue, in.data()) == 0);
+    }
+    for (int i = 0; i < 40; ++i) REQUIRE(TCODPATH_queue_pop(&queue, nullptr) == 0);
+    for (int i = 50; i < 80; ++i) {  // Wraps around the end of the buffer
+      const auto in = Index3{i, -i, 2 * i};
+      REQUIRE(TCODPATH_queue_push(&queue, in.data()) == 0);
+    }
+    REQUIRE(TCODPATH_queue_reserve(&queue, 1000) == 0);
+    CHECK(queue.capacity == 1024);
+    CHECK(queue.size == 40);
+    for (int i = 40; i < 80; ++i) {
+      REQUIRE(TCODPATH_queue_peek(&queue, out.data()) == 0);
+      CHECK(out == Index3{i, -i, 2 * i});
+      REQUIRE(TCODPATH_queue_pop(&queue, out.data()) == 0);
+      CHECK(out == Index3{i, -i, 2 * i});
+    }
+    CHECK(queue.size == 0);
+  }
+  SECTION("Bulk push and pop match a std::deque") {
+    auto expected = std::deque<Index3>{};
+    auto rng = std::mt19937{0};
+    int next = 0;
+    for (int round = 0; round < 2000; ++round) {
+      const int n = static_cast<int>(rng() % 20);
+      if (rng() % 2) {
+        auto batch = std::vector<Index3>{};
+        for (int i = 0; i < n; ++i, ++next) batch.push_back({next, next + 1, next + 2});
+        REQUIRE(TCODPATH_queue_push_n(&queue, n, batch.data()) == 0);
+        expected.insert(expected.end(), batch.begin(), batch.end());
+      } else {
+        auto batch = std::vector<Index3>(n);
+        const auto popped = TCODPATH_queue_pop_n(&queue, n, batch.data());
+        REQUIRE(popped == std::min<ptrdiff_t>(n, static_cast<ptrdiff_t>(expected.size())));
+        for (ptrdiff_t i = 0; i < popped; ++i) {
+          CHECK(batch[i] == expected.front());
+          expected.pop_front();
+        }
+      }
+      REQUIRE(queue.size == static_cast<ptrdiff_t>(expected.size()));
+      REQUIRE((queue.capacity & (queue.capacity - 1)) == 0);
+    }
+  }
+  TCODPATH_queue_uninit(&queue);
+  CHECK(queue.data == nullptr);
+  CHECK(queue.capacity == 0);
+}
+
+TEST_CASE("TCODPATH_RingBuffer wraps around", "") {
+  auto buffer = TCODPATH_RingBuffer{};
+  auto expected = std::deque<unsigned char>{};
+  auto rng = std::mt19937{1};
+  unsigned char next = 0;
+  for (int round = 0; round < 2000; ++round) {
+    auto bytes = std::vector<unsigned char>(rng() % 100);
+    if (rng() % 2) {
+      for (auto& byte : bytes) byte = next++;
+      REQUIRE(TCODPATH_ring_buffer_append(&buffer, static_cast<ptrdiff_t>(bytes.size()), bytes.data()) == 0);
+      expected.insert(expected.end(), bytes.begin(), bytes.end());
+    } else if (bytes.size() > expected.size()) {
+      CHECK(TCODPATH_ring_buffer_pop(&buffer, static_cast<ptrdiff_t>(bytes.size()), bytes.data()) < 0);
+    } else {
+      REQUIRE(TCODPATH_ring_buffer_pop(&buffer, static_cast<ptrdiff_t>(bytes.size()), bytes.data()) == 0);
+      for (const auto byte : bytes) {
+        CHECK(byte == expected.front());
+        expected.pop_front();
+      }
+    }
+    REQUIRE(buffer.used_bytes == static_cast<ptrdiff_t>(expected.size()));
+  }
+  TCODPATH_ring_buffer_uninit(&buffer);
+  CHECK(buffer.data == nullptr);
+}
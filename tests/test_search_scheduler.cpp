@@ -0,0 +1,93 @@
+#include <libtcod-path/search_scheduler.hpp>
+#include <libtcod-path/uniform_cost_search.h>
+
+#include <array>
+#include <catch2/catch_all.hpp>
+#include <limits>
+#include <memory>
+
+#include "common.h"
+
+using tcod::path::ResumableSearch;
+using tcod::path::SearchScheduler;
+using tcod::path::SearchStatus;
+
+static constexpr auto MAX = std::numeric_limits<Map2D<>::value_type>::max();
+
+TEST_CASE("ResumableSearch", "") {
+  auto costs = Map2D({32, 32}, 1);
+  for (int y = 0; y < 28; ++y) costs[{y, 16}] = 0;
+  auto graph = as_2d_graph(costs, 2, 3);
+
+  auto expected = Map2D(costs.get_shape(), MAX);
+  const auto start = std::vector<TCODPATH_IndexType>{0, 0};
+  const auto goal = std::vector<TCODPATH_IndexType>{0, 31};
+  REQUIRE(TCODPATH_astar(&graph, nullptr, expected.c_data(), nullptr, start.data(), goal.data(), nullptr) == 0);
+
+  auto distance = Map2D(costs.get_shape(), MAX);
+  auto search = ResumableSearch{graph, *distance.c_data(), nullptr, start, goal};
+  int slices = 0;
+  while (search.run_for(10) == SearchStatus::pending) ++slices;
+  CHECK(slices > 1);
+  CHECK(search.get_status() == SearchStatus::complete);
+  CHECK(search.get_path_cost() == expected[{0, 31}]);
+}
+
+TEST_CASE("ResumableSearch anytime", "") {
+  auto costs = Map2D({32, 32}, 1);
+  for (int y = 4; y < 32; ++y) costs[{y, 16}] = 0;
+  for (int x = 8; x < 28; ++x) costs[{12, x}] = 3;
+  auto graph = as_2d_graph(costs, 2, 3);
+  const auto start = std::vector<TCODPATH_IndexType>{31, 0};
+  const auto goal = std::vector<TCODPATH_IndexType>{31, 31};
+  auto heuristic = TCODPATH_Heuristic{};
+  heuristic.basic = TCODPATH_HeuristicBasic{TCODPATH_HEURISTIC_BASIC, {31, 31}, {2, 2}};
+
+  auto expected = Map2D(costs.get_shape(), MAX);
+  REQUIRE(TCODPATH_astar(&graph, nullptr, expected.c_data(), nullptr, start.data(), goal.data(), nullptr) == 0);
+
+  auto distance = Map2D(costs.get_shape(), MAX);
+  auto search = ResumableSearch{graph, *distance.c_data(), nullptr, start, goal, {&heuristic, 300, true}};
+  while (!search.has_path() && search.run_for(1) == SearchStatus::pending) {
+  }
+  REQUIRE(search.has_path());
+  CHECK(search.get_path_cost() >= expected[{31, 31}]);
+  search.run_for(1'000'000);
+  CHECK(search.get_status() == SearchStatus::complete);
+  CHECK(search.get_path_cost() == expected[{31, 31}]);  // Optimal once the search has finished
+}
+
+TEST_CASE("SearchScheduler", "") {
+  auto costs = Map2D({32, 32}, 1);
+  auto graph = as_2d_graph(costs, 2, 3);
+  auto distances = std::vector<Map2D<>>{};
+  for (int i = 0; i < 3; ++i) distances.emplace_back(costs.get_shape(), MAX);
+  auto make_search = [&](int i) {
+    return std::make_shared<ResumableSearch>(
+        graph,
+        *distances.at(i).c_data(),
+        nullptr,
+        std::vector<TCODPATH_IndexType>{0, 0},
+        std::vector<TCODPATH_IndexType>{31, static_cast<TCODPATH_IndexType>(31 - i)});
+  };
+  auto scheduler = SearchScheduler{};
+  auto low = make_search(0);
+  auto high = make_search(1);
+  auto cancelled = make_search(2);
+  scheduler.submit(low, 0);
+  scheduler.submit(high, 1);
+  scheduler.submit(cancelled, 0);
+
+  CHECK(scheduler.run_frame(50) == 50);
+  CHECK(high->get_expansions() == 50);  // Higher priority runs first
+  CHECK(low->get_expansions() == 0);
+  scheduler.cancel(cancelled);
+  CHECK(cancelled->get_status() == SearchStatus::cancelled);
+  CHECK(scheduler.get_pending_count() == 2);
+
+  while (scheduler.get_pending_count()) CHECK(scheduler.run_frame(100) <= 100);
+  CHECK(high->get_status() == SearchStatus::complete);
+  CHECK(low->get_status() == SearchStatus::complete);
+  CHECK(low->get_path_cost() == 31 * 3);
+  CHECK(cancelled->get_expansions() == 0);
+}
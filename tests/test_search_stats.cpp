@@ -0,0 +1,206 @@
+#include <libtcod-path/breadth_first_search.h>
+#include <libtcod-path/differential.h>
+#include <libtcod-path/focal_search.h>
+#include <libtcod-path/partition.h>
+#include <libtcod-path/search_stats.h>
+#include <libtcod-path/uniform_cost_search.h>
+
+#include <array>
+#include <catch2/catch_all.hpp>
+#include <limits>
+#include <string>
+#include <vector>
+
+#include "common.h"
+
+namespace {
+const auto TEST_DATA = std::vector<std::string>{
+    "........#.",
+    "........#.",
+    "..#####.#.",
+    "......#...",
+    "......#...",
+};
+constexpr int OPEN_NODES = 50 - 10;
+constexpr auto MAX = std::numeric_limits<Map2D<>::value_type>::max();
+
+/// Events recorded by `record_trace`.
+struct TraceLog {
+  std::vector<std::array<int, 3>> pushes;  // y, x, distance
+  std::vector<std::array<int, 3>> expansions;
+};
+void record_trace(
+    void* userdata, TCODPATH_TraceEvent event, int dimensions, const TCODPATH_IndexType* index, int distance) {
+  REQUIRE(dimensions == 2);
+  auto& log = *static_cast<TraceLog*>(userdata);
+  (event == TCODPATH_TRACE_PUSH ? log.pushes : log.expansions).push_back({index[0], index[1], distance});
+}
+}  // namespace
+
+TEST_CASE("TCODPATH_SearchStats UCS", "") {
+  auto costs = wall_costs_from_test_data(TEST_DATA);
+  auto graph = as_2d_graph(costs, 2, 3);
+  auto distance = Map2D(costs.get_shape(), MAX);
+  auto stats = TCODPATH_SearchStats{};
+  auto ucs = TCODPATH_UniformCostSearch{};
+  REQUIRE(TCODPATH_ucs_init(&ucs, &graph, nullptr, distance.c_data(), nullptr) == 0);
+  ucs.stats = &stats;
+  const auto start = std::array{0, 0};
+  distance[{0, 0}] = 0;
+  REQUIRE(TCODPATH_ucs_push(&ucs, start.data()) == 0);
+  int steps = 0;
+  REQUIRE(TCODPATH_ucs_run(&ucs, 1000, &steps) == 1);
+  TCODPATH_ucs_uninit(&ucs);
+
+  CHECK(stats.expansions == OPEN_NODES);
+  CHECK(stats.pushes == stats.expansions + stats.stale_pops);  // Every entry was either expanded or discarded
+  CHECK(steps == stats.pushes);
+  CHECK(stats.peak_frontier > 0);
+  CHECK(stats.peak_frontier <= stats.pushes);
+  CHECK(stats.heuristic_calls == 0);
+  CHECK(stats.bytes_allocated >= stats.peak_frontier * static_cast<int64_t>(ucs.frontier.node_size));
+  CHECK(stats.phase_ns[TCODPATH_STATS_PHASE_SEARCH] > 0);
+  CHECK(stats.phase_ns[TCODPATH_STATS_PHASE_PARTITION] == 0);
+}
+
+TEST_CASE("TCODPATH_SearchStats A* heuristic calls", "") {
+  auto costs = wall_costs_from_test_data(TEST_DATA);
+  auto graph = as_2d_graph(costs, 2, 3);
+  auto heuristic = TCODPATH_Heuristic{};
+  heuristic.basic = TCODPATH_HeuristicBasic{TCODPATH_HEURISTIC_BASIC, {4, 9}, {2, 2}};
+  auto distance = Map2D(costs.get_shape(), MAX);
+  auto stats = TCODPATH_SearchStats{};
+  auto ucs = TCODPATH_UniformCostSearch{};
+  REQUIRE(TCODPATH_ucs_init(&ucs, &graph, &heuristic, distance.c_data(), nullptr) == 0);
+  ucs.stats = &stats;
+  const auto start = std::array{0, 0};
+  const auto goal = std::array{4, 9};
+  TCODPATH_ucs_set_goal(&ucs, goal.data());
+  distance[{0, 0}] = 0;
+  REQUIRE(TCODPATH_ucs_push(&ucs, start.data()) == 0);
+  REQUIRE(TCODPATH_ucs_run(&ucs, 1000, nullptr) == 1);
+  TCODPATH_ucs_uninit(&ucs);
+  CHECK(distance[{4, 9}] != MAX);
+
+  CHECK(stats.expansions > 0);
+  CHECK(stats.expansions < OPEN_NODES);  // The goal is reached before the whole map is searched
+  CHECK(stats.heuristic_calls == stats.pushes + stats.stale_pops + stats.expansions);  // One per push and per pop
+}
+
+TEST_CASE("TCODPATH_SearchStats focal search", "") {
+  auto costs = wall_costs_from_test_data(TEST_DATA);
+  auto graph = as_2d_graph(costs, 2, 3);
+  auto heuristic = TCODPATH_Heuristic{};
+  heuristic.basic = TCODPATH_HeuristicBasic{TCODPATH_HEURISTIC_BASIC, {4, 9}, {2, 2}};
+  auto distance = Map2D(costs.get_shape(), MAX);
+  auto closed = Map2D(costs.get_shape(), 0);
+  auto stats = TCODPATH_SearchStats{};
+  auto focal = TCODPATH_FocalSearch{};
+  REQUIRE(
+      TCODPATH_focal_init(&focal, &graph, &heuristic, nullptr, 150, distance.c_data(), nullptr, closed.c_data()) ==
+      0);
+  focal.stats = &stats;
+  const auto start = std::array{0, 0};
+  distance[{0, 0}] = 0;
+  REQUIRE(TCODPATH_focal_push(&focal, start.data()) == 0);
+  int steps = 0;
+  int err = 0;
+  while ((err = TCODPATH_focal_step(&focal)) == 0) ++steps;
+  REQUIRE(err == 1);
+  TCODPATH_focal_uninit(&focal);
+
+  CHECK(stats.expansions >= OPEN_NODES);  // Every open node is closed at least once
+  CHECK(stats.expansions <= steps);  // Some steps only discard stale entries
+  CHECK(stats.pushes >= stats.expansions);
+  CHECK(stats.stale_pops <= stats.pushes);
+  CHECK(stats.peak_frontier > 0);
+  CHECK(stats.heuristic_calls >= stats.pushes);
+  CHECK(stats.bytes_allocated > 0);
+}
+
+TEST_CASE("TCODPATH_SearchStats BFS", "") {
+  auto costs = wall_costs_from_test_data(TEST_DATA);
+  auto graph = as_2d_graph(costs, 1, 1);
+  auto distance = Map2D(costs.get_shape(), MAX);
+  auto stats = TCODPATH_SearchStats{};
+  auto bfs = TCODPATH_BreadthFirstSearch{};
+  REQUIRE(TCODPATH_bfs_init(&bfs, &graph, distance.c_data(), nullptr) == 0);
+  bfs.stats = &stats;
+  const auto start = std::array{0, 0};
+  distance[{0, 0}] = 0;
+  REQUIRE(TCODPATH_bfs_push(&bfs, start.data()) == 0);
+  while (TCODPATH_bfs_step(&bfs) == 0) {
+  }
+  TCODPATH_bfs_uninit(&bfs);
+
+  CHECK(stats.expansions == OPEN_NODES);
+  CHECK(stats.pushes == OPEN_NODES);
+  CHECK(stats.stale_pops == 0);
+  CHECK(stats.peak_frontier > 0);
+  CHECK(stats.peak_frontier < OPEN_NODES);
+}
+
+TEST_CASE("TCODPATH_SearchStats partition and differentials", "") {
+  auto costs = wall_costs_from_test_data(TEST_DATA);
+  auto graph = as_2d_graph(costs, 2, 3);
+  auto partition = Map2D(costs.get_shape(), 0);
+  auto stats = TCODPATH_SearchStats{};
+  REQUIRE(TCODPATH_partition_from_graph_with_stats(&graph, partition.c_data(), &stats) == 1);
+  CHECK(stats.expansions == OPEN_NODES);
+  CHECK(stats.pushes == OPEN_NODES);
+  CHECK(stats.phase_ns[TCODPATH_STATS_PHASE_PARTITION] > 0);
+  CHECK(stats.phase_ns[TCODPATH_STATS_PHASE_DIFFERENTIAL] == 0);
+
+  TCODPATH_stats_clear(&stats);
+  CHECK(stats.expansions == 0);
+  auto differentials_data = std::vector<int>(5 * 10 * 2);
+  auto differentials_shape = std::vector<int>{5, 10, 2};
+  auto differentials = TCODPATH_Map{};
+  TCODPATH_map_init_contigious_from(&differentials, 3, differentials_shape.data(), -4, differentials_data.data());
+  TCODPATH_differential_generate_all_auto_with_stats(&graph, 1, partition.c_data(), &differentials, &stats);
+  CHECK(stats.expansions == OPEN_NODES * 2);  // One full Dijkstra search per differential
+  CHECK(stats.bytes_allocated > 0);
+  CHECK(stats.phase_ns[TCODPATH_STATS_PHASE_SEARCH] > 0);
+  CHECK(stats.phase_ns[TCODPATH_STATS_PHASE_DIFFERENTIAL] >= stats.phase_ns[TCODPATH_STATS_PHASE_SEARCH]);
+}
+
+TEST_CASE("TCODPATH_SearchTrace", "") {
+  auto costs = wall_costs_from_test_data(TEST_DATA);
+  auto graph = as_2d_graph(costs, 2, 3);
+  auto log = TraceLog{};
+  const auto trace = TCODPATH_SearchTrace{record_trace, &log};
+  const auto start = std::array{0, 0};
+  SECTION("UCS") {
+    auto distance = Map2D(costs.get_shape(), MAX);
+    auto stats = TCODPATH_SearchStats{};
+    auto ucs = TCODPATH_UniformCostSearch{};
+    REQUIRE(TCODPATH_ucs_init(&ucs, &graph, nullptr, distance.c_data(), nullptr) == 0);
+    ucs.stats = &stats;
+    ucs.trace = &trace;
+    distance[{0, 0}] = 0;
+    REQUIRE(TCODPATH_ucs_push(&ucs, start.data()) == 0);
+    REQUIRE(TCODPATH_ucs_run(&ucs, 1000, nullptr) == 1);
+    TCODPATH_ucs_uninit(&ucs);
+    CHECK(static_cast<int64_t>(log.pushes.size()) == stats.pushes);
+    REQUIRE(static_cast<int64_t>(log.expansions.size()) == stats.expansions);
+    CHECK(log.expansions.front() == std::array{0, 0, 0});
+    for (size_t i = 1; i < log.expansions.size(); ++i) {
+      CHECK(log.expansions[i - 1][2] <= log.expansions[i][2]);  // Dijkstra expands in distance order
+      CHECK(distance[{log.expansions[i][0], log.expansions[i][1]}] == log.expansions[i][2]);
+    }
+  }
+  SECTION("BFS") {
+    auto distance = Map2D(costs.get_shape(), MAX);
+    auto bfs = TCODPATH_BreadthFirstSearch{};
+    REQUIRE(TCODPATH_bfs_init(&bfs, &graph, distance.c_data(), nullptr) == 0);
+    bfs.trace = &trace;
+    distance[{0, 0}] = 0;
+    REQUIRE(TCODPATH_bfs_push(&bfs, start.data()) == 0);
+    while (TCODPATH_bfs_step(&bfs) == 0) {
+    }
+    TCODPATH_bfs_uninit(&bfs);
+    CHECK(log.pushes.size() == OPEN_NODES);
+    REQUIRE(log.expansions.size() == OPEN_NODES);
+    for (size_t i = 1; i < log.expansions.size(); ++i) CHECK(log.expansions[i - 1][2] <= log.expansions[i][2]);
+  }
+}
@@ -0,0 +1,124 @@
+#include <libtcod-path/focal_search.h>
+#include <libtcod-path/uniform_cost_search.h>
+
+#include <array>
+#include <catch2/catch_all.hpp>
+#include <limits>
+#include <random>
+
+#include "common.h"
+
+static constexpr auto MAX = std::numeric_limits<Map2D<>::value_type>::max();
+
+static auto count_reached(const Map2D<>& distance) -> int {
+  int reached = 0;
+  for (int y = 0; y < distance.get_shape().at(0); ++y) {
+    for (int x = 0; x < distance.get_shape().at(1); ++x) reached += distance[{y, x}] != MAX;
+  }
+  return reached;
+}
+
+TEST_CASE("Bounded-suboptimal searches", "") {
+  auto rng = std::mt19937{42};
+  const auto start = std::array<TCODPATH_IndexType, 2>{0, 0};
+  const auto goal = std::array<TCODPATH_IndexType, 2>{39, 39};
+  auto heuristic = TCODPATH_Heuristic{};
+  heuristic.basic = TCODPATH_HeuristicBasic{TCODPATH_HEURISTIC_BASIC, {39, 39}, {1, 1}};  // Admissible
+
+  for (int round = 0; round < 20; ++round) {
+    auto costs = Map2D({40, 40}, 1);
+    for (int i = 0; i < 400; ++i) costs[{static_cast<int>(rng() % 40), static_cast<int>(rng() % 40)}] = rng() % 4;
+    costs[start] = costs[goal] = 1;
+    auto graph = as_2d_graph(costs, 2, 3);
+
+    auto optimal = Map2D(costs.get_shape(), MAX);
+    const int reachable = TCODPATH_astar(&graph, &heuristic, optimal.c_data(), nullptr, start.data(), goal.data(), 0);
+    REQUIRE(reachable >= 0);
+    if (reachable == 1) continue;
+    const int best = optimal[goal];
+
+    for (int suboptimality : {100, 110, 150, 300}) {
+      INFO("round " << round << ", suboptimality " << suboptimality);
+      for (bool reopen : {true, false}) {
+        auto distance = Map2D(costs.get_shape(), MAX);
+        auto closed = Map2D(costs.get_shape(), 0);
+        int bound = 0;
+        REQUIRE(
+            TCODPATH_weighted_astar(
+                &graph,
+                &heuristic,
+                suboptimality,
+                distance.c_data(),
+                nullptr,
+                reopen ? nullptr : closed.c_data(),
+                start.data(),
+                goal.data(),
+                &bound) == 0);
+        CHECK(distance[goal] * 100 <= best * suboptimality);
+        CHECK(bound <= suboptimality);
+        CHECK(distance[goal] * 100 <= best * bound);  // The reported bound is never better than the truth
+      }
+      auto distance = Map2D(costs.get_shape(), MAX);
+      auto closed = Map2D(costs.get_shape(), 0);
+      int bound = 0;
+      REQUIRE(
+          TCODPATH_focal_search(
+              &graph,
+              &heuristic,
+              nullptr,
+              suboptimality,
+              distance.c_data(),
+              nullptr,
+              closed.c_data(),
+              start.data(),
+              goal.data(),
+              nullptr,
+              &bound) == 0);
+      CHECK(distance[goal] * 100 <= best * suboptimality);
+      CHECK(bound <= suboptimality);
+      CHECK(distance[goal] * 100 <= best * bound);
+    }
+  }
+}
+
+TEST_CASE("Bounded-suboptimal searches expand fewer nodes", "") {
+  auto costs = Map2D({64, 64}, 1);
+  for (int y = 8; y < 64; ++y) costs[{y, 40}] = 0;
+  auto graph = as_2d_graph(costs, 2, 3);
+  const auto start = std::array<TCODPATH_IndexType, 2>{63, 0};
+  const auto goal = std::array<TCODPATH_IndexType, 2>{63, 63};
+  auto heuristic = TCODPATH_Heuristic{};
+  heuristic.basic = TCODPATH_HeuristicBasic{TCODPATH_HEURISTIC_BASIC, {63, 63}, {1, 1}};
+
+  auto optimal = Map2D(costs.get_shape(), MAX);
+  REQUIRE(TCODPATH_astar(&graph, &heuristic, optimal.c_data(), nullptr, start.data(), goal.data(), nullptr) == 0);
+
+  auto weighted = Map2D(costs.get_shape(), MAX);
+  auto closed = Map2D(costs.get_shape(), 0);
+  int bound = 0;
+  REQUIRE(
+      TCODPATH_weighted_astar(
+          &graph, &heuristic, 300, weighted.c_data(), nullptr, closed.c_data(), start.data(), goal.data(), &bound) ==
+      0);
+  CHECK(count_reached(weighted) < count_reached(optimal));
+  CHECK(weighted[goal] * 100 <= optimal[goal] * bound);
+
+  auto focal = Map2D(costs.get_shape(), MAX);
+  closed = Map2D(costs.get_shape(), 0);
+  REQUIRE(
+      TCODPATH_focal_search(
+          &graph,
+          &heuristic,
+          nullptr,
+          150,
+          focal.c_data(),
+          nullptr,
+          closed.c_data(),
+          start.data(),
+          goal.data(),
+          nullptr,
+          &bound) == 0);
+  CHECK(count_reached(focal) < count_reached(optimal));
+  CHECK(focal[goal] * 100 <= optimal[goal] * bound);
+  CHECK(bound <= 150);
+}
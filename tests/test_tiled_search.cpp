@@ -0,0 +1,168 @@
+#include <libtcod-path/tiled_search.h>
+#include <libtcod-path/uniform_cost_search.h>
+
+#include <array>
+#include <catch2/catch_all.hpp>
+#include <cstdint>
+#include <filesystem>
+#include <limits>
+#include <random>
+#include <string>
+
+#include "common.h"
+
+namespace {
+constexpr auto MAX = std::numeric_limits<Map2D<>::value_type>::max();
+
+/// Return a map of random costs from 0 to 3, where 0 is a wall.
+auto random_costs(std::mt19937& rng, TCODPATH_IndexType height, TCODPATH_IndexType width) -> Map2D<> {
+  auto costs = Map2D({height, width}, 1);
+  for (int i = 0; i < height * width / 3; ++i) {
+    costs[{static_cast<int>(rng() % height), static_cast<int>(rng() % width)}] = rng() % 4;
+  }
+  return costs;
+}
+
+/// Check that every reached node of `distance` leads back to a source through `direction` at the right cost.
+void check_directions(const Map2D<>& costs, const Map2D<>& distance, const TCODPATH_TiledMap& direction) {
+  const auto width = costs.get_shape().at(1);
+  for (TCODPATH_IndexType y = 0; y < costs.get_shape().at(0); ++y) {
+    for (TCODPATH_IndexType x = 0; x < width; ++x) {
+      if (distance[{y, x}] == MAX) continue;
+      const auto parent = TCODPATH_tiled_search_parent(&direction, TCODPATH_tiled_map_id(&direction, y, x));
+      if (parent < 0) {
+        REQUIRE(distance[{y, x}] == 0);  // Only the source has no parent
+        continue;
+      }
+      const auto parent_index = std::array{static_cast<int>(parent / width), static_cast<int>(parent % width)};
+      const bool diagonal = parent_index[0] != y && parent_index[1] != x;
+      REQUIRE(distance[{y, x}] == distance[parent_index] + (diagonal ? 3 : 2) * costs[{y, x}]);
+    }
+  }
+}
+}  // namespace
+
+TEST_CASE("TCODPATH_TiledMap layout", "") {
+  auto map = TCODPATH_TiledMap{};
+  REQUIRE(TCODPATH_tiled_map_init(&map, 37, 70, 16, sizeof(TCODPATH_ValueType), nullptr) == 0);
+  CHECK(map.tiles_shape[0] == 3);
+  CHECK(map.tiles_shape[1] == 5);
+  CHECK(TCODPATH_tiled_map_tile_count(&map) == 15);
+  CHECK(TCODPATH_tiled_map_tile_of(&map, 36, 69) == 14);
+  CHECK(TCODPATH_tiled_map_id(&map, 36, 69) == 37 * 70 - 1);
+  TCODPATH_tiled_map_set(&map, 17, 33, 5);
+  CHECK(TCODPATH_tiled_map_get(&map, 17, 33) == 5);
+  // Tile 7 is {1, 2}, the node is {1, 1} within it
+  const auto* tile = TCODPATH_tiled_map_tile_data(&map, 7);
+  CHECK(TCODPATH_tiled_map_at(&map, 17, 33) == tile + 17 * sizeof(TCODPATH_ValueType));
+  TCODPATH_tiled_map_uninit(&map);
+
+  CHECK(TCODPATH_tiled_map_init(&map, 10, 10, 12, 4, nullptr) == TCODPATH_E_INVALID_ARGUMENT);  // Not a power of two
+  // Node indexes within a tile must fit in 32 bits
+  CHECK(TCODPATH_tiled_map_size_bytes(10, 10, TCODPATH_TILED_MAX_TILE_SIZE, 1) != 0);
+  CHECK(TCODPATH_tiled_map_size_bytes(10, 10, TCODPATH_TILED_MAX_TILE_SIZE * 2, 1) == 0);
+  // Maps with more than 2^31 nodes
+  CHECK(TCODPATH_tiled_map_size_bytes(int64_t{1} << 17, int64_t{1} << 17, 0, 1) == size_t{1} << 34);
+  CHECK(TCODPATH_tiled_map_size_bytes(int64_t{1} << 62, int64_t{1} << 62, 0, 1) == 0);
+}
+
+TEST_CASE("TCODPATH_tiled_dijkstra matches TCODPATH_dijkstra", "") {
+  auto rng = std::mt19937{11};
+  for (int round = 0; round < 6; ++round) {
+    const TCODPATH_IndexType height = 20 + rng() % 60;
+    const TCODPATH_IndexType width = 20 + rng() % 60;
+    auto costs = random_costs(rng, height, width);
+    const auto source = std::array{static_cast<int>(rng() % height), static_cast<int>(rng() % width)};
+    auto graph = as_2d_graph(costs, 2, 3);
+    auto expected = Map2D(costs.get_shape(), MAX);
+    expected[source] = 0;
+    TCODPATH_dijkstra(&graph, expected.c_data(), nullptr);
+
+    auto tiled_costs = TCODPATH_TiledMap{};
+    auto tiled_distance = TCODPATH_TiledMap{};
+    auto direction = TCODPATH_TiledMap{};
+    const int tile_size = 1 << (2 + round % 3);
+    const auto value_size = static_cast<ptrdiff_t>(sizeof(TCODPATH_ValueType));
+    REQUIRE(TCODPATH_tiled_map_init(&tiled_costs, height, width, tile_size, value_size, nullptr) == 0);
+    REQUIRE(TCODPATH_tiled_map_init(&tiled_distance, height, width, tile_size, value_size, nullptr) == 0);
+    REQUIRE(TCODPATH_tiled_map_init(&direction, height, width, tile_size, 1, nullptr) == 0);
+    REQUIRE(TCODPATH_tiled_map_copy_from(&tiled_costs, costs.c_data()) == 0);
+
+    // Without slack every node is expanded once, slack processes tiles further but finds the same distances
+    for (const TCODPATH_ValueType slack : {0, 50}) {
+      REQUIRE(TCODPATH_tiled_map_fill(&tiled_distance, MAX) == 0);
+      auto stats = TCODPATH_SearchStats{};
+      if (slack == 0) {
+        TCODPATH_tiled_map_set(&tiled_distance, source[0], source[1], 0);
+        REQUIRE(TCODPATH_tiled_dijkstra(&tiled_costs, &tiled_distance, &direction, 2, 3, &stats) == 0);
+      } else {
+        auto search = TCODPATH_TiledSearch{};
+        REQUIRE(TCODPATH_tiled_search_init(&search, &tiled_costs, &tiled_distance, &direction, 2, 3) == 0);
+        search.slack = slack;
+        search.stats = &stats;
+        REQUIRE(TCODPATH_tiled_search_add_source(&search, source[0], source[1], 0) == 0);
+        REQUIRE(TCODPATH_tiled_search_run(&search) == 0);
+        CHECK(search.tile_loads >= 1);
+        TCODPATH_tiled_search_uninit(&search);
+      }
+      auto distance = Map2D(costs.get_shape(), -1);
+      REQUIRE(TCODPATH_tiled_map_copy_to(&tiled_distance, distance.c_data()) == 0);
+      REQUIRE(as_string(distance) == as_string(expected));
+      check_directions(costs, distance, direction);
+      int64_t reached = 0;
+      for (TCODPATH_IndexType y = 0; y < height; ++y) {
+        for (TCODPATH_IndexType x = 0; x < width; ++x) reached += distance[{y, x}] != MAX;
+      }
+      if (TCODPATH_STATS_ENABLED && slack == 0) CHECK(stats.expansions == reached);
+      if (TCODPATH_STATS_ENABLED) CHECK(stats.expansions >= reached);
+    }
+    TCODPATH_tiled_map_uninit(&direction);
+    TCODPATH_tiled_map_uninit(&tiled_distance);
+    TCODPATH_tiled_map_uninit(&tiled_costs);
+  }
+}
+
+#if defined(__unix__) || defined(__APPLE__)
+TEST_CASE("TCODPATH_tiled_dijkstra on mapped files", "") {
+  auto rng = std::mt19937{3};
+  const TCODPATH_IndexType height = 150;
+  const TCODPATH_IndexType width = 90;
+  auto costs = random_costs(rng, height, width);
+  auto graph = as_2d_graph(costs, 2, 3);
+  auto expected = Map2D(costs.get_shape(), MAX);
+  expected[{0, 0}] = 0;
+  expected[{149, 89}] = 0;
+  TCODPATH_dijkstra(&graph, expected.c_data(), nullptr);
+
+  const auto directory = std::filesystem::temp_directory_path();
+  const auto costs_path = (directory / "tcodpath_tiled_costs.bin").string();
+  const auto distance_path = (directory / "tcodpath_tiled_distance.bin").string();
+  const auto open = [&](TCODPATH_TiledMap& map, const std::string& path, int64_t rows, TCODPATH_TiledOpenMode mode) {
+    return TCODPATH_tiled_map_open(&map, path.c_str(), rows, width, 16, sizeof(TCODPATH_ValueType), mode);
+  };
+  auto tiled_costs = TCODPATH_TiledMap{};
+  REQUIRE(open(tiled_costs, costs_path, height, TCODPATH_TILED_CREATE) == 0);
+  CHECK(tiled_costs.mapped);
+  REQUIRE(TCODPATH_tiled_map_copy_from(&tiled_costs, costs.c_data()) == 0);
+  REQUIRE(TCODPATH_tiled_map_sync(&tiled_costs) == 0);
+  TCODPATH_tiled_map_uninit(&tiled_costs);
+
+  REQUIRE(open(tiled_costs, costs_path, height, TCODPATH_TILED_READ_ONLY) == 0);
+  auto tiled_distance = TCODPATH_TiledMap{};
+  REQUIRE(open(tiled_distance, distance_path, height, TCODPATH_TILED_CREATE) == 0);
+  REQUIRE(TCODPATH_tiled_map_fill(&tiled_distance, MAX) == 0);
+  TCODPATH_tiled_map_set(&tiled_distance, 0, 0, 0);
+  TCODPATH_tiled_map_set(&tiled_distance, 149, 89, 0);
+  REQUIRE(TCODPATH_tiled_dijkstra(&tiled_costs, &tiled_distance, nullptr, 2, 3, nullptr) == 0);
+  auto distance = Map2D(costs.get_shape(), -1);
+  REQUIRE(TCODPATH_tiled_map_copy_to(&tiled_distance, distance.c_data()) == 0);
+  CHECK(as_string(distance) == as_string(expected));
+  TCODPATH_tiled_map_uninit(&tiled_distance);
+  TCODPATH_tiled_map_uninit(&tiled_costs);
+
+  // A file smaller than the map is rejected
+  CHECK(open(tiled_costs, costs_path, height * 2, TCODPATH_TILED_READ_ONLY) < 0);
+  std::filesystem::remove(costs_path);
+  std::filesystem::remove(distance_path);
+}
+#endif